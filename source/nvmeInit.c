@@ -1,3688 +1,7281 @@
-/**
- *******************************************************************************
- ** Copyright (c) 2011-2012                                                   **
- **                                                                           **
- **   Integrated Device Technology, Inc.                                      **
- **   Intel Corporation                                                       **
- **   LSI Corporation                                                         **
- **                                                                           **
- ** All rights reserved.                                                      **
- **                                                                           **
- *******************************************************************************
- **                                                                           **
- ** Redistribution and use in source and binary forms, with or without        **
- ** modification, are permitted provided that the following conditions are    **
- ** met:                                                                      **
- **                                                                           **
- **   1. Redistributions of source code must retain the above copyright       **
- **      notice, this list of conditions and the following disclaimer.        **
- **                                                                           **
- **   2. Redistributions in binary form must reproduce the above copyright    **
- **      notice, this list of conditions and the following disclaimer in the  **
- **      documentation and/or other materials provided with the distribution. **
- **                                                                           **
- ** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS   **
- ** IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, **
- ** THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR    **
- ** PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR         **
- ** CONTRIBUTORS BE LIABLE FOR ANY DIRECT,INDIRECT, INCIDENTAL, SPECIAL,      **
- ** EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,       **
- ** PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR        **
- ** PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF    **
- ** LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING      **
- ** NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS        **
- ** SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.              **
- **                                                                           **
- ** The views and conclusions contained in the software and documentation     **
- ** are those of the authors and should not be interpreted as representing    **
- ** official policies, either expressed or implied, of Intel Corporation,     **
- ** Integrated Device Technology Inc., or Sandforce Corporation.              **
- **                                                                           **
- *******************************************************************************
-**/
-
-/*
- * File: nvmeInit.c
- */
-
-#include "precomp.h"
-#ifndef DBG
-#include "nvmeinit.tmh"
-#endif
-
-/*******************************************************************************
- * NVMeGetPhysAddr
- *
- * @brief Helper routine for converting virtual address to physical address by
- *        calling StorPortGetPhysicalAddress.
- *
- * @param pAE - Pointer to hardware device extension
- * @param pVirtAddr - Virtual address to convert
- *
- * @return STOR_PHYSICAL_ADDRESS
- *     Physical Address - If all resources are allocated and initialized
- *     NULL - If anything goes wrong
- ******************************************************************************/
-STOR_PHYSICAL_ADDRESS NVMeGetPhysAddr(
-    PNVME_DEVICE_EXTENSION pAE,
-    PVOID pVirtAddr
-)
-{
-    ULONG MappedSize;
-    STOR_PHYSICAL_ADDRESS PhysAddr;
-
-    /* Zero out the receiving buffer before converting */
-    PhysAddr.QuadPart = 0;
-    if (pAE->ntldrDump == FALSE) {
-        PhysAddr = StorPortGetPhysicalAddress(pAE,
-                                              NULL,
-                                              pVirtAddr,
-                                              &MappedSize);
-    } else {
-        PhysAddr = MmGetPhysicalAddress(pVirtAddr);
-    }
-
-    /* If fails, log the event and print out the error */
-    if ( PhysAddr.QuadPart == 0) {
-        StorPortDebugPrint(ERROR,
-            "NVMeGetPhysAddr: <Error> Invalid phys addr.\n");
-    }
-
-    return PhysAddr;
-} /* NVMeGetPhysAddr */
-
-/*******************************************************************************
- * NVMeGetCurCoreNumber
- *
- * @brief Helper routine for retrieving current processor number by calling
- *        StorPortGetCurrentProcessorNumber
- *
- * @param pAE - Pointer to hardware device extension
- * @param pPN - Pointer to PROCESSOR_NUMBER structure
- *
- * @return BOOLEAN
- *     TRUE - If valid number is retrieved
- *     FALSE - If anything goes wrong
- ******************************************************************************/
-BOOLEAN NVMeGetCurCoreNumber(
-    PNVME_DEVICE_EXTENSION pAE,
-    PPROCESSOR_NUMBER pPN
-)
-{
-    ULONG Status = STOR_STATUS_SUCCESS;
-
-    /* Get Current processor number and make sure it's valid */
-    Status = StorPortGetCurrentProcessorNumber(pAE, pPN);
-    if (Status != STOR_STATUS_SUCCESS) {
-        StorPortDebugPrint(ERROR,
-                           "NVMeGetCurCoreNumber: <Error> Failure, Sts=%d.\n",
-                           Status);
-        return (FALSE);
-    }
-
-    if (pPN->Number >= pAE->ResMapTbl.NumActiveCores) {
-        StorPortDebugPrint(ERROR,
-                    "NVMeGetCurCoreNumber: <Error> Invalid core number = %d.\n",
-                     pPN->Number);
-        return (FALSE);
-    }
-
-    return (TRUE);
-} /* NVMeGetCurCoreNumber */
-
-/*******************************************************************************
- * NVMeAllocateMem
- *
- * @brief Helper routoine for Buffer Allocation.
- *        StorPortAllocateContiguousMemorySpecifyCacheNode is called to allocate
- *        memory from the preferred NUMA node. If succeeded, zero out the memory
- *        before returning to the caller.
- *
- * @param pAE - Pointer to hardware device extension
- * @param Size - In bytes
- * @param Node - Preferred NUMA node
- *
- * @return PVOID
- *    Buffer Addr - If all resources are allocated and initialized properly
- *    NULL - If anything goes wrong
- ******************************************************************************/
-PVOID NVMeAllocateMem(
-    PNVME_DEVICE_EXTENSION pAE,
-    ULONG Size,
-    ULONG Node
-)
-{
-    PHYSICAL_ADDRESS Low;
-    PHYSICAL_ADDRESS High;
-    PHYSICAL_ADDRESS Align;
-    PVOID pBuf = NULL;
-    ULONG Status = 0;
-    ULONG NewBytesAllocated;
-    
-    if (pAE->ntldrDump == FALSE) {
-        /* Set up preferred range and alignment before allocating */
-        Low.QuadPart = 0;
-        High.QuadPart = (-1);
-        Align.QuadPart = 0;
-        Status = StorPortAllocateContiguousMemorySpecifyCacheNode(
-                     pAE, Size, Low, High, Align, MmCached, Node, (PVOID)&pBuf);
-
-        /* It fails, log the error first */
-        if ((Status != 0) || (pBuf == NULL)) {
-            StorPortDebugPrint(ERROR,
-                               "NVMeAllocateMem: Failure from node=%d, sts=0x%x\n",
-                               Node, Status);
-            /* If the memory allocation fails for the requested node,
-            * we will try to allocate from any available node, which is not
-            * expected to fail.
-            */
-
-            /* Give it another try from any nodes that can grant the request */
-            Status = 0;
-            pBuf = NULL;
-            Status = StorPortAllocateContiguousMemorySpecifyCacheNode(
-                     pAE, Size, Low, High, Align, MmCached, MM_ANY_NODE_OK, (PVOID)&pBuf);
-            if ((Status != 0) || (pBuf == NULL)) {
-                StorPortDebugPrint(ERROR,
-                               "NVMeAllocateMem: Failure from Node 0, sts=0x%x\n",
-                               Status);
-                return NULL;
-            }
-        }
-    } else {     
-        NewBytesAllocated = pAE->DumpBufferBytesAllocated + Size;
-        if (NewBytesAllocated <= DUMP_BUFFER_SIZE) {
-            pBuf = pAE->DumpBuffer + pAE->DumpBufferBytesAllocated;               
-            pAE->DumpBufferBytesAllocated = NewBytesAllocated;
-        } else {
-            StorPortDebugPrint(ERROR,
-                               "Unable to allocate %d bytes at DumpBuffer offset %d.\n",
-                               Size,
-                               pAE->DumpBufferBytesAllocated);
-            return NULL;
-        }
-    }
-
-
-
-    StorPortDebugPrint(INFO, "NVMeAllocateMem: Succeeded!\n");
-    /* Zero out the buffer before return */
-    memset(pBuf, 0, Size);
-
-    return pBuf;
-} /* NVMeAllocateMem */
-
-
-/*******************************************************************************
- * NVMeAllocatePool
- *
- * @brief Helper routoine for non-contiguous buffer allocation.
- *        StorPortAllocatePool is called to allocate memory from non-paged pool.
- *        If succeeded, zero out the memory before returning to the caller.
- *
- * @param pAE - Pointer to hardware device extension
- * @param Size - In bytes
- *
- * @return PVOID
- *     Buffer Addr - If all resources are allocated and initialized properly
- *     NULL - If anything goes wrong
- ******************************************************************************/
-PVOID NVMeAllocatePool(
-    PNVME_DEVICE_EXTENSION pAE,
-    ULONG Size
-)
-{
-    ULONG Tag = 'eMVN';
-    PVOID pBuf = NULL;
-    ULONG Status = STOR_STATUS_SUCCESS;
-    ULONG NewBytesAllocated;
-
-    if (pAE->ntldrDump == FALSE) {
-        /* Call StorPortAllocatePool to allocate the buffer */
-        Status = StorPortAllocatePool(pAE, Size, Tag, (PVOID)&pBuf);
-    } else {     
-        NewBytesAllocated = pAE->DumpBufferBytesAllocated + Size;
-        if (NewBytesAllocated <= DUMP_BUFFER_SIZE) {
-            pBuf = pAE->DumpBuffer + pAE->DumpBufferBytesAllocated;               
-            pAE->DumpBufferBytesAllocated = NewBytesAllocated;
-        } else {
-             StorPortDebugPrint(ERROR,
-                                "Unable to allocate %d bytes at DumpBuffer offset %d.\n",
-                                Size,
-                                pAE->DumpBufferBytesAllocated);
-        }
-    }    
-
-    /* It fails, log the error and return NULL */
-    if ((Status != STOR_STATUS_SUCCESS) || (pBuf == NULL)) {
-        StorPortDebugPrint(ERROR,
-                           "NVMeAllocatePool:<Error> Failure, sts=0x%x\n",
-                           Status );
-        return NULL;
-    }
-
-    /* Zero out the buffer before return */
-    memset(pBuf, 0, Size);
-
-    return pBuf;
-} /* NVMeAllocatePool */
-
-/*******************************************************************************
- * NVMeActiveProcessorCount
- *
- * @brief Helper routoine for deciding the number of active processors of an
- *        NUMA node.
- *
- * @param Mask - bitmap of the active processors
- *
- * @return USHORT
- *     The number of active processors
- ******************************************************************************/
-USHORT NVMeActiveProcessorCount(
-    ULONG_PTR Mask
-)
-{
-    USHORT Count = 0;
-
-    /*
-     * Loop thru the bits of Mask (a 32 or 64-bit value), increase the count
-     * by one when Mask is non-zero after bit-wise AND operation between Mask
-     * and Mask-1. This figures out the number of bits (in Mask) that are set
-     * as 1.
-     */
-    while (Mask) {
-        Count++;
-        Mask &= (Mask - 1);
-    }
-
-    return Count;
-} /* NVMeActiveProcessorCount */
-
-/*******************************************************************************
- * NVMeEnumNumaCores
- *
- * @brief NVMeEnumNumaCores collects the current NUMA/CPU topology information.
- *        Confirms if NUMA is supported, how many NUMA nodes in current system
- *        before allocating memory for CORE_TBL structures
- *
- * @param pAE - Pointer to hardware device extension
- *
- * @return BOOLEAN
- *     TRUE - If all resources are allocated and initialized properly
- *     FALSE - If anything goes wrong
- ******************************************************************************/
-BOOLEAN NVMeEnumNumaCores(
-    PNVME_DEVICE_EXTENSION pAE
-)
-{
-    GROUP_AFFINITY GroupAffinity;
-    USHORT Bit = 0, Grp;
-    ULONG Core = 0, CoreCounter = 0;
-    ULONG BaseCoreNum = 0;
-    ULONG Node = 0;
-    ULONG Status = 0;
-    ULONG TotalCores = 0;
-    USHORT MaxNumCoresInGroup = sizeof(KAFFINITY) * 8;
-    PRES_MAPPING_TBL pRMT = &pAE->ResMapTbl;
-    PCORE_TBL pCoreTblTemp = NULL;
-    PNUMA_NODE_TBL pNNT = NULL;
-    BOOLEAN FirstCoreFound = FALSE;
-    KAFFINITY GrpAffinityMask = 0;
-    PPROC_GROUP_TBL pProcGrpTbl = NULL;
-    ULONG SysProcessorNumber = 0;
-
-    /*
-     * Decide how many NUMA nodes in current system if only one (0 returned),
-     * NUMA is not supported.
-     */
-    StorPortGetHighestNodeNumber( pAE, &Node );
-    pRMT->NumNumaNodes = Node + 1;
-
-    StorPortDebugPrint(INFO,
-                       "NVMeEnumNumaCores: # of NUMA node(s) = %d.\n",
-                       Node + 1);
-    /*
-     * Allocate buffer for NUMA_NODE_TBL structure array.
-     * If fails, return FALSE
-     */
-    pRMT->pNumaNodeTbl = (PNUMA_NODE_TBL)
-        NVMeAllocatePool(pAE, pRMT->NumNumaNodes * sizeof(NUMA_NODE_TBL));
-
-    if (pRMT->pNumaNodeTbl == NULL)
-        return (FALSE);
-
-    /* Find out the current group topology in the system */
-    Status = StorPortGetActiveGroupCount(pAE, &pRMT->NumGroup);
-    if (pRMT->NumGroup == 0 || Status != STOR_STATUS_SUCCESS) {
-        StorPortDebugPrint(INFO, "NVMeEnumNumaCores: Failed to retrieve number of group.\n");
-        return (FALSE);
-    }
-    /*
-     * Allocate buffer for PROC_GROUP_TBL structure array.
-     * If fails, return FALSE
-     */
-    pRMT->pProcGroupTbl = (PPROC_GROUP_TBL)
-        NVMeAllocatePool(pAE, pRMT->NumGroup * sizeof(PROC_GROUP_TBL));
-
-    if (pRMT->pProcGroupTbl == NULL)
-        return (FALSE);
-
-    memset((PVOID)pRMT->pProcGroupTbl, 0, pRMT->NumGroup * sizeof(PROC_GROUP_TBL));
-    StorPortDebugPrint(INFO, "NVMeEnumNumaCores: Number of groups = %d.\n", pRMT->NumGroup);
-    for (Grp = 0; Grp < pRMT->NumGroup; Grp++) {
-        Status = StorPortGetGroupAffinity(pAE, Grp, &GrpAffinityMask);
-        if (Status != STOR_STATUS_SUCCESS) {
-            StorPortDebugPrint(INFO, "NVMeEnumNumaCores: Failed to retrieve group affinity(%d).\n", Grp);
-            return (FALSE);
-        }
-        StorPortDebugPrint(INFO, "NVMeEnumNumaCores: Group(%d) affinity mask(0x%Ix).\n", Grp, GrpAffinityMask);
-        pProcGrpTbl = pRMT->pProcGroupTbl + Grp;
-        pProcGrpTbl->GroupAffinity.Group = Grp;
-        pProcGrpTbl->GroupAffinity.Mask = GrpAffinityMask;
-
-        /* Mark down the associated first system-wise logical processor number*/
-        pProcGrpTbl->BaseProcessor = SysProcessorNumber;
-
-        /* Find out the number of logical processors of the group */
-        pProcGrpTbl->NumProcessor = NVMeActiveProcessorCount(GrpAffinityMask);
-        SysProcessorNumber += pProcGrpTbl->NumProcessor;
-    }
-    StorPortDebugPrint(INFO, "NVMeEnumNumaCores: Total %d logical processors\n", SysProcessorNumber);
-
-    /* Based on NUMA node number, retrieve their affinity masks and counts */
-    for (Node = 0; Node < pRMT->NumNumaNodes; Node++) {
-        pNNT = pRMT->pNumaNodeTbl + Node;
-
-        StorPortDebugPrint(INFO, "NVMeEnumNumaCores: NUMA Node#%d\n", Node);
-
-        /* Retrieve the processor affinity based on NUMA nodes */
-        memset((PVOID)&GroupAffinity, 0, sizeof(GROUP_AFFINITY));
-
-        Status = StorPortGetNodeAffinity(pAE, Node, &GroupAffinity);
-        if (Status != STOR_STATUS_SUCCESS) {
-            StorPortDebugPrint(ERROR,
-                "NVMeEnumNumaCores: <Error> GetNodeAffinity fails, sts=0x%x\n",
-                Status);
-            return (FALSE);
-        }
-
-        StorPortDebugPrint(INFO, "Core mask is 0x%Ix in Group(%d)\n", 
-            GroupAffinity.Mask, GroupAffinity.Group);
-
-        /* Find out the number of active cores of the NUMA node */
-        pNNT->NodeNum = Node;
-        pNNT->NumCores = NVMeActiveProcessorCount(GroupAffinity.Mask);
-        pRMT->NumActiveCores += pNNT->NumCores;
-        StorPortCopyMemory((PVOID)&pNNT->GroupAffinity,
-                           (PVOID)&GroupAffinity,
-                           sizeof(GROUP_AFFINITY));
-    }
-
-    /* Allocate buffer for CORE_TBL structure array. If fails, return FALSE */
-    pRMT->pCoreTbl = (PCORE_TBL)
-        NVMeAllocatePool(pAE, pRMT->NumActiveCores * sizeof(CORE_TBL));
-
-    if (pRMT->pCoreTbl == NULL)
-        return (FALSE);
-
-    /* Based on NUMA node number, populate the NUMA/Core tables */
-    for (Node = 0; Node < pRMT->NumNumaNodes; Node++) {
-        pNNT = pRMT->pNumaNodeTbl + Node;
-        if (pNNT->NumCores == 0)
-            continue;
-        /* figure out the system-wise starting logical processor number for the node */
-        pProcGrpTbl = pRMT->pProcGroupTbl + pNNT->GroupAffinity.Group;
-        BaseCoreNum = pProcGrpTbl->BaseProcessor;
-
-        /*
-         * For each existing NUMA node, need to find out its first and last
-         * associated cores in terms of system-wise processor number for
-         * later reference in IO queue allocation. Initialize the as the first
-         * core number of the associated group.
-         */
-        pNNT->FirstCoreNum = BaseCoreNum;
-        pNNT->LastCoreNum = BaseCoreNum;
-        FirstCoreFound = FALSE;
-
-        /* For each core, populate CORE_TBL structure */
-        for (Bit = 0; Bit < MaxNumCoresInGroup; Bit++) {
-            /* Save previsou bit check result first */
-            if (((pNNT->GroupAffinity.Mask >> Bit) & 1) == 1) {
-                /* Mark the first core if haven't found yet, reset the counter */
-                if (FirstCoreFound == FALSE) {
-                    CoreCounter = 0;
-                    FirstCoreFound = TRUE;
-                }
-                Core = BaseCoreNum + CoreCounter;
-                pCoreTblTemp = pRMT->pCoreTbl + Core;
-                pCoreTblTemp->NumaNode = (USHORT) Node;
-                pCoreTblTemp->Group = pNNT->GroupAffinity.Group;
-                
-                /* Always mark the last core */
-                pNNT->LastCoreNum = Core;
-                CoreCounter++;
-                TotalCores++;
-            }
-        }
-
-        StorPortDebugPrint(INFO,
-                           "There are %d cores in Node#%d.\n",
-                           pNNT->NumCores, Node);
-    }
-
-    /* Double check the total core number */
-    if (TotalCores > pRMT->NumActiveCores) {
-        StorPortDebugPrint(ERROR,
-            "NVMeEnumNumaCores: <Error> Cores number mismatch, %d, %d\n",
-            TotalCores, pRMT->NumActiveCores);
-
-        return (FALSE);
-    }
-
-    StorPortDebugPrint(INFO,
-                       "The total number of CPU cores %d.\n",
-                       pRMT->NumActiveCores);
-
-    return(TRUE);
-} /* NVMeEnumNumaCores */
-
-/*******************************************************************************
- * NVMeStrCompare
- *
- * @brief Helper routoine for deciding which driver is being loaded
- *
- * @param pTargetString - Pointer to the target string to compare with.
- * @param pArgumentString - Pointer to the string from the system.
- *
- * @return BOOLEAN
- *     TRUE - If it's a normal driver being loaded
- *     FALSE - If it's a crashdump or hibernation driver being loaded
- ******************************************************************************/
-BOOLEAN NVMeStrCompare(
-    PCSTR pTargetString,
-    PCSTR pArgumentString
-)
-{
-    PCHAR pTargetIndex = (PCHAR) pTargetString;
-    PCHAR pArgumentIndex = (PCHAR) pArgumentString;
-    CHAR Target;
-    CHAR Argument;
-
-    if (pArgumentIndex == NULL) {
-        return (FALSE);
-    }
-
-    while (*pTargetIndex) {
-        Target = *pTargetIndex;
-        Argument = *pArgumentIndex;
-
-        /* Lower case the char. */
-        if ((Target >= 'A') && (Target <= 'Z')) {
-            Target = Target + ('a' - 'A');
-        }
-
-        if ((Argument >= 'A') && (Argument <= 'Z')) {
-            Argument = Argument + ('a' - 'A');
-        }
-
-        /* Return FALSE if not matched */
-        if (Target != Argument) {
-            return FALSE;
-        }
-
-        pTargetIndex++;
-        pArgumentIndex++;
-    }
-
-    return (TRUE);
-} /* NVMeStrCompare */
-
-/*******************************************************************************
- * NVMeEnumMsiMessages
- *
- * @brief NVMeEnumMsiMessages retrieves the related information of granted MSI
- *        vectors, such as, address, data, and the number of granted vectors,
- *        etc...
- *
- * @param pAE - Pointer to hardware device extension.
- *
- * @return BOOLEAN
- *     TRUE - If all resources are allocated and initialized properly
- *     FALSE - If anything goes wrong
- ******************************************************************************/
-BOOLEAN NVMeEnumMsiMessages (
-    PNVME_DEVICE_EXTENSION pAE
-)
-{
-    ULONG32 MsgID;
-    ULONG32 Status = STOR_STATUS_SUCCESS;
-    MESSAGE_INTERRUPT_INFORMATION MII;
-    PRES_MAPPING_TBL pRMT = &pAE->ResMapTbl;
-    PMSI_MESSAGE_TBL pMMT = NULL;
-
-    /* Assuming it's MSI-X by defult and find it out later */
-    pRMT->InterruptType = INT_TYPE_MSIX;
-
-    /*
-     * Loop thru each MessageID by calling StorPortMSIInfo
-     * to see if it is granted by OS and figure out how many
-     * messages are actually granted
-     */
-    for (MsgID = 0; MsgID < pRMT->NumActiveCores; MsgID++) {
-        pMMT = pRMT->pMsiMsgTbl + MsgID;
-
-        memset(&MII, 0, sizeof(MESSAGE_INTERRUPT_INFORMATION));
-
-        Status = StorPortGetMSIInfo ( pAE, MsgID, &MII );
-        if (Status == STOR_STATUS_SUCCESS) {
-            /* It's granted only when the IDs matched */
-            if (MsgID == MII.MessageId) {
-                pMMT->MsgID = MII.MessageId;
-                pMMT->Addr = MII.MessageAddress;
-                pMMT->Data = MII.MessageData;
-            } else {
-                ASSERT(FALSE);
-            }
-        } else {
-			/* Use INTx when failing to retrieve any message information */
-			if (MsgID == 0)
-				pRMT->InterruptType = INT_TYPE_INTX;
-			/* Number of MSI Granted will No of IO Queue + 1 Admin Queue 
-			Incase of Active Core more than Queues supported
-			Admin Queue MSGID should not be considered*/
-			else
-				MsgID--;
-
-            break;
-        }
-    }
-
-    pRMT->NumMsiMsgGranted = MsgID;
-
-    StorPortDebugPrint(INFO,
-                       "NVMeEnumMsiMessages: Msg granted=%d\n",
-                       pRMT->NumMsiMsgGranted);
-
-    /* Is the request message number satisfied? */
-    if (pRMT->NumMsiMsgGranted > 1) {
-        /* If the addresses for the first 2 messages are == then its MSI */
-        pMMT = pRMT->pMsiMsgTbl + 1;
-        if (pMMT->Addr.QuadPart == pRMT->pMsiMsgTbl->Addr.QuadPart) {
-            pRMT->InterruptType = INT_TYPE_MSI;
-        }
-    } else if (pRMT->NumMsiMsgGranted == 1) {
-        /* Only one message granted and it is shared */
-        pRMT->InterruptType = INT_TYPE_MSI;
-        pRMT->pMsiMsgTbl->Shared = TRUE;
-    } else {
-        /* Using INTx and the interrupt is shared anyway */
-        pRMT->pMsiMsgTbl->Shared = TRUE;
-    }
-
-    return (TRUE);
-} /* NVMeEnumMsiMessages */
-
-/*******************************************************************************
- * NVMeMsiMapCores
- *
- * @brief NVMeMsiMapCores is called to setup the initial mapping for MSI or MSIX
- *        modes.  Initial mapping is just 1:1, learning will happen as each core
- *        processes an IO and new mappings will be created for optimal use.
- *
- * @param pAE - Pointer to hardware device extension.
- *
- * @return VOID
- ******************************************************************************/
-VOID NVMeMsiMapCores(
-	PNVME_DEVICE_EXTENSION pAE
-	)
-{
-	UCHAR Core;
-	UCHAR MaxCore;
-	PRES_MAPPING_TBL pRMT = &pAE->ResMapTbl;
-	PMSI_MESSAGE_TBL pMMT = NULL;
-	PCORE_TBL pCT = NULL;
-	PCPL_QUEUE_INFO pCQI = NULL;
-	USHORT MsgID;
-	PGROUP_AFFINITY pTempGrpAff = NULL;
-	GROUP_AFFINITY TempGrpAff;
-	PPROC_GROUP_TBL pProcGrpTbl = NULL;
-	PQUEUE_INFO pQI = &pAE->QueueInfo;
-#if DBG
-	ULONG CoreNo;
-#endif
-
-	MaxCore = (UCHAR)min(pAE->QueueInfo.NumSubIoQAllocFromAdapter,
-		pAE->QueueInfo.NumCplIoQAllocFromAdapter);
-	
-
-	/* if API is executed succesfully use the data obtained from API else fallback to learning cores */
-	if (pAE->IsMsiMappingComplete == TRUE)
-	{
-		/* Handle every msgid that is available..!! */
-		for (MsgID = 0; MsgID < pRMT->NumMsiMsgGranted; MsgID++)
-		{
-			pTempGrpAff = pAE->pArrGrpAff + MsgID;
-			memcpy(&TempGrpAff, pTempGrpAff, sizeof(GROUP_AFFINITY));
-			/* Check which bit is set in mask, this will be the corresponding coreno for current msgid */
-			for (Core = 0; Core < pRMT->NumActiveCores; Core++)
-			{
-				if (((TempGrpAff.Mask) & 1) == 1)
-					break;
-				else
-					TempGrpAff.Mask = TempGrpAff.Mask >> 1;
-			}
-
-			/* Update values in core table and msimsg table accordingly.. */
-			pProcGrpTbl = pRMT->pProcGroupTbl + TempGrpAff.Group;
-			pCT = pRMT->pCoreTbl + Core + pProcGrpTbl->BaseProcessor;
-			pCT->Group = TempGrpAff.Group;
-			/* assign new queue pair only if MsgGranted is less than Cores*/
-			if (pAE->ResMapTbl.NumMsiMsgGranted < pAE->ResMapTbl.NumActiveCores) {
-				pCT->CplQueue = pCT->SubQueue = (USHORT)pQI->NumIoQMapped;
-			}
-			pCT->MsiMsgID = MsgID;
-			pMMT = pRMT->pMsiMsgTbl + pCT->MsiMsgID;
-			pMMT->CplQueueNum = pCT->CplQueue;
-			pCQI = pQI->pCplQueueInfo + pCT->CplQueue;
-			pCQI->MsiMsgID = pCT->MsiMsgID;
-			pQI->NumIoQMapped++;
-
-		}
-
-#if DBG
-		StorPortDebugPrint(INFO, "NVMeMsimapcores: <Info> Learning Complete.  Core Table:\n");
-		for (CoreNo = 0; CoreNo < pRMT->NumActiveCores; CoreNo++) {
-			pCT = pRMT->pCoreTbl + CoreNo;
-			StorPortDebugPrint(INFO, "NVMeMsimapcores: <Info> \tCore(%d) MSID(%d) QueuePair(%d)\n",
-				CoreNo,
-				pCT->MsiMsgID,
-				pCT->SubQueue);
-		}
-		pAE->LearningComplete = TRUE;
-#endif
-		pAE->LearningCores = pRMT->NumActiveCores;
-
-	}
-	else
-	{
-
-
-		/*
-		 * Loop thru the cores and assign granted messages in sequential manner.
-		 * When requests completed, based on the messagID and look up the
-		 * associated completion queue for just-completed entries
-		 */
-		for (Core = 0; Core < pRMT->NumActiveCores; Core++) {
-			if (Core < MaxCore) {
-				/* Handle one Core Table at a time */
-				pCT = pRMT->pCoreTbl + Core;
-
-				/* Mark down the initial associated message + SQ/CQ for this core */
-				pCT->MsiMsgID = pCT->CplQueue - 1;
-
-				/*
-				 * On the other side, mark down the associated core number
-				 * for the message as well
-				 */
-				pMMT = pRMT->pMsiMsgTbl + pCT->MsiMsgID;
-				pMMT->CplQueueNum = pCT->CplQueue;
-
-				StorPortDebugPrint(INFO,
-					"NVMeMsiMapCores: Core(0x%x)Msg#(0x%x)\n",
-					Core, pCT->MsiMsgID);
-			}
-		}
-	}
-} /* NVMeMsiMapCores */
-
-/*******************************************************************************
- * NVMeCompleteResMapTbl
- *
- * @brief NVMeCompleteResMapTbl completes the resource mapping table among
- *        active cores, the granted vectors and the allocated IO queues.
- *
- * @param pAE - Pointer to hardware device extension.
- *
- * @return VOID
- ******************************************************************************/
-VOID NVMeCompleteResMapTbl(
-    PNVME_DEVICE_EXTENSION pAE
-)
-{
-    PRES_MAPPING_TBL pRMT = &pAE->ResMapTbl;
-
-    /* The last thing to do is completing Resource Mapping Table. */
-    if ( (pRMT->InterruptType == INT_TYPE_MSIX) ||
-         (pRMT->InterruptType == INT_TYPE_MSI) ) {
-        NVMeMsiMapCores(pAE);
-    }
-
-    /* No need to do anything more for INTx */
-
-} /* NVMeCompleteResMapTbl */
-
-/*******************************************************************************
- * NVMeMapCore2Queue
- *
- * @brief NVMeMapCore2Queue is called to retrieve the associated queue ID of the
- *        given core number
- *
- * @param pAE - Pointer to hardware device extension
- * @param pPN - Pointer to PROCESSOR_NUMBER structure
- * @param pSubQueue - Pointer to buffer to save retrieved submI[QueueID]ssion queue ID
- * @param pCplQueue - Pointer to buffer to save retrieved Completion queue ID
- *
- * @return ULONG
- *     STOR_STATUS_SUCCESS - If valid number is retrieved
- *     STOR_STATUS_UNSUCCESSFUL - If anything goes wrong
- ******************************************************************************/
-ULONG NVMeMapCore2Queue(
-    PNVME_DEVICE_EXTENSION pAE,
-    PPROCESSOR_NUMBER pPN,
-    USHORT* pSubQueue,
-    USHORT* pCplQueue
-)
-{
-    PRES_MAPPING_TBL pRMT = &pAE->ResMapTbl;
-    PCORE_TBL pCT = NULL;
-	PPROC_GROUP_TBL pPGT = NULL;
-    ULONG coreNum;
-
-    if (pAE->ntldrDump == TRUE) {
-        *pSubQueue = *pCplQueue = 1;
-        return (STOR_STATUS_SUCCESS);
-    }
-
-	pPGT = pRMT->pProcGroupTbl + pPN->Group;
-	coreNum = (ULONG)(pPN->Number + pPGT->BaseProcessor);
-    
-    /* Ensure the core number is valid first */
-    if (coreNum >= pRMT->NumActiveCores) {
-        StorPortDebugPrint(ERROR,
-            "NVMeMapCore2Queue: <Error> Invalid core number = %d.\n", coreNum);
-        return (STOR_STATUS_UNSUCCESSFUL);
-    }
-
-    /* Locate the target CORE_TBL entry for the specific core number
-     * indexed depending on whether we're still learning the table or not
-     */
-    if (pAE->LearningCores == pRMT->NumActiveCores) {
-        pCT = pRMT->pCoreTbl + coreNum;
-        /* Return the queue IDs */
-        *pSubQueue = pCT->SubQueue;
-        *pCplQueue = pCT->CplQueue;
-    } else {
-        *pSubQueue = (USHORT)pAE->LearningCores + 1;
-        *pCplQueue = (USHORT)pAE->LearningCores + 1;
-    }
-
-    return (STOR_STATUS_SUCCESS);
-} /* NVMeMapCore2Queue */
-
-/*******************************************************************************
- * NVMeInitFreeQ
- *
- * @brief NVMeInitFreeQ gets called to initialize the free queue list of the
- *        specific submission queue with its associated command entries and PRP
- *        List buffers.
- *
- * @param pSQI - Pointer to the SUB_QUEUE_INFO structure.
- *
- * @return VOID
- ******************************************************************************/
-VOID NVMeInitFreeQ(
-    PSUB_QUEUE_INFO pSQI,
-    PNVME_DEVICE_EXTENSION pAE
-)
-{
-    USHORT Entry;
-    PCMD_ENTRY pCmdEntry = NULL;
-    PCMD_INFO pCmdInfo = NULL;
-    ULONG_PTR CurPRPList = 0;
-    ULONG prpListSz = 0;
-#ifdef DUMB_DRIVER
-    ULONG_PTR PtrTemp;
-    ULONG dblBuffSz = 0;
-#endif
-
-    /* For each entry, initialize the CmdID and PRPList flields */
-    CurPRPList = (ULONG_PTR)((PUCHAR)pSQI->pPRPListStart);
-
-    for (Entry = 0; Entry < pSQI->SubQEntries; Entry++) {
-        pCmdEntry = (PCMD_ENTRY)pSQI->pCmdEntry;
-        pCmdEntry += Entry;
-        pCmdInfo = &pCmdEntry->CmdInfo;
-
-        /*
-         * Set up CmdID and dedicated PRP Lists before adding to FreeQ
-         * Use Entry to locate the starting point.
-         */
-        pCmdInfo->CmdID = Entry;
-        pCmdInfo->pPRPList = (PVOID)(CurPRPList + pAE->PRPListSize);
-
-        /*
-         * Because PRP List can't cross page boundary, if not enough room left
-         * for one list, need to move on to next page boundary.
-         * NumPRPListOnepage is calculated for this purpose.
-         */
-        if (Entry != 0 && ((Entry % pSQI->NumPRPListOnePage) == 0))
-            pCmdInfo->pPRPList = PAGE_ALIGN_BUF_PTR(pCmdInfo->pPRPList);
-
-        /* Save the address of current list for calculating next list */
-        CurPRPList = (ULONG_PTR)pCmdInfo->pPRPList;
-        pCmdInfo->prpListPhyAddr = NVMeGetPhysAddr(pAE, pCmdInfo->pPRPList);
-
-#ifdef DUMB_DRIVER
-        PtrTemp = (ULONG_PTR)((PUCHAR)pSQI->pDlbBuffStartVa);
-        pCmdInfo->pDblVir = (PVOID)(PtrTemp + (DUMB_DRIVER_SZ * Entry));
-        pCmdInfo->dblPhy = StorPortGetPhysicalAddress(pAE,
-                                                      NULL,
-                                                      pCmdInfo->pDblVir,
-                                                      &dblBuffSz);
-
-        PtrTemp = (ULONG_PTR)((PUCHAR)pSQI->pDlbBuffStartListVa);
-        pCmdInfo->pDblPrpListVir = (PVOID)(PtrTemp + (PAGE_SIZE * Entry));
-        pCmdInfo->dblPrpListPhy = StorPortGetPhysicalAddress(pAE,
-                                                      NULL,
-                                                      pCmdInfo->pDblPrpListVir,
-                                                      &dblBuffSz);
-#endif
-
-        InsertTailList(&pSQI->FreeQList, &pCmdEntry->ListEntry);
-    }
-} /* NVMeInitFreeQ */
-
-/*******************************************************************************
- * NVMeAllocQueues
- *
- * @brief NVMeAllocQueues gets called to allocate buffers in
- *        non-paged, contiguous memory space for Submission/Completion queues.
- *
- * @param pAE - Pointer to hardware device extension.
- * @param QueueID - Which queue to allocate memory for
- * @param QEntries - the number of entries to allocate for this queue
- * @param NumaNode - Which NUMA node associated memory to allocate from
- *
- * @return ULONG
- *     STOR_STATUS_SUCCESS - If all resources are allocated properly
- *     Otherwise - If anything goes wrong
- ******************************************************************************/
-ULONG NVMeAllocQueues (
-    PNVME_DEVICE_EXTENSION pAE,
-    USHORT QueueID,
-    ULONG QEntries,
-    USHORT NumaNode
-)
-{
-
-    /* The number of Submission entries makes up exact one system page size */
-    ULONG SysPageSizeInSubEntries;
-    PQUEUE_INFO pQI = &pAE->QueueInfo;
-    PSUB_QUEUE_INFO pSQI = NULL;
-    PRES_MAPPING_TBL pRMT = &pAE->ResMapTbl;
-    ULONG SizeQueueEntry = 0;
-    ULONG NumPageToAlloc = 0;
-
-    /* Ensure the QueueID is valid via the number of active cores in system */
-    if (QueueID > pRMT->NumActiveCores)
-        return (STOR_STATUS_INVALID_PARAMETER);
-
-    /* Locate the target SUB_QUEUE_STRUCTURE via QueueID */
-    pSQI = pQI->pSubQueueInfo + QueueID;
-
-    /*
-     * To ensure:
-     *   1. Allocating enough memory and
-     *   2. The starting addresses of Sub/Com queues are system page aligned.
-     *
-     *      Need to:
-     *        1. Round up the allocated size of all Submission entries to be
-     *           multiple(s) of system page size.
-     *        2. Add one extra system page to allocation size
-     */
-    SysPageSizeInSubEntries = PAGE_SIZE / sizeof (NVMe_COMMAND);
-    if ((QEntries % SysPageSizeInSubEntries) != 0)
-        QEntries = (QEntries + SysPageSizeInSubEntries) &
-                  ~(SysPageSizeInSubEntries - 1);
-
-    /*
-     * Determine the allocation size in bytes
-     *   1. For Sub/Cpl/Cmd entries
-     *   2. For PRP Lists
-     */
-    SizeQueueEntry = QEntries * (sizeof(NVMe_COMMAND) +
-                                 sizeof(NVMe_COMPLETION_QUEUE_ENTRY) +
-                                 sizeof(CMD_ENTRY));
-
-    /* Allcate memory for Sub/Cpl/Cmd entries first */
-    pSQI->pQueueAlloc = NVMeAllocateMem(pAE,
-                                        SizeQueueEntry + PAGE_SIZE,
-                                        NumaNode);
-
-    if (pSQI->pQueueAlloc == NULL)
-        return ( STOR_STATUS_INSUFFICIENT_RESOURCES );
-
-    /* Save the size if needed to free the unused buffers */
-    pSQI->QueueAllocSize = SizeQueueEntry + PAGE_SIZE;
-
-#ifdef DUMB_DRIVER
-    pSQI->pDblBuffAlloc = NVMeAllocateMem(pAE,
-                                          (QEntries * DUMB_DRIVER_SZ) + PAGE_SIZE,
-                                          NumaNode);
-
-    if (pSQI->pDblBuffAlloc == NULL)
-        return ( STOR_STATUS_INSUFFICIENT_RESOURCES );
-
-    /* Save the size if needed to free the unused buffers */
-    pSQI->dblBuffSz = (QEntries * DUMB_DRIVER_SZ) + PAGE_SIZE;
-
-    /* now the PRP list mem for this SQ to use */
-    pSQI->pDblBuffListAlloc = NVMeAllocateMem(pAE,
-                                          (QEntries * PAGE_SIZE) + PAGE_SIZE,
-                                          NumaNode);
-
-    if (pSQI->pDblBuffListAlloc == NULL)
-        return ( STOR_STATUS_INSUFFICIENT_RESOURCES );
-
-    /* Save the size if needed to free the unused buffers */
-    pSQI->dblBuffListSz = (QEntries * PAGE_SIZE) + PAGE_SIZE;
-#endif
-
-    /*
-     * Allcate memory for PRP Lists In order not crossing page boundary, need to
-     * calculate how many lists one page can accommodate.
-     */
-    pSQI->NumPRPListOnePage = PAGE_SIZE / pAE->PRPListSize;
-    NumPageToAlloc = (QEntries % pSQI->NumPRPListOnePage) ?
-        (QEntries / pSQI->NumPRPListOnePage) + 1 :
-        (QEntries / pSQI->NumPRPListOnePage);
-
-    pSQI->pPRPListAlloc = NVMeAllocateMem(pAE,
-                                          (NumPageToAlloc + 1) * PAGE_SIZE,
-                                          NumaNode);
-
-    if (pSQI->pPRPListAlloc == NULL) {
-        /* Free the allcated memory for Sub/Cpl/Cmd entries before returning */
-        StorPortFreeContiguousMemorySpecifyCache((PVOID)pAE,
-                                                 pSQI->pQueueAlloc,
-                                                 pSQI->QueueAllocSize,
-                                                 MmCached);
-        pSQI->pQueueAlloc = NULL;
-        return ( STOR_STATUS_INSUFFICIENT_RESOURCES );
-    }
-
-    /* Save the size if needed to free the unused buffers */
-    pSQI->PRPListAllocSize = (NumPageToAlloc + 1) * PAGE_SIZE;
-
-    /* Mark down the number of entries allocated successfully */
-    if (QueueID != 0) {
-        pQI->NumIoQEntriesAllocated = (USHORT)QEntries;
-    } else {
-        pQI->NumAdQEntriesAllocated = (USHORT)QEntries;
-    }
-
-    return (STOR_STATUS_SUCCESS);
-} /* NVMeAllocQueues */
-
-/*******************************************************************************
- * NVMeInitSubQueue
- *
- * @brief NVMeInitSubQueue gets called to initialize the SUB_QUEUE_INFO
- *        structure of the specific submission queue associated with the QueueID
- *
- * @param pAE - Pointer to hardware device extension.
- * @param QueueID - Which submission queue structure to initialize
- *
- * @return ULONG
- *     STOR_STATUS_SUCCESS - If all resources are allocated properly
- *     Otherwise - If anything goes wrong
- ******************************************************************************/
-ULONG NVMeInitSubQueue(
-    PNVME_DEVICE_EXTENSION pAE,
-    USHORT QueueID
-)
-{
-    PQUEUE_INFO pQI = &pAE->QueueInfo;
-    PSUB_QUEUE_INFO pSQI = pQI->pSubQueueInfo + QueueID;
-    PRES_MAPPING_TBL pRMT = &pAE->ResMapTbl;
-    ULONG_PTR PtrTemp = 0;
-    USHORT Entries;
-    ULONG dbIndex = 0;
-    UCHAR maxCore;
-
-    NVMe_CONTROLLER_CAPABILITIES CAP = {0};
-
-    maxCore = (UCHAR)min(pAE->QueueInfo.NumCplIoQAllocFromAdapter,
-                        pAE->QueueInfo.NumSubIoQAllocFromAdapter);
-
-    /* Ensure the QueueID is valid via the number of active cores in system */
-    if (QueueID > maxCore)
-        return ( STOR_STATUS_INVALID_PARAMETER );
-		
-/* Code Analysis fails on StoPortReadRegisterUlong64 */
-#if 0 // (NTDDI_VERSION > NTDDI_WIN7) && defined(_WIN64)
-    CAP.AsUlonglong = StorPortReadRegisterUlong64(pAE,
-        (PULONG64)(&pAE->pCtrlRegister->CAP));
-#else
-    CAP.HighPart = StorPortReadRegisterUlong(pAE,
-        (PULONG)(&pAE->pCtrlRegister->CAP.HighPart));
-    CAP.LowPart = StorPortReadRegisterUlong(pAE,
-        (PULONG)(&pAE->pCtrlRegister->CAP.LowPart));
-#endif
-
-    /* Initialize static fields of SUB_QUEUE_INFO structure */
-    pSQI->SubQEntries = (QueueID != 0) ? pQI->NumIoQEntriesAllocated :
-                                         pQI->NumAdQEntriesAllocated;
-    pSQI->SubQueueID = QueueID;
-    pSQI->FreeSubQEntries = pSQI->SubQEntries;
-
-     /* calculate byte offset per 1.0c spec formula */
-    dbIndex = 2 * QueueID * (4 << CAP.DSTRD);
-
-    /* convert to index */
-    dbIndex = dbIndex / sizeof(NVMe_QUEUE_Y_DOORBELL);
-    pSQI->pSubTDBL = (PULONG)(&pAE->pCtrlRegister->IODB[dbIndex].QHT );
-
-    StorPortDebugPrint(INFO,
-                       "NVMeInitSubQueue : SQ 0x%x pSubTDBL 0x%p at index  0x%x\n",
-                       QueueID, pSQI->pSubTDBL, dbIndex);
-    pSQI->Requests = 0;
-    pSQI->SubQTailPtr = 0;
-    pSQI->SubQHeadPtr = 0;
-
-    /*
-     * The queue is shared by cores when:
-     *   it's Admin queue, or
-     *   not enough IO queues are allocated, or
-     *   we are in crashdump.
-     */
-    if ((QueueID == 0)                                   ||
-        (pQI->NumSubIoQAllocated < maxCore) ||
-        (pAE->ntldrDump == TRUE)) {
-        pSQI->Shared = TRUE;
-    }
-
-    pSQI->CplQueueID = QueueID;
-
-    /*
-     * Initialize submission queue starting point. Per NVMe specification, need
-     * to make it system page aligned if it's not.
-     */
-    pSQI->pSubQStart = PAGE_ALIGN_BUF_PTR(pSQI->pQueueAlloc);
-
-    memset(pSQI->pQueueAlloc, 0, pSQI->QueueAllocSize);
-
-    pSQI->SubQStart = NVMeGetPhysAddr(pAE, pSQI->pSubQStart);
-    /* If fails on converting to physical address, return here */
-    if (pSQI->SubQStart.QuadPart == 0)
-        return ( STOR_STATUS_INSUFFICIENT_RESOURCES );
-
-#ifdef DUMB_DRIVER
-    pSQI->pDlbBuffStartVa = PAGE_ALIGN_BUF_PTR(pSQI->pDblBuffAlloc);
-    memset(pSQI->pDblBuffAlloc, 0, pSQI->dblBuffSz);
-
-    pSQI->pDlbBuffStartListVa = PAGE_ALIGN_BUF_PTR(pSQI->pDblBuffListAlloc);
-    memset(pSQI->pDblBuffListAlloc, 0, pSQI->dblBuffListSz);
-#endif
-
-    /*
-     * Initialize PRP list starting point. Per NVMe specification, need to make
-     * it system page aligned if it's not.
-     */
-    pSQI->pPRPListStart = PAGE_ALIGN_BUF_PTR(pSQI->pPRPListAlloc);
-    memset(pSQI->pPRPListAlloc, 0, pSQI->PRPListAllocSize);
-
-    pSQI->PRPListStart = NVMeGetPhysAddr( pAE, pSQI->pPRPListStart );
-    /* If fails on converting to physical address, return here */
-    if (pSQI->PRPListStart.QuadPart == 0)
-        return ( STOR_STATUS_INSUFFICIENT_RESOURCES );
-
-    /* Initialize list head of the free queue list */
-    InitializeListHead(&pSQI->FreeQList);
-
-    return (STOR_STATUS_SUCCESS);
-} /* NVMeInitSubQueue */
-
-/*******************************************************************************
- * NVMeInitCplQueue
- *
- * @brief NVMeInitCplQueue gets called to initialize the CPL_QUEUE_INFO
- *        structure of the specific completion queue associated with the QueueID
- *
- * @param pAE - Pointer to hardware device extension.
- * @param QueueID - Which completion queue structure to initialize
- *
- * @return ULONG
- *     STOR_STATUS_SUCCESS - If all resources are allocated properly
- *     Otherwise - If anything goes wrong
- ******************************************************************************/
-ULONG NVMeInitCplQueue(
-    PNVME_DEVICE_EXTENSION pAE,
-    USHORT QueueID
-)
-{
-    PQUEUE_INFO pQI = &pAE->QueueInfo;
-    PSUB_QUEUE_INFO pSQI = NULL;
-    PCPL_QUEUE_INFO pCQI = NULL;
-    PRES_MAPPING_TBL pRMT = &pAE->ResMapTbl;
-    PCORE_TBL pCT = NULL;
-    ULONG_PTR PtrTemp;
-    USHORT Entries;
-    ULONG queueSize = 0;
-    ULONG dbIndex = 0;
-    UCHAR maxCore;
-
-    NVMe_CONTROLLER_CAPABILITIES CAP = {0};
-
-    maxCore = (UCHAR)min(pAE->QueueInfo.NumCplIoQAllocFromAdapter,
-                        pAE->QueueInfo.NumSubIoQAllocFromAdapter);
-
-    /* Ensure the QueueID is valid via the number of active cores in system */
-    if (QueueID > maxCore)
-        return ( STOR_STATUS_INVALID_PARAMETER );
-		
-/* Code Analysis fails on StoPortReadRegisterUlong64 */
-#if 0 // (NTDDI_VERSION > NTDDI_WIN7) && defined(_WIN64)
-    CAP.AsUlonglong = StorPortReadRegisterUlong64(pAE,
-        (PULONG64)(&pAE->pCtrlRegister->CAP));
-#else
-    CAP.HighPart = StorPortReadRegisterUlong(pAE,
-        (PULONG)(&pAE->pCtrlRegister->CAP.HighPart));
-    CAP.LowPart = StorPortReadRegisterUlong(pAE,
-        (PULONG)(&pAE->pCtrlRegister->CAP.LowPart));
-#endif
-
-    pSQI = pQI->pSubQueueInfo + QueueID;
-    pCQI = pQI->pCplQueueInfo + QueueID;
-
-    /* Initialize static fields of CPL_QUEUE_INFO structure */
-    pCQI->CplQueueID = QueueID;
-    pCQI->CplQEntries = pSQI->SubQEntries;
-
-    /* calculate byte offset per 10.c spec formula  */
-    dbIndex = (2 * QueueID + 1) * (4 << CAP.DSTRD);
-
-    /* convert to index */
-    dbIndex = dbIndex / sizeof(NVMe_QUEUE_Y_DOORBELL);
-    pCQI->pCplHDBL = (PULONG)(&pAE->pCtrlRegister->IODB[dbIndex].QHT );
-
-    StorPortDebugPrint(INFO,
-                       "NVMeInitCplQueue : CQ 0x%x pCplHDBL 0x%p at index  0x%x\n",
-                       QueueID, pCQI->pCplHDBL, dbIndex);
-    pCQI->Completions = 0;
-    pCQI->CurPhaseTag = 0;
-    pCQI->CplQHeadPtr = 0;
-
-    /**
-     * The queue is shared by cores when:
-     *   it's Admin queue, or
-     *   not enough IO queues are allocated, or
-     *   we are in crashdump.
-     */
-    if ((QueueID == 0)                                   ||
-        (pQI->NumCplIoQAllocated < maxCore) ||
-        (pAE->ntldrDump == TRUE)) {
-        pCQI->Shared = TRUE;
-    }
-
-    if (pRMT->InterruptType == INT_TYPE_MSI ||
-        pRMT->InterruptType == INT_TYPE_MSIX) {
-        if (pRMT->NumMsiMsgGranted < maxCore) {
-            /* All completion queueus share the single message */
-            pCQI->MsiMsgID = 0;
-        } else {
-            /*
-             * When enough queues allocated, the mappings between cores and
-             * queues are set up as core#(n) <=> queue#(n+1)
-             * Only need to deal with IO queues since Admin queue uses message#0
-             *
-             * When we come through here the first time during boot/init, the msg
-             * ID needs to be initialized.  After learning is complete, the msg ID
-             * will point to the proper MSI vector.  Learning is complete when
-             * LearningCores == NumActiveCores.
-             */
-            if ((QueueID != 0) && (pAE->LearningCores < pRMT->NumActiveCores)) {
-                pCT = pRMT->pCoreTbl + QueueID - 1;
-                pCQI->MsiMsgID = pCT->MsiMsgID;
-            }
-        }
-    }
-
-    /*
-     * Initialize completion queue entries. Firstly, make Cpl queue starting
-     * entry system page aligned.
-     */
-    queueSize = pSQI->SubQEntries * sizeof(NVMe_COMMAND);
-    PtrTemp = (ULONG_PTR)((PUCHAR)pSQI->pSubQStart);
-    pCQI->pCplQStart = (PVOID)(PtrTemp + queueSize);
-
-    queueSize = pSQI->SubQEntries * sizeof(NVMe_COMPLETION_QUEUE_ENTRY);
-    pCQI->pCplQStart = PAGE_ALIGN_BUF_PTR(pCQI->pCplQStart);
-    memset(pCQI->pCplQStart, 0, queueSize);
-
-    pCQI->CplQStart = NVMeGetPhysAddr( pAE, pCQI->pCplQStart );
-    /* If fails on converting to physical address, return here */
-    if (pCQI->CplQStart.QuadPart == 0)
-        return ( STOR_STATUS_INSUFFICIENT_RESOURCES );
-
-    return (STOR_STATUS_SUCCESS);
-} /* NVMeInitCplQueue */
-
-/*******************************************************************************
- * NVMeInitCmdEntries
- *
- * @brief NVMeInitCmdEntries gets called to initialize the CMD_ENTRY structure
- *        of the specific submission queue associated with the QueueID
- *
- * @param pAE - Pointer to hardware device extension.
- * @param QueueID - Which submission queue structure to initialize
- *
- * @return ULONG
- *     STOR_STATUS_SUCCESS - If all resources are allocated properly
- *     Otherwise - If anything goes wrong
- ******************************************************************************/
-ULONG NVMeInitCmdEntries(
-    PNVME_DEVICE_EXTENSION pAE,
-    USHORT QueueID
-)
-{
-    PQUEUE_INFO pQI = &pAE->QueueInfo;
-    PSUB_QUEUE_INFO pSQI = pQI->pSubQueueInfo + QueueID;
-    PCPL_QUEUE_INFO pCQI = pQI->pCplQueueInfo + QueueID;
-    PRES_MAPPING_TBL pRMT = &pAE->ResMapTbl;
-    ULONG_PTR PtrTemp = 0;
-
-    /* Ensure the QueueID is valid via the number of active cores in system */
-    if (QueueID > pRMT->NumActiveCores)
-        return (STOR_STATUS_INVALID_PARAMETER);
-
-    /* Initialize command entries and Free list */
-    PtrTemp = (ULONG_PTR)((PUCHAR)pCQI->pCplQStart);
-    pSQI->pCmdEntry = (PVOID) (PtrTemp + (pSQI->SubQEntries *
-                                          sizeof(NVMe_COMPLETION_QUEUE_ENTRY)));
-
-    memset(pSQI->pCmdEntry, 0, sizeof(CMD_ENTRY) * pSQI->SubQEntries);
-    NVMeInitFreeQ(pSQI, pAE);
-
-    return (STOR_STATUS_SUCCESS);
-} /* NVMeInitCmdEntries */
-
-/*******************************************************************************
- * NVMeResetAdapter
- *
- * @brief NVMeResetAdapter gets called to reset the adapter by setting EN bit of
- *        CC register as 0. This causes the adapter to forget about queues --
- *        the internal adapter falls back to initial state.
- *
- * @param pAE - Pointer to hardware device extension.
- *
- * @return BOOLEAN
- *     TRUE - If reset procedure seemed to worky
- *     FALSE - If anything goes wrong
- ******************************************************************************/
-BOOLEAN NVMeResetAdapter(
-    PNVME_DEVICE_EXTENSION pAE
-)
-{
-    NVMe_CONTROLLER_CONFIGURATION CC;
-
-    /* Need to to ensure the Controller registers are memory-mapped properly */
-    if (pAE->pCtrlRegister == NULL)
-        return (FALSE);
-
-    StorPortDebugPrint(INFO, "NVMeResetAdapter:  Clearing EN...\n");
-    /*
-     * Immediately reset our start state to indicate that the controller
-     * is ont ready
-     */
-    CC.AsUlong= StorPortReadRegisterUlong(pAE,
-                                          (PULONG)(&pAE->pCtrlRegister->CC));
-	if (CC.EN == 1) {
-
-		/*
-         * Before we transition to 0, make sure the ctrl is actually RDY        
-         */
-        if(FALSE == NVMeWaitForCtrlRDY(pAE, 1)) {
-            return FALSE;
-        }
-		
-		CC.EN = 0;
-
-		StorPortWriteRegisterUlong(pAE,
-			(PULONG)(&pAE->pCtrlRegister->CC),
-			CC.AsUlong);
-
-
-		if (NVMeWaitForCtrlRDY(pAE, 0) == FALSE) {
-			StorPortDebugPrint(INFO,
-				"NVMeResetAdapter: EN bit is not getting Cleared\n");
-			return (FALSE);
-		}
-	}
-
- 	pAE->DriverState.NextDriverState = NVMeWaitOnRDY;
-
-    return (TRUE);
-} /* NVMeResetAdapter */
-
-
-/*******************************************************************************
- * NVMeEnableAdapter
- *
- * @brief NVMeEnableAdapter gets called to do the followings:
- *     - Program AdminQ related registers
- *     - Set EN bit of CC register as 1
- *     - Check if device is ready via RDY bit of STS register
- *     - Report the readiness of the adapter in return
- *
- * @param pAE - Pointer to hardware device extension.
- *
- * @return BOOLEAN
- *  TRUE  - if Adapter is enabled correctly
- *  FALSE - if anything goes wrong
- ******************************************************************************/
-BOOLEAN NVMeEnableAdapter(
-    PNVME_DEVICE_EXTENSION pAE
-)
-{
-    PQUEUE_INFO pQI = &pAE->QueueInfo;
-    NVMe_CONTROLLER_CONFIGURATION CC = {0};
-
-
-    /*
-     * Program Admin queue registers before enabling the adapter:
-     * Admin Queue Attributes
-     */
-    StorPortWriteRegisterUlong(
-        pAE,
-        (PULONG)(&pAE->pCtrlRegister->AQA),
-        (pQI->pSubQueueInfo->SubQEntries - 1) +
-        ((pQI->pCplQueueInfo->CplQEntries - 1) << NVME_AQA_CQS_LSB));
-
-    /* Admin Submission Queue Base Address (64 bit) */
-    StorPortWriteRegisterUlong(
-        pAE,
-        (PULONG)(&pAE->pCtrlRegister->ASQ.LowPart),
-        (ULONG)(pQI->pSubQueueInfo->SubQStart.LowPart));
-
-    StorPortWriteRegisterUlong(
-        pAE,
-        (PULONG)(&pAE->pCtrlRegister->ASQ.HighPart),
-        (ULONG)(pQI->pSubQueueInfo->SubQStart.HighPart));
-
-    /* Admin Completion Queue Base Address (64 bit) */
-    StorPortWriteRegisterUlong(
-        pAE,
-        (PULONG)(&pAE->pCtrlRegister->ACQ.LowPart),
-        (ULONG)(pQI->pCplQueueInfo->CplQStart.LowPart));
-
-    StorPortWriteRegisterUlong(
-        pAE,
-        (PULONG)(&pAE->pCtrlRegister->ACQ.HighPart),
-        (ULONG)(pQI->pCplQueueInfo->CplQStart.HighPart));
-
-
-    StorPortDebugPrint(INFO, "NVMeEnableAdapter:  Setting EN...\n");
-    /*
-     * Set up Controller Configuration Register
-     */
-    CC.EN = 1;
-    CC.CSS = NVME_CC_NVM_CMD;
-    CC.MPS = (PAGE_SIZE >> NVME_MEM_PAGE_SIZE_SHIFT);
-    CC.AMS = NVME_CC_ROUND_ROBIN;
-    CC.SHN = NVME_CC_SHUTDOWN_NONE;
-    CC.IOSQES = NVME_CC_IOSQES;
-    CC.IOCQES = NVME_CC_IOCQES;
-
-    StorPortWriteRegisterUlong(pAE,
-                               (PULONG)(&pAE->pCtrlRegister->CC),
-                               CC.AsUlong);
-    return TRUE;
-} /* NVMeEnableAdapter */
-
-/*******************************************************************************
- * NVMeSetFeaturesCompletion
- *
- * @brief NVMeSetFeaturesCompletion gets called to exam the first LBA Range
- *        entry of a given namespace. The procedure is described below:
- *
- *        Only exam the first LBA Range entry of a given namespace;
- *
- *        if (NLB == Namespace Size) {
- *            if (Type == 00b) {
- *                Change the followings via Set Features (ID#3):
- *                    Type to Filesystem;
- *                    Attributes(bit0) as 1 (can be overwritten);
- *                    Attributes(bit1) as 0 (visible);
- *                Mark ExposeNamespace as TRUE;
- *                Mark ReadOnly as FALSE;
- *            } else if (Type == 01b) {
- *                if (Attributes(bit0) != 0)
- *                    Mark ReadOnly as FALSE;
- *                else
- *                    Mark ReadOnly as TRUE;
- *
- *                if (Attributes(bit1) != 0)
- *                    Mark ExposeNamespace as FALSE;
- *                else
- *                    Mark ExposeNamespace as TRUE;
- *            } else {
- *                Mark ExposeNamespace as FALSE;
- *                Mark ReadOnly based on Attributes(bit0);
- *            }
- *        } else {
- *            Mark ExposeNamespace as FALSE;
- *            Mark ReadOnly based on Attributes(bit0);
- *        }
- *
- * @param pAE - Pointer to hardware device extension.
- * @param pNVMeCmd - Pointer to the original submission entry
- * @param pCplEntry - Pointer to the completion entry
- *
- * @return VOID
- ******************************************************************************/
-VOID NVMeSetFeaturesCompletion(
-    PNVME_DEVICE_EXTENSION pAE,
-    PNVMe_COMMAND pNVMeCmd,
-    PNVMe_COMPLETION_QUEUE_ENTRY pCplEntry
-)
-{
-    PQUEUE_INFO pQI = &pAE->QueueInfo;
-    PADMIN_SET_FEATURES_COMMAND_LBA_RANGE_TYPE_ENTRY pLbaRangeTypeEntry = NULL;
-    PNVME_LUN_EXTENSION pLunExt = NULL;
-    PADMIN_SET_FEATURES_COMMAND_DW10 pSetFeaturesCDW10 = NULL;
-    PADMIN_SET_FEATURES_COMMAND_LBA_RANGE_TYPE_DW11 pSetFeaturesCDW11 = NULL;
-    NS_VISBILITY visibility = IGNORED;
-    ULONG lunId;
-    UINT8 flbas;
-    UINT16 metadataSize;
-
-    /*
-     * Mark down the resulted information if succeeded. Otherwise, log the error
-     * bit in case of errors and fail the state machine
-     */
-    pSetFeaturesCDW10 =
-        (PADMIN_SET_FEATURES_COMMAND_DW10) &pNVMeCmd->CDW10;
-
-    if (pAE->DriverState.InterruptCoalescingSet == FALSE &&
-        pNVMeCmd->CDW0.OPC == ADMIN_SET_FEATURES        &&
-        pSetFeaturesCDW10->FID == INTERRUPT_COALESCING ) {
-        if (pCplEntry->DW3.SF.SC != 0) {
-            NVMeDriverFatalError(pAE,
-                                (1 << START_STATE_INT_COALESCING_FAILURE));
-        } else {
-            pAE->DriverState.InterruptCoalescingSet = TRUE;
-
-            /* Reset the counter and keep tihs state to set more features */
-            pAE->DriverState.StateChkCount = 0;
-            pAE->DriverState.NextDriverState = NVMeWaitOnSetFeatures;
-        }
-    } else if (pNVMeCmd->CDW0.OPC == ADMIN_SET_FEATURES &&
-               pSetFeaturesCDW10->FID == NUMBER_OF_QUEUES) {
-        if (pCplEntry->DW3.SF.SC != 0) {
-            NVMeDriverFatalError(pAE,
-                                (1 << START_STATE_QUEUE_ALLOC_FAILURE));
-        } else {
-            /*
-             * NCQR and NSQR are 0 based values. NumSubIoQAllocFromAdapter and
-             * NumSubIoQAllocFromAdapter are 1 based values.
-             */
-            pQI->NumSubIoQAllocFromAdapter = GET_WORD_0(pCplEntry->DW0) + 1;
-            pQI->NumCplIoQAllocFromAdapter = GET_WORD_1(pCplEntry->DW0) + 1;
-
-            /*
-             * Ensure there is the minimum number of queues between the MSI
-             * granted, number of cores, and number allocated from the adapter.
-             */
-            if (pAE->ntldrDump == FALSE) {
-                pQI->NumSubIoQAllocFromAdapter = min(pQI->NumSubIoQAllocFromAdapter,
-                                                     pAE->ResMapTbl.NumActiveCores);
-
-                pQI->NumCplIoQAllocFromAdapter = min(pQI->NumCplIoQAllocFromAdapter,
-                                                     pAE->ResMapTbl.NumActiveCores);
-
-                /* Only take the min if the number of MSI is greater than 0 */
-                if (pAE->ResMapTbl.NumMsiMsgGranted > 0) {
-                    pQI->NumSubIoQAllocFromAdapter = min(pQI->NumSubIoQAllocFromAdapter,
-                                                         pAE->ResMapTbl.NumMsiMsgGranted);
-
-                    pQI->NumCplIoQAllocFromAdapter = min(pQI->NumCplIoQAllocFromAdapter,
-                                                         pAE->ResMapTbl.NumMsiMsgGranted);
-                }
-            } 
-
-            /* Reset the counter and keep tihs state to set more features */
-            pAE->DriverState.StateChkCount = 0;
-            pAE->DriverState.NextDriverState = NVMeWaitOnSetFeatures;
-        }
-    } else if ((pAE->DriverState.TtlLbaRangeExamined <
-                pAE->DriverState.IdentifyNamespaceFetched) &&
-               (pSetFeaturesCDW10->FID == LBA_RANGE_TYPE)) {
-        /* first check completion status code */
-        if (pCplEntry->DW3.SF.SC != 0) {
-           /* Support for LBA Range Type is optional,
-            * handle the case that it's not supported 
-            */
-			if ((pCplEntry->DW3.SF.SCT == GENERIC_COMMAND_STATUS) &&
-				((pCplEntry->DW3.SF.SC == INVALID_FIELD_IN_COMMAND) ||
-				(pCplEntry->DW3.SF.SC == INVALID_NAMESPACE_OR_FORMAT))) {
-                /*
-                 * The device doesn't support the optional LBA Range Type
-                 * command so assume the slot is online/visible and writable
-                 */
-                if (pAE->controllerIdentifyData.OACS.SupportsNamespaceMgmtAndAttachment) 
-                    lunId = pAE->DriverState.IdentifyNamespaceFetched - 1;
-                else
-                    lunId = pAE->DriverState.VisibleNamespacesExamined;
-
-                pLunExt = pAE->pLunExtensionTable[lunId];
-                if (pLunExt->identifyData.NCAP != 0) {
-					if (!pAE->controllerIdentifyData.OACS.SupportsNamespaceMgmtAndAttachment) {
-						pLunExt->nsStatus = ATTACHED;
-					}
-                    pLunExt->slotStatus = ONLINE;
-                    pLunExt->ReadOnly = FALSE;
-                    pAE->DriverState.VisibleNamespacesExamined++;
-                    pAE->DriverState.ConfigLbaRangeNeeded = FALSE;
-                    pAE->DriverState.TtlLbaRangeExamined++;
-                } else if ((INACTIVE == pLunExt->nsStatus) || (INVALID == pLunExt->nsStatus)) {
-                    pAE->DriverState.ConfigLbaRangeNeeded = FALSE;
-                    pAE->DriverState.TtlLbaRangeExamined++;
-                }
-
-                /* Reset the counter and set next state accordingly */
-                pAE->DriverState.StateChkCount = 0;
-                if (pAE->DriverState.NumKnownNamespaces == 0 ||
-                    pAE->DriverState.TtlLbaRangeExamined ==
-                    pAE->DriverState.NumKnownNamespaces) {
-                    /* We have called identify namespace as well as get/set
-                     * features for each of the NN namespaces that exist.
-                     * Move on to the next state in the state machine.
-                     */
-
-                    pAE->visibleLuns = pAE->DriverState.VisibleNamespacesExamined;
-                    pAE->DriverState.NextDriverState = NVMeWaitOnSetupQueues;
-                } else {
-                    /* We have more namespaces to identify so
-                     * we'll set the state to NVMeWaitOnIdentifyNS in order
-                     * to identify the remaining namespaces.
-                     */
-                    pAE->DriverState.NextDriverState = NVMeWaitOnIdentifyNS;
-                }
-            } else {
-                NVMeDriverFatalError(pAE,
-                                    (1 << START_STATE_LBA_RANGE_CHK_FAILURE));
-            }
-        } else {
-            /*
-             * When Get Features command completes, exam the completed data to
-             * see if Set Features is required. If so, simply set
-             * ConfigLbaRangeNeeded as TRUE If not, simply increase
-             * TtlLbaRangeExamined and set ConfigLbaRangeNeeded as FALSE When Set
-             * Features command completes, simply increase TtlLbaRangeExamined
-             */
-            lunId = pAE->DriverState.VisibleNamespacesExamined;
-
-            pLbaRangeTypeEntry =
-                (PADMIN_SET_FEATURES_COMMAND_LBA_RANGE_TYPE_ENTRY)
-                pAE->DriverState.pDataBuffer;
-            pSetFeaturesCDW11 =
-                (PADMIN_SET_FEATURES_COMMAND_LBA_RANGE_TYPE_DW11) &pNVMeCmd->CDW11;
-
-            pLunExt = pAE->pLunExtensionTable[lunId];
-
-            if (pNVMeCmd->CDW0.OPC == ADMIN_GET_FEATURES) {
-                /* driver only supports 1 LBA range type per NS (NUM is 0 based) */
-                if (pSetFeaturesCDW11->NUM == 0) {
-
-                    /*
-                     *
-                     * NOTE:  spec/group still working this behavior out
-                     * wrt dealing with range tpyes so making this simple
-                     * for now so we can update it when needed.  Currently
-                     * we'll IGNORE the range TYPE entirely
-                     *
-                     */
-                    StorPortDebugPrint(INFO,
-                           "pLbaRangeTypeEntry type : 0x%llX lun id %d nsid 0x%x\n",
-                           pLbaRangeTypeEntry->Type,
-                           lunId,
-                           pNVMeCmd->NSID);
-
-                    visibility =
-                        pLbaRangeTypeEntry->Attributes.Hidden ? HIDDEN:VISIBLE;
-                    pLunExt->ReadOnly =
-                            pLbaRangeTypeEntry->Attributes.Overwriteable ?
-                                FALSE:TRUE;
-                    /*
-                     *  When the namespace is formatted using metadata, 
-                     *  don't advertise it for now 
-                     */
-                    flbas = pLunExt->identifyData.FLBAS.SupportedCombination;
-                    metadataSize = pLunExt->identifyData.LBAFx[flbas].MS;
-                    if (metadataSize != 0)
-                       visibility = HIDDEN;
-
-                } else {
-                    /*
-                     * Don't support more than one entry per NS. Mark it IGNORED
-                     */
-                    visibility = IGNORED;
-                }
-
-                pAE->DriverState.ConfigLbaRangeNeeded = FALSE;
-                pAE->DriverState.TtlLbaRangeExamined++;
-                if (visibility == VISIBLE) {
-                    pLunExt->slotStatus = ONLINE;
-                    pAE->DriverState.VisibleNamespacesExamined++;
-                } else {
-                    StorPortDebugPrint(INFO,"NVMeSetFeaturesCompletion: FYI LnuExt at %d has been cleared (NSID not visible)\n",
-                        lunId);
-                    RtlZeroMemory(pLunExt, sizeof(NVME_LUN_EXTENSION));
-                }
-
-            } else if (pNVMeCmd->CDW0.OPC == ADMIN_SET_FEATURES) {
-
-                /* TODO: set features not currently called, after its ironed out
-                 * how we want to handle range types, we'll need to fill
-                 * this in
-                 */
-
-                /*
-                pAE->DriverState.VisibleNamespacesExamined++;
-                pLunExt->ReadOnly = FALSE;
-                pAE->DriverState.TtlLbaRangeExamined++;
-                pAE->DriverState.ConfigLbaRangeNeeded = FALSE;
-                */
-            }
-
-            /* Reset the counter and set next state accordingly */
-            pAE->DriverState.StateChkCount = 0;
-            if (pAE->DriverState.NumKnownNamespaces == 0 ||
-                pAE->DriverState.TtlLbaRangeExamined ==
-				pAE->DriverState.NumKnownNamespaces) {
-                /* We have called identify namespace as well as get/set
-                 * features for each of the NN namespaces that exist.
-                 * Move on to the next state in the state machine.
-                 */
-                pAE->visibleLuns = pAE->DriverState.VisibleNamespacesExamined;
-                pAE->DriverState.NextDriverState = NVMeWaitOnSetupQueues;
-            } else {
-                /* We have more namespaces to identify and get/set features
-                 * for. But before we can move on to the next namespace,
-                 * we'll check if we need to call set features - if not,
-                 * we'll set the state to NVMeWaitOnIdentifyNS so we can
-                 * continue to identify the remaining namespaces.
-                 */
-                if (TRUE == pAE->DriverState.ConfigLbaRangeNeeded) {
-                    // We still need to issue a set features for this namespace
-                pAE->DriverState.NextDriverState = NVMeWaitOnSetFeatures;
-                } else {
-                    // Move on to the next namespace and issue an identify
-                    pAE->DriverState.NextDriverState = NVMeWaitOnIdentifyNS;
-                }
-            }
-        }
-    }
-} /* NVMeSetFeaturesCompletion */
-
-/*******************************************************************************
- * NVMeDeleteQueueCallback
- *
- * @brief NVMeDeleteQueueCallback is the callback function used to notify
- *        the caller that a queue deletion has completed
- *
- * @param pAE - Pointer to hardware device extension.
- * @param pSrbExtension - Pointer to the completion entry
- *
- * @return BOOLEAN
- *     TRUE - to indicate we completed fine
- ******************************************************************************/
-BOOLEAN NVMeDeleteQueueCallback(
-    PVOID pNVMeDevExt,
-    PVOID pSrbExtension
-)
-{
-    PNVME_DEVICE_EXTENSION pAE = (PNVME_DEVICE_EXTENSION)pNVMeDevExt;
-    PNVME_SRB_EXTENSION pSrbExt = (PNVME_SRB_EXTENSION)pSrbExtension;
-    PNVMe_COMMAND pNVMeCmd = (PNVMe_COMMAND)(&pSrbExt->nvmeSqeUnit);
-    PNVMe_COMPLETION_QUEUE_ENTRY pCplEntry = pSrbExt->pCplEntry;
-    PQUEUE_INFO pQI = &pAE->QueueInfo;
-
-    if (pNVMeCmd->CDW0.OPC == ADMIN_DELETE_IO_COMPLETION_QUEUE) {
-        if (pCplEntry->DW3.SF.SC == 0) {
-            PCPL_QUEUE_INFO pCQI = pQI->pCplQueueInfo + pQI->NumCplIoQCreated;
-            /*
-             * Because learning mode doesn't re-allocate mem, we need to
-             * zero out some counters as well as all entries so nothing
-             * is left stale when recreated
-             */
-            pCQI->CurPhaseTag = 0;
-            pCQI->CplQHeadPtr = 0;
-            memset(pCQI->pCplQStart,
-                0,
-                (pCQI->CplQEntries * sizeof(NVMe_COMPLETION_QUEUE_ENTRY)));
-            pQI->NumCplIoQCreated--;
-        } else {
-            NVMeDriverFatalError(pAE,
-                                (1 << FATAL_CPLQ_DELETE_FAILURE));
-        }
-    } else if (pNVMeCmd->CDW0.OPC == ADMIN_DELETE_IO_SUBMISSION_QUEUE) {
-        if (pCplEntry->DW3.SF.SC == 0) {
-            PSUB_QUEUE_INFO pSQI = pQI->pSubQueueInfo + pQI->NumSubIoQCreated;
-            pSQI->SubQTailPtr = 0;
-            pSQI->SubQHeadPtr = 0;
-            /* we don't recycle SQs w/learning mode but for consistency... */
-            memset(pSQI->pSubQStart,
-                0,
-                (pSQI->SubQEntries * sizeof(NVMe_COMMAND)));
-            pQI->NumSubIoQCreated--;
-        } else {
-            NVMeDriverFatalError(pAE,
-                                (1 << FATAL_SUBQ_DELETE_FAILURE));
-        }
-    }
-    return TRUE;
-}
-
-/*******************************************************************************
- * NVMeInitCallback
- *
- * @brief NVMeInitCallback is the callback function used to notify
- *        Initialization module the completion of the requests, which are
- *        initiated by driver's initialization module itself. In addition to the
- *        NVME_DEVICE_EXTENSION, the completion entry are also passed. After
- *        examining the entry, some resulted information needs to be noted and
- *        error status needs to be reported if there is any.
- *
- * @param pAE - Pointer to hardware device extension.
- * @param pSrbExtension - Pointer to the completion entry
- *
- * @return BOOLEAN
- *     TRUE - If all resources are allocated and initialized properly
- *     FALSE - If anything goes wrong
- ******************************************************************************/
-BOOLEAN NVMeInitCallback(
-    PVOID pNVMeDevExt,
-    PVOID pSrbExtension
-)
-{
-    PNVME_DEVICE_EXTENSION pAE = (PNVME_DEVICE_EXTENSION)pNVMeDevExt;
-    PNVME_SRB_EXTENSION pSrbExt = (PNVME_SRB_EXTENSION)pSrbExtension;
-    PNVMe_COMMAND pNVMeCmd = (PNVMe_COMMAND)(&pSrbExt->nvmeSqeUnit);
-    PNVMe_COMPLETION_QUEUE_ENTRY pCplEntry = pSrbExt->pCplEntry;
-    PQUEUE_INFO pQI = &pAE->QueueInfo;
-	ULONG totalQueuePairs;
-	PRES_MAPPING_TBL pRMT;
-    PULONG pNamespaceId = NULL;
-    ULONG currentNSID = 0;
-    ULONG lunId = INVALID_LUN_EXTN;
-    int i = 0;
-    UCHAR flbas;
-
-    NVMe_CONTROLLER_CAPABILITIES CAP = {0};
-    StorPortDebugPrint(INFO,"NVMeInitCallback: Driver state: %d\n", pAE->DriverState.NextDriverState);
-    switch (pAE->DriverState.NextDriverState) {
-        case NVMeWaitOnIdentifyCtrl:
-            /*
-             * Mark down Controller structure is retrieved if succeeded
-             * Otherwise, log the error bit in case of errors and fail the state
-             * machine.
-             */
-            if ((pCplEntry->DW3.SF.SC == 0) &&
-                (pCplEntry->DW3.SF.SCT == 0)) {
-                ULONG maxXferSize;
-
-                /* Reset the counter */
-                pAE->DriverState.StateChkCount = 0;
-
-                /* copy over the data from the init state machine temp buffer */
-                StorPortCopyMemory(&pAE->controllerIdentifyData,
-                                pAE->DriverState.pDataBuffer,
-                                sizeof(ADMIN_IDENTIFY_CONTROLLER));
-
-                /* Set next state */
-				if (pAE->controllerIdentifyData.OACS.SupportsNamespaceMgmtAndAttachment) {
-					pAE->DriverState.NextDriverState = NVMeWaitOnListAttachedNs;
-				}
-				else {
-					pAE->DriverState.NextDriverState = NVMeWaitOnIdentifyNS;
-					pAE->DriverState.NumKnownNamespaces = pAE->controllerIdentifyData.NN;
-				}
-
-/* Code Analysis fails on StoPortReadRegisterUlong64 */
-#if 0 // (NTDDI_VERSION > NTDDI_WIN7) && defined(_WIN64)
-                CAP.AsUlonglong = StorPortReadRegisterUlong64(pAE,
-                    (PULONG64)(&pAE->pCtrlRegister->CAP));
-#else
-                CAP.HighPart = StorPortReadRegisterUlong(pAE,
-                    (PULONG)(&pAE->pCtrlRegister->CAP.HighPart));
-                CAP.LowPart = StorPortReadRegisterUlong(pAE,
-                    (PULONG)(&pAE->pCtrlRegister->CAP.LowPart));
-#endif
-
-                /*
-                 * we don't discover the HW xfer limit until after we've reported it
-                 * to storport so if we find out its smaller than what we'rve reported,
-                 * then all we can do is fail init and log and error.  The user will
-                 * have to reconfigure the regsitry and try again
-                  */
-                if (pAE->controllerIdentifyData.MDTS > 0) {
-                    maxXferSize = (1 << pAE->controllerIdentifyData.MDTS) *
-                        (1 << (12 + CAP.MPSMIN)) ;
-                    if (pAE->InitInfo.MaxTxSize > maxXferSize) {
-                        StorPortDebugPrint(INFO, "ERROR: Ctrl reports smaller Max Xfer Sz than INF (0x%x < 0x%x)\n",
-                            maxXferSize, pAE->InitInfo.MaxTxSize);
-                        NVMeDriverFatalError(pAE,
-                                            (1 << START_MAX_XFER_MISMATCH_FAILURE));
-                    }
-                }
-                if (pAE->controllerIdentifyData.NN == 0) {
-                    /* No namespaces so jump to Disabled.  An adapter object will
-                     * be created without any child LUNs.
-                     * In this state, IOCTLs can be processed, but no IO.
-                     */
-                    NVMeDriverFatalError(pAE, 
-                                      ( 1 << START_STATE_IDENTIFY_CTRL_FAILURE)); 
-                    pAE->visibleLuns = 0;
-                }
-            } else {
-                NVMeDriverFatalError(pAE,
-                                    (1 << START_STATE_IDENTIFY_CTRL_FAILURE));
-            }
-        break;
-        case NVMeWaitOnListAttachedNs:
-            /*
-             * Save list of attached namespaces if succeed.
-			 * If command fails because of unknown opcode, most
-			 * likely drive does not support namespace management.
-             * Otherwise, log the error bit in case of errors and
-             * fail the state machine
-             */
-            if ((pCplEntry->DW3.SF.SC == SUCCESSFUL_COMPLETION) &&
-                (pCplEntry->DW3.SF.SCT == GENERIC_COMMAND_STATUS)) {
-
-                pNamespaceId = (PULONG) pAE->DriverState.pDataBuffer;
-                for (i = 0; i < MAX_NAMESPACES; i++) {
-                    currentNSID = (ULONG)*pNamespaceId;
-
-                    /* A value of 0 NSID indicates end of list of namespaces */ 
-                    if (currentNSID == 0) {
-                        break;
-                    }
-
-                    /* found a new NSID */
-                    lunId = pAE->DriverState.NumKnownNamespaces;
-                    pAE->pLunExtensionTable[lunId]->namespaceId = currentNSID;
-                    pAE->pLunExtensionTable[lunId]->nsStatus = ATTACHED;
-                    pAE->DriverState.NumKnownNamespaces++;
-                    pNamespaceId++;
-                }
-                /* Move to the next state: list all existing namespace(s) */
-                pAE->DriverState.NextDriverState = NVMeWaitOnListExistingNs;
-            } else {
-                NVMeDriverFatalError(pAE,
-                                    (1 << START_STATE_LIST_ATTACHED_NS_FAILURE));
-            }
-        break;
-        case NVMeWaitOnListExistingNs:
-            /*
-             * Save list of unattached namespaces if succeed.
-             * Otherwise, log the error bit in case of errors and
-             * fail the state machine
-             */
-            if ((pCplEntry->DW3.SF.SC == SUCCESSFUL_COMPLETION) &&
-                (pCplEntry->DW3.SF.SCT == GENERIC_COMMAND_STATUS)) {
-
-                pNamespaceId = (PULONG) pAE->DriverState.pDataBuffer;
-                for (i = 0; i < MAX_NAMESPACES; i++) {
-                    currentNSID = (ULONG)*pNamespaceId;
-
-                    /* A value of 0 NSID indicates end of list of namespaces */ 
-                    if (currentNSID == 0) {
-                        break;
-                    }
-
-                    if (INVALID == NVMeGetNamespaceStatusAndSlot(pAE, currentNSID, &lunId)) {
-                        /* found a new NSID */
-                        lunId = pAE->DriverState.NumKnownNamespaces;
-                        pAE->pLunExtensionTable[lunId]->namespaceId = currentNSID;
-                        pAE->pLunExtensionTable[lunId]->nsStatus = INACTIVE;
-                        pAE->DriverState.NumKnownNamespaces++;
-                    }
-                    pNamespaceId++;
-                }
-                /* Move to the next state: identify namespace(s) */
-                pAE->DriverState.NextDriverState = NVMeWaitOnIdentifyNS;
-            } else {
-                NVMeDriverFatalError(pAE,
-                                    (1 << START_STATE_LIST_EXISTING_NS_FAILURE));
-            }
-        break;
-        case NVMeWaitOnIdentifyNS:
-            /*
-             * Mark down Namespace structure is retrieved if succeeded
-             * Otherwise, log the error bit in case of errors and
-             * fail the state machine
-             */
-            if ((pCplEntry->DW3.SF.SC == 0) &&
-                (pCplEntry->DW3.SF.SCT == 0)) {
-                PNVME_LUN_EXTENSION pLunExt = NULL;
-				if (pAE->controllerIdentifyData.OACS.SupportsNamespaceMgmtAndAttachment)
-					pLunExt = pAE->pLunExtensionTable[pAE->DriverState.IdentifyNamespaceFetched];
-				else
-                    pLunExt = pAE->pLunExtensionTable[pAE->DriverState.VisibleNamespacesExamined];
-
-                pAE->DriverState.IdentifyNamespaceFetched++;
-
-                /* Reset the counter and set next state */
-                pAE->DriverState.StateChkCount = 0;
-
-                /* Move to the next state to set features for this namespace */
-                pAE->DriverState.NextDriverState = NVMeWaitOnSetFeatures;
-
-                /* copy over the data from the init state machine temp buffer */
-                StorPortCopyMemory(&pLunExt->identifyData,
-                                pAE->DriverState.pDataBuffer,
-                                sizeof(ADMIN_IDENTIFY_NAMESPACE));
-                /* Mark down the Namespace ID */
-                /* 
-                 * If capable of namespace mgmt, we already should have saved NSID
-                 * Otherwise, mark down the Namespace ID here 
-                 */
-                if (!pAE->controllerIdentifyData.OACS.SupportsNamespaceMgmtAndAttachment)
-                    pLunExt->namespaceId =
-                        pAE->DriverState.IdentifyNamespaceFetched;
-
-                /* Note next Namespace ID to fetch Namespace structure */
-                /* for use in the LBA range type commands we need this info */
-                pAE->DriverState.CurrentNsid = pLunExt->namespaceId;
-
-            } else {
-                /*
-                 * In case of supporting non-contiguous NSID and the inactive NSIDs, 
-                 * move onto next NSID until it hits the value of NN of 
-                 * Identify Controller structure.
-                 */
-                if ((pCplEntry->DW3.SF.SC == INVALID_NAMESPACE_OR_FORMAT) &&
-                    (pCplEntry->DW3.SF.SCT == 0) &&
-                    (pAE->DriverState.CurrentNsid < pAE->controllerIdentifyData.NN)) {
-                    pAE->DriverState.CurrentNsid++;
-
-                    /* Reset the counter */
-                    pAE->DriverState.StateChkCount = 0;
-
-                    /* Stay in this state to fetch next namespace structure */
-                    pAE->DriverState.NextDriverState = NVMeWaitOnIdentifyNS;
-                } else {
-                    NVMeDriverFatalError(pAE,
-                                    (1 << START_STATE_IDENTIFY_NS_FAILURE));
-                }
-            }
-        break;
-        case NVMeWaitOnSetFeatures:
-            NVMeSetFeaturesCompletion(pAE, pNVMeCmd, pCplEntry);
-        break;
-        case NVMeWaitOnIoCQ:
-            /*
-             * Mark down the number of created completion queues if succeeded
-             * Otherwise, log the error bit in case of errors and
-             * fail the state machine
-             */
-
-            if ((pCplEntry->DW3.SF.SC == 0) &&
-                (pCplEntry->DW3.SF.SCT == 0)) {
-                pQI->NumCplIoQCreated++;
-
-                /* Reset the counter and set next state */
-                pAE->DriverState.StateChkCount = 0;
-                if (pQI->NumCplIoQAllocated == pQI->NumCplIoQCreated) {
-                    pAE->DriverState.NextDriverState = NVMeWaitOnIoSQ;
-                } else {
-                    pAE->DriverState.NextDriverState = NVMeWaitOnIoCQ;
-                }
-            } else {
-                NVMeDriverFatalError(pAE,
-                                    (1 << START_STATE_CPLQ_CREATE_FAILURE));
-            }
-        break;
-        case NVMeWaitOnIoSQ:
-            /*
-             * Mark down the number of created submission queues if succeeded
-             * Otherwise, log the error bit in case of errors and
-             * fail the state machine
-             */
-            if ((pCplEntry->DW3.SF.SC == 0) &&
-                (pCplEntry->DW3.SF.SCT == 0)) {
-                PRES_MAPPING_TBL pRMT = &pAE->ResMapTbl;
-                pQI->NumSubIoQCreated++;
-
-                /* Reset the counter and set next state */
-                pAE->DriverState.StateChkCount = 0;
-                if (pQI->NumSubIoQAllocated == pQI->NumSubIoQCreated) {
-                    /* if we've learned the cores we're done */
-                    if (pAE->LearningCores < pRMT->NumActiveCores) {
-                        pAE->DriverState.NextDriverState = NVMeWaitOnLearnMapping;
-                    } else {
-						/*In crash/Hibernate mode, NVMeWaitOnNamespaceReady state is skipped*/
-						if ((pAE->ntldrDump == TRUE) ||
-							(pAE->DriverState.AllNamespacesAreReady)) {
-							pAE->DriverState.NextDriverState = NVMeStartComplete;							
-						} else {
-							pAE->DriverState.NextDriverState = NVMeWaitOnNamespaceReady;
-						}                        
-                    }
-                } else {
-                    pAE->DriverState.NextDriverState = NVMeWaitOnIoSQ;
-                }
-            } else {
-                NVMeDriverFatalError(pAE,
-                                    (1 << START_STATE_SUBQ_CREATE_FAILURE));
-            }
-        break;
-        case NVMeWaitOnLearnMapping:
-
-				pRMT = &pAE->ResMapTbl;
-                
-
-                /*
-                 * see if we still have more core/vector mapping to learn
-                 * or if we're ready to redo the queues based on the new map
-                 */
-                pAE->DriverState.StateChkCount = 0;
-                totalQueuePairs = min(pAE->QueueInfo.NumCplIoQAllocFromAdapter,
-                                      pAE->QueueInfo.NumSubIoQAllocFromAdapter);
-                if (pAE->LearningCores < totalQueuePairs) {
-                    pAE->DriverState.NextDriverState = NVMeWaitOnLearnMapping;
-                } else {
-                    PRES_MAPPING_TBL pRMT = &pAE->ResMapTbl;
-                    PCORE_TBL pCT = NULL;
-                    ULONG CoreIndex;
-
-                    pAE->LearningCores = pAE->ResMapTbl.NumActiveCores;
-
-                    /*
-                     * At this point, learning mode should have mapped all 
-                     * queues and MSI vectors.  The counter will be equal to 
-                     * number of MSI and also equal to the number of total
-                     * queue pairs.  If not, it means there was a problem during
-                     * learning mode, so we should go to shared mode.
-                     */
-                    if ((pAE->QueueInfo.NumIoQMapped < pRMT->NumMsiMsgGranted) ||
-                        (pAE->QueueInfo.NumIoQMapped < (totalQueuePairs+1))) {
-                            ASSERT(FALSE);
-                            StorPortDebugPrint(INFO, 
-                                "Number of IO Queues mapped not equal to MSI, going to Shared mode\n");
-
-                            pRMT->pMsiMsgTbl->Shared = TRUE;
-                            pAE->DriverState.NextDriverState = NVMeStartComplete;
-
-                    } else {
-
-#if DBG
-                        /* print out the learned table */
-                        StorPortDebugPrint(INFO, "Learning Complete.  Core Table:\n");
-                        for (CoreIndex = 0; CoreIndex < pRMT->NumActiveCores; CoreIndex++) {
-                            pCT = pRMT->pCoreTbl + CoreIndex;
-                            StorPortDebugPrint(INFO,
-                                               "\tCore(0x%x) MSID(0x%x) QueuePair(0x%x)\n",
-                                               CoreIndex,
-                                               pCT->MsiMsgID,
-                                               pCT->SubQueue);
-
-                        }
-
-                        pAE->LearningComplete = TRUE;
-#endif
-                        /*
-                         * Learning is done. Any additional cores not assigned to
-                         * queues will be assigned in the start complete state.
-                         */
-
-                        pAE->DriverState.NextDriverState = NVMeWaitOnReSetupQueues;
-                    }
-                }
-
-        break;
-        case NVMeWaitOnReSetupQueues:
-            if (TRUE == NVMeDeleteQueueCallback(pAE, pSrbExt)) {
-                /* if we've deleted the last CQ, we rae ready to recreate them */
-                if (0 == pQI->NumCplIoQCreated) {
-                    pAE->DriverState.NextDriverState = NVMeWaitOnIoCQ;
-                } else {
-                    pAE->DriverState.NextDriverState = NVMeWaitOnReSetupQueues;
-                }
-            }
-        break;
-		case NVMeWaitOnNamespaceReady:
-			if ((pCplEntry->DW3.SF.SC == NAMESPACE_NOT_READY) &&
-				(pCplEntry->DW3.SF.SCT == 0)) {
-				pAE->DriverState.NextDriverState = NVMeWaitOnNamespaceReady;
-			}
-			else {
-				/* The command has completed succesfully, namespace should be ready */
-				pAE->pLunExtensionTable[pAE->DriverState.NextNamespaceToCheckForReady]->nsReady = TRUE;
-				pAE->DriverState.NextNamespaceToCheckForReady++;
-				/* We need to ensure all namespaces are ready in case of multiple namespaces */
-				if (pAE->DriverState.NextNamespaceToCheckForReady < pAE->DriverState.NumKnownNamespaces) {
-					pAE->DriverState.NextDriverState = NVMeWaitOnNamespaceReady;
-				}
-				else {
-					pAE->DriverState.AllNamespacesAreReady = TRUE;
-					pAE->DriverState.NextDriverState = NVMeStartComplete;
-				}				
-			}
-			/* free the read buffer for namespaceready */
-			if ((pAE->ntldrDump == FALSE) && (NULL != pSrbExt->pDataBuffer)) {
-			        StorPortFreePool((PVOID)pAE, pSrbExt->pDataBuffer);
-					pSrbExt->pDataBuffer = NULL;
-				}
-			break;
-        case NVMeStartComplete:
-            ASSERT(pAE->ntldrDump);
-        break;
-        default:
-            NVMeDriverFatalError(pAE,
-                                (1 << START_STATE_UNKNOWN_STATE_FAILURE));
-        break;
-    } /* end switch */
-
-    NVMeCallArbiter(pAE);
-
-    return (TRUE);
-} /* NVMeInitCallback */
-
-/*******************************************************************************
- * NVMePreparePRPs
- *
- * @brief NVMePreparePRPs is a helper routine to prepare PRP entries
- *        for initialization routines and ioctl requests.
- *
- * @param pAE - Pointer to hardware device extension.
- * @param pSrbExt - Pointer to Srb Extension
- * @param pBuffer - Pointer to the transferring buffer.
- * @param TxLength - Data transfer size in bytes.
- *
- * @return BOOLEAN
- *     TRUE - If the PRP conversion completed without any errors
- *     FALSE - If anything goes wrong
- ******************************************************************************/
-BOOLEAN NVMePreparePRPs(
-    PNVME_DEVICE_EXTENSION pAE,
-    PNVME_SRB_EXTENSION pSrbExt,
-    PVOID pBuffer,
-    ULONG TxLength
-)
-{
-    PNVMe_COMMAND pSubEntry = &pSrbExt->nvmeSqeUnit;
-    STOR_PHYSICAL_ADDRESS PhyAddr;
-    ULONG_PTR PtrTemp = 0;
-    ULONG RoomInFirstPage = 0;
-    ULONG RemainLength = TxLength;
-    PUINT64 pPrpList = NULL;
-
-    if (pBuffer == NULL || TxLength == 0)
-        return (FALSE);
-
-    /* Go ahead and prepare 1st PRP entries, need at least one PRP entry */
-    PhyAddr = NVMeGetPhysAddr(pAE, pBuffer);
-    if (PhyAddr.QuadPart == 0)
-        return (FALSE);
-
-    pSubEntry->PRP1 = PhyAddr.QuadPart;
-    pSrbExt->numberOfPrpEntries = 1;
-    /*
-     * Find out how much room still available in current page.
-     * If it's enough, only PRP1 is needed.
-     */
-    RoomInFirstPage = PAGE_SIZE - (PhyAddr.QuadPart & (PAGE_SIZE - 1));
-    if ( RoomInFirstPage >= TxLength )
-        return (TRUE);
-    else
-        RemainLength -= RoomInFirstPage;
-
-    PtrTemp = (ULONG_PTR)((PUCHAR)pBuffer);
-    PtrTemp = PAGE_ALIGN_BUF_ADDR(PtrTemp);
-    /*
-     * With the remaining transfer size, either use PRP2 as another PRP entry or
-     * a pointer to the pre-allocated PRP list
-     */
-    if (RemainLength > PAGE_SIZE) {
-        pPrpList = &pSrbExt->prpList[0];
-        pSubEntry->PRP2 = 0;
-    } else {
-        /* Use PRP2 as 2nd PRP entry and return */
-        PhyAddr = NVMeGetPhysAddr(pAE, (PVOID)PtrTemp);
-        if (PhyAddr.QuadPart == 0)
-            return (FALSE);
-        pSubEntry->PRP2 = PhyAddr.QuadPart;
-        pSrbExt->numberOfPrpEntries++;
-        return (TRUE);
-    }
-    /* 
-     * Convert data buffer pages into PRP entries while
-     * decreasing remaining transfer size and noting the # of PRP entries used
-     */
-    while (RemainLength) {
-        PhyAddr = NVMeGetPhysAddr(pAE, (PVOID)PtrTemp);
-        if (PhyAddr.QuadPart == 0)
-            return (FALSE);
-        *pPrpList = (UINT64) PhyAddr.QuadPart;
-        pSrbExt->numberOfPrpEntries++;
-        /* When remaining size is no larger than a page, it's the last entry */
-        if (RemainLength <= PAGE_SIZE)
-            break;
-        pPrpList++;
-        RemainLength -= PAGE_SIZE;
-        PtrTemp += PAGE_SIZE;
-    }
-
-    return (TRUE);
-}
-
-/*******************************************************************************
- * NVMeSetIntCoalescing
- *
- * @brief NVMeSetIntCoalescing gets called to configure interrupt coalescing
- *        with the values fetched from Registry via Set Features command with
- *        Feature ID#8.
- *
- * @param pAE - Pointer to hardware device extension.
- *
- * @return BOOLEAN
- *     TRUE - If the issued command completed without any errors
- *     FALSE - If anything goes wrong
- ******************************************************************************/
-BOOLEAN NVMeSetIntCoalescing(
-    PNVME_DEVICE_EXTENSION pAE
-)
-{
-    PNVME_SRB_EXTENSION pNVMeSrbExt =
-        (PNVME_SRB_EXTENSION)pAE->DriverState.pSrbExt;
-    PNVMe_COMMAND pSetFeatures = (PNVMe_COMMAND)(&pNVMeSrbExt->nvmeSqeUnit);
-
-    PADMIN_SET_FEATURES_COMMAND_DW10 pSetFeaturesCDW10 = NULL;
-    PADMIN_SET_FEATURES_COMMAND_INTERRUPT_COALESCING_DW11
-        pSetFeaturesCDW11 = NULL;
-
-    /* Zero out the extension first */
-    memset((PVOID)pNVMeSrbExt, 0, sizeof(NVME_SRB_EXTENSION));
-
-    /* Populate SRB_EXTENSION fields */
-    pNVMeSrbExt->pNvmeDevExt = pAE;
-    pNVMeSrbExt->pNvmeCompletionRoutine = NVMeInitCallback;
-
-    /* Populate submission entry fields */
-    pSetFeatures->CDW0.OPC = ADMIN_SET_FEATURES;
-    pSetFeaturesCDW10 = (PADMIN_SET_FEATURES_COMMAND_DW10) &pSetFeatures->CDW10;
-    pSetFeaturesCDW11 = (PADMIN_SET_FEATURES_COMMAND_INTERRUPT_COALESCING_DW11)
-        &pSetFeatures->CDW11;
-
-    pSetFeaturesCDW10->FID = INTERRUPT_COALESCING;
-
-    /* Set up the Aggregation Time and Threshold */
-    pSetFeaturesCDW11->TIME = pAE->InitInfo.IntCoalescingTime;
-    pSetFeaturesCDW11->THR = pAE->InitInfo.IntCoalescingEntry;
-
-    /* Now issue the command via Admin Doorbell register */
-    return ProcessIo(pAE, pNVMeSrbExt, NVME_QUEUE_TYPE_ADMIN, FALSE);
-} /* NVMeSetIntCoalescing */
-
-/*******************************************************************************
- * NVMeAllocQueueFromAdapter
- *
- * @brief NVMeAllocQueueFromAdapter gets called to allocate
- *        submission/completion queues from the adapter via Set Feature command
- *        with Feature ID#7. This routine requests the same number of
- *        submission/completion queues as the number of current active cores in
- *        the system.
- *
- * @param pAE - Pointer to hardware device extension.
- *
- * @return BOOLEAN
- *     TRUE - If the issued command completed without any errors
- *     FALSE - If anything goes wrong
- ******************************************************************************/
-BOOLEAN NVMeAllocQueueFromAdapter(
-    PNVME_DEVICE_EXTENSION pAE
-)
-{
-    PNVME_SRB_EXTENSION pNVMeSrbExt =
-        (PNVME_SRB_EXTENSION)pAE->DriverState.pSrbExt;
-    PNVMe_COMMAND pSetFeatures = (PNVMe_COMMAND)(&pNVMeSrbExt->nvmeSqeUnit);
-    PADMIN_SET_FEATURES_COMMAND_DW10 pSetFeaturesCDW10 = NULL;
-    PADMIN_SET_FEATURES_COMMAND_NUMBER_OF_QUEUES_DW11 pSetFeaturesCDW11 = NULL;
-
-    /* Zero out the extension first */
-    memset((PVOID)pNVMeSrbExt, 0, sizeof(NVME_SRB_EXTENSION));
-
-    /* Populate SRB_EXTENSION fields */
-    pNVMeSrbExt->pNvmeDevExt = pAE;
-    pNVMeSrbExt->pNvmeCompletionRoutine = NVMeInitCallback;
-
-    /* Populate submission entry fields */
-    pSetFeatures->CDW0.OPC = ADMIN_SET_FEATURES;
-    pSetFeaturesCDW10 = (PADMIN_SET_FEATURES_COMMAND_DW10) &pSetFeatures->CDW10;
-    pSetFeaturesCDW11 = (PADMIN_SET_FEATURES_COMMAND_NUMBER_OF_QUEUES_DW11)
-        &pSetFeatures->CDW11;
-    pSetFeaturesCDW10->FID = NUMBER_OF_QUEUES;
-
-    /* Set up NCSQR and NSQR, which are 0-based. */
-    if (pAE->ntldrDump == TRUE) {
-        /* In crashdump/hibernation case, only 1 pair of IO queue needed */
-        pSetFeaturesCDW11->NCQR = 0;
-        pSetFeaturesCDW11->NSQR = 0;
-    } else {
-        /*
-         * Number of cores, number of MSI granted, and number of queues
-         * supported by the controller are the variables to determine how
-         * many queues to create.
-         */
-        pSetFeaturesCDW11->NCQR = min(pAE->ResMapTbl.NumActiveCores,
-                                      pAE->ResMapTbl.NumMsiMsgGranted) - 1;
-        pSetFeaturesCDW11->NSQR = min(pAE->ResMapTbl.NumActiveCores,
-                                      pAE->ResMapTbl.NumMsiMsgGranted) - 1;    }
-
-    /* Now issue the command via Admin Doorbell register */
-    return ProcessIo(pAE, pNVMeSrbExt, NVME_QUEUE_TYPE_ADMIN, FALSE);
-} /* NVMeAllocQueueFromAdapter */
-
-/*******************************************************************************
- * NVMeAccessLbaRangeEntry
- *
- * @brief NVMeAccessLbaRangeEntry gets called to query/update the first LBA
- *        Range entry of a given namespace. The procedure is described below:
- *
- *        Depending on the value of ConfigLbaRangeNeeded, if TRUE, it issues
- *        Set Features command. Otherwise, it issues Get Features commands.
- *
- *        When issuing Set Features, the namespace has:
- *          Type = Filesystem,
- *          ReadOnly = FALSE,
- *          Visible = TRUE.
- *
- *        When command completes, NVMeSetFeaturesCompletion is called to exam
- *        the LBA Range Type entries and wrap up the access.
- *
- * @param pAE - Pointer to hardware device extension.
- *
- * @return BOOLEAN
- *     TRUE - If the issued command completed without any errors
- *     FALSE - If anything goes wrong
- ******************************************************************************/
-BOOLEAN NVMeAccessLbaRangeEntry(
-    PNVME_DEVICE_EXTENSION pAE
-)
-{
-    PNVME_SRB_EXTENSION pNVMeSrbExt =
-        (PNVME_SRB_EXTENSION)pAE->DriverState.pSrbExt;
-    PNVMe_COMMAND pSetFeatures = (PNVMe_COMMAND)(&pNVMeSrbExt->nvmeSqeUnit);
-    PADMIN_SET_FEATURES_COMMAND_DW10 pSetFeaturesCDW10 = NULL;
-    PADMIN_SET_FEATURES_COMMAND_LBA_RANGE_TYPE_ENTRY pLbaRangeEntry = NULL;
-    ULONG NSID = pAE->DriverState.CurrentNsid;
-    BOOLEAN Query = pAE->DriverState.ConfigLbaRangeNeeded;
-
-    /* 
-     * if not capable of namespace mgmt...
-     * Fail here if Namespace ID is 0 or out of range 
-     */
-    if ((!pAE->controllerIdentifyData.OACS.SupportsNamespaceMgmtAndAttachment) &&
-		(NSID == 0 || NSID > pAE->DriverState.NumKnownNamespaces))
-        return FALSE;
-
-    /* Zero out the extension first */
-    memset((PVOID)pNVMeSrbExt, 0, sizeof(NVME_SRB_EXTENSION));
-
-    /* Populate SRB_EXTENSION fields */
-    pNVMeSrbExt->pNvmeDevExt = pAE;
-    pNVMeSrbExt->pNvmeCompletionRoutine = NVMeInitCallback;
-
-    /* Populate submission entry fields */
-    pSetFeatures->NSID = NSID;
-
-    /*
-     * Prepare the buffer for transferring LBA Range entries
-     * Need to zero the buffer out first when retrieving the entries
-     */
-    if (pAE->DriverState.ConfigLbaRangeNeeded == TRUE) {
-        pSetFeatures->CDW0.OPC = ADMIN_SET_FEATURES;
-
-        /* Prepare new first LBA Range entry */
-        pLbaRangeEntry = (PADMIN_SET_FEATURES_COMMAND_LBA_RANGE_TYPE_ENTRY)
-            pAE->DriverState.pDataBuffer;
-        pLbaRangeEntry->Type = LBA_TYPE_FILESYSTEM;
-        pLbaRangeEntry->Attributes.Overwriteable = 1;
-        pLbaRangeEntry->Attributes.Hidden = 0;
-        pLbaRangeEntry->NLB = pAE->pLunExtensionTable[NSID-1]->identifyData.NSZE;
-    } else {
-        pSetFeatures->CDW0.OPC = ADMIN_GET_FEATURES;
-        memset(pAE->DriverState.pDataBuffer, 0, PAGE_SIZE);
-    }
-
-    /* Prepare PRP entries, need at least one PRP entry */
-    if (NVMePreparePRPs(pAE,
-                        pNVMeSrbExt,
-                        pAE->DriverState.pDataBuffer,
-                        sizeof(ADMIN_SET_FEATURES_LBA_COMMAND_RANGE_TYPE_ENTRY))
-                        == FALSE) {
-        return (FALSE);
-    }
-
-    pSetFeaturesCDW10 = (PADMIN_SET_FEATURES_COMMAND_DW10) &pSetFeatures->CDW10;
-    pSetFeaturesCDW10->FID = LBA_RANGE_TYPE;
-
-    /* Now issue the command via Admin Doorbell register */
-    return ProcessIo(pAE, pNVMeSrbExt, NVME_QUEUE_TYPE_ADMIN, FALSE);
-} /* NVMeAccessLbaRangeEntry */
-
-/*******************************************************************************
- * NVMeGetIdentifyStructures
- *
- * @brief NVMeGetIdentifyStructures gets called to retrieve Identify structures,
- *        including the Controller and Namespace information depending on
- *        NamespaceID.
- *
- * @param pAE - Pointer to hardware device extension.
- * @param NamespaceID - Specify either Controller or Namespace structure to
- *                      retrieve
- *
- * @return BOOLEAN
- *     TRUE - If the issued command completed without any errors
- *     FALSE - If anything goes wrong
- ******************************************************************************/
-BOOLEAN NVMeGetIdentifyStructures(
-    PNVME_DEVICE_EXTENSION pAE,
-    ULONG NamespaceID,
-    USHORT CNS
-)
-{
-    PNVME_SRB_EXTENSION pNVMeSrbExt =
-        (PNVME_SRB_EXTENSION)pAE->DriverState.pSrbExt;
-    PNVMe_COMMAND pIdentify = NULL;
-    PADMIN_IDENTIFY_CONTROLLER pIdenCtrl = &pAE->controllerIdentifyData;
-    PADMIN_IDENTIFY_COMMAND_DW10 pIdentifyCDW10 = NULL;
-    ULONG lunId;
-
-    /* Zero-out the entire SRB_EXTENSION */
-    memset((PVOID)pNVMeSrbExt, 0, sizeof(NVME_SRB_EXTENSION));
-
-    /* Populate SRB_EXTENSION fields */
-    pNVMeSrbExt->pNvmeDevExt = pAE;
-    pNVMeSrbExt->pNvmeCompletionRoutine = NVMeInitCallback;
-
-    /* Populate submission entry fields */
-    pIdentify = &pNVMeSrbExt->nvmeSqeUnit;
-    pIdentify->CDW0.OPC = ADMIN_IDENTIFY;
-
-    pIdentifyCDW10 = (PADMIN_IDENTIFY_COMMAND_DW10) &pIdentify->CDW10;
-    /* Set the type of identify command */
-    pIdentifyCDW10->CNS = CNS;
-
-    switch (CNS) {
-    case IDENTIFY_CNTLR:
-        /* Prepare PRP entries, need at least one PRP entry */
-        if (NVMePreparePRPs(pAE,
-                            pNVMeSrbExt,
-                            (PVOID)pAE->DriverState.pDataBuffer,
-                            sizeof(ADMIN_IDENTIFY_CONTROLLER)) == FALSE) {
-            return (FALSE);
-        }
-        break;
-     case IDENTIFY_NAMESPACE:
-
-        if ( pIdenCtrl == NULL )
-            return (FALSE);
-
-        StorPortDebugPrint(INFO,"NVMeGetIdentifyStructures: IDEN_NAMESPACE\n");
-        /* Indicate it's for Namespace structure */
-        pIdentifyCDW10 = (PADMIN_IDENTIFY_COMMAND_DW10) &pIdentify->CDW10;
-        pIdentifyCDW10->CNS = 0;
-
-        /* NN of Controller structure is 1-based */
-        if ((NamespaceID <= pIdenCtrl->NN) ||
-            (pAE->controllerIdentifyData.OACS.SupportsNamespaceMgmtAndAttachment)) {
-
-            if (pAE->controllerIdentifyData.OACS.SupportsNamespaceMgmtAndAttachment)
-                //Use NVMeGetNamespaceStatusAndSlot to get lunId
-                NVMeGetNamespaceStatusAndSlot(pAE, NamespaceID, &lunId);
-            else
-                lunId = pAE->DriverState.VisibleNamespacesExamined;
-
-            /* Namespace ID is 1-based. */
-            pIdentify->NSID = NamespaceID;
-
-            StorPortDebugPrint(INFO,
-                "NVMeGetIdentifyStructures: Get NS INFO for NSID 0x%x tgt lun 0x%x\n",
-                    NamespaceID, lunId);
-
-            /* Prepare PRP entries, need at least one PRP entry */
-            if (NVMePreparePRPs(pAE,
-                                pNVMeSrbExt,
-                                (PVOID)pAE->DriverState.pDataBuffer,
-                                sizeof(ADMIN_IDENTIFY_NAMESPACE)) == FALSE) {
-                return (FALSE);
-            }
-        } else {
-            /* no initial namespaces defined */
-            StorPortDebugPrint(INFO,
-                "NVMeGetIdentifyStructures: NamespaceID <= pIdenCtrl->NN\n");
-            pAE->DriverState.StateChkCount = 0;
-            pAE->visibleLuns = 0;
-            pAE->DriverState.NextDriverState = NVMeWaitOnSetupQueues;
-            NVMeCallArbiter(pAE);
-            return (TRUE);
-        }
-        break;
-    case LIST_ATTACHED_NAMESPACES:
-    case LIST_EXISTING_NAMESPACES:
-        /* Prepare PRP entries, need at least one PRP entry */
-        if (NVMePreparePRPs(pAE,
-                            pNVMeSrbExt,
-                            (PVOID)pAE->DriverState.pDataBuffer,
-							sizeof(ULONG) * MAX_NUMBER_OF_NAMESPACES) == FALSE) {
-            return (FALSE);
-        }
-        break;
-    default:
-        break;
-    }
-
-    /* Now issue the command via Admin Doorbell register */
-    return ProcessIo(pAE, pNVMeSrbExt, NVME_QUEUE_TYPE_ADMIN, FALSE);
-} /* NVMeGetIdentifyStructures */
-
-/*******************************************************************************
- * NVMeCreateCplQueue
- *
- * @brief NVMeCreateCplQueue gets called to create one IO completion queue at a
- *        time via issuing Create IO Completion Queue command. The smaller value
- *        of NumCplIoQAllocated of QUEUE_INFO and NumActiveCores of
- *        RES_MAPPING_TABLE decides the number of completion queues to create,
- *        which is indicated in NumCplIoQAllocated of QUEUE_INFO.
- *
- * @param pAE - Pointer to hardware device extension.
- * @param QueueID - Which completion queue to create.
- *
- * @return BOOLEAN
- *     TRUE - If the issued commands completed without any errors
- *     FALSE - If anything goes wrong
- ******************************************************************************/
-BOOLEAN NVMeCreateCplQueue(
-    PNVME_DEVICE_EXTENSION pAE,
-    USHORT QueueID
-)
-{
-    PNVME_SRB_EXTENSION pNVMeSrbExt =
-        (PNVME_SRB_EXTENSION)pAE->DriverState.pSrbExt;
-    PQUEUE_INFO pQI = &pAE->QueueInfo;
-    PNVMe_COMMAND pCreateCpl = NULL;
-    PADMIN_CREATE_IO_COMPLETION_QUEUE_DW10 pCreateCplCDW10 = NULL;
-    PADMIN_CREATE_IO_COMPLETION_QUEUE_DW11 pCreateCplCDW11 = NULL;
-    PCPL_QUEUE_INFO pCQI = NULL;
-
-    if (QueueID != 0 && QueueID <= pQI->NumCplIoQAllocated) {
-        /* Zero-out the entire SRB_EXTENSION */
-        memset((PVOID)pNVMeSrbExt, 0, sizeof(NVME_SRB_EXTENSION));
-
-        /* Populate SRB_EXTENSION fields */
-        pNVMeSrbExt->pNvmeDevExt = pAE;
-        pNVMeSrbExt->pNvmeCompletionRoutine = NVMeInitCallback;
-
-        /* Populate submission entry fields */
-        pCreateCpl = (PNVMe_COMMAND)(&pNVMeSrbExt->nvmeSqeUnit);
-        pCreateCplCDW10 = (PADMIN_CREATE_IO_COMPLETION_QUEUE_DW10)
-                          (&pCreateCpl->CDW10);
-        pCreateCplCDW11 = (PADMIN_CREATE_IO_COMPLETION_QUEUE_DW11)
-                          (&pCreateCpl->CDW11);
-
-        /* Populate submission entry fields */
-        pCreateCpl->CDW0.OPC = ADMIN_CREATE_IO_COMPLETION_QUEUE;
-        pCQI = pQI->pCplQueueInfo + QueueID;
-        pCreateCpl->PRP1 = pCQI->CplQStart.QuadPart;
-        pCreateCplCDW10->QID = QueueID;
-        pCreateCplCDW10->QSIZE = pQI->NumIoQEntriesAllocated - 1;
-        pCreateCplCDW11->PC = 1;
-        pCreateCplCDW11->IEN = 1;
-        pCreateCplCDW11->IV = pCQI->MsiMsgID;
-
-        /* Now issue the command via Admin Doorbell register */
-        return ProcessIo(pAE, pNVMeSrbExt, NVME_QUEUE_TYPE_ADMIN, FALSE);
-    }
-
-    return (FALSE);
-} /* NVMeCreateCplQueue */
-
-/*******************************************************************************
- * NVMeCreateSubQueue
- *
- * @brief NVMeCreateSubQueue gets called to create one IO submission queue at a
- *        time via issuing Create IO Submission Queue command. The smaller value
- *        of NumSubIoQAllocated of QUEUE_INFO and NumActiveCores of
- *        RES_MAPPING_TABLE decides the number of submission queues to create,
- *        which is indicated in NumSubIoQAllocated of QUEUE_INFO.
- *
- * @param pAE - Pointer to hardware device extension.
- * @param QueueID - Which submission queue to create.
- *
- * @return BOOLEAN
- *     TRUE - If the issued commands completed without any errors
- *     FALSE - If anything goes wrong
- ******************************************************************************/
-BOOLEAN NVMeCreateSubQueue(
-    PNVME_DEVICE_EXTENSION pAE,
-    USHORT QueueID
-)
-{
-    PNVME_SRB_EXTENSION pNVMeSrbExt =
-        (PNVME_SRB_EXTENSION)pAE->DriverState.pSrbExt;
-    PQUEUE_INFO pQI = &pAE->QueueInfo;
-    PNVMe_COMMAND pCreateSub = NULL;
-    PADMIN_CREATE_IO_SUBMISSION_QUEUE_DW10 pCreateSubCDW10 = NULL;
-    PADMIN_CREATE_IO_SUBMISSION_QUEUE_DW11 pCreateSubCDW11 = NULL;
-    PSUB_QUEUE_INFO pSQI = NULL;
-
-    if (QueueID != 0 && QueueID <= pQI->NumCplIoQAllocated) {
-        /* Zero-out the entire SRB_EXTENSION */
-        memset((PVOID)pNVMeSrbExt, 0, sizeof(NVME_SRB_EXTENSION));
-
-        /* Populate SRB_EXTENSION fields */
-        pNVMeSrbExt->pNvmeDevExt = pAE;
-        pNVMeSrbExt->pNvmeCompletionRoutine = NVMeInitCallback;
-
-        /* Populate submission entry fields */
-        pCreateSub = (PNVMe_COMMAND)(&pNVMeSrbExt->nvmeSqeUnit);
-        pCreateSubCDW10 = (PADMIN_CREATE_IO_SUBMISSION_QUEUE_DW10)
-                          (&pCreateSub->CDW10);
-        pCreateSubCDW11 = (PADMIN_CREATE_IO_SUBMISSION_QUEUE_DW11)
-                          (&pCreateSub->CDW11);
-
-        /* Populate submission entry fields */
-        pCreateSub->CDW0.OPC = ADMIN_CREATE_IO_SUBMISSION_QUEUE;
-        pSQI = pQI->pSubQueueInfo + QueueID;
-        pCreateSub->PRP1 = pSQI->SubQStart.QuadPart;
-        pCreateSubCDW10->QID = QueueID;
-        pCreateSubCDW10->QSIZE = pQI->NumIoQEntriesAllocated - 1;
-        pCreateSubCDW11->CQID = pSQI->CplQueueID;
-        pCreateSubCDW11->PC = 1;
-
-        /* Now issue the command via Admin Doorbell register */
-        return ProcessIo(pAE, pNVMeSrbExt, NVME_QUEUE_TYPE_ADMIN, FALSE);
-    }
-
-    return (FALSE);
-} /* NVMeCreateSubQueue */
-
-/*******************************************************************************
- * NVMeDeleteCplQueues
- *
- * @brief NVMeDeleteCplQueues gets called to delete a number of IO completion
- *        queues via issuing Delete IO Completion Queue commands.
- *        For us exclusively by the init state machine
- *
- * @param pAE - Pointer to hardware device extension.
- *
- * @return BOOLEAN
- *     TRUE - If the issued commands completed without any errors
- *     FALSE - If anything goes wrong
- ******************************************************************************/
-BOOLEAN NVMeDeleteCplQueues(
-    PNVME_DEVICE_EXTENSION pAE
-)
-{
-    PNVME_SRB_EXTENSION pNVMeSrbExt =
-        (PNVME_SRB_EXTENSION)pAE->DriverState.pSrbExt;
-    PQUEUE_INFO pQI = &pAE->QueueInfo;
-    PNVMe_COMMAND pDeleteCpl = NULL;
-    PADMIN_DELETE_IO_COMPLETION_QUEUE_DW10 pDeleteCplCDW10 = NULL;
-    USHORT QueueID = (USHORT)pQI->NumCplIoQCreated;
-
-    if (QueueID > 0) {
-
-        /* init and setup srb ext */
-        NVMeInitSrbExtension(pNVMeSrbExt, pAE, NULL);
-        pNVMeSrbExt->pNvmeCompletionRoutine = NVMeInitCallback;
-
-        /* Populate submission entry fields */
-        pDeleteCpl = (PNVMe_COMMAND)(&pNVMeSrbExt->nvmeSqeUnit);
-        pDeleteCplCDW10 = (PADMIN_DELETE_IO_COMPLETION_QUEUE_DW10)
-                          (&pDeleteCpl->CDW10);
-        pDeleteCpl->CDW0.OPC = ADMIN_DELETE_IO_COMPLETION_QUEUE;
-        pDeleteCplCDW10->QID = QueueID;
-
-        /* Now issue the command via Admin Doorbell register */
-        if (ProcessIo(pAE, pNVMeSrbExt, NVME_QUEUE_TYPE_ADMIN, FALSE) == FALSE) {
-            return (FALSE);
-        }
-    }
-
-    return (TRUE);
-} /* NVMeDeleteCplQueues */
-
-/*******************************************************************************
- * NVMeDeleteSubQueues
- *
- * @brief NVMeDeleteSubQueues gets called to delete a number of IO submission
- *        queues via issuing Delete IO Submission Queue commands.
- *        For us exclusively by the init state machine
- *
- * @param pAE - Pointer to hardware device extension.
- *
- * @return BOOLEAN
- *     TRUE - If the issued commands completed without any errors
- *     FALSE - If anything goes wrong
- ******************************************************************************/
-BOOLEAN NVMeDeleteSubQueues(
-    PNVME_DEVICE_EXTENSION pAE
-)
-{
-    PNVME_SRB_EXTENSION pNVMeSrbExt =
-        (PNVME_SRB_EXTENSION)pAE->DriverState.pSrbExt;
-    PQUEUE_INFO pQI = &pAE->QueueInfo;
-    PNVMe_COMMAND pDeleteSub = NULL;
-    PADMIN_DELETE_IO_SUBMISSION_QUEUE_DW10 pDeleteSubCDW10 = NULL;
-    USHORT QueueID = (USHORT)pQI->NumSubIoQCreated;
-
-    if (QueueID > 0) {
-
-        /* init and setup srb ext */
-        NVMeInitSrbExtension(pNVMeSrbExt, pAE, NULL);
-        pNVMeSrbExt->pNvmeCompletionRoutine = NVMeInitCallback;
-
-        /* Populate submission entry fields */
-        pDeleteSub = (PNVMe_COMMAND)(&pNVMeSrbExt->nvmeSqeUnit);
-        pDeleteSubCDW10 = (PADMIN_DELETE_IO_SUBMISSION_QUEUE_DW10)
-                          (&pDeleteSub->CDW10);
-        pDeleteSub->CDW0.OPC = ADMIN_DELETE_IO_SUBMISSION_QUEUE;
-        pDeleteSubCDW10->QID = QueueID;
-
-        /* Now issue the command via Admin Doorbell register */
-        if (ProcessIo(pAE, pNVMeSrbExt, NVME_QUEUE_TYPE_ADMIN, FALSE) == FALSE) {
-            return (FALSE);
-        }
-    }
-    return (TRUE);
-} /* NVMeDeleteSubQueues */
-
-/*******************************************************************************
- * NVMeNormalShutdown
- *
- * @brief NVMeNormalShutdown gets called to follow the normal shutdown sequence
- *        defined in NVMe specification when receiving SRB_FUNCTION_SHUTDOWN
- *        from the host:
- *
- *        1. Set state to NVMeShutdown to prevent taking any new requests
- *        2. Delete all created submisison queues
- *        3. If succeeded, delete all created completion queues (reset device)
- *        4. Set SHN to normal shutdown (01b)
- *        5. Keep reading back CSTS for 100 ms and check if SHST is 01b.
- *        6. If so or timeout, return SRB_STATUS_SUCCESS to Storport
- *
- * @param pAE - Pointer to hardware device extension.
- *
- * @return BOOLEAN
- *     TRUE - If the issued commands completed without any errors
- *     FALSE - If anything goes wrong
- ******************************************************************************/
-BOOLEAN NVMeNormalShutdown(
-    PNVME_DEVICE_EXTENSION pAE
-)
-{
-    NVMe_CONTROLLER_CONFIGURATION CC;
-    NVMe_CONTROLLER_STATUS CSTS;
-    ULONG PollMax = pAE->uSecCrtlTimeout / MAX_STATE_STALL_us;
-    ULONG PollCount;
-
-    /* Check for any pending cmds. */
-    if (NVMeDetectPendingCmds(pAE, FALSE, SRB_STATUS_BUS_RESET) == TRUE) {
-        return FALSE;
-    }
-
-    /* Delete all queues */
-    if (NVMeResetAdapter(pAE) != TRUE) {
-        return (FALSE);
-    }
-
-    /* Need to to ensure the Controller registers are memory-mapped properly */
-    if ( pAE->pCtrlRegister == FALSE ) {
-        return (FALSE);
-    }
-
-    StorPortDebugPrint(INFO, "NVMeInit.c: Issue Shutdown Notification\n");
-
-    /*
-     * Read Controller Configuration first before setting SHN bits of
-     * Controller Configuration to normal shutdown (01b)
-     */
-    CC.AsUlong = StorPortReadRegisterUlong(pAE,
-                                           (PULONG)(&pAE->pCtrlRegister->CC));
-    CC.SHN = 1;
-    /* Set SHN bits of Controller Configuration to normal shutdown (01b) */
-    StorPortWriteRegisterUlong (pAE,
-                                (PULONG)(&pAE->pCtrlRegister->CC),
-                                CC.AsUlong);
-
-    /* Checking if the adapter is ready for normal shutdown */
-    for (PollCount = 0; PollCount < PollMax; PollCount++) {
-        CSTS.AsUlong = StorPortReadRegisterUlong(pAE,
-                           (PULONG)(&pAE->pCtrlRegister->CSTS.AsUlong));
-
-        if (CSTS.SHST == 2) {
-            StorPortDebugPrint(INFO, "NVMeInit.c: Shutdown Successful\n");
-
-            /* Free the memory if we are doing shutdown */
-            NVMeFreeBuffers(pAE);
-            return (TRUE);
-        }
-
-        NVMeStallExecution(pAE, MAX_STATE_STALL_us);
-    }
-
-#if DBG
-    /*
-     * QEMU: Returning TRUE is a workaround as Qemu device is not returning the
-     * status as shutdown complete. So this is a workaround for QEMU.
-     */
-    NVMeFreeBuffers(pAE);
-    return (TRUE);
-#else /* DBG */
-    return (FALSE);
-#endif /* DBG */
-} /* NVMeNormalShutdown */
-
-/*******************************************************************************
- * NVMeFreeBuffers
- *
- * @brief NVMeFreeBuffers gets called to free buffers that had been allocated.
- *        The buffers are required to be physically contiguous.
- *
- * @param pAE - Pointer to hardware device extension.
- *
- * @return VOID
- ******************************************************************************/
-VOID NVMeFreeBuffers (
-    PNVME_DEVICE_EXTENSION pAE
-)
-{
-    USHORT QueueID;
-    PQUEUE_INFO pQI = &pAE->QueueInfo;
-    PRES_MAPPING_TBL pRMT = &pAE->ResMapTbl;
-    PSUB_QUEUE_INFO pSQI = NULL;
-
-    /* First, free the Start State Data buffer memory allocated by driver */
-    if (pAE->DriverState.pDataBuffer != NULL) {
-        StorPortFreeContiguousMemorySpecifyCache((PVOID)pAE,
-                                                 pAE->DriverState.pDataBuffer,
-                                                 PAGE_SIZE, MmCached);
-        pAE->DriverState.pDataBuffer = NULL;
-    }
-    /* Free the NVME_LUN_EXTENSION memory allocated by driver */
-    if (pAE->pLunExtensionTable[0] != NULL) {
-        StorPortFreeContiguousMemorySpecifyCache((PVOID)pAE,
-                                                 pAE->pLunExtensionTable[0],
-                                                 pAE->LunExtSize,
-                                                 MmCached);
-        pAE->pLunExtensionTable[0] = NULL;
-    }
-
-    /* Free the allocated queue entry and PRP list buffers */
-    if (pQI->pSubQueueInfo != NULL) {
-        for (QueueID = 0; QueueID <= pRMT->NumActiveCores; QueueID++) {
-            pSQI = pQI->pSubQueueInfo + QueueID;
-            if (pSQI->pQueueAlloc != NULL) {
-                StorPortFreeContiguousMemorySpecifyCache((PVOID)pAE,
-                                                         pSQI->pQueueAlloc,
-                                                         pSQI->QueueAllocSize,
-                                                         MmCached);
-                pSQI->pQueueAlloc = NULL;
-            }
-
-            if (pSQI->pPRPListAlloc != NULL) {
-                StorPortFreeContiguousMemorySpecifyCache((PVOID)pAE,
-                                                         pSQI->pPRPListAlloc,
-                                                         pSQI->PRPListAllocSize,
-                                                         MmCached);
-                pSQI->pPRPListAlloc = NULL;
-            }
-
-
-#ifdef DUMB_DRIVER
-            if (pSQI->pDblBuffAlloc != NULL)
-                StorPortFreeContiguousMemorySpecifyCache((PVOID)pAE,
-                                                         pSQI->pDblBuffAlloc,
-                                                         pSQI->dblBuffSz,
-                                                         MmCached);
-            if (pSQI->pDblBuffListAlloc != NULL)
-                StorPortFreeContiguousMemorySpecifyCache((PVOID)pAE,
-                                                         pSQI->pDblBuffListAlloc,
-                                                         pSQI->dblBuffListSz,
-                                                         MmCached);
-#endif /* DUMB_DRIVER */
-        }
-    }
-
-    /* Lastly, free the allocated non-contiguous buffers */
-    NVMeFreeNonContiguousBuffers(pAE);
-} /* NVMeFreeBuffers */
-
-
-/*******************************************************************************
- * NVMeFreeNonContiguousBuffers
- *
- * @brief NVMeFreeNonContiguousBuffer gets called to free buffers that had been
- *        allocated without requiring physically contiguous.
- *
- * @param pAE - Pointer to hardware device extension.
- *
- * @return VOID
- ******************************************************************************/
-VOID NVMeFreeNonContiguousBuffers (
-    PNVME_DEVICE_EXTENSION pAE
-)
-{
-    PQUEUE_INFO pQI = &pAE->QueueInfo;
-    PRES_MAPPING_TBL pRMT = &pAE->ResMapTbl;
-
-    /* Free the Start State Machine SRB EXTENSION allocated by driver */
-    if (pAE->DriverState.pSrbExt != NULL) {
-        StorPortFreePool((PVOID)pAE, pAE->DriverState.pSrbExt);
-        pAE->DriverState.pSrbExt = NULL;
-    }
-
-    /* Free the resource mapping tables if allocated */
-    if (pRMT->pMsiMsgTbl != NULL) {
-        StorPortFreePool((PVOID)pAE, pRMT->pMsiMsgTbl);
-        pRMT->pMsiMsgTbl = NULL;
-    }
-
-    if (pRMT->pCoreTbl != NULL) {
-        StorPortFreePool((PVOID)pAE, pRMT->pCoreTbl);
-        pRMT->pCoreTbl = NULL;
-    }
-
-    if (pRMT->pNumaNodeTbl != NULL) {
-        StorPortFreePool((PVOID)pAE, pRMT->pNumaNodeTbl);
-        pRMT->pNumaNodeTbl = NULL;
-    }
-
-    if (pRMT->pProcGroupTbl != NULL) {
-        StorPortFreePool((PVOID)pAE, pRMT->pProcGroupTbl);
-        pRMT->pProcGroupTbl = NULL;
-    }
-
-    /* Free the allocated SUB/CPL_QUEUE_INFO structures memory */
-    if ( pQI->pSubQueueInfo != NULL ) {
-        StorPortFreePool((PVOID)pAE, pQI->pSubQueueInfo);
-        pQI->pSubQueueInfo = NULL;
-    }
-
-    if ( pQI->pCplQueueInfo != NULL ) {
-        StorPortFreePool((PVOID)pAE, pQI->pCplQueueInfo);
-        pQI->pCplQueueInfo = NULL;
-    }
-
-    /* Free the DPC array memory */
-    if (pAE->pDpcArray != NULL) {
-        StorPortFreePool((PVOID)pAE, pAE->pDpcArray);
-        pAE->pDpcArray = NULL;
-    }
-
-	/* Free the memory allocated for Group affinity */
-	if (pAE->pArrGrpAff != NULL) {
-		StorPortFreePool((PVOID)pAE, pAE->pArrGrpAff);
-		pAE->pArrGrpAff = NULL;
-	}
-
-} /* NVMeFreeNonContiguousBuffer */
-
-/*******************************************************************************
- * NVMeAllocIoQueues
- *
- * @brief NVMeAllocIoQueues gets called to allocate IO queue(s) from system
- *        memory after determining the number of queues to allocate. In the case
- *        of failing to allocate memory, it needs to fall back to use one queue
- *        per adapter and free up the allocated buffers that is not used. The
- *        scenarios can be described in the follow pseudo codes:
- *
- *        if (Queue Number granted from adapter >= core number) {
- *            for (NUMA = 0; NUMA < NUMA node number; NUMA++) {
- *                for (Core = FirstCore; Core <= LastCore; Core++) {
- *                    Allocate queue pair for each core;
- *                    if (Succeeded) {
- *                        Note down which queue to use for each core;
- *                    } else {
- *                        if (failed on first queue allocation and NUMA == 0) {
- *                            return FALSE;
- *                        } else { //at least one queue allocated
- *                            // Fall back to one queue per adapter
- *                            Free up the allocated, not used queues;
- *                            Mark down number of queues allocated;
- *                            Note down which queue to use for each core;
- *                            return TRUE;
- *                        }
- *                    }
- *                }
- *            }
- *            Mark down number of queue pairs allocated;
- *            return TRUE;
- *        } else {
- *            // Allocate one queue pair only
- *            Allocate one queue pair;
- *            if (Succeeded) {
- *                Mark down one pair of queues allocated;
- *                Note down which queue to use for each core;
- *                return TRUE;
- *            } else {
- *                return FALSE;
- *            }
- *        }
- *
- * @param pAE - Pointer to hardware device extension.
- *
- * @return BOOLEAN
- *     TRUE - If all resources are allocated and initialized properly
- *     FALSE - If anything goes wrong
- ******************************************************************************/
-BOOLEAN NVMeAllocIoQueues(
-    PNVME_DEVICE_EXTENSION pAE
-)
-{
-    ULONG Status = STOR_STATUS_SUCCESS;
-    PQUEUE_INFO pQI = &pAE->QueueInfo;
-    PRES_MAPPING_TBL pRMT = &pAE->ResMapTbl;
-    PNUMA_NODE_TBL pNNT = NULL;
-    PSUB_QUEUE_INFO pSQI = NULL;
-    PCORE_TBL pCT = NULL;
-    ULONG Core, Node, QEntries;
-    ULONG CoreTableIndex = 0;
-    USHORT QueueID = 0;
-    ULONG Queue = 0;
-
-    pQI->NumSubIoQAllocated = pQI->NumCplIoQAllocated = 0;
-
-    if (pAE->ntldrDump == TRUE) {
-        QEntries = MIN_IO_QUEUE_ENTRIES; 
-        Status = NVMeAllocQueues(pAE,
-                                 QueueID + 1,
-                                 QEntries,
-                                 0);
-    
-        if (Status == STOR_STATUS_SUCCESS) {
-            pQI->NumSubIoQAllocated = ++pQI->NumCplIoQAllocated;
-            return (TRUE);
-        } else {
-            return (FALSE);
-        }
-    } else {
-        for (Node = 0; Node < pRMT->NumNumaNodes; Node++) {
-            pNNT = pRMT->pNumaNodeTbl + Node;
-            /* When no logical processors assigned to the node, just move on */
-            if (pNNT->NumCores == 0)
-                continue;
-
-            for (Core = pNNT->FirstCoreNum; Core <= pNNT->LastCoreNum; Core++) {
-
-
-                pCT = pRMT->pCoreTbl + CoreTableIndex;
-
-                /*
-                 * If there are more cores than Qs alloc'd from the adapter, just
-                 * cycle through the available Qs in the core table.  Ex, if there
-                 * are 2 Q's and 4 cores, the table will look like:
-                 * Core  QID
-                 *  0     1
-                 *  1     2
-                 *  3     1
-                 *  4     2
-                 */
-                 QueueID = (QueueID + 1 > (USHORT)pQI->NumSubIoQAllocFromAdapter) ?
-                            1 : QueueID + 1;
-
-                if (pQI->NumSubIoQAllocated < QueueID)  {
- 
-                    QEntries = pAE->InitInfo.IoQEntries;
-                    Status = NVMeAllocQueues(pAE,
-                                             QueueID,
-                                             QEntries,
-                                             (USHORT)Node);
-
-                    if (Status == STOR_STATUS_SUCCESS) {
-   
-                        pQI->NumSubIoQAllocated = ++pQI->NumCplIoQAllocated;
-                    } else {
-                        /*
-                         * If faling on the very first queue allocation, failure
-                         * case.
-                         */
-                        if (CoreTableIndex == pNNT->FirstCoreNum && Node == 0) {
-                            return (FALSE);
-                        } else {
-                            /*
-                             * Fall back to share the very first queue allocated.
-                             * Free the other allocated queues before returning
-                             * and return TRUE.
-                             */
-                            Queue = 0;
-                            for (Core = 1; Core < pRMT->NumActiveCores; Core++) {
-                                /* Need to keep first allocated IO queue for sharing */
-                                Queue = Core + 1; 
-                                pSQI = pQI->pSubQueueInfo + Queue;
-
-                                if (pSQI->pQueueAlloc != NULL)
-                                    StorPortFreeContiguousMemorySpecifyCache(
-                                        (PVOID)pAE,
-                                        pSQI->pQueueAlloc,
-                                        pSQI->QueueAllocSize,
-                                        MmCached);
-                                pSQI->pQueueAlloc = NULL;
-
-                                if (pSQI->pPRPListAlloc != NULL)
-                                    StorPortFreeContiguousMemorySpecifyCache(
-                                        (PVOID)pAE,
-                                        pSQI->pPRPListAlloc,
-                                        pSQI->PRPListAllocSize,
-                                        MmCached);
-                                pSQI->pPRPListAlloc = NULL;
-#ifdef DUMB_DRIVER
-                                if (pSQI->pDblBuffAlloc != NULL)
-                                    StorPortFreeContiguousMemorySpecifyCache(
-                                                            (PVOID)pAE,
-                                                            pSQI->pDblBuffAlloc,
-                                                            pSQI->dblBuffSz,
-                                                            MmCached);
-
-                                if (pSQI->pDblBuffListAlloc != NULL)
-                                    StorPortFreeContiguousMemorySpecifyCache(
-                                                            (PVOID)pAE,
-                                                            pSQI->pDblBuffListAlloc,
-                                                            pSQI->dblBuffListSz,
-                                                            MmCached);
-
-#endif
-                                pCT = pRMT->pCoreTbl + Core;
-                                pCT->SubQueue = pCT->CplQueue = 1;
-                            }
-
-                            pQI->NumSubIoQAllocated = pQI->NumCplIoQAllocated = 1;
-        
-                            pAE->MultipleCoresToSingleQueueFlag = TRUE;
-                            return (TRUE);
-                        } /* fall back to use only one queue */
-                    } /* failure case */
-                } else {
-                    pAE->MultipleCoresToSingleQueueFlag = TRUE;
-                }
-
-                /* Succeeded! Mark down the number of queues allocated */
-                pCT->SubQueue = pCT->CplQueue = QueueID;
-                StorPortDebugPrint(INFO,
-                    "NVMeAllocIoQueues: Core 0x%x ---> QueueID 0x%x\n",
-                    CoreTableIndex, QueueID);
-                CoreTableIndex++;
-            } /* current core */
-        } /* current NUMA node */
-
-        return (TRUE);
-    }
-} /* NVMeAllocIoQueues */
-/*******************************************************************************
- * NVMeAcqQueueEntry
- *
- * @brief NVMeAcqQueueEntry gets called to retrieve a Command Info entry from
- *        the head of the specified FreeQ
- *
- * @param pAE - Pointer to hardware device extension.
- * @param pFreeQ - Pointer to the FreeQ
- * @param queue - Which queue to retrieve entry from
- *
- * @return PCMD_ENTRY
- *     Success: A poiter to the CMD_ENTRY structure
- *     Failure: A NULL pointer
- ******************************************************************************/
-PCMD_ENTRY NVMeAcqQueueEntry(
-    PNVME_DEVICE_EXTENSION pAE,
-    PLIST_ENTRY pFreeQ
-)
-{
-    PLIST_ENTRY pListEntry = NULL;
-    PCMD_ENTRY pCmdEntry = NULL;
-
-    if (IsListEmpty(pFreeQ) == FALSE) {
-        pListEntry = (PLIST_ENTRY) RemoveHeadList(pFreeQ);
-        pCmdEntry = CONTAINING_RECORD(pListEntry, CMD_ENTRY, ListEntry);
-
-        StorPortDebugPrint(TRACE,
-                           "NVMeAcqQueueEntry : Entry at 0x%p\n",
-                           pCmdEntry);
-    } else {
-        StorPortDebugPrint(WARNING,
-                           "NVMeAcqQueueEntry: <Warning> No entry acquired.\n");
-    }
-
-    return pCmdEntry;
-} /* NVMeAcqQueueEntry */
-
-/*******************************************************************************
- * NVMeGetCmdEntry
- *
- * @brief NVMeGetCmdEntry gets called to acquire an command entry for a request
- *        which needs to be processed in adapter. The returned CMD_INFO contains
- *        CmdID and the associated PRPList that might be used when necessary.
- *
- * @param pAE - Pointer to hardware device extension.
- * @param QueueID - Which submission queue to acquire Cmd ID from
- * @param Context - Depending on callers, this can be the original SRB of the
- *                  request or anything else.
- * @param pCmdInfo - Pointer to a caller prepared buffer where the acquired
- *                   command info is saved.
- *
- * @return ULONG
- *     STOR_STATUS_SUCCESS - If a CmdID is successfully acquired
- *     Otherwise - If anything goes wrong
- ******************************************************************************/
-ULONG NVMeGetCmdEntry(
-    PNVME_DEVICE_EXTENSION pAE,
-    USHORT QueueID,
-    PVOID Context,
-    PVOID pCmdInfo
-)
-{
-    PQUEUE_INFO pQI = &pAE->QueueInfo;
-    PSUB_QUEUE_INFO pSQI = NULL;
-    PCMD_ENTRY pCmdEntry = NULL;
-    PLIST_ENTRY pListEntry = NULL;
-
-    if (QueueID > pQI->NumSubIoQCreated || pCmdInfo == NULL)
-        return (STOR_STATUS_INVALID_PARAMETER);
-
-    pSQI = pQI->pSubQueueInfo + QueueID;
-
-    if (!IsListEmpty(&pSQI->FreeQList)) {
-        /* Retrieve a free CMD_INFO entry for the request */
-        pListEntry = RemoveHeadList(&pSQI->FreeQList);
-        pCmdEntry = (PCMD_ENTRY)CONTAINING_RECORD(pListEntry, CMD_ENTRY, ListEntry);
-    } else {
-        StorPortDebugPrint(ERROR,
-                           "NVMeGetCmdEntry: <Error> Queue#%d is full!\n",
-                           QueueID);
-        return (STOR_STATUS_INSUFFICIENT_RESOURCES);
-    }
-
-
-    /* Mark down it's used and save the original context */
-    pCmdEntry->Context = Context;
-    ASSERT(pCmdEntry->Pending == FALSE);
-
-    pCmdEntry->Pending = TRUE;
-
-    /* Return the CMD_INFO structure */
-    *(ULONG_PTR *)pCmdInfo = (ULONG_PTR)(&pCmdEntry->CmdInfo);
-
-    return (STOR_STATUS_SUCCESS);
-} /* NVMeGetCmdEntry */
-
-/*******************************************************************************
- * NVMeGetCplEntry
- *
- * @brief NVMeGetCplEntry gets called to retrieve one completion queue entry at
- *        a time from the specified completion queue. This routine is
- *        responsible for looking up teh embedded PhaseTag and determine if the
- *        entry is a newly completed one. If not, return
- *        STOR_STATUS_UNSUCCESSFUL. Otherwise, do the following:
- *
- *        1. Copy the completion entry to pCplEntry
- *        2. Increase the Completion Queue Head Pointer by one.
- *        3. Reset the Head Pointer to 0 and change CurPhaseTag if it's equal to
- *           the associated CplQEntries
- *        4. Program the associated Doorbell register with the Head Pointer
- *        5. Return STOR_STATUS_SUCCESS
- *
- * @param pAE - Pointer to hardware device extension.
- * @param QueueID - Which completion queue to retrieve entry from
- * @param pCplEntry - The caller prepared buffer to save the retrieved entry
- *
- * @return ULONG
- *    STOR_STATUS_SUCCESS - If there is one newly completed entry returned
- *    STOR_STATUS_UNSUCCESSFUL - If there is no newly completed entry
- *    Otherwise - If anything goes wrong
- ******************************************************************************/
-ULONG NVMeGetCplEntry(
-    PNVME_DEVICE_EXTENSION pAE,
-    PCPL_QUEUE_INFO pCQI,
-    PVOID pCplEntry
-)
-{
-    PQUEUE_INFO pQI = &pAE->QueueInfo;
-    PNVMe_COMPLETION_QUEUE_ENTRY pCQE = NULL;
-
-    /* Make sure the parameters are valid */
-    if (pCQI->CplQueueID > pQI->NumCplIoQCreated || pCplEntry == NULL)
-        return (STOR_STATUS_INVALID_PARAMETER);
-
-    pCQE = (PNVMe_COMPLETION_QUEUE_ENTRY)pCQI->pCplQStart;
-    pCQE += pCQI->CplQHeadPtr;
-
-    /* Check Phase Tag to determine if it's a newly completed entry */
-    if (pCQI->CurPhaseTag != pCQE->DW3.SF.P) {
-        *(ULONG_PTR *)pCplEntry = (ULONG_PTR)pCQE;
-        pCQI->CplQHeadPtr++;
-        pCQI->Completions++;
-
-        if (pCQI->CplQHeadPtr == pCQI->CplQEntries) {
-            pCQI->CplQHeadPtr = 0;
-            pCQI->CurPhaseTag = !pCQI->CurPhaseTag;
-        }
-
-        return STOR_STATUS_SUCCESS;
-    }
-
-    return STOR_STATUS_UNSUCCESSFUL;
-} /* NVMeGetCplEntry */
-
-/*******************************************************************************
- * NVMeReadRegistry
- *
- * @brief This function gets called to fetch values of sub-keys from Registry
- *        and it calls StorPortRegistryRead to complete.
- *
- * @param pAE - Pointer to Device Extension
- * @param pLabel - Pointer to the string name
- * @param Type - The Regsitry data type
- * @param pBuffer - The buffer holding the value
- * @param pLen - The buffer holding the length of readback data
- *
- * @return BOOLEAN
- *     Returns TRUE when no error encountered, otherwise, FALSE.
- ******************************************************************************/
-BOOLEAN NVMeReadRegistry(
-    PNVME_DEVICE_EXTENSION pAE,
-    UCHAR* pLabel,
-    ULONG Type,
-    UCHAR* pBuffer,
-    ULONG* pLen
-)
-{
-    BOOLEAN Ret = FALSE;
-
-    Ret = StorPortRegistryRead(pAE,
-                               pLabel,
-                               1,
-                               Type,
-                               pBuffer,
-                               pLen);
-
-    if (Ret == FALSE || (*pLen) == 0) {
-        StorPortDebugPrint(ERROR,
-                           "NVMeReadRegistry: <Error> ret = 0x%x\n",
-                           Ret);
-        return (FALSE);
-    }
-
-    if (*((PULONG)pBuffer) == REGISTRY_KEY_NOT_FOUND) {
-        StorPortDebugPrint(ERROR,
-                           "NVMeReadRegistry: <Error> Registry is not found\n");
-        return (FALSE);
-    }
-
-    return (TRUE);
-} /* NVMeReadRegistry */
-
-/*******************************************************************************
- * NVMeWriteRegistry
- *
- * @brief This function gets called to write values of sub-keys in Registry and
- *        it calls StorPortRegistryWrite to complete.
- *
- * @param pAE - Pointer to Device Extension
- * @param pLabel - Pointer to the string name
- * @param Type - The Regsitry data type
- * @param pBuffer - The buffer holding the value
- * @param Len - The length of data to write
- *
- * @return BOOLEAN
- *     Returns TRUE when no error encountered, otherwise, FALSE.
- ******************************************************************************/
-BOOLEAN NVMeWriteRegistry(
-    PNVME_DEVICE_EXTENSION pAE,
-    UCHAR* pLabel,
-    ULONG Type,
-    UCHAR* pBuffer,
-    ULONG Len
-)
-{
-    BOOLEAN Ret = FALSE;
-
-    Ret = StorPortRegistryWrite(pAE,
-                                pLabel,
-                                1,
-                                Type,
-                                pBuffer,
-                                Len);
-
-    if ( Ret == FALSE ) {
-        StorPortDebugPrint(ERROR,
-                           "NVMeWriteRegistry: <Error> ret = 0x%x\n",
-                           Ret);
-        return (FALSE);
-    }
-
-    return (TRUE);
-} /* NVMeWriteRegistry */
-
-/*******************************************************************************
- * NVMeFetchRegistry
- *
- * @brief NVMeFetchRegistry gets called to fetch all the default values from
- *        Registry when the driver first loaded. The sub-keys are:
- *
- *        Namespace: The supported number of Namespace
- *        TranSize: Max transfer size in bytes with one request
- *        AdQueueEntries: The number of Admin queue entries, 128 by default
- *        IoQueueEntries: The number of IO queue entries, 1024 by default
- *        IntCoalescingTime: The frequency of interrupt coalescing time in 100
- *                           ms increments
- *        IntCoalescingEntry: The frequency of interrupt coalescing entries
- *
- * @param pAE - Device Extension
- *
- * @return BOOLEAN
- *     Returns TRUE when no error encountered, otherwise, FALSE.
- ******************************************************************************/
-BOOLEAN NVMeFetchRegistry(
-    PNVME_DEVICE_EXTENSION pAE
-)
-{
-    UCHAR NAMESPACES[] = "Namespaces";
-    UCHAR MAXTXSIZE[] = "MaxTXSize";
-    UCHAR ADQUEUEENTRY[] = "AdQEntries";
-    UCHAR IOQUEUEENTRY[] = "IoQEntries";
-    UCHAR INTCOALESCINGTIME[] = "IntCoalescingTime";
-    UCHAR INTCOALESCINGENTRY[] = "IntCoalescingEntries";
-
-    ULONG Type = MINIPORT_REG_DWORD;
-    UCHAR* pBuf = NULL;
-    ULONG Len = sizeof(ULONG);
-
-    /* Allocate the buffer from Storport API and zero it out if succeeded */
-    pBuf = StorPortAllocateRegistryBuffer(pAE, &Len);
-    if (pBuf == NULL)
-        return (FALSE);
-
-    memset(pBuf, 0, sizeof(ULONG));
-
-    /*
-     * Fetch the following initial values from
-     * HKLM\System\CurrentControlSet\Services\NVMeOSD\Parameters\Device\
-     * NVMeOSD stands for NVM Express Open Source Driver
-     */
-    if (NVMeReadRegistry(pAE,
-                         NAMESPACES,
-                         Type,
-                         pBuf,
-                         (ULONG*)&Len ) == TRUE ) {
-        if (RANGE_CHK(*(PULONG)pBuf,
-                      MIN_NAMESPACES,
-                      MAX_NAMESPACES) == TRUE) {
-            StorPortCopyMemory((PVOID)(&pAE->InitInfo.Namespaces),
-                   (PVOID)pBuf,
-                   sizeof(ULONG));
-        }
-    }
-
-    memset(pBuf, 0, sizeof(ULONG));
-
-    if (NVMeReadRegistry(pAE,
-                         MAXTXSIZE,
-                         Type,
-                         pBuf,
-                         (ULONG*)&Len ) == TRUE ) {
-        if (RANGE_CHK(*(PULONG)pBuf, MIN_TX_SIZE, MAX_TX_SIZE) == TRUE) {
-            StorPortCopyMemory((PVOID)(&pAE->InitInfo.MaxTxSize),
-                   (PVOID)pBuf,
-                   sizeof(ULONG));
-        }
-    }
-
-    memset(pBuf, 0, sizeof(ULONG));
-
-    if (NVMeReadRegistry(pAE,
-                         ADQUEUEENTRY,
-                         Type,
-                         pBuf,
-                         (ULONG*)&Len ) == TRUE ) {
-        if (RANGE_CHK(*(PULONG)pBuf,
-                      MIN_AD_QUEUE_ENTRIES,
-                      MAX_AD_QUEUE_ENTRIES) == TRUE) {
-            StorPortCopyMemory((PVOID)(&pAE->InitInfo.AdQEntries),
-                   (PVOID)pBuf,
-                   sizeof(ULONG));
-        }
-    }
-
-    memset(pBuf, 0, sizeof(ULONG));
-
-    if (NVMeReadRegistry(pAE,
-                         IOQUEUEENTRY,
-                         Type,
-                         pBuf,
-                         (ULONG*)&Len ) == TRUE ) {
-        if (RANGE_CHK(*(PULONG)pBuf,
-                      MIN_IO_QUEUE_ENTRIES,
-                      MAX_IO_QUEUE_ENTRIES) == TRUE) {
-            StorPortCopyMemory((PVOID)(&pAE->InitInfo.IoQEntries),
-                   (PVOID)pBuf,
-                   sizeof(ULONG));
-        }
-    }
-
-    memset(pBuf, 0, sizeof(ULONG));
-
-    if (NVMeReadRegistry(pAE,
-                         INTCOALESCINGTIME,
-                         Type,
-                         pBuf,
-                         (ULONG*)&Len ) == TRUE ) {
-        if (RANGE_CHK(*(PLONG)pBuf,
-                      MIN_INT_COALESCING_TIME,
-                      MAX_INT_COALESCING_TIME) == TRUE) {
-            StorPortCopyMemory((PVOID)(&pAE->InitInfo.IntCoalescingTime),
-                   (PVOID)pBuf,
-                   sizeof(ULONG));
-        }
-    }
-
-    memset(pBuf, 0, sizeof(ULONG));
-
-    if (NVMeReadRegistry(pAE,
-                         INTCOALESCINGENTRY,
-                         Type,
-                         pBuf,
-                         (ULONG*)&Len ) == TRUE ) {
-        if (RANGE_CHK(*(PLONG)pBuf,
-                      MIN_INT_COALESCING_ENTRY,
-                      MAX_INT_COALESCING_ENTRY) == TRUE) {
-            StorPortCopyMemory((PVOID)(&pAE->InitInfo.IntCoalescingEntry),
-                   (PVOID)pBuf,
-                   sizeof(ULONG));
-        }
-    }
-
-    /* Release the buffer before returning */
-    StorPortFreeRegistryBuffer( pAE, pBuf );
-
-    return (TRUE);
-} /* NVMeFetchRegistry */
-
-/*******************************************************************************
- * NVMeMaskInterrupts
- *
- * @brief Masks/disables the interrupts
- *
- * @param pAE - Device Extension
- *
- * @return VOID
- ******************************************************************************/
-VOID NVMeMaskInterrupts(
-    PNVME_DEVICE_EXTENSION pAE
-)
-{
-    PRES_MAPPING_TBL pRMT = &pAE->ResMapTbl;
-
-    /* Determine the Interrupt type */
-    switch (pRMT->InterruptType) {
-        case INT_TYPE_INTX: {
-            StorPortDebugPrint(INFO,
-                "NVMeDisableInterrupts: Disabled INTx interrupts\n");
-            break;
-        }
-        case INT_TYPE_MSIX: {
-            break;
-        }
-        case INT_TYPE_MSI: {
-            break;
-        }
-        case INT_TYPE_NONE:
-        default: {
-            StorPortDebugPrint(ERROR,
-                "NVMeDisableInterrupts: Unrecognized intr type\n");
-            break;
-        }
-    }
-} /* NVMeMaskInterrupts */
-
-/*******************************************************************************
- * NVMeUnmaskInterrupts
- *
- * @brief Unmasks/Enables the interrupts
- *
- * @param pAE - Device Extension
- *
- * @return VOID
- ******************************************************************************/
-VOID NVMeUnmaskInterrupts(
-    PNVME_DEVICE_EXTENSION pAE
-)
-{
-    PRES_MAPPING_TBL pRMT = &pAE->ResMapTbl;
-
-    /* Determine the Interrupt type */
-    switch (pRMT->InterruptType) {
-        case INT_TYPE_INTX: {
-            StorPortDebugPrint(INFO,
-                "NVMeDisableInterrupts: Disabled INTx interrupts\n");
-            break;
-        }
-        case INT_TYPE_MSIX: {
-            break;
-        }
-        case INT_TYPE_MSI: {
-            break;
-        }
-        case INT_TYPE_NONE:
-        default: {
-            StorPortDebugPrint(ERROR,
-                "NVMeDisableInterrupts: Unrecognized intr type\n");
-            break;
-        }
-    }
-} /* NVMeUnmaskInterrupts */
+/**
+ *******************************************************************************
+ ** Copyright (c) 2011-2012                                                   **
+ **                                                                           **
+ **   Integrated Device Technology, Inc.                                      **
+ **   Intel Corporation                                                       **
+ **   LSI Corporation                                                         **
+ **                                                                           **
+ ** All rights reserved.                                                      **
+ **                                                                           **
+ *******************************************************************************
+ **                                                                           **
+ ** Redistribution and use in source and binary forms, with or without        **
+ ** modification, are permitted provided that the following conditions are    **
+ ** met:                                                                      **
+ **                                                                           **
+ **   1. Redistributions of source code must retain the above copyright       **
+ **      notice, this list of conditions and the following disclaimer.        **
+ **                                                                           **
+ **   2. Redistributions in binary form must reproduce the above copyright    **
+ **      notice, this list of conditions and the following disclaimer in the  **
+ **      documentation and/or other materials provided with the distribution. **
+ **                                                                           **
+ ** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS   **
+ ** IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, **
+ ** THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR    **
+ ** PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR         **
+ ** CONTRIBUTORS BE LIABLE FOR ANY DIRECT,INDIRECT, INCIDENTAL, SPECIAL,      **
+ ** EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,       **
+ ** PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR        **
+ ** PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF    **
+ ** LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING      **
+ ** NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS        **
+ ** SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.              **
+ **                                                                           **
+ ** The views and conclusions contained in the software and documentation     **
+ ** are those of the authors and should not be interpreted as representing    **
+ ** official policies, either expressed or implied, of Intel Corporation,     **
+ ** Integrated Device Technology Inc., or Sandforce Corporation.              **
+ **                                                                           **
+ *******************************************************************************
+**/
+
+/*
+ * File: nvmeInit.c
+ */
+
+#include "precomp.h"
+#ifndef DBG
+#include "nvmeinit.tmh"
+#endif
+
+/*******************************************************************************
+ * NVMeGetPhysAddr
+ *
+ * @brief Helper routine for converting virtual address to physical address by
+ *        calling StorPortGetPhysicalAddress.
+ *
+ * @param pAE - Pointer to hardware device extension
+ * @param pVirtAddr - Virtual address to convert
+ *
+ * @return STOR_PHYSICAL_ADDRESS
+ *     Physical Address - If all resources are allocated and initialized
+ *     NULL - If anything goes wrong
+ ******************************************************************************/
+STOR_PHYSICAL_ADDRESS NVMeGetPhysAddr(
+    PNVME_DEVICE_EXTENSION pAE,
+    PVOID pVirtAddr
+)
+{
+    ULONG MappedSize;
+    STOR_PHYSICAL_ADDRESS PhysAddr;
+
+    /* Zero out the receiving buffer before converting */
+    PhysAddr.QuadPart = 0;
+    if (pAE->ntldrDump == FALSE) {
+        PhysAddr = StorPortGetPhysicalAddress(pAE,
+                                              NULL,
+                                              pVirtAddr,
+                                              &MappedSize);
+    } else {
+        PhysAddr = MmGetPhysicalAddress(pVirtAddr);
+    }
+
+    /* If fails, log the event and print out the error */
+    if ( PhysAddr.QuadPart == 0) {
+        StorPortDebugPrint(ERROR,
+            "NVMeGetPhysAddr: <Error> Invalid phys addr.\n");
+    }
+
+    return PhysAddr;
+} /* NVMeGetPhysAddr */
+
+/*******************************************************************************
+ * NVMeGetCurCoreNumber
+ *
+ * @brief Helper routine for retrieving current processor number by calling
+ *        StorPortGetCurrentProcessorNumber
+ *
+ * @param pAE - Pointer to hardware device extension
+ * @param pPN - Pointer to PROCESSOR_NUMBER structure
+ *
+ * @return BOOLEAN
+ *     TRUE - If valid number is retrieved
+ *     FALSE - If anything goes wrong
+ ******************************************************************************/
+BOOLEAN NVMeGetCurCoreNumber(
+    PNVME_DEVICE_EXTENSION pAE,
+    PPROCESSOR_NUMBER pPN
+)
+{
+    ULONG Status = STOR_STATUS_SUCCESS;
+
+    /* Get Current processor number and make sure it's valid */
+    Status = StorPortGetCurrentProcessorNumber(pAE, pPN);
+    if (Status != STOR_STATUS_SUCCESS) {
+        StorPortDebugPrint(ERROR,
+                           "NVMeGetCurCoreNumber: <Error> Failure, Sts=%d.\n",
+                           Status);
+        return (FALSE);
+    }
+
+    if (pPN->Number >= pAE->ResMapTbl.NumActiveCores) {
+        StorPortDebugPrint(ERROR,
+                    "NVMeGetCurCoreNumber: <Error> Invalid core number = %d.\n",
+                     pPN->Number);
+        return (FALSE);
+    }
+
+    return (TRUE);
+} /* NVMeGetCurCoreNumber */
+
+/*******************************************************************************
+ * NVMeAllocateMemNode
+ *
+ * @brief Helper routoine for Buffer Allocation.
+ *        StorPortAllocateContiguousMemorySpecifyCacheNode is called to allocate
+ *        memory from the preferred NUMA node. If the node can't grant it, the
+ *        allocation is retried from any node and accounted as remote. If
+ *        succeeded, zero out the memory before returning to the caller.
+ *
+ * @param pAE - Pointer to hardware device extension
+ * @param Size - In bytes
+ * @param Node - Preferred NUMA node
+ * @param pRemote - Optional, set to TRUE if the preferred node was not honored
+ *
+ * @return PVOID
+ *    Buffer Addr - If all resources are allocated and initialized properly
+ *    NULL - If anything goes wrong
+ ******************************************************************************/
+PVOID NVMeAllocateMemNode(
+    PNVME_DEVICE_EXTENSION pAE,
+    ULONG Size,
+    ULONG Node,
+    PBOOLEAN pRemote
+)
+{
+    PHYSICAL_ADDRESS Low;
+    PHYSICAL_ADDRESS High;
+    PHYSICAL_ADDRESS Align;
+    PVOID pBuf = NULL;
+    ULONG Status = 0;
+    ULONG NewBytesAllocated;
+    BOOLEAN Remote = FALSE;
+
+    if (pAE->ntldrDump == FALSE) {
+        /* Set up preferred range and alignment before allocating */
+        Low.QuadPart = 0;
+        High.QuadPart = (-1);
+        Align.QuadPart = 0;
+        Status = StorPortAllocateContiguousMemorySpecifyCacheNode(
+                     pAE, Size, Low, High, Align, MmCached, Node, (PVOID)&pBuf);
+
+        /* It fails, log the error first */
+        if ((Status != 0) || (pBuf == NULL)) {
+            StorPortDebugPrint(WARNING,
+                               "NVMeAllocateMem: Failure from node=%d, sts=0x%x\n",
+                               Node, Status);
+            /* If the memory allocation fails for the requested node,
+            * we will try to allocate from any available node, which is not
+            * expected to fail.
+            */
+
+            /* Give it another try from any nodes that can grant the request */
+            Status = 0;
+            pBuf = NULL;
+            Status = StorPortAllocateContiguousMemorySpecifyCacheNode(
+                     pAE, Size, Low, High, Align, MmCached, MM_ANY_NODE_OK, (PVOID)&pBuf);
+            if ((Status != 0) || (pBuf == NULL)) {
+                StorPortDebugPrint(ERROR,
+                               "NVMeAllocateMem: Failure from any node, sts=0x%x\n",
+                               Status);
+                return NULL;
+            }
+            Remote = TRUE;
+        }
+
+        /* Account for where the buffer ended up */
+        if (Remote == TRUE) {
+            pAE->NumaRemoteAllocs++;
+            pAE->NumaRemoteBytes += Size;
+        } else {
+            pAE->NumaLocalAllocs++;
+        }
+    } else {     
+        NewBytesAllocated = pAE->DumpBufferBytesAllocated + Size;
+        if (NewBytesAllocated <= pAE->DumpBufferSize) {
+            pBuf = pAE->DumpBuffer + pAE->DumpBufferBytesAllocated;               
+            pAE->DumpBufferBytesAllocated = NewBytesAllocated;
+        } else {
+            StorPortDebugPrint(ERROR,
+                               "Unable to allocate %d bytes at DumpBuffer offset %d.\n",
+                               Size,
+                               pAE->DumpBufferBytesAllocated);
+            return NULL;
+        }
+    }
+
+    if (pRemote != NULL)
+        *pRemote = Remote;
+
+    StorPortDebugPrint(INFO, "NVMeAllocateMem: Succeeded!\n");
+    /* Zero out the buffer before return */
+    memset(pBuf, 0, Size);
+
+    return pBuf;
+} /* NVMeAllocateMemNode */
+
+/*******************************************************************************
+ * NVMeAllocateMem
+ *
+ * @brief Helper routoine for Buffer Allocation when the caller doesn't track
+ *        the placement itself. See NVMeAllocateMemNode.
+ *
+ * @param pAE - Pointer to hardware device extension
+ * @param Size - In bytes
+ * @param Node - Preferred NUMA node
+ *
+ * @return PVOID
+ *    Buffer Addr - If all resources are allocated and initialized properly
+ *    NULL - If anything goes wrong
+ ******************************************************************************/
+PVOID NVMeAllocateMem(
+    PNVME_DEVICE_EXTENSION pAE,
+    ULONG Size,
+    ULONG Node
+)
+{
+    return NVMeAllocateMemNode(pAE, Size, Node, NULL);
+} /* NVMeAllocateMem */
+
+
+/*******************************************************************************
+ * NVMeAllocatePool
+ *
+ * @brief Helper routoine for non-contiguous buffer allocation.
+ *        StorPortAllocatePool is called to allocate memory from non-paged pool.
+ *        If succeeded, zero out the memory before returning to the caller.
+ *
+ * @param pAE - Pointer to hardware device extension
+ * @param Size - In bytes
+ *
+ * @return PVOID
+ *     Buffer Addr - If all resources are allocated and initialized properly
+ *     NULL - If anything goes wrong
+ ******************************************************************************/
+PVOID NVMeAllocatePool(
+    PNVME_DEVICE_EXTENSION pAE,
+    ULONG Size
+)
+{
+    ULONG Tag = 'eMVN';
+    PVOID pBuf = NULL;
+    ULONG Status = STOR_STATUS_SUCCESS;
+    ULONG NewBytesAllocated;
+
+    if (pAE->ntldrDump == FALSE) {
+        /* Call StorPortAllocatePool to allocate the buffer */
+        Status = StorPortAllocatePool(pAE, Size, Tag, (PVOID)&pBuf);
+    } else {     
+        NewBytesAllocated = pAE->DumpBufferBytesAllocated + Size;
+        if (NewBytesAllocated <= pAE->DumpBufferSize) {
+            pBuf = pAE->DumpBuffer + pAE->DumpBufferBytesAllocated;               
+            pAE->DumpBufferBytesAllocated = NewBytesAllocated;
+        } else {
+             StorPortDebugPrint(ERROR,
+                                "Unable to allocate %d bytes at DumpBuffer offset %d.\n",
+                                Size,
+                                pAE->DumpBufferBytesAllocated);
+        }
+    }    
+
+    /* It fails, log the error and return NULL */
+    if ((Status != STOR_STATUS_SUCCESS) || (pBuf == NULL)) {
+        StorPortDebugPrint(ERROR,
+                           "NVMeAllocatePool:<Error> Failure, sts=0x%x\n",
+                           Status );
+        return NULL;
+    }
+
+    /* Zero out the buffer before return */
+    memset(pBuf, 0, Size);
+
+    return pBuf;
+} /* NVMeAllocatePool */
+
+/*******************************************************************************
+ * NVMeActiveProcessorCount
+ *
+ * @brief Helper routoine for deciding the number of active processors of an
+ *        NUMA node.
+ *
+ * @param Mask - bitmap of the active processors
+ *
+ * @return USHORT
+ *     The number of active processors
+ ******************************************************************************/
+USHORT NVMeActiveProcessorCount(
+    ULONG_PTR Mask
+)
+{
+    USHORT Count = 0;
+
+    /*
+     * Loop thru the bits of Mask (a 32 or 64-bit value), increase the count
+     * by one when Mask is non-zero after bit-wise AND operation between Mask
+     * and Mask-1. This figures out the number of bits (in Mask) that are set
+     * as 1.
+     */
+    while (Mask) {
+        Count++;
+        Mask &= (Mask - 1);
+    }
+
+    return Count;
+} /* NVMeActiveProcessorCount */
+
+/*******************************************************************************
+ * NVMeEnumNumaCores
+ *
+ * @brief NVMeEnumNumaCores collects the current NUMA/CPU topology information.
+ *        Confirms if NUMA is supported, how many NUMA nodes in current system
+ *        before allocating memory for CORE_TBL structures
+ *
+ * @param pAE - Pointer to hardware device extension
+ *
+ * @return BOOLEAN
+ *     TRUE - If all resources are allocated and initialized properly
+ *     FALSE - If anything goes wrong
+ ******************************************************************************/
+BOOLEAN NVMeEnumNumaCores(
+    PNVME_DEVICE_EXTENSION pAE
+)
+{
+    GROUP_AFFINITY GroupAffinity;
+    USHORT Bit = 0, Grp;
+    ULONG Core = 0, CoreCounter = 0;
+    ULONG BaseCoreNum = 0;
+    ULONG Node = 0;
+    ULONG Status = 0;
+    ULONG TotalCores = 0;
+    USHORT MaxNumCoresInGroup = sizeof(KAFFINITY) * 8;
+    PRES_MAPPING_TBL pRMT = &pAE->ResMapTbl;
+    PCORE_TBL pCoreTblTemp = NULL;
+    PNUMA_NODE_TBL pNNT = NULL;
+    BOOLEAN FirstCoreFound = FALSE;
+    KAFFINITY GrpAffinityMask = 0;
+    PPROC_GROUP_TBL pProcGrpTbl = NULL;
+    ULONG SysProcessorNumber = 0;
+
+    /*
+     * Decide how many NUMA nodes in current system if only one (0 returned),
+     * NUMA is not supported.
+     */
+    StorPortGetHighestNodeNumber( pAE, &Node );
+    pRMT->NumNumaNodes = Node + 1;
+
+    StorPortDebugPrint(INFO,
+                       "NVMeEnumNumaCores: # of NUMA node(s) = %d.\n",
+                       Node + 1);
+    /*
+     * Allocate buffer for NUMA_NODE_TBL structure array.
+     * If fails, return FALSE
+     */
+    pRMT->pNumaNodeTbl = (PNUMA_NODE_TBL)
+        NVMeAllocatePool(pAE, pRMT->NumNumaNodes * sizeof(NUMA_NODE_TBL));
+
+    if (pRMT->pNumaNodeTbl == NULL)
+        return (FALSE);
+
+    /* Find out the current group topology in the system */
+    Status = StorPortGetActiveGroupCount(pAE, &pRMT->NumGroup);
+    if (pRMT->NumGroup == 0 || Status != STOR_STATUS_SUCCESS) {
+        StorPortDebugPrint(INFO, "NVMeEnumNumaCores: Failed to retrieve number of group.\n");
+        return (FALSE);
+    }
+    /*
+     * Allocate buffer for PROC_GROUP_TBL structure array.
+     * If fails, return FALSE
+     */
+    pRMT->pProcGroupTbl = (PPROC_GROUP_TBL)
+        NVMeAllocatePool(pAE, pRMT->NumGroup * sizeof(PROC_GROUP_TBL));
+
+    if (pRMT->pProcGroupTbl == NULL)
+        return (FALSE);
+
+    memset((PVOID)pRMT->pProcGroupTbl, 0, pRMT->NumGroup * sizeof(PROC_GROUP_TBL));
+    StorPortDebugPrint(INFO, "NVMeEnumNumaCores: Number of groups = %d.\n", pRMT->NumGroup);
+    for (Grp = 0; Grp < pRMT->NumGroup; Grp++) {
+        Status = StorPortGetGroupAffinity(pAE, Grp, &GrpAffinityMask);
+        if (Status != STOR_STATUS_SUCCESS) {
+            StorPortDebugPrint(INFO, "NVMeEnumNumaCores: Failed to retrieve group affinity(%d).\n", Grp);
+            return (FALSE);
+        }
+        StorPortDebugPrint(INFO, "NVMeEnumNumaCores: Group(%d) affinity mask(0x%Ix).\n", Grp, GrpAffinityMask);
+        pProcGrpTbl = pRMT->pProcGroupTbl + Grp;
+        pProcGrpTbl->GroupAffinity.Group = Grp;
+        pProcGrpTbl->GroupAffinity.Mask = GrpAffinityMask;
+
+        /* Mark down the associated first system-wise logical processor number*/
+        pProcGrpTbl->BaseProcessor = SysProcessorNumber;
+
+        /* Find out the number of logical processors of the group */
+        pProcGrpTbl->NumProcessor = NVMeActiveProcessorCount(GrpAffinityMask);
+        SysProcessorNumber += pProcGrpTbl->NumProcessor;
+    }
+    StorPortDebugPrint(INFO, "NVMeEnumNumaCores: Total %d logical processors\n", SysProcessorNumber);
+
+    /* Based on NUMA node number, retrieve their affinity masks and counts */
+    for (Node = 0; Node < pRMT->NumNumaNodes; Node++) {
+        pNNT = pRMT->pNumaNodeTbl + Node;
+
+        StorPortDebugPrint(INFO, "NVMeEnumNumaCores: NUMA Node#%d\n", Node);
+
+        /* Retrieve the processor affinity based on NUMA nodes */
+        memset((PVOID)&GroupAffinity, 0, sizeof(GROUP_AFFINITY));
+
+        Status = StorPortGetNodeAffinity(pAE, Node, &GroupAffinity);
+        if (Status != STOR_STATUS_SUCCESS) {
+            StorPortDebugPrint(ERROR,
+                "NVMeEnumNumaCores: <Error> GetNodeAffinity fails, sts=0x%x\n",
+                Status);
+            return (FALSE);
+        }
+
+        StorPortDebugPrint(INFO, "Core mask is 0x%Ix in Group(%d)\n", 
+            GroupAffinity.Mask, GroupAffinity.Group);
+
+        /* Find out the number of active cores of the NUMA node */
+        pNNT->NodeNum = Node;
+        pNNT->NumCores = NVMeActiveProcessorCount(GroupAffinity.Mask);
+        pRMT->NumActiveCores += pNNT->NumCores;
+        StorPortCopyMemory((PVOID)&pNNT->GroupAffinity,
+                           (PVOID)&GroupAffinity,
+                           sizeof(GROUP_AFFINITY));
+    }
+
+    /* Allocate buffer for CORE_TBL structure array. If fails, return FALSE */
+    pRMT->pCoreTbl = (PCORE_TBL)
+        NVMeAllocatePool(pAE, pRMT->NumActiveCores * sizeof(CORE_TBL));
+
+    if (pRMT->pCoreTbl == NULL)
+        return (FALSE);
+
+    /* Based on NUMA node number, populate the NUMA/Core tables */
+    for (Node = 0; Node < pRMT->NumNumaNodes; Node++) {
+        pNNT = pRMT->pNumaNodeTbl + Node;
+        if (pNNT->NumCores == 0)
+            continue;
+        /* figure out the system-wise starting logical processor number for the node */
+        pProcGrpTbl = pRMT->pProcGroupTbl + pNNT->GroupAffinity.Group;
+        BaseCoreNum = pProcGrpTbl->BaseProcessor;
+
+        /*
+         * For each existing NUMA node, need to find out its first and last
+         * associated cores in terms of system-wise processor number for
+         * later reference in IO queue allocation. Initialize the as the first
+         * core number of the associated group.
+         */
+        pNNT->FirstCoreNum = BaseCoreNum;
+        pNNT->LastCoreNum = BaseCoreNum;
+        FirstCoreFound = FALSE;
+
+        /* For each core, populate CORE_TBL structure */
+        for (Bit = 0; Bit < MaxNumCoresInGroup; Bit++) {
+            /* Save previsou bit check result first */
+            if (((pNNT->GroupAffinity.Mask >> Bit) & 1) == 1) {
+                /* Mark the first core if haven't found yet, reset the counter */
+                if (FirstCoreFound == FALSE) {
+                    CoreCounter = 0;
+                    FirstCoreFound = TRUE;
+                }
+                Core = BaseCoreNum + CoreCounter;
+                pCoreTblTemp = pRMT->pCoreTbl + Core;
+                pCoreTblTemp->NumaNode = (USHORT) Node;
+                pCoreTblTemp->Group = pNNT->GroupAffinity.Group;
+                
+                /* Always mark the last core */
+                pNNT->LastCoreNum = Core;
+                CoreCounter++;
+                TotalCores++;
+            }
+        }
+
+        StorPortDebugPrint(INFO,
+                           "There are %d cores in Node#%d.\n",
+                           pNNT->NumCores, Node);
+    }
+
+    /* Double check the total core number */
+    if (TotalCores > pRMT->NumActiveCores) {
+        StorPortDebugPrint(ERROR,
+            "NVMeEnumNumaCores: <Error> Cores number mismatch, %d, %d\n",
+            TotalCores, pRMT->NumActiveCores);
+
+        return (FALSE);
+    }
+
+    StorPortDebugPrint(INFO,
+                       "The total number of CPU cores %d.\n",
+                       pRMT->NumActiveCores);
+
+    /* Tag cores with their last level cache, not fatal if unavailable */
+    NVMeEnumCacheTopology(pAE);
+
+    return(TRUE);
+} /* NVMeEnumNumaCores */
+
+/*******************************************************************************
+ * NVMeEnumCacheTopology
+ *
+ * @brief NVMeEnumCacheTopology tags each CORE_TBL entry with the last level
+ *        cache it shares with other cores, so queue pairs can be shared by
+ *        cache-local cores when there are more cores than queues.  It has to
+ *        be called at PASSIVE_LEVEL after NVMeEnumNumaCores.  Failing to get
+ *        the topology is not fatal, all cores of a NUMA node are then treated
+ *        as one cache domain.
+ *
+ * @param pAE - Pointer to hardware device extension
+ *
+ * @return BOOLEAN
+ *     TRUE - If the cache domains were retrieved
+ *     FALSE - If the NUMA node is used as the cache domain
+ ******************************************************************************/
+BOOLEAN NVMeEnumCacheTopology(
+    PNVME_DEVICE_EXTENSION pAE
+)
+{
+    PRES_MAPPING_TBL pRMT = &pAE->ResMapTbl;
+    PSYSTEM_LOGICAL_PROCESSOR_INFORMATION_EX pInfoBuf = NULL;
+    PSYSTEM_LOGICAL_PROCESSOR_INFORMATION_EX pInfo = NULL;
+    PPROC_GROUP_TBL pPGT = NULL;
+    PCORE_TBL pCT = NULL;
+    ULONG InfoLength = 0;
+    ULONG Offset;
+    ULONG Core;
+    ULONG Bit;
+    UCHAR LlcLevel = 0;
+    USHORT CacheGroup = 0;
+    NTSTATUS NtStatus;
+
+    /* Default, one cache domain per NUMA node */
+    for (Core = 0; Core < pRMT->NumActiveCores; Core++) {
+        pCT = pRMT->pCoreTbl + Core;
+        pCT->CacheGroup = 0;
+    }
+
+    NtStatus = KeQueryLogicalProcessorRelationship(NULL,
+                                                   RelationCache,
+                                                   NULL,
+                                                   &InfoLength);
+    if ((NtStatus != STATUS_INFO_LENGTH_MISMATCH) || (InfoLength == 0))
+        return (FALSE);
+
+    pInfoBuf = (PSYSTEM_LOGICAL_PROCESSOR_INFORMATION_EX)
+        NVMeAllocatePool(pAE, InfoLength);
+    if (pInfoBuf == NULL)
+        return (FALSE);
+
+    NtStatus = KeQueryLogicalProcessorRelationship(NULL,
+                                                   RelationCache,
+                                                   pInfoBuf,
+                                                   &InfoLength);
+    if (!NT_SUCCESS(NtStatus)) {
+        StorPortFreePool((PVOID)pAE, pInfoBuf);
+        return (FALSE);
+    }
+
+    /* Find out which level is the last level cache */
+    for (Offset = 0; Offset < InfoLength; Offset += pInfo->Size) {
+        pInfo = (PSYSTEM_LOGICAL_PROCESSOR_INFORMATION_EX)
+            ((PUCHAR)pInfoBuf + Offset);
+        if ((pInfo->Cache.Type != CacheInstruction) &&
+            (pInfo->Cache.Level > LlcLevel))
+            LlcLevel = pInfo->Cache.Level;
+    }
+
+    /* Number the LLC instances and tag their cores */
+    for (Offset = 0; Offset < InfoLength; Offset += pInfo->Size) {
+        pInfo = (PSYSTEM_LOGICAL_PROCESSOR_INFORMATION_EX)
+            ((PUCHAR)pInfoBuf + Offset);
+        if ((pInfo->Cache.Type == CacheInstruction) ||
+            (pInfo->Cache.Level != LlcLevel) ||
+            (pInfo->Cache.GroupMask.Group >= pRMT->NumGroup))
+            continue;
+
+        pPGT = pRMT->pProcGroupTbl + pInfo->Cache.GroupMask.Group;
+        for (Bit = 0; Bit < pPGT->NumProcessor; Bit++) {
+            if (((pInfo->Cache.GroupMask.Mask >> Bit) & 1) == 0)
+                continue;
+            Core = pPGT->BaseProcessor + Bit;
+            if (Core < pRMT->NumActiveCores) {
+                pCT = pRMT->pCoreTbl + Core;
+                pCT->CacheGroup = CacheGroup;
+            }
+        }
+
+        StorPortDebugPrint(INFO,
+                           "NVMeEnumCacheTopology: L%d#%d grp(%d) mask(0x%Ix)\n",
+                           LlcLevel, CacheGroup,
+                           pInfo->Cache.GroupMask.Group,
+                           pInfo->Cache.GroupMask.Mask);
+        CacheGroup++;
+    }
+
+    StorPortFreePool((PVOID)pAE, pInfoBuf);
+
+    return (TRUE);
+} /* NVMeEnumCacheTopology */
+
+/*******************************************************************************
+ * NVMeLocalityMapCores
+ *
+ * @brief NVMeLocalityMapCores assigns every active core a queue pair so that
+ *        cores sharing a cache domain (same NUMA node and CacheGroup) use the
+ *        same queue pair whenever there are fewer queue pairs than cores.
+ *        Domains are ordered by NUMA node and then by their first core.
+ *        - QueuePairs >= domains: each domain gets one queue pair plus a share
+ *          of the rest in proportion to its core count, never more than its
+ *          cores, and its cores are split into contiguous runs across those
+ *          queue pairs.
+ *        - QueuePairs < domains: consecutive domains, so domains of the same
+ *          NUMA node first, are packed onto each queue pair.
+ *        Only the core table is used, so it can be driven with any topology.
+ *
+ * @param pRMT - Pointer to the resource mapping table, core table filled in
+ * @param QueuePairs - Number of IO queue pairs available, at least 1
+ *
+ * @return VOID
+ ******************************************************************************/
+VOID NVMeLocalityMapCores(
+    PRES_MAPPING_TBL pRMT,
+    USHORT QueuePairs
+)
+{
+    PCORE_TBL pCT = NULL;
+    PCORE_TBL pFirstCT = NULL;
+    ULONG Node;
+    ULONG Core;
+    ULONG Peer;
+    ULONG NumDomains = 0;
+    ULONG Domain;
+    ULONG DomainCores;
+    ULONG CoresBefore = 0;
+    ULONG Rank;
+    ULONG Extra;
+    ULONG QueueBase;
+    ULONG DomainQueues;
+    USHORT QueueID;
+
+    if ((QueuePairs == 0) || (pRMT->NumActiveCores == 0))
+        return;
+
+    /* Count domains, a core starts one when no earlier core shares it */
+    for (Core = 0; Core < pRMT->NumActiveCores; Core++) {
+        pCT = pRMT->pCoreTbl + Core;
+        for (Peer = 0; Peer < Core; Peer++) {
+            pFirstCT = pRMT->pCoreTbl + Peer;
+            if ((pFirstCT->NumaNode == pCT->NumaNode) &&
+                (pFirstCT->CacheGroup == pCT->CacheGroup))
+                break;
+        }
+        if (Peer == Core)
+            NumDomains++;
+    }
+
+    Extra = (QueuePairs > NumDomains) ? (QueuePairs - NumDomains) : 0;
+    Domain = 0;
+
+    for (Node = 0; Node < pRMT->NumNumaNodes; Node++) {
+        for (Core = 0; Core < pRMT->NumActiveCores; Core++) {
+            pFirstCT = pRMT->pCoreTbl + Core;
+            if (pFirstCT->NumaNode != Node)
+                continue;
+
+            /* Only handle a domain at its first core */
+            for (Peer = 0; Peer < Core; Peer++) {
+                pCT = pRMT->pCoreTbl + Peer;
+                if ((pCT->NumaNode == Node) &&
+                    (pCT->CacheGroup == pFirstCT->CacheGroup))
+                    break;
+            }
+            if (Peer != Core)
+                continue;
+
+            DomainCores = 0;
+            for (Peer = Core; Peer < pRMT->NumActiveCores; Peer++) {
+                pCT = pRMT->pCoreTbl + Peer;
+                if ((pCT->NumaNode == Node) &&
+                    (pCT->CacheGroup == pFirstCT->CacheGroup))
+                    DomainCores++;
+            }
+
+            if (QueuePairs >= NumDomains) {
+                /* One queue pair per domain plus its share of the extra ones */
+                QueueBase = Domain +
+                    (Extra * CoresBefore) / pRMT->NumActiveCores;
+                DomainQueues = Domain + 1 +
+                    (Extra * (CoresBefore + DomainCores)) / pRMT->NumActiveCores -
+                    QueueBase;
+
+                /* Rounding can give a domain more queue pairs than cores */
+                if (DomainQueues > DomainCores)
+                    DomainQueues = DomainCores;
+            } else {
+                /* Several domains per queue pair */
+                QueueBase = (Domain * QueuePairs) / NumDomains;
+                DomainQueues = 1;
+            }
+
+            Rank = 0;
+            for (Peer = Core; Peer < pRMT->NumActiveCores; Peer++) {
+                pCT = pRMT->pCoreTbl + Peer;
+                if ((pCT->NumaNode != Node) ||
+                    (pCT->CacheGroup != pFirstCT->CacheGroup))
+                    continue;
+
+                QueueID = (USHORT)(QueueBase + 1 +
+                                   (Rank * DomainQueues) / DomainCores);
+                pCT->SubQueue = pCT->CplQueue = QueueID;
+                Rank++;
+
+                StorPortDebugPrint(INFO,
+                    "NVMeLocalityMapCores: Core 0x%x (Node %d LLC %d) ---> QueueID 0x%x\n",
+                    Peer, Node, pCT->CacheGroup, QueueID);
+            }
+
+            CoresBefore += DomainCores;
+            Domain++;
+        }
+    }
+} /* NVMeLocalityMapCores */
+
+/*******************************************************************************
+ * NVMeStrCompare
+ *
+ * @brief Helper routoine for deciding which driver is being loaded
+ *
+ * @param pTargetString - Pointer to the target string to compare with.
+ * @param pArgumentString - Pointer to the string from the system.
+ *
+ * @return BOOLEAN
+ *     TRUE - If it's a normal driver being loaded
+ *     FALSE - If it's a crashdump or hibernation driver being loaded
+ ******************************************************************************/
+BOOLEAN NVMeStrCompare(
+    PCSTR pTargetString,
+    PCSTR pArgumentString
+)
+{
+    PCHAR pTargetIndex = (PCHAR) pTargetString;
+    PCHAR pArgumentIndex = (PCHAR) pArgumentString;
+    CHAR Target;
+    CHAR Argument;
+
+    if (pArgumentIndex == NULL) {
+        return (FALSE);
+    }
+
+    while (*pTargetIndex) {
+        Target = *pTargetIndex;
+        Argument = *pArgumentIndex;
+
+        /* Lower case the char. */
+        if ((Target >= 'A') && (Target <= 'Z')) {
+            Target = Target + ('a' - 'A');
+        }
+
+        if ((Argument >= 'A') && (Argument <= 'Z')) {
+            Argument = Argument + ('a' - 'A');
+        }
+
+        /* Return FALSE if not matched */
+        if (Target != Argument) {
+            return FALSE;
+        }
+
+        pTargetIndex++;
+        pArgumentIndex++;
+    }
+
+    return (TRUE);
+} /* NVMeStrCompare */
+
+/*******************************************************************************
+ * NVMeEnumMsiMessages
+ *
+ * @brief NVMeEnumMsiMessages retrieves the related information of granted MSI
+ *        vectors, such as, address, data, and the number of granted vectors,
+ *        etc...
+ *
+ * @param pAE - Pointer to hardware device extension.
+ *
+ * @return BOOLEAN
+ *     TRUE - If all resources are allocated and initialized properly
+ *     FALSE - If anything goes wrong
+ ******************************************************************************/
+BOOLEAN NVMeEnumMsiMessages (
+    PNVME_DEVICE_EXTENSION pAE
+)
+{
+    ULONG32 MsgID;
+    ULONG32 Status = STOR_STATUS_SUCCESS;
+    MESSAGE_INTERRUPT_INFORMATION MII;
+    PRES_MAPPING_TBL pRMT = &pAE->ResMapTbl;
+    PMSI_MESSAGE_TBL pMMT = NULL;
+
+    /* Assuming it's MSI-X by defult and find it out later */
+    pRMT->InterruptType = INT_TYPE_MSIX;
+
+    /*
+     * Loop thru each MessageID by calling StorPortMSIInfo
+     * to see if it is granted by OS and figure out how many
+     * messages are actually granted
+     */
+    for (MsgID = 0; MsgID < pRMT->NumActiveCores; MsgID++) {
+        pMMT = pRMT->pMsiMsgTbl + MsgID;
+
+        memset(&MII, 0, sizeof(MESSAGE_INTERRUPT_INFORMATION));
+
+        Status = StorPortGetMSIInfo ( pAE, MsgID, &MII );
+        if (Status == STOR_STATUS_SUCCESS) {
+            /* It's granted only when the IDs matched */
+            if (MsgID == MII.MessageId) {
+                pMMT->MsgID = MII.MessageId;
+                pMMT->Addr = MII.MessageAddress;
+                pMMT->Data = MII.MessageData;
+            } else {
+                ASSERT(FALSE);
+            }
+        } else {
+			/* Use INTx when failing to retrieve any message information */
+			if (MsgID == 0)
+				pRMT->InterruptType = INT_TYPE_INTX;
+			/* Number of MSI Granted will No of IO Queue + 1 Admin Queue 
+			Incase of Active Core more than Queues supported
+			Admin Queue MSGID should not be considered*/
+			else
+				MsgID--;
+
+            break;
+        }
+    }
+
+    pRMT->NumMsiMsgGranted = MsgID;
+
+    StorPortDebugPrint(INFO,
+                       "NVMeEnumMsiMessages: Msg granted=%d\n",
+                       pRMT->NumMsiMsgGranted);
+
+    /* Is the request message number satisfied? */
+    if (pRMT->NumMsiMsgGranted > 1) {
+        /* If the addresses for the first 2 messages are == then its MSI */
+        pMMT = pRMT->pMsiMsgTbl + 1;
+        if (pMMT->Addr.QuadPart == pRMT->pMsiMsgTbl->Addr.QuadPart) {
+            pRMT->InterruptType = INT_TYPE_MSI;
+        }
+    } else if (pRMT->NumMsiMsgGranted == 1) {
+        /* Only one message granted and it is shared */
+        pRMT->InterruptType = INT_TYPE_MSI;
+        pRMT->pMsiMsgTbl->Shared = TRUE;
+    } else {
+        /* Using INTx and the interrupt is shared anyway */
+        pRMT->pMsiMsgTbl->Shared = TRUE;
+    }
+
+    return (TRUE);
+} /* NVMeEnumMsiMessages */
+
+/*******************************************************************************
+ * NVMeMsiMapCoresFromAffinity
+ *
+ * @brief NVMeMsiMapCoresFromAffinity builds the core/vector/queue mapping from
+ *        the message target affinities reported by StorPort (pArrGrpAff), so
+ *        no learning IO is needed.  Every message is validated before any of
+ *        the tables are touched.  With fewer messages than cores, cores are
+ *        first grouped by cache locality.  Cores whose queue pair ends up with
+ *        no vector share a bound queue pair, preferably a cache-local one.
+ *
+ * @param pAE - Pointer to hardware device extension.
+ *
+ * @return BOOLEAN
+ *     TRUE - If the mapping was built from the reported affinities
+ *     FALSE - If any affinity is unusable, tables are left untouched
+ ******************************************************************************/
+BOOLEAN NVMeMsiMapCoresFromAffinity(
+    PNVME_DEVICE_EXTENSION pAE
+)
+{
+    PRES_MAPPING_TBL pRMT = &pAE->ResMapTbl;
+    PQUEUE_INFO pQI = &pAE->QueueInfo;
+    PMSI_MESSAGE_TBL pMMT = NULL;
+    PCORE_TBL pCT = NULL;
+    PCORE_TBL pPeerCT = NULL;
+    PCPL_QUEUE_INFO pCQI = NULL;
+    PGROUP_AFFINITY pGrpAff = NULL;
+    ULONG MsgID;
+    ULONG Core;
+    ULONG Peer;
+    ULONG Score;
+    USHORT Queue;
+    USHORT QueuePairs;
+
+    QueuePairs = (USHORT)min(pQI->NumSubIoQAllocated, pQI->NumCplIoQAllocated);
+    if ((pAE->pArrGrpAff == NULL) || (QueuePairs == 0) ||
+        (pRMT->NumMsiMsgGranted == 0)) {
+        return (FALSE);
+    }
+
+    /* First pass, make sure each message targets a known active core */
+    for (MsgID = 0; MsgID < pRMT->NumMsiMsgGranted; MsgID++) {
+        if (NVMeGetAffinityCore(pAE, pAE->pArrGrpAff + MsgID, &Core) == FALSE) {
+            StorPortDebugPrint(WARNING,
+                "NVMeMsiMapCoresFromAffinity: <Warning> Msg#%d grp(%d) mask(0x%Ix) unusable\n",
+                MsgID,
+                (pAE->pArrGrpAff + MsgID)->Group,
+                (pAE->pArrGrpAff + MsgID)->Mask);
+            return (FALSE);
+        }
+    }
+
+    /*
+     * Start from a clean slate, nothing is mapped yet.  A CQ whose MsiMsgID
+     * is past the granted messages has no vector bound yet.
+     */
+    for (Core = 0; Core < pRMT->NumActiveCores; Core++) {
+        pCT = pRMT->pCoreTbl + Core;
+        pCT->Learned = FALSE;
+    }
+    for (MsgID = 0; MsgID < pRMT->NumMsiMsgGranted; MsgID++) {
+        pMMT = pRMT->pMsiMsgTbl + MsgID;
+        pMMT->Learned = FALSE;
+    }
+    for (Queue = 1; Queue <= QueuePairs; Queue++) {
+        pCQI = pQI->pCplQueueInfo + Queue;
+        pCQI->MsiMsgID = (USHORT)pRMT->NumMsiMsgGranted;
+    }
+    pQI->NumIoQMapped = 1;
+
+    /*
+     * With fewer messages than cores, regroup the cores by cache locality
+     * onto no more queue pairs than there are messages.  Otherwise the core
+     * keeps the queue pair it got at allocation time.
+     */
+    if (pRMT->NumMsiMsgGranted < pRMT->NumActiveCores) {
+        NVMeLocalityMapCores(pRMT,
+            (USHORT)min(QueuePairs, pRMT->NumMsiMsgGranted));
+    }
+
+    /*
+     * Second pass, bind each message to its target core's queue pair.  The
+     * first message landing on a queue pair becomes the vector of its CQ.
+     */
+    for (MsgID = 0; MsgID < pRMT->NumMsiMsgGranted; MsgID++) {
+        pGrpAff = pAE->pArrGrpAff + MsgID;
+        NVMeGetAffinityCore(pAE, pGrpAff, &Core);
+        pCT = pRMT->pCoreTbl + Core;
+        pCT->Group = pGrpAff->Group;
+        pCT->Learned = TRUE;
+
+        pCQI = pQI->pCplQueueInfo + pCT->CplQueue;
+        if (pCQI->MsiMsgID >= pRMT->NumMsiMsgGranted) {
+            pCQI->MsiMsgID = (USHORT)MsgID;
+            pQI->NumIoQMapped++;
+        }
+        pCT->MsiMsgID = pCQI->MsiMsgID;
+
+        pMMT = pRMT->pMsiMsgTbl + MsgID;
+        pMMT->CplQueueNum = pCT->CplQueue;
+        pMMT->Learned = TRUE;
+    }
+
+    /*
+     * Third pass, cores whose queue pair got no vector ride along with a
+     * bound queue pair, first choice in the same cache domain, then on the
+     * same NUMA node, else the first one found.
+     */
+    for (Core = 0; Core < pRMT->NumActiveCores; Core++) {
+        pCT = pRMT->pCoreTbl + Core;
+        pCQI = pQI->pCplQueueInfo + pCT->CplQueue;
+        if (pCQI->MsiMsgID < pRMT->NumMsiMsgGranted) {
+            pCT->MsiMsgID = pCQI->MsiMsgID;
+            continue;
+        }
+
+        pPeerCT = NULL;
+        Score = 0;
+        for (Peer = 0; Peer < pRMT->NumActiveCores; Peer++) {
+            PCORE_TBL pCandCT = pRMT->pCoreTbl + Peer;
+
+            pCQI = pQI->pCplQueueInfo + pCandCT->CplQueue;
+            if (pCQI->MsiMsgID >= pRMT->NumMsiMsgGranted)
+                continue;
+            if (pPeerCT == NULL) {
+                pPeerCT = pCandCT;
+                Score = 1;
+            }
+            if ((pCandCT->NumaNode == pCT->NumaNode) && (Score < 2)) {
+                pPeerCT = pCandCT;
+                Score = 2;
+            }
+            if ((pCandCT->NumaNode == pCT->NumaNode) &&
+                (pCandCT->CacheGroup == pCT->CacheGroup)) {
+                pPeerCT = pCandCT;
+                break;
+            }
+        }
+
+        /* Validated above, at least one message targets a core */
+        ASSERT(pPeerCT != NULL);
+        pCT->SubQueue = pPeerCT->SubQueue;
+        pCT->CplQueue = pPeerCT->CplQueue;
+        pCQI = pQI->pCplQueueInfo + pCT->CplQueue;
+        pCT->MsiMsgID = pCQI->MsiMsgID;
+    }
+
+    /* Queue pairs no core uses still need a valid vector to be created */
+    for (Queue = 1; Queue <= QueuePairs; Queue++) {
+        pCQI = pQI->pCplQueueInfo + Queue;
+        if (pCQI->MsiMsgID >= pRMT->NumMsiMsgGranted)
+            pCQI->MsiMsgID = 0;
+    }
+
+    return (TRUE);
+} /* NVMeMsiMapCoresFromAffinity */
+
+/*******************************************************************************
+ * NVMeGetAffinityCore
+ *
+ * @brief NVMeGetAffinityCore converts a message target group affinity into the
+ *        system-wise core number used to index the core table, using the
+ *        lowest processor set in the mask.
+ *
+ * @param pAE - Pointer to hardware device extension.
+ * @param pGrpAff - Pointer to the group affinity of the message.
+ * @param pCore - Pointer to buffer to save the core number.
+ *
+ * @return BOOLEAN
+ *     TRUE - If the affinity names a valid active core
+ *     FALSE - If the group is unknown, the mask is empty or out of range
+ ******************************************************************************/
+BOOLEAN NVMeGetAffinityCore(
+    PNVME_DEVICE_EXTENSION pAE,
+    PGROUP_AFFINITY pGrpAff,
+    PULONG pCore
+)
+{
+    PRES_MAPPING_TBL pRMT = &pAE->ResMapTbl;
+    PPROC_GROUP_TBL pPGT = NULL;
+    ULONG Bit;
+
+    if ((pGrpAff->Group >= pRMT->NumGroup) || (pGrpAff->Mask == 0))
+        return (FALSE);
+
+    pPGT = pRMT->pProcGroupTbl + pGrpAff->Group;
+    for (Bit = 0; Bit < pPGT->NumProcessor; Bit++) {
+        if (((pGrpAff->Mask >> Bit) & 1) == 1)
+            break;
+    }
+
+    if (Bit >= pPGT->NumProcessor)
+        return (FALSE);
+
+    /* Same numbering NVMeMapCore2Queue uses for the submitting processor */
+    *pCore = pPGT->BaseProcessor + Bit;
+
+    return (*pCore < pRMT->NumActiveCores) ? TRUE : FALSE;
+} /* NVMeGetAffinityCore */
+
+/*******************************************************************************
+ * NVMeMsiMapVerify
+ *
+ * @brief NVMeMsiMapVerify checks the core/vector/queue tables are consistent:
+ *        every active core must point at an allocated queue pair whose
+ *        completion queue interrupts on a granted message, and that message
+ *        must route back to the same completion queue.  Otherwise completions
+ *        on that queue would never be reaped.
+ *
+ * @param pAE - Pointer to hardware device extension.
+ *
+ * @return BOOLEAN
+ *     TRUE - If the mapping is consistent
+ *     FALSE - If any core would lose its completions
+ ******************************************************************************/
+BOOLEAN NVMeMsiMapVerify(
+    PNVME_DEVICE_EXTENSION pAE
+)
+{
+    PRES_MAPPING_TBL pRMT = &pAE->ResMapTbl;
+    PQUEUE_INFO pQI = &pAE->QueueInfo;
+    PCORE_TBL pCT = NULL;
+    PCPL_QUEUE_INFO pCQI = NULL;
+    PMSI_MESSAGE_TBL pMMT = NULL;
+    ULONG Core;
+
+    for (Core = 0; Core < pRMT->NumActiveCores; Core++) {
+        pCT = pRMT->pCoreTbl + Core;
+
+        if ((pCT->CplQueue == 0) ||
+            (pCT->CplQueue > pQI->NumCplIoQAllocated) ||
+            (pCT->SubQueue != pCT->CplQueue)) {
+            StorPortDebugPrint(ERROR,
+                "NVMeMsiMapVerify: <Error> Core(%d) bad QueuePair sub(%d) cpl(%d)\n",
+                Core, pCT->SubQueue, pCT->CplQueue);
+            return (FALSE);
+        }
+
+        pCQI = pQI->pCplQueueInfo + pCT->CplQueue;
+        if (pCQI->MsiMsgID >= pRMT->NumMsiMsgGranted) {
+            StorPortDebugPrint(ERROR,
+                "NVMeMsiMapVerify: <Error> Core(%d) CQ(%d) bad MSID(%d)\n",
+                Core, pCT->CplQueue, pCQI->MsiMsgID);
+            return (FALSE);
+        }
+
+        pMMT = pRMT->pMsiMsgTbl + pCQI->MsiMsgID;
+        if (pMMT->CplQueueNum != pCT->CplQueue) {
+            StorPortDebugPrint(ERROR,
+                "NVMeMsiMapVerify: <Error> Core(%d) CQ(%d) MSID(%d) routes to CQ(%d)\n",
+                Core, pCT->CplQueue, pCQI->MsiMsgID, pMMT->CplQueueNum);
+            return (FALSE);
+        }
+    }
+
+    return (TRUE);
+} /* NVMeMsiMapVerify */
+
+/*******************************************************************************
+ * NVMeMsiMapCores
+ *
+ * @brief NVMeMsiMapCores is called to setup the initial mapping for MSI or MSIX
+ *        modes.  When StorPort reported the message target affinities the final
+ *        mapping is derived from them directly and verified, no learning is
+ *        needed.  Otherwise the initial mapping is just 1:1, learning will
+ *        happen as each core processes an IO and new mappings will be created
+ *        for optimal use.
+ *
+ * @param pAE - Pointer to hardware device extension.
+ *
+ * @return VOID
+ ******************************************************************************/
+VOID NVMeMsiMapCores(
+	PNVME_DEVICE_EXTENSION pAE
+	)
+{
+	ULONG Core;
+	UCHAR MaxCore;
+	PRES_MAPPING_TBL pRMT = &pAE->ResMapTbl;
+	PMSI_MESSAGE_TBL pMMT = NULL;
+	PCORE_TBL pCT = NULL;
+	PQUEUE_INFO pQI = &pAE->QueueInfo;
+	USHORT MsgID;
+	USHORT QueuePairs;
+
+	MaxCore = (UCHAR)min(pAE->QueueInfo.NumSubIoQAllocFromAdapter,
+		pAE->QueueInfo.NumCplIoQAllocFromAdapter);
+	
+
+	/* if API is executed succesfully use the data obtained from API else fallback to learning cores */
+	if (pAE->IsMsiMappingComplete == TRUE)
+	{
+		if ((NVMeMsiMapCoresFromAffinity(pAE) == TRUE) &&
+			(NVMeMsiMapVerify(pAE) == TRUE)) {
+#if DBG
+			StorPortDebugPrint(INFO, "NVMeMsimapcores: <Info> Affinity mapping complete.  Core Table:\n");
+			for (Core = 0; Core < pRMT->NumActiveCores; Core++) {
+				pCT = pRMT->pCoreTbl + Core;
+				StorPortDebugPrint(INFO, "NVMeMsimapcores: <Info> \tCore(%d) MSID(%d) QueuePair(%d)\n",
+					Core,
+					pCT->MsiMsgID,
+					pCT->SubQueue);
+			}
+			pAE->LearningComplete = TRUE;
+#endif
+			pAE->LearningCores = pRMT->NumActiveCores;
+			return;
+		}
+
+		/*
+		 * The reported affinities can't be trusted, put the core table back
+		 * the way NVMeAllocIoQueues left it and learn the mapping instead.
+		 */
+		StorPortDebugPrint(WARNING,
+			"NVMeMsiMapCores: <Warning> Affinity mapping unusable, learning instead\n");
+		pAE->IsMsiMappingComplete = FALSE;
+		pQI->NumIoQMapped = 1;
+		QueuePairs = (USHORT)max(1, min(pQI->NumSubIoQAllocated, pQI->NumCplIoQAllocated));
+		NVMeLocalityMapCores(pRMT, QueuePairs);
+		for (Core = 0; Core < pRMT->NumActiveCores; Core++) {
+			pCT = pRMT->pCoreTbl + Core;
+			pCT->MsiMsgID = 0;
+			pCT->Learned = FALSE;
+		}
+		for (MsgID = 0; MsgID < pRMT->NumMsiMsgGranted; MsgID++) {
+			pMMT = pRMT->pMsiMsgTbl + MsgID;
+			pMMT->CplQueueNum = 0;
+			pMMT->Learned = FALSE;
+		}
+	}
+
+	/*
+	 * Loop thru the cores and assign granted messages in sequential manner,
+	 * queue pair n+1 uses message n. When requests completed, based on the
+	 * messagID and look up the associated completion queue for just-completed
+	 * entries
+	 */
+	for (Core = 0; Core < pRMT->NumActiveCores; Core++) {
+		/* Handle one Core Table at a time */
+		pCT = pRMT->pCoreTbl + Core;
+		if (pCT->CplQueue > MaxCore)
+			continue;
+
+		/* Mark down the initial associated message + SQ/CQ for this core */
+		pCT->MsiMsgID = pCT->CplQueue - 1;
+
+		/*
+		 * On the other side, mark down the associated core number
+		 * for the message as well
+		 */
+		pMMT = pRMT->pMsiMsgTbl + pCT->MsiMsgID;
+		pMMT->CplQueueNum = pCT->CplQueue;
+
+		StorPortDebugPrint(INFO,
+			"NVMeMsiMapCores: Core(0x%x)Msg#(0x%x)\n",
+			Core, pCT->MsiMsgID);
+	}
+} /* NVMeMsiMapCores */
+
+/*******************************************************************************
+ * NVMeCompleteResMapTbl
+ *
+ * @brief NVMeCompleteResMapTbl completes the resource mapping table among
+ *        active cores, the granted vectors and the allocated IO queues.
+ *
+ * @param pAE - Pointer to hardware device extension.
+ *
+ * @return VOID
+ ******************************************************************************/
+VOID NVMeCompleteResMapTbl(
+    PNVME_DEVICE_EXTENSION pAE
+)
+{
+    PRES_MAPPING_TBL pRMT = &pAE->ResMapTbl;
+
+    /* The last thing to do is completing Resource Mapping Table. */
+    if ( (pRMT->InterruptType == INT_TYPE_MSIX) ||
+         (pRMT->InterruptType == INT_TYPE_MSI) ) {
+        NVMeMsiMapCores(pAE);
+    }
+
+    /* No need to do anything more for INTx */
+
+} /* NVMeCompleteResMapTbl */
+
+/*******************************************************************************
+ * NVMeMapCore2Queue
+ *
+ * @brief NVMeMapCore2Queue is called to retrieve the associated queue ID of the
+ *        given core number
+ *
+ * @param pAE - Pointer to hardware device extension
+ * @param pPN - Pointer to PROCESSOR_NUMBER structure
+ * @param pSubQueue - Pointer to buffer to save retrieved submI[QueueID]ssion queue ID
+ * @param pCplQueue - Pointer to buffer to save retrieved Completion queue ID
+ *
+ * @return ULONG
+ *     STOR_STATUS_SUCCESS - If valid number is retrieved
+ *     STOR_STATUS_UNSUCCESSFUL - If anything goes wrong
+ ******************************************************************************/
+ULONG NVMeMapCore2Queue(
+    PNVME_DEVICE_EXTENSION pAE,
+    PPROCESSOR_NUMBER pPN,
+    USHORT* pSubQueue,
+    USHORT* pCplQueue
+)
+{
+    PRES_MAPPING_TBL pRMT = &pAE->ResMapTbl;
+    PCORE_TBL pCT = NULL;
+	PPROC_GROUP_TBL pPGT = NULL;
+    ULONG coreNum;
+
+    if (pAE->ntldrDump == TRUE) {
+        *pSubQueue = *pCplQueue = 1;
+        return (STOR_STATUS_SUCCESS);
+    }
+
+	pPGT = pRMT->pProcGroupTbl + pPN->Group;
+	coreNum = (ULONG)(pPN->Number + pPGT->BaseProcessor);
+    
+    /* Ensure the core number is valid first */
+    if (coreNum >= pRMT->NumActiveCores) {
+        StorPortDebugPrint(ERROR,
+            "NVMeMapCore2Queue: <Error> Invalid core number = %d.\n", coreNum);
+        return (STOR_STATUS_UNSUCCESSFUL);
+    }
+
+    /* Locate the target CORE_TBL entry for the specific core number
+     * indexed depending on whether we're still learning the table or not
+     */
+    if (pAE->LearningCores == pRMT->NumActiveCores) {
+        pCT = pRMT->pCoreTbl + coreNum;
+        /* Return the queue IDs */
+        *pSubQueue = pCT->SubQueue;
+        *pCplQueue = pCT->CplQueue;
+    } else {
+        *pSubQueue = (USHORT)pAE->LearningCores + 1;
+        *pCplQueue = (USHORT)pAE->LearningCores + 1;
+    }
+
+    return (STOR_STATUS_SUCCESS);
+} /* NVMeMapCore2Queue */
+
+/*******************************************************************************
+ * NVMeInitFreeQ
+ *
+ * @brief NVMeInitFreeQ gets called to initialize the free queue list of the
+ *        specific submission queue with its associated command entries and PRP
+ *        List buffers.
+ *
+ * @param pSQI - Pointer to the SUB_QUEUE_INFO structure.
+ *
+ * @return VOID
+ ******************************************************************************/
+VOID NVMeInitFreeQ(
+    PSUB_QUEUE_INFO pSQI,
+    PNVME_DEVICE_EXTENSION pAE
+)
+{
+    USHORT Entry;
+    PCMD_ENTRY pCmdEntry = NULL;
+    PCMD_INFO pCmdInfo = NULL;
+    ULONG_PTR CurPRPList = 0;
+    ULONG prpListSz = 0;
+#ifdef DUMB_DRIVER
+    ULONG_PTR PtrTemp;
+    ULONG dblBuffSz = 0;
+#endif
+
+    /* For each entry, initialize the CmdID and PRPList flields */
+    CurPRPList = (ULONG_PTR)((PUCHAR)pSQI->pPRPListStart);
+
+    for (Entry = 0; Entry < pSQI->SubQEntries; Entry++) {
+        pCmdEntry = (PCMD_ENTRY)pSQI->pCmdEntry;
+        pCmdEntry += Entry;
+        pCmdInfo = &pCmdEntry->CmdInfo;
+
+        /*
+         * Set up CmdID and dedicated PRP Lists before adding to FreeQ
+         * Use Entry to locate the starting point.
+         */
+        pCmdInfo->CmdID = Entry;
+        if (pSQI->NonContiguous == TRUE) {
+            /* The list pages are separate allocations, pick the page first */
+            pCmdInfo->pPRPList = (PVOID)
+                ((PUCHAR)pSQI->pPRPListPages[Entry / pSQI->NumPRPListOnePage] +
+                 ((Entry % pSQI->NumPRPListOnePage) * pAE->PRPListSize));
+        } else {
+            pCmdInfo->pPRPList = (PVOID)(CurPRPList + pAE->PRPListSize);
+
+            /*
+             * Because PRP List can't cross page boundary, if not enough room
+             * left for one list, need to move on to next page boundary.
+             * NumPRPListOnepage is calculated for this purpose.
+             */
+            if (Entry != 0 && ((Entry % pSQI->NumPRPListOnePage) == 0))
+                pCmdInfo->pPRPList = PAGE_ALIGN_BUF_PTR(pCmdInfo->pPRPList);
+        }
+
+        /* Save the address of current list for calculating next list */
+        CurPRPList = (ULONG_PTR)pCmdInfo->pPRPList;
+        pCmdInfo->prpListPhyAddr = NVMeGetPhysAddr(pAE, pCmdInfo->pPRPList);
+
+#ifdef DUMB_DRIVER
+        PtrTemp = (ULONG_PTR)((PUCHAR)pSQI->pDlbBuffStartVa);
+        pCmdInfo->pDblVir = (PVOID)(PtrTemp + (DUMB_DRIVER_SZ * Entry));
+        pCmdInfo->dblPhy = StorPortGetPhysicalAddress(pAE,
+                                                      NULL,
+                                                      pCmdInfo->pDblVir,
+                                                      &dblBuffSz);
+
+        PtrTemp = (ULONG_PTR)((PUCHAR)pSQI->pDlbBuffStartListVa);
+        pCmdInfo->pDblPrpListVir = (PVOID)(PtrTemp + (PAGE_SIZE * Entry));
+        pCmdInfo->dblPrpListPhy = StorPortGetPhysicalAddress(pAE,
+                                                      NULL,
+                                                      pCmdInfo->pDblPrpListVir,
+                                                      &dblBuffSz);
+#endif
+
+        InsertTailList(&pSQI->FreeQList, &pCmdEntry->ListEntry);
+    }
+} /* NVMeInitFreeQ */
+
+/*******************************************************************************
+ * NVMeAllocQueueMem
+ *
+ * @brief NVMeAllocQueueMem allocates one of the per queue buffers as
+ *        contiguous memory from the queue's NUMA node with the placement
+ *        recorded. A non-contiguous queue only gets its command entries here,
+ *        from pool, see NVMeAllocQueuePages for its rings and PRP lists.
+ *
+ * @param pAE - Pointer to hardware device extension.
+ * @param pSQI - Pointer to the submission queue info of the queue pair
+ * @param Size - In bytes
+ * @param AllocFlag - NUMA_ALLOC_XXX to note if the node wasn't honored
+ *
+ * @return PVOID
+ *     Buffer Addr - If the buffer is allocated
+ *     NULL - If anything goes wrong
+ ******************************************************************************/
+PVOID NVMeAllocQueueMem(
+    PNVME_DEVICE_EXTENSION pAE,
+    PSUB_QUEUE_INFO pSQI,
+    ULONG Size,
+    USHORT AllocFlag
+)
+{
+    PVOID pBuf = NULL;
+    BOOLEAN Remote = FALSE;
+
+    if (pSQI->NonContiguous == TRUE)
+        return NVMeAllocatePool(pAE, Size);
+
+    pBuf = NVMeAllocateMemNode(pAE, Size, pSQI->NumaNode, &Remote);
+    if ((pBuf != NULL) && (Remote == TRUE))
+        pSQI->RemoteAllocs |= AllocFlag;
+
+    return pBuf;
+} /* NVMeAllocQueueMem */
+
+/*******************************************************************************
+ * NVMeAllocQueuePages
+ *
+ * @brief NVMeAllocQueuePages allocates the pages of a non-contiguous ring or
+ *        PRP list buffer one at a time, each as contiguous memory from the
+ *        queue's NUMA node so StorPort can translate it, and returns the table
+ *        tracking them.
+ *
+ * @param pAE - Pointer to hardware device extension.
+ * @param pSQI - Pointer to the submission queue info of the queue pair
+ * @param NumPages - Number of pages to allocate
+ * @param AllocFlag - NUMA_ALLOC_XXX to note if the node wasn't honored
+ *
+ * @return PVOID *
+ *     Page table - If all pages are allocated
+ *     NULL - If anything goes wrong
+ ******************************************************************************/
+PVOID *NVMeAllocQueuePages(
+    PNVME_DEVICE_EXTENSION pAE,
+    PSUB_QUEUE_INFO pSQI,
+    ULONG NumPages,
+    USHORT AllocFlag
+)
+{
+    PVOID *pPages = NULL;
+    BOOLEAN Remote = FALSE;
+    ULONG Page;
+
+    pPages = (PVOID *)NVMeAllocatePool(pAE, NumPages * sizeof(PVOID));
+    if (pPages == NULL)
+        return NULL;
+
+    for (Page = 0; Page < NumPages; Page++) {
+        pPages[Page] = NVMeAllocateMemNode(pAE,
+                                           PAGE_SIZE,
+                                           pSQI->NumaNode,
+                                           &Remote);
+        if (pPages[Page] == NULL) {
+            NVMeFreeQueuePages(pAE, pPages, NumPages);
+            return NULL;
+        }
+
+        if (Remote == TRUE)
+            pSQI->RemoteAllocs |= AllocFlag;
+    }
+
+    return pPages;
+} /* NVMeAllocQueuePages */
+
+/*******************************************************************************
+ * NVMeFreeQueuePages
+ *
+ * @brief NVMeFreeQueuePages frees the pages NVMeAllocQueuePages allocated,
+ *        including a partially filled table, and the table itself.
+ *
+ * @param pAE - Pointer to hardware device extension.
+ * @param pPages - Page table, may be NULL
+ * @param NumPages - Number of entries in the table
+ *
+ * @return VOID
+ ******************************************************************************/
+VOID NVMeFreeQueuePages(
+    PNVME_DEVICE_EXTENSION pAE,
+    PVOID *pPages,
+    ULONG NumPages
+)
+{
+    ULONG Page;
+
+    if (pPages == NULL)
+        return;
+
+    for (Page = 0; Page < NumPages; Page++) {
+        if (pPages[Page] != NULL)
+            StorPortFreeContiguousMemorySpecifyCache((PVOID)pAE,
+                                                     pPages[Page],
+                                                     PAGE_SIZE,
+                                                     MmCached);
+    }
+
+    StorPortFreePool((PVOID)pAE, pPages);
+} /* NVMeFreeQueuePages */
+
+/*******************************************************************************
+ * NVMeClearRing
+ *
+ * @brief NVMeClearRing zeroes the entries of a ring, either linear from
+ *        pStart or spread over the pages of a non-contiguous ring.
+ *
+ * @param pStart - Starting virtual address of a linear ring
+ * @param pPages - Page table of a non-contiguous ring, NULL if linear
+ * @param Bytes - Size of the ring
+ *
+ * @return VOID
+ ******************************************************************************/
+VOID NVMeClearRing(
+    PVOID pStart,
+    PVOID *pPages,
+    ULONG Bytes
+)
+{
+    ULONG Page;
+
+    if (pPages == NULL) {
+        memset(pStart, 0, Bytes);
+        return;
+    }
+
+    for (Page = 0; Page < BYTES_TO_PAGES(Bytes); Page++)
+        memset(pPages[Page], 0, PAGE_SIZE);
+} /* NVMeClearRing */
+
+/*******************************************************************************
+ * NVMeBuildQueuePRPList
+ *
+ * @brief NVMeBuildQueuePRPList describes the pages of a non-contiguous ring
+ *        with a PRP list for the Create IO Sub/Cpl queue commands. When a list
+ *        page fills up and pages remain, its last entry points to the next
+ *        list page.
+ *
+ * @param pAE - Pointer to hardware device extension.
+ * @param pPages - Page table of the ring
+ * @param NumPages - Number of ring pages
+ * @param pList - Page aligned list pages, enough for NumPages entries
+ *
+ * @return STOR_PHYSICAL_ADDRESS
+ *     Physical address of the first list page, 0 if anything goes wrong
+ ******************************************************************************/
+STOR_PHYSICAL_ADDRESS NVMeBuildQueuePRPList(
+    PNVME_DEVICE_EXTENSION pAE,
+    PVOID *pPages,
+    ULONG NumPages,
+    PVOID pList
+)
+{
+    PUINT64 pEntry = (PUINT64)pList;
+    STOR_PHYSICAL_ADDRESS ListStart;
+    STOR_PHYSICAL_ADDRESS PhysAddr;
+    ULONG Page;
+    ULONG Slot = 0;
+
+    ListStart = NVMeGetPhysAddr(pAE, pList);
+    if (ListStart.QuadPart == 0)
+        return ListStart;
+
+    memset(pList, 0, QUEUE_PRP_LIST_PAGES(NumPages * PAGE_SIZE) * PAGE_SIZE);
+
+    for (Page = 0; Page < NumPages; Page++) {
+        /* Chain to the next list page, which directly follows this one */
+        if ((Slot == PRP_ENTRIES_PER_LIST_PAGE - 1) && (Page + 1 < NumPages)) {
+            PhysAddr = NVMeGetPhysAddr(pAE, pEntry + 1);
+            if (PhysAddr.QuadPart == 0)
+                return PhysAddr;
+
+            *pEntry++ = PhysAddr.QuadPart;
+            Slot = 0;
+        }
+
+        PhysAddr = NVMeGetPhysAddr(pAE, pPages[Page]);
+        if (PhysAddr.QuadPart == 0)
+            return PhysAddr;
+
+        *pEntry++ = PhysAddr.QuadPart;
+        Slot++;
+    }
+
+    return ListStart;
+} /* NVMeBuildQueuePRPList */
+
+/*******************************************************************************
+ * NVMeAllocQueues
+ *
+ * @brief NVMeAllocQueues gets called to allocate buffers in
+ *        non-paged, contiguous memory space for Submission/Completion queues.
+ *
+ * @param pAE - Pointer to hardware device extension.
+ * @param QueueID - Which queue to allocate memory for
+ * @param QEntries - the number of entries to allocate for this queue
+ * @param NumaNode - Which NUMA node associated memory to allocate from
+ *
+ * @return ULONG
+ *     STOR_STATUS_SUCCESS - If all resources are allocated properly
+ *     Otherwise - If anything goes wrong
+ ******************************************************************************/
+ULONG NVMeAllocQueues (
+    PNVME_DEVICE_EXTENSION pAE,
+    USHORT QueueID,
+    ULONG QEntries,
+    USHORT NumaNode
+)
+{
+
+    /* The number of Submission entries makes up exact one system page size */
+    ULONG SysPageSizeInSubEntries;
+    PQUEUE_INFO pQI = &pAE->QueueInfo;
+    PSUB_QUEUE_INFO pSQI = NULL;
+    PRES_MAPPING_TBL pRMT = &pAE->ResMapTbl;
+    ULONG SizeQueueEntry = 0;
+    ULONG NumPageToAlloc = 0;
+    ULONG MaxQEntries;
+    ULONG SubQBytes;
+    ULONG CmbSlot;
+    ULONG ListPages;
+    ULONG RingPages;
+    BOOLEAN Remote = FALSE;
+    BOOLEAN NonContigOk;
+    NVMe_CONTROLLER_CAPABILITIES CAP = {0};
+
+    /* Ensure the QueueID is valid via the number of active cores in system */
+    if (QueueID > pRMT->NumActiveCores)
+        return (STOR_STATUS_INVALID_PARAMETER);
+
+    CAP.LowPart = StorPortReadRegisterUlong(pAE,
+        (PULONG)(&pAE->pCtrlRegister->CAP.LowPart));
+
+    /* Locate the target SUB_QUEUE_STRUCTURE via QueueID */
+    pSQI = pQI->pSubQueueInfo + QueueID;
+    pSQI->NumaNode = NumaNode;
+    pSQI->RemoteAllocs = 0;
+    pSQI->NonContiguous = FALSE;
+
+    /*
+     * To ensure:
+     *   1. Allocating enough memory and
+     *   2. The starting addresses of Sub/Com queues are system page aligned.
+     *
+     *      Need to:
+     *        1. Round up the allocated size of all Submission entries to be
+     *           multiple(s) of system page size.
+     *        2. Add one extra system page to allocation size
+     */
+    SysPageSizeInSubEntries = PAGE_SIZE / sizeof (NVMe_COMMAND);
+    if ((QEntries % SysPageSizeInSubEntries) != 0)
+        QEntries = (QEntries + SysPageSizeInSubEntries) &
+                  ~(SysPageSizeInSubEntries - 1);
+
+    /*
+     * Determine the allocation size in bytes
+     *   1. For Sub/Cpl entries, the DMA rings
+     *   2. For PRP Lists
+     *   3. For Cmd entries, host only metadata kept apart from the rings
+     */
+    SizeQueueEntry = QEntries * (sizeof(NVMe_COMMAND) +
+                                 sizeof(NVMe_COMPLETION_QUEUE_ENTRY));
+
+    /*
+     * The rounding above must not push an IO queue past what the controller
+     * supports, the rest of the rings is simply left unused.
+     */
+    MaxQEntries = (ULONG)CAP.MQES + 1;
+    if ((QueueID != 0) && (MaxQEntries > 1) && (QEntries > MaxQEntries))
+        QEntries = MaxQEntries;
+    QEntries = min(QEntries, MAX_IO_QUEUE_ENTRIES);
+
+    /*
+     * An IO submission ring that fits in what is left of the Controller
+     * Memory Buffer goes there, in its own page aligned slot. The controller
+     * then fetches the entries from its own memory instead of reading them
+     * over PCIe, and only the completion ring needs host memory.
+     */
+    pSQI->InCmb = FALSE;
+    pSQI->CmbOffset = 0;
+    SubQBytes = QEntries * sizeof(NVMe_COMMAND);
+    if ((QueueID != 0) && (pAE->pCmb != NULL)) {
+        CmbSlot = (ULONG)ROUND_TO_PAGES(SubQBytes);
+        if (CmbSlot <= (pAE->CmbSize - pAE->CmbUsed)) {
+            pSQI->CmbOffset = pAE->CmbUsed;
+            pSQI->InCmb = TRUE;
+            pAE->CmbUsed += CmbSlot;
+            SubQBytes = 0;
+            SizeQueueEntry = QEntries * sizeof(NVMe_COMPLETION_QUEUE_ENTRY);
+        }
+    }
+
+    /*
+     * IO rings may be physically scattered when the controller allows it.
+     * Very deep rings are allocated page by page straight away, others only
+     * if the contiguous allocation can't be granted.
+     */
+    NonContigOk = ((QueueID != 0) &&
+                   (pAE->ntldrDump == FALSE) &&
+                   (CAP.CQR == 0)) ? TRUE : FALSE;
+    pSQI->NonContiguous = ((NonContigOk == TRUE) &&
+                           (SizeQueueEntry > MAX_CONTIG_QUEUE_SIZE)) ?
+                          TRUE : FALSE;
+
+    /* Allcate memory for Sub/Cpl entries first */
+    if (pSQI->NonContiguous == FALSE) {
+        pSQI->pQueueAlloc = NVMeAllocQueueMem(pAE,
+                                              pSQI,
+                                              SizeQueueEntry + PAGE_SIZE,
+                                              NUMA_ALLOC_QUEUE);
+
+        if ((pSQI->pQueueAlloc == NULL) && (NonContigOk == TRUE)) {
+            StorPortDebugPrint(WARNING,
+                "NVMeAllocQueues: Queue 0x%x falls back to non-contiguous rings\n",
+                QueueID);
+            pSQI->NonContiguous = TRUE;
+        }
+    }
+
+    if (pSQI->NonContiguous == TRUE) {
+        /* Sub ring pages first, then the Cpl ring pages */
+        RingPages =
+            BYTES_TO_PAGES(SubQBytes) +
+            BYTES_TO_PAGES(QEntries * sizeof(NVMe_COMPLETION_QUEUE_ENTRY));
+        pSQI->pRingPages = NVMeAllocQueuePages(pAE,
+                                               pSQI,
+                                               RingPages,
+                                               NUMA_ALLOC_QUEUE);
+
+        if (pSQI->pRingPages == NULL)
+            return ( STOR_STATUS_INSUFFICIENT_RESOURCES );
+
+        pSQI->NumRingPages = RingPages;
+        pSQI->QueueAllocSize = RingPages * PAGE_SIZE;
+    } else {
+        if (pSQI->pQueueAlloc == NULL)
+            return ( STOR_STATUS_INSUFFICIENT_RESOURCES );
+
+        /* Save the size if needed to free the unused buffers */
+        pSQI->QueueAllocSize = SizeQueueEntry + PAGE_SIZE;
+    }
+
+    /*
+     * Command entries are only touched by the cores submitting to and
+     * completing from this queue, so keep them on the same node, in a
+     * separate buffer from the rings the controller reads and writes.
+     */
+    pSQI->pCmdEntryAlloc = NVMeAllocQueueMem(pAE,
+                                             pSQI,
+                                             QEntries * sizeof(CMD_ENTRY),
+                                             NUMA_ALLOC_CMD_ENTRY);
+
+    if (pSQI->pCmdEntryAlloc == NULL) {
+        NVMeFreeQueueBuffers(pAE, pSQI);
+        return ( STOR_STATUS_INSUFFICIENT_RESOURCES );
+    }
+
+    pSQI->CmdEntryAllocSize = QEntries * sizeof(CMD_ENTRY);
+
+    /*
+     * Non-contiguous rings need a PRP list each, these stay contiguous so
+     * the Create IO Sub/Cpl queue commands can point at them.
+     */
+    if (pSQI->NonContiguous == TRUE) {
+        ListPages =
+            QUEUE_PRP_LIST_PAGES(SubQBytes) +
+            QUEUE_PRP_LIST_PAGES(QEntries * sizeof(NVMe_COMPLETION_QUEUE_ENTRY));
+        pSQI->pQueuePRPAlloc = NVMeAllocateMemNode(pAE,
+                                                   (ListPages + 1) * PAGE_SIZE,
+                                                   NumaNode,
+                                                   &Remote);
+
+        if (pSQI->pQueuePRPAlloc == NULL) {
+            NVMeFreeQueueBuffers(pAE, pSQI);
+            return ( STOR_STATUS_INSUFFICIENT_RESOURCES );
+        }
+
+        pSQI->QueuePRPAllocSize = (ListPages + 1) * PAGE_SIZE;
+    }
+
+#ifdef DUMB_DRIVER
+    pSQI->pDblBuffAlloc = NVMeAllocateMem(pAE,
+                                          (QEntries * DUMB_DRIVER_SZ) + PAGE_SIZE,
+                                          NumaNode);
+
+    if (pSQI->pDblBuffAlloc == NULL)
+        return ( STOR_STATUS_INSUFFICIENT_RESOURCES );
+
+    /* Save the size if needed to free the unused buffers */
+    pSQI->dblBuffSz = (QEntries * DUMB_DRIVER_SZ) + PAGE_SIZE;
+
+    /* now the PRP list mem for this SQ to use */
+    pSQI->pDblBuffListAlloc = NVMeAllocateMem(pAE,
+                                          (QEntries * PAGE_SIZE) + PAGE_SIZE,
+                                          NumaNode);
+
+    if (pSQI->pDblBuffListAlloc == NULL)
+        return ( STOR_STATUS_INSUFFICIENT_RESOURCES );
+
+    /* Save the size if needed to free the unused buffers */
+    pSQI->dblBuffListSz = (QEntries * PAGE_SIZE) + PAGE_SIZE;
+#endif
+
+    /*
+     * Allcate memory for PRP Lists In order not crossing page boundary, need to
+     * calculate how many lists one page can accommodate.
+     */
+    pSQI->NumPRPListOnePage = PAGE_SIZE / pAE->PRPListSize;
+    NumPageToAlloc = (QEntries % pSQI->NumPRPListOnePage) ?
+        (QEntries / pSQI->NumPRPListOnePage) + 1 :
+        (QEntries / pSQI->NumPRPListOnePage);
+
+    if (pSQI->NonContiguous == TRUE) {
+        /* Lists never cross a page, so each page can stand on its own */
+        pSQI->pPRPListPages = NVMeAllocQueuePages(pAE,
+                                                  pSQI,
+                                                  NumPageToAlloc,
+                                                  NUMA_ALLOC_PRP_LIST);
+
+        if (pSQI->pPRPListPages == NULL) {
+            NVMeFreeQueueBuffers(pAE, pSQI);
+            return ( STOR_STATUS_INSUFFICIENT_RESOURCES );
+        }
+
+        pSQI->NumPRPListPages = NumPageToAlloc;
+        pSQI->PRPListAllocSize = NumPageToAlloc * PAGE_SIZE;
+    } else {
+        pSQI->pPRPListAlloc = NVMeAllocQueueMem(pAE,
+                                                pSQI,
+                                                (NumPageToAlloc + 1) * PAGE_SIZE,
+                                                NUMA_ALLOC_PRP_LIST);
+
+        if (pSQI->pPRPListAlloc == NULL) {
+            /* Free the allcated memory for Sub/Cpl/Cmd entries before returning */
+            NVMeFreeQueueBuffers(pAE, pSQI);
+            return ( STOR_STATUS_INSUFFICIENT_RESOURCES );
+        }
+
+        /* Save the size if needed to free the unused buffers */
+        pSQI->PRPListAllocSize = (NumPageToAlloc + 1) * PAGE_SIZE;
+    }
+
+    /* Mark down the number of entries allocated successfully */
+    pSQI->QEntriesAllocated = (USHORT)QEntries;
+    if (QueueID != 0) {
+        pQI->NumIoQEntriesAllocated = max(pQI->NumIoQEntriesAllocated,
+                                          (USHORT)QEntries);
+    } else {
+        pQI->NumAdQEntriesAllocated = (USHORT)QEntries;
+    }
+
+    return (STOR_STATUS_SUCCESS);
+} /* NVMeAllocQueues */
+
+/*******************************************************************************
+ * NVMeInitSubQueue
+ *
+ * @brief NVMeInitSubQueue gets called to initialize the SUB_QUEUE_INFO
+ *        structure of the specific submission queue associated with the QueueID
+ *
+ * @param pAE - Pointer to hardware device extension.
+ * @param QueueID - Which submission queue structure to initialize
+ *
+ * @return ULONG
+ *     STOR_STATUS_SUCCESS - If all resources are allocated properly
+ *     Otherwise - If anything goes wrong
+ ******************************************************************************/
+ULONG NVMeInitSubQueue(
+    PNVME_DEVICE_EXTENSION pAE,
+    USHORT QueueID
+)
+{
+    PQUEUE_INFO pQI = &pAE->QueueInfo;
+    PSUB_QUEUE_INFO pSQI = pQI->pSubQueueInfo + QueueID;
+    PRES_MAPPING_TBL pRMT = &pAE->ResMapTbl;
+    ULONG_PTR PtrTemp = 0;
+    USHORT Entries;
+    ULONG dbIndex = 0;
+    UCHAR maxCore;
+
+    NVMe_CONTROLLER_CAPABILITIES CAP = {0};
+
+    maxCore = (UCHAR)min(pAE->QueueInfo.NumCplIoQAllocFromAdapter,
+                        pAE->QueueInfo.NumSubIoQAllocFromAdapter);
+
+    /* Ensure the QueueID is valid via the number of active cores in system */
+    if (QueueID > maxCore)
+        return ( STOR_STATUS_INVALID_PARAMETER );
+		
+/* Code Analysis fails on StoPortReadRegisterUlong64 */
+#if 0 // (NTDDI_VERSION > NTDDI_WIN7) && defined(_WIN64)
+    CAP.AsUlonglong = StorPortReadRegisterUlong64(pAE,
+        (PULONG64)(&pAE->pCtrlRegister->CAP));
+#else
+    CAP.HighPart = StorPortReadRegisterUlong(pAE,
+        (PULONG)(&pAE->pCtrlRegister->CAP.HighPart));
+    CAP.LowPart = StorPortReadRegisterUlong(pAE,
+        (PULONG)(&pAE->pCtrlRegister->CAP.LowPart));
+#endif
+
+    /* Initialize static fields of SUB_QUEUE_INFO structure */
+    pSQI->SubQEntries = pSQI->QEntriesAllocated;
+    pSQI->SubQueueID = QueueID;
+    pSQI->FreeSubQEntries = pSQI->SubQEntries;
+
+     /* calculate byte offset per 1.0c spec formula */
+    dbIndex = 2 * QueueID * (4 << CAP.DSTRD);
+
+    /* convert to index */
+    dbIndex = dbIndex / sizeof(NVMe_QUEUE_Y_DOORBELL);
+    pSQI->pSubTDBL = (PULONG)(&pAE->pCtrlRegister->IODB[dbIndex].QHT );
+
+    StorPortDebugPrint(INFO,
+                       "NVMeInitSubQueue : SQ 0x%x pSubTDBL 0x%p at index  0x%x\n",
+                       QueueID, pSQI->pSubTDBL, dbIndex);
+    pSQI->Requests = 0;
+    pSQI->SubQTailPtr = 0;
+    pSQI->SubQHeadPtr = 0;
+
+    /*
+     * The queue is shared by cores when:
+     *   it's Admin queue, or
+     *   not enough IO queues are allocated, or
+     *   we are in crashdump.
+     */
+    if ((QueueID == 0)                                   ||
+        (pQI->NumSubIoQAllocated < maxCore) ||
+        (pAE->ntldrDump == TRUE)) {
+        pSQI->Shared = TRUE;
+    }
+
+    pSQI->CplQueueID = QueueID;
+
+    /*
+     * Initialize submission queue starting point. Per NVMe specification, need
+     * to make it system page aligned if it's not. A ring NVMeAllocQueues
+     * placed in the Controller Memory Buffer has no host memory behind it.
+     */
+    if (pSQI->InCmb == TRUE) {
+        pSQI->pSubQPages = NULL;
+        pSQI->pSubQStart = pAE->pCmb + pSQI->CmbOffset;
+        pSQI->SubQStart.QuadPart = pAE->CmbPhys.QuadPart + pSQI->CmbOffset;
+    } else if (pSQI->NonContiguous == TRUE) {
+        pSQI->pSubQPages = pSQI->pRingPages;
+        pSQI->pSubQStart = pSQI->pRingPages[0];
+        NVMeClearRing(NULL, pSQI->pRingPages, pSQI->QueueAllocSize);
+
+        /* The queue is created from the PRP list describing the ring */
+        pSQI->SubQStart = NVMeBuildQueuePRPList(
+                              pAE,
+                              pSQI->pSubQPages,
+                              BYTES_TO_PAGES(pSQI->SubQEntries *
+                                             sizeof(NVMe_COMMAND)),
+                              PAGE_ALIGN_BUF_PTR(pSQI->pQueuePRPAlloc));
+    } else {
+        pSQI->pSubQPages = NULL;
+        pSQI->pSubQStart = PAGE_ALIGN_BUF_PTR(pSQI->pQueueAlloc);
+        memset(pSQI->pQueueAlloc, 0, pSQI->QueueAllocSize);
+        pSQI->SubQStart = NVMeGetPhysAddr(pAE, pSQI->pSubQStart);
+    }
+    /* If fails on converting to physical address, return here */
+    if (pSQI->SubQStart.QuadPart == 0)
+        return ( STOR_STATUS_INSUFFICIENT_RESOURCES );
+
+#ifdef DUMB_DRIVER
+    pSQI->pDlbBuffStartVa = PAGE_ALIGN_BUF_PTR(pSQI->pDblBuffAlloc);
+    memset(pSQI->pDblBuffAlloc, 0, pSQI->dblBuffSz);
+
+    pSQI->pDlbBuffStartListVa = PAGE_ALIGN_BUF_PTR(pSQI->pDblBuffListAlloc);
+    memset(pSQI->pDblBuffListAlloc, 0, pSQI->dblBuffListSz);
+#endif
+
+    /*
+     * Initialize PRP list starting point. Per NVMe specification, need to make
+     * it system page aligned if it's not.
+     */
+    if (pSQI->NonContiguous == TRUE) {
+        /* The lists are located through pPRPListPages, see NVMeInitFreeQ */
+        pSQI->pPRPListStart = pSQI->pPRPListPages[0];
+        NVMeClearRing(NULL, pSQI->pPRPListPages, pSQI->PRPListAllocSize);
+    } else {
+        pSQI->pPRPListStart = PAGE_ALIGN_BUF_PTR(pSQI->pPRPListAlloc);
+        memset(pSQI->pPRPListAlloc, 0, pSQI->PRPListAllocSize);
+    }
+
+    pSQI->PRPListStart = NVMeGetPhysAddr( pAE, pSQI->pPRPListStart );
+    /* If fails on converting to physical address, return here */
+    if (pSQI->PRPListStart.QuadPart == 0)
+        return ( STOR_STATUS_INSUFFICIENT_RESOURCES );
+
+    /* Initialize list head of the free queue list */
+    InitializeListHead(&pSQI->FreeQList);
+
+    return (STOR_STATUS_SUCCESS);
+} /* NVMeInitSubQueue */
+
+/*******************************************************************************
+ * NVMeInitCplQueue
+ *
+ * @brief NVMeInitCplQueue gets called to initialize the CPL_QUEUE_INFO
+ *        structure of the specific completion queue associated with the QueueID
+ *
+ * @param pAE - Pointer to hardware device extension.
+ * @param QueueID - Which completion queue structure to initialize
+ *
+ * @return ULONG
+ *     STOR_STATUS_SUCCESS - If all resources are allocated properly
+ *     Otherwise - If anything goes wrong
+ ******************************************************************************/
+ULONG NVMeInitCplQueue(
+    PNVME_DEVICE_EXTENSION pAE,
+    USHORT QueueID
+)
+{
+    PQUEUE_INFO pQI = &pAE->QueueInfo;
+    PSUB_QUEUE_INFO pSQI = NULL;
+    PCPL_QUEUE_INFO pCQI = NULL;
+    PRES_MAPPING_TBL pRMT = &pAE->ResMapTbl;
+    ULONG_PTR PtrTemp;
+    USHORT Entries;
+    ULONG queueSize = 0;
+    ULONG subQSize;
+    ULONG dbIndex = 0;
+    UCHAR maxCore;
+
+    NVMe_CONTROLLER_CAPABILITIES CAP = {0};
+
+    maxCore = (UCHAR)min(pAE->QueueInfo.NumCplIoQAllocFromAdapter,
+                        pAE->QueueInfo.NumSubIoQAllocFromAdapter);
+
+    /* Ensure the QueueID is valid via the number of active cores in system */
+    if (QueueID > maxCore)
+        return ( STOR_STATUS_INVALID_PARAMETER );
+		
+/* Code Analysis fails on StoPortReadRegisterUlong64 */
+#if 0 // (NTDDI_VERSION > NTDDI_WIN7) && defined(_WIN64)
+    CAP.AsUlonglong = StorPortReadRegisterUlong64(pAE,
+        (PULONG64)(&pAE->pCtrlRegister->CAP));
+#else
+    CAP.HighPart = StorPortReadRegisterUlong(pAE,
+        (PULONG)(&pAE->pCtrlRegister->CAP.HighPart));
+    CAP.LowPart = StorPortReadRegisterUlong(pAE,
+        (PULONG)(&pAE->pCtrlRegister->CAP.LowPart));
+#endif
+
+    pSQI = pQI->pSubQueueInfo + QueueID;
+    pCQI = pQI->pCplQueueInfo + QueueID;
+
+    /* Initialize static fields of CPL_QUEUE_INFO structure */
+    pCQI->CplQueueID = QueueID;
+    pCQI->CplQEntries = pSQI->SubQEntries;
+
+    /* calculate byte offset per 10.c spec formula  */
+    dbIndex = (2 * QueueID + 1) * (4 << CAP.DSTRD);
+
+    /* convert to index */
+    dbIndex = dbIndex / sizeof(NVMe_QUEUE_Y_DOORBELL);
+    pCQI->pCplHDBL = (PULONG)(&pAE->pCtrlRegister->IODB[dbIndex].QHT );
+
+    StorPortDebugPrint(INFO,
+                       "NVMeInitCplQueue : CQ 0x%x pCplHDBL 0x%p at index  0x%x\n",
+                       QueueID, pCQI->pCplHDBL, dbIndex);
+    pCQI->Completions = 0;
+    pCQI->CurPhaseTag = 0;
+    pCQI->CplQHeadPtr = 0;
+
+    /**
+     * The queue is shared by cores when:
+     *   it's Admin queue, or
+     *   not enough IO queues are allocated, or
+     *   we are in crashdump.
+     */
+    if ((QueueID == 0)                                   ||
+        (pQI->NumCplIoQAllocated < maxCore) ||
+        (pAE->ntldrDump == TRUE)) {
+        pCQI->Shared = TRUE;
+    }
+
+    if (pRMT->InterruptType == INT_TYPE_MSI ||
+        pRMT->InterruptType == INT_TYPE_MSIX) {
+        if (pAE->IsMsiMappingComplete == TRUE) {
+            /*
+             * The vector was already assigned from the reported message
+             * affinities by NVMeMsiMapCores, keep it.
+             */
+        } else if (pRMT->NumMsiMsgGranted < maxCore) {
+            /* All completion queueus share the single message */
+            pCQI->MsiMsgID = 0;
+        } else {
+            /*
+             * When enough queues allocated, the initial mappings between
+             * queues and messages are set up as queue#(n+1) <=> message#(n)
+             * by NVMeMsiMapCores.
+             * Only need to deal with IO queues since Admin queue uses message#0
+             *
+             * When we come through here the first time during boot/init, the msg
+             * ID needs to be initialized.  After learning is complete, the msg ID
+             * will point to the proper MSI vector.  Learning is complete when
+             * LearningCores == NumActiveCores.
+             */
+            if ((QueueID != 0) && (pAE->LearningCores < pRMT->NumActiveCores)) {
+                pCQI->MsiMsgID = QueueID - 1;
+            }
+        }
+    }
+
+    /*
+     * Initialize completion queue entries. Firstly, make Cpl queue starting
+     * entry system page aligned. The submission ring ahead of it in host
+     * memory takes no room when it is in the Controller Memory Buffer.
+     */
+    subQSize = (pSQI->InCmb == TRUE) ?
+               0 : pSQI->SubQEntries * sizeof(NVMe_COMMAND);
+    if (pSQI->NonContiguous == TRUE) {
+        /* Its pages follow the ones of the submission queue ring */
+        queueSize = pSQI->SubQEntries * sizeof(NVMe_COMPLETION_QUEUE_ENTRY);
+        pCQI->pCplQPages = pSQI->pRingPages + BYTES_TO_PAGES(subQSize);
+        pCQI->pCplQStart = pCQI->pCplQPages[0];
+        NVMeClearRing(NULL, pCQI->pCplQPages, queueSize);
+
+        /* Its PRP list follows the one of the submission queue */
+        PtrTemp = (ULONG_PTR)PAGE_ALIGN_BUF_PTR(pSQI->pQueuePRPAlloc);
+        PtrTemp += QUEUE_PRP_LIST_PAGES(subQSize) * PAGE_SIZE;
+        pCQI->CplQStart = NVMeBuildQueuePRPList(pAE,
+                                                pCQI->pCplQPages,
+                                                BYTES_TO_PAGES(queueSize),
+                                                (PVOID)PtrTemp);
+    } else {
+        PtrTemp = (ULONG_PTR)PAGE_ALIGN_BUF_PTR(pSQI->pQueueAlloc);
+        pCQI->pCplQStart = (PVOID)(PtrTemp + subQSize);
+
+        queueSize = pSQI->SubQEntries * sizeof(NVMe_COMPLETION_QUEUE_ENTRY);
+        pCQI->pCplQPages = NULL;
+        pCQI->pCplQStart = PAGE_ALIGN_BUF_PTR(pCQI->pCplQStart);
+        memset(pCQI->pCplQStart, 0, queueSize);
+        pCQI->CplQStart = NVMeGetPhysAddr( pAE, pCQI->pCplQStart );
+    }
+    /* If fails on converting to physical address, return here */
+    if (pCQI->CplQStart.QuadPart == 0)
+        return ( STOR_STATUS_INSUFFICIENT_RESOURCES );
+
+    return (STOR_STATUS_SUCCESS);
+} /* NVMeInitCplQueue */
+
+/*******************************************************************************
+ * NVMeInitCmdEntries
+ *
+ * @brief NVMeInitCmdEntries gets called to initialize the CMD_ENTRY structure
+ *        of the specific submission queue associated with the QueueID
+ *
+ * @param pAE - Pointer to hardware device extension.
+ * @param QueueID - Which submission queue structure to initialize
+ *
+ * @return ULONG
+ *     STOR_STATUS_SUCCESS - If all resources are allocated properly
+ *     Otherwise - If anything goes wrong
+ ******************************************************************************/
+ULONG NVMeInitCmdEntries(
+    PNVME_DEVICE_EXTENSION pAE,
+    USHORT QueueID
+)
+{
+    PQUEUE_INFO pQI = &pAE->QueueInfo;
+    PSUB_QUEUE_INFO pSQI = pQI->pSubQueueInfo + QueueID;
+    PRES_MAPPING_TBL pRMT = &pAE->ResMapTbl;
+
+    /* Ensure the QueueID is valid via the number of active cores in system */
+    if (QueueID > pRMT->NumActiveCores)
+        return (STOR_STATUS_INVALID_PARAMETER);
+
+    /* Initialize command entries and Free list */
+    pSQI->pCmdEntry = pSQI->pCmdEntryAlloc;
+
+    memset(pSQI->pCmdEntry, 0, sizeof(CMD_ENTRY) * pSQI->SubQEntries);
+    NVMeInitFreeQ(pSQI, pAE);
+
+    return (STOR_STATUS_SUCCESS);
+} /* NVMeInitCmdEntries */
+
+/*******************************************************************************
+ * NVMeResetAdapter
+ *
+ * @brief NVMeResetAdapter gets called to reset the adapter by setting EN bit of
+ *        CC register as 0. This causes the adapter to forget about queues --
+ *        the internal adapter falls back to initial state.
+ *
+ * @param pAE - Pointer to hardware device extension.
+ *
+ * @return BOOLEAN
+ *     TRUE - If reset procedure seemed to worky
+ *     FALSE - If anything goes wrong
+ ******************************************************************************/
+BOOLEAN NVMeResetAdapter(
+    PNVME_DEVICE_EXTENSION pAE
+)
+{
+    NVMe_CONTROLLER_CONFIGURATION CC;
+
+    /* Need to to ensure the Controller registers are memory-mapped properly */
+    if (pAE->pCtrlRegister == NULL)
+        return (FALSE);
+
+    StorPortDebugPrint(INFO, "NVMeResetAdapter:  Clearing EN...\n");
+    /*
+     * Immediately reset our start state to indicate that the controller
+     * is ont ready
+     */
+    CC.AsUlong= StorPortReadRegisterUlong(pAE,
+                                          (PULONG)(&pAE->pCtrlRegister->CC));
+	if (CC.EN == 1) {
+
+		/*
+         * Before we transition to 0, make sure the ctrl is actually RDY        
+         */
+        if(FALSE == NVMeWaitForCtrlRDY(pAE, 1)) {
+            return FALSE;
+        }
+		
+		CC.EN = 0;
+
+		StorPortWriteRegisterUlong(pAE,
+			(PULONG)(&pAE->pCtrlRegister->CC),
+			CC.AsUlong);
+
+
+		if (NVMeWaitForCtrlRDY(pAE, 0) == FALSE) {
+			StorPortDebugPrint(INFO,
+				"NVMeResetAdapter: EN bit is not getting Cleared\n");
+			return (FALSE);
+		}
+	}
+
+    /*
+     * The reset took the Host Memory Buffer back from the controller and
+     * dropped the shadow doorbell and APST configuration
+     */
+    pAE->HmbEnabled = FALSE;
+    pAE->DoorbellBufferEnabled = FALSE;
+    pAE->ApstEnabled = FALSE;
+ 	pAE->DriverState.NextDriverState = NVMeWaitOnRDY;
+
+    return (TRUE);
+} /* NVMeResetAdapter */
+
+
+/*******************************************************************************
+ * NVMeEnableAdapter
+ *
+ * @brief NVMeEnableAdapter gets called to do the followings:
+ *     - Program AdminQ related registers
+ *     - Set EN bit of CC register as 1
+ *     - Check if device is ready via RDY bit of STS register
+ *     - Report the readiness of the adapter in return
+ *
+ * @param pAE - Pointer to hardware device extension.
+ *
+ * @return BOOLEAN
+ *  TRUE  - if Adapter is enabled correctly
+ *  FALSE - if anything goes wrong
+ ******************************************************************************/
+BOOLEAN NVMeEnableAdapter(
+    PNVME_DEVICE_EXTENSION pAE
+)
+{
+    PQUEUE_INFO pQI = &pAE->QueueInfo;
+    NVMe_CONTROLLER_CONFIGURATION CC = {0};
+    NVMe_CONTROLLER_CAPABILITIES CAP = {0};
+
+
+    /*
+     * Program Admin queue registers before enabling the adapter:
+     * Admin Queue Attributes
+     */
+    StorPortWriteRegisterUlong(
+        pAE,
+        (PULONG)(&pAE->pCtrlRegister->AQA),
+        (pQI->pSubQueueInfo->SubQEntries - 1) +
+        ((pQI->pCplQueueInfo->CplQEntries - 1) << NVME_AQA_CQS_LSB));
+
+    /* Admin Submission Queue Base Address (64 bit) */
+    StorPortWriteRegisterUlong(
+        pAE,
+        (PULONG)(&pAE->pCtrlRegister->ASQ.LowPart),
+        (ULONG)(pQI->pSubQueueInfo->SubQStart.LowPart));
+
+    StorPortWriteRegisterUlong(
+        pAE,
+        (PULONG)(&pAE->pCtrlRegister->ASQ.HighPart),
+        (ULONG)(pQI->pSubQueueInfo->SubQStart.HighPart));
+
+    /* Admin Completion Queue Base Address (64 bit) */
+    StorPortWriteRegisterUlong(
+        pAE,
+        (PULONG)(&pAE->pCtrlRegister->ACQ.LowPart),
+        (ULONG)(pQI->pCplQueueInfo->CplQStart.LowPart));
+
+    StorPortWriteRegisterUlong(
+        pAE,
+        (PULONG)(&pAE->pCtrlRegister->ACQ.HighPart),
+        (ULONG)(pQI->pCplQueueInfo->CplQStart.HighPart));
+
+
+    StorPortDebugPrint(INFO, "NVMeEnableAdapter:  Setting EN...\n");
+    /*
+     * Set up Controller Configuration Register
+     */
+    CC.EN = 1;
+    CC.CSS = NVME_CC_NVM_CMD;
+
+    /*
+     * Zoned namespaces are only reachable with all supported I/O Command Sets
+     * enabled; the NVM Command Set behaves the same either way.
+     */
+    CAP.HighPart = StorPortReadRegisterUlong(pAE,
+        (PULONG)(&pAE->pCtrlRegister->CAP.HighPart));
+    pAE->IoCmdSetsEnabled = FALSE;
+    if ((CAP.CSS & NVME_CAP_CSS_IO_CMD_SETS) != 0) {
+        CC.CSS = NVME_CC_ALL_IO_CMD_SETS;
+        pAE->IoCmdSetsEnabled = TRUE;
+    }
+    CC.MPS = (PAGE_SIZE >> NVME_MEM_PAGE_SIZE_SHIFT);
+    CC.AMS = NVME_CC_ROUND_ROBIN;
+    CC.SHN = NVME_CC_SHUTDOWN_NONE;
+    CC.IOSQES = NVME_CC_IOSQES;
+    CC.IOCQES = NVME_CC_IOCQES;
+
+    StorPortWriteRegisterUlong(pAE,
+                               (PULONG)(&pAE->pCtrlRegister->CC),
+                               CC.AsUlong);
+    return TRUE;
+} /* NVMeEnableAdapter */
+
+/*******************************************************************************
+ * NVMeSetFeaturesCompletion
+ *
+ * @brief NVMeSetFeaturesCompletion gets called to exam the first LBA Range
+ *        entry of a given namespace. The procedure is described below:
+ *
+ *        Only exam the first LBA Range entry of a given namespace;
+ *
+ *        if (NLB == Namespace Size) {
+ *            if (Type == 00b) {
+ *                Change the followings via Set Features (ID#3):
+ *                    Type to Filesystem;
+ *                    Attributes(bit0) as 1 (can be overwritten);
+ *                    Attributes(bit1) as 0 (visible);
+ *                Mark ExposeNamespace as TRUE;
+ *                Mark ReadOnly as FALSE;
+ *            } else if (Type == 01b) {
+ *                if (Attributes(bit0) != 0)
+ *                    Mark ReadOnly as FALSE;
+ *                else
+ *                    Mark ReadOnly as TRUE;
+ *
+ *                if (Attributes(bit1) != 0)
+ *                    Mark ExposeNamespace as FALSE;
+ *                else
+ *                    Mark ExposeNamespace as TRUE;
+ *            } else {
+ *                Mark ExposeNamespace as FALSE;
+ *                Mark ReadOnly based on Attributes(bit0);
+ *            }
+ *        } else {
+ *            Mark ExposeNamespace as FALSE;
+ *            Mark ReadOnly based on Attributes(bit0);
+ *        }
+ *
+ * @param pAE - Pointer to hardware device extension.
+ * @param pNVMeCmd - Pointer to the original submission entry
+ * @param pCplEntry - Pointer to the completion entry
+ *
+ * @return VOID
+ ******************************************************************************/
+VOID NVMeSetFeaturesCompletion(
+    PNVME_DEVICE_EXTENSION pAE,
+    PNVMe_COMMAND pNVMeCmd,
+    PNVMe_COMPLETION_QUEUE_ENTRY pCplEntry
+)
+{
+    PQUEUE_INFO pQI = &pAE->QueueInfo;
+    PADMIN_SET_FEATURES_COMMAND_LBA_RANGE_TYPE_ENTRY pLbaRangeTypeEntry = NULL;
+    PNVME_LUN_EXTENSION pLunExt = NULL;
+    PADMIN_SET_FEATURES_COMMAND_DW10 pSetFeaturesCDW10 = NULL;
+    PADMIN_SET_FEATURES_COMMAND_LBA_RANGE_TYPE_DW11 pSetFeaturesCDW11 = NULL;
+    NS_VISBILITY visibility = IGNORED;
+    ULONG lunId;
+
+    /*
+     * Mark down the resulted information if succeeded. Otherwise, log the error
+     * bit in case of errors and fail the state machine
+     */
+    pSetFeaturesCDW10 =
+        (PADMIN_SET_FEATURES_COMMAND_DW10) &pNVMeCmd->CDW10;
+
+    if (pAE->DriverState.InterruptCoalescingSet == FALSE &&
+        pNVMeCmd->CDW0.OPC == ADMIN_SET_FEATURES        &&
+        pSetFeaturesCDW10->FID == INTERRUPT_COALESCING ) {
+        if (pCplEntry->DW3.SF.SC != 0) {
+            NVMeDriverFatalError(pAE,
+                                (1 << START_STATE_INT_COALESCING_FAILURE));
+        } else {
+            pAE->DriverState.InterruptCoalescingSet = TRUE;
+
+            /* Reset the counter and keep tihs state to set more features */
+            pAE->DriverState.StateChkCount = 0;
+            pAE->DriverState.NextDriverState = NVMeWaitOnSetFeatures;
+        }
+    } else if (pNVMeCmd->CDW0.OPC == ADMIN_SET_FEATURES &&
+               pSetFeaturesCDW10->FID == NUMBER_OF_QUEUES) {
+        if (pCplEntry->DW3.SF.SC != 0) {
+            NVMeDriverFatalError(pAE,
+                                (1 << START_STATE_QUEUE_ALLOC_FAILURE));
+        } else {
+            /*
+             * NCQR and NSQR are 0 based values. NumSubIoQAllocFromAdapter and
+             * NumSubIoQAllocFromAdapter are 1 based values.
+             */
+            pQI->NumSubIoQAllocFromAdapter = GET_WORD_0(pCplEntry->DW0) + 1;
+            pQI->NumCplIoQAllocFromAdapter = GET_WORD_1(pCplEntry->DW0) + 1;
+
+            /*
+             * Ensure there is the minimum number of queues between the MSI
+             * granted, number of cores, and number allocated from the adapter.
+             */
+            if (pAE->ntldrDump == FALSE) {
+                pQI->NumSubIoQAllocFromAdapter = min(pQI->NumSubIoQAllocFromAdapter,
+                                                     pAE->ResMapTbl.NumActiveCores);
+
+                pQI->NumCplIoQAllocFromAdapter = min(pQI->NumCplIoQAllocFromAdapter,
+                                                     pAE->ResMapTbl.NumActiveCores);
+
+                /* Only take the min if the number of MSI is greater than 0 */
+                if (pAE->ResMapTbl.NumMsiMsgGranted > 0) {
+                    pQI->NumSubIoQAllocFromAdapter = min(pQI->NumSubIoQAllocFromAdapter,
+                                                         pAE->ResMapTbl.NumMsiMsgGranted);
+
+                    pQI->NumCplIoQAllocFromAdapter = min(pQI->NumCplIoQAllocFromAdapter,
+                                                         pAE->ResMapTbl.NumMsiMsgGranted);
+                }
+            } 
+
+            /*
+             * Reset the counter and keep tihs state to set more features,
+             * the namespaces kept on a fast resume need none
+             */
+            pAE->DriverState.StateChkCount = 0;
+            if (pAE->DriverState.FastResume == TRUE)
+                pAE->DriverState.NextDriverState = NVMeWaitOnStreams;
+            else
+                pAE->DriverState.NextDriverState = NVMeWaitOnSetFeatures;
+        }
+    } else if ((pAE->DriverState.TtlLbaRangeExamined <
+                pAE->DriverState.IdentifyNamespaceFetched) &&
+               (pSetFeaturesCDW10->FID == LBA_RANGE_TYPE)) {
+        /* first check completion status code */
+        if (pCplEntry->DW3.SF.SC != 0) {
+           /* Support for LBA Range Type is optional,
+            * handle the case that it's not supported 
+            */
+			if ((pCplEntry->DW3.SF.SCT == GENERIC_COMMAND_STATUS) &&
+				((pCplEntry->DW3.SF.SC == INVALID_FIELD_IN_COMMAND) ||
+				(pCplEntry->DW3.SF.SC == INVALID_NAMESPACE_OR_FORMAT))) {
+                /*
+                 * The device doesn't support the optional LBA Range Type
+                 * command so assume the slot is online/visible and writable
+                 */
+                if (pAE->controllerIdentifyData.OACS.SupportsNamespaceMgmtAndAttachment) 
+                    lunId = pAE->DriverState.IdentifyNamespaceFetched - 1;
+                else
+                    lunId = pAE->DriverState.VisibleNamespacesExamined;
+
+                pLunExt = pAE->pLunExtensionTable[lunId];
+                if (pLunExt->identifyData.NCAP != 0) {
+					if (!pAE->controllerIdentifyData.OACS.SupportsNamespaceMgmtAndAttachment) {
+						pLunExt->nsStatus = ATTACHED;
+					}
+                    pLunExt->slotStatus = ONLINE;
+                    NVMeRefreshLunIoParams(pAE, pLunExt);
+                    pLunExt->ReadOnly = FALSE;
+                    pAE->DriverState.VisibleNamespacesExamined++;
+                    pAE->DriverState.ConfigLbaRangeNeeded = FALSE;
+                    pAE->DriverState.TtlLbaRangeExamined++;
+                } else if ((INACTIVE == pLunExt->nsStatus) || (INVALID == pLunExt->nsStatus)) {
+                    pAE->DriverState.ConfigLbaRangeNeeded = FALSE;
+                    pAE->DriverState.TtlLbaRangeExamined++;
+                }
+
+                /* Reset the counter and set next state accordingly */
+                pAE->DriverState.StateChkCount = 0;
+                if (pAE->DriverState.NumKnownNamespaces == 0 ||
+                    pAE->DriverState.TtlLbaRangeExamined ==
+                    pAE->DriverState.NumKnownNamespaces) {
+                    /* We have called identify namespace as well as get/set
+                     * features for each of the NN namespaces that exist.
+                     * Move on to the next state in the state machine.
+                     */
+
+                    pAE->visibleLuns = pAE->DriverState.VisibleNamespacesExamined;
+                    pAE->DriverState.NextDriverState = NVMeWaitOnZoned;
+                } else {
+                    /* We have more namespaces to identify so
+                     * we'll set the state to NVMeWaitOnIdentifyNS in order
+                     * to identify the remaining namespaces.
+                     */
+                    pAE->DriverState.NextDriverState = NVMeWaitOnIdentifyNS;
+                }
+            } else {
+                NVMeDriverFatalError(pAE,
+                                    (1 << START_STATE_LBA_RANGE_CHK_FAILURE));
+            }
+        } else {
+            /*
+             * When Get Features command completes, exam the completed data to
+             * see if Set Features is required. If so, simply set
+             * ConfigLbaRangeNeeded as TRUE If not, simply increase
+             * TtlLbaRangeExamined and set ConfigLbaRangeNeeded as FALSE When Set
+             * Features command completes, simply increase TtlLbaRangeExamined
+             */
+            lunId = pAE->DriverState.VisibleNamespacesExamined;
+
+            pLbaRangeTypeEntry =
+                (PADMIN_SET_FEATURES_COMMAND_LBA_RANGE_TYPE_ENTRY)
+                pAE->DriverState.pDataBuffer;
+            pSetFeaturesCDW11 =
+                (PADMIN_SET_FEATURES_COMMAND_LBA_RANGE_TYPE_DW11) &pNVMeCmd->CDW11;
+
+            pLunExt = pAE->pLunExtensionTable[lunId];
+
+            if (pNVMeCmd->CDW0.OPC == ADMIN_GET_FEATURES) {
+                /* driver only supports 1 LBA range type per NS (NUM is 0 based) */
+                if (pSetFeaturesCDW11->NUM == 0) {
+
+                    /*
+                     *
+                     * NOTE:  spec/group still working this behavior out
+                     * wrt dealing with range tpyes so making this simple
+                     * for now so we can update it when needed.  Currently
+                     * we'll IGNORE the range TYPE entirely
+                     *
+                     */
+                    StorPortDebugPrint(INFO,
+                           "pLbaRangeTypeEntry type : 0x%llX lun id %d nsid 0x%x\n",
+                           pLbaRangeTypeEntry->Type,
+                           lunId,
+                           pNVMeCmd->NSID);
+
+                    visibility =
+                        pLbaRangeTypeEntry->Attributes.Hidden ? HIDDEN:VISIBLE;
+                    pLunExt->ReadOnly =
+                            pLbaRangeTypeEntry->Attributes.Overwriteable ?
+                                FALSE:TRUE;
+                    /*
+                     *  When the namespace is formatted with a metadata
+                     *  layout the driver can't handle, don't advertise it
+                     */
+                    if (NVMeLunFormatSupported(pAE, pLunExt) == FALSE)
+                       visibility = HIDDEN;
+
+                } else {
+                    /*
+                     * Don't support more than one entry per NS. Mark it IGNORED
+                     */
+                    visibility = IGNORED;
+                }
+
+                pAE->DriverState.ConfigLbaRangeNeeded = FALSE;
+                pAE->DriverState.TtlLbaRangeExamined++;
+                if (visibility == VISIBLE) {
+                    pLunExt->slotStatus = ONLINE;
+                    NVMeRefreshLunIoParams(pAE, pLunExt);
+                    pAE->DriverState.VisibleNamespacesExamined++;
+                } else {
+                    StorPortDebugPrint(INFO,"NVMeSetFeaturesCompletion: FYI LnuExt at %d has been cleared (NSID not visible)\n",
+                        lunId);
+                    RtlZeroMemory(pLunExt, sizeof(NVME_LUN_EXTENSION));
+                }
+
+            } else if (pNVMeCmd->CDW0.OPC == ADMIN_SET_FEATURES) {
+
+                /* TODO: set features not currently called, after its ironed out
+                 * how we want to handle range types, we'll need to fill
+                 * this in
+                 */
+
+                /*
+                pAE->DriverState.VisibleNamespacesExamined++;
+                pLunExt->ReadOnly = FALSE;
+                pAE->DriverState.TtlLbaRangeExamined++;
+                pAE->DriverState.ConfigLbaRangeNeeded = FALSE;
+                */
+            }
+
+            /* Reset the counter and set next state accordingly */
+            pAE->DriverState.StateChkCount = 0;
+            if (pAE->DriverState.NumKnownNamespaces == 0 ||
+                pAE->DriverState.TtlLbaRangeExamined ==
+				pAE->DriverState.NumKnownNamespaces) {
+                /* We have called identify namespace as well as get/set
+                 * features for each of the NN namespaces that exist.
+                 * Move on to the next state in the state machine.
+                 */
+                pAE->visibleLuns = pAE->DriverState.VisibleNamespacesExamined;
+                pAE->DriverState.NextDriverState = NVMeWaitOnZoned;
+            } else {
+                /* We have more namespaces to identify and get/set features
+                 * for. But before we can move on to the next namespace,
+                 * we'll check if we need to call set features - if not,
+                 * we'll set the state to NVMeWaitOnIdentifyNS so we can
+                 * continue to identify the remaining namespaces.
+                 */
+                if (TRUE == pAE->DriverState.ConfigLbaRangeNeeded) {
+                    // We still need to issue a set features for this namespace
+                pAE->DriverState.NextDriverState = NVMeWaitOnSetFeatures;
+                } else {
+                    // Move on to the next namespace and issue an identify
+                    pAE->DriverState.NextDriverState = NVMeWaitOnIdentifyNS;
+                }
+            }
+        }
+    }
+} /* NVMeSetFeaturesCompletion */
+
+/*******************************************************************************
+ * NVMeZonedUpdateLun
+ *
+ * @brief NVMeZonedUpdateLun gets called with the completion of an Identify
+ *        (Zoned Namespace) command to record whether the namespace is zoned,
+ *        and its zone geometry if it is.
+ *
+ * @param pLunExt - Pointer to the LUN extension of the namespace
+ * @param pCplEntry - Pointer to the completion entry
+ * @param pZnsData - The Identify (Zoned Namespace) data
+ *
+ * @return VOID
+ ******************************************************************************/
+VOID NVMeZonedUpdateLun(
+    PNVME_LUN_EXTENSION pLunExt,
+    PNVMe_COMPLETION_QUEUE_ENTRY pCplEntry,
+    PADMIN_IDENTIFY_ZNS_NAMESPACE pZnsData
+)
+{
+    UCHAR flbas = pLunExt->identifyData.FLBAS.SupportedCombination;
+
+    pLunExt->zoned = FALSE;
+    if ((pCplEntry->DW3.SF.SC == SUCCESSFUL_COMPLETION) &&
+        (pCplEntry->DW3.SF.SCT == GENERIC_COMMAND_STATUS) &&
+        (pZnsData->LBAFE[flbas].ZSZE != 0)) {
+        pLunExt->zoned = TRUE;
+        pLunExt->zoneSize = pZnsData->LBAFE[flbas].ZSZE;
+        pLunExt->maxOpenZones =
+            (pZnsData->MOR == MAXULONG) ? 0 : pZnsData->MOR + 1;
+
+        StorPortDebugPrint(INFO,
+            "NVMeZonedUpdateLun: NSID 0x%x zone size 0x%llx max open %d\n",
+            pLunExt->namespaceId, pLunExt->zoneSize, pLunExt->maxOpenZones);
+    }
+} /* NVMeZonedUpdateLun */
+
+/*******************************************************************************
+ * NVMeZonedCompletion
+ *
+ * @brief NVMeZonedCompletion gets called to examine the completion of the
+ *        Identify (Zoned Namespace) command issued by NVMeIdentifyZoned. A
+ *        namespace of another command set fails the command and is simply
+ *        left as a regular block device.
+ *
+ * @param pAE - Pointer to hardware device extension.
+ * @param pCplEntry - Pointer to the completion entry
+ *
+ * @return VOID
+ ******************************************************************************/
+VOID NVMeZonedCompletion(
+    PNVME_DEVICE_EXTENSION pAE,
+    PNVMe_COMPLETION_QUEUE_ENTRY pCplEntry
+)
+{
+    PNVME_LUN_EXTENSION pLunExt =
+        pAE->pLunExtensionTable[pAE->DriverState.ZonedLunExamined];
+
+    NVMeZonedUpdateLun(pLunExt,
+                       pCplEntry,
+                       (PADMIN_IDENTIFY_ZNS_NAMESPACE)
+                       pAE->DriverState.pDataBuffer);
+
+    pAE->DriverState.ZonedLunExamined++;
+
+    /* Reset the counter and stay here until all namespaces are done */
+    pAE->DriverState.StateChkCount = 0;
+    pAE->DriverState.NextDriverState = NVMeWaitOnZoned;
+} /* NVMeZonedCompletion */
+
+/*******************************************************************************
+ * NVMeStreamsUpdateLun
+ *
+ * @brief NVMeStreamsUpdateLun gets called with the successful completion of
+ *        the Directive Receive that allocated streams to a namespace. The
+ *        namespace is split into as many power of 2 sized LBA regions as
+ *        there are streams; writes are tagged with the stream of the region
+ *        they start in.
+ *
+ * @param pAE - Pointer to hardware device extension.
+ * @param pLunExt - Pointer to the LUN extension of the namespace
+ * @param pCplEntry - Pointer to the completion entry
+ *
+ * @return VOID
+ ******************************************************************************/
+VOID NVMeStreamsUpdateLun(
+    PNVME_DEVICE_EXTENSION pAE,
+    PNVME_LUN_EXTENSION pLunExt,
+    PNVMe_COMPLETION_QUEUE_ENTRY pCplEntry
+)
+{
+    USHORT numStreams = 0;
+    UCHAR shift = 0;
+
+    numStreams = (USHORT)min(GET_WORD_0(pCplEntry->DW0),
+                             pAE->InitInfo.Streams);
+    if (numStreams != 0) {
+        while (((pLunExt->identifyData.NSZE - 1) >> shift) >= numStreams)
+            shift++;
+    }
+
+    pLunExt->numStreams = numStreams;
+    pLunExt->streamShift = shift;
+    StorPortDebugPrint(INFO,
+        "NVMeStreamsUpdateLun: NSID 0x%x streams %d\n",
+        pLunExt->namespaceId, numStreams);
+} /* NVMeStreamsUpdateLun */
+
+/*******************************************************************************
+ * NVMeStreamsCompletion
+ *
+ * @brief NVMeStreamsCompletion gets called to examine the completion of the
+ *        Directive commands issued by NVMeConfigureStreams. Streams are an
+ *        optimization only: when either step fails, the namespace is simply
+ *        left without streams and the state machine carries on.
+ *
+ * @param pAE - Pointer to hardware device extension.
+ * @param pNVMeCmd - Pointer to the original submission entry
+ * @param pCplEntry - Pointer to the completion entry
+ *
+ * @return VOID
+ ******************************************************************************/
+VOID NVMeStreamsCompletion(
+    PNVME_DEVICE_EXTENSION pAE,
+    PNVMe_COMMAND pNVMeCmd,
+    PNVMe_COMPLETION_QUEUE_ENTRY pCplEntry
+)
+{
+    PNVME_LUN_EXTENSION pLunExt =
+        pAE->pLunExtensionTable[pAE->DriverState.StreamsLunExamined];
+
+    if ((pCplEntry->DW3.SF.SC == SUCCESSFUL_COMPLETION) &&
+        (pCplEntry->DW3.SF.SCT == GENERIC_COMMAND_STATUS)) {
+        if (pNVMeCmd->CDW0.OPC == ADMIN_DIRECTIVE_SEND) {
+            /* Enabled, allocate the streams next */
+            pAE->DriverState.StreamsEnabled = TRUE;
+        } else {
+            NVMeStreamsUpdateLun(pAE, pLunExt, pCplEntry);
+
+            pAE->DriverState.StreamsEnabled = FALSE;
+            pAE->DriverState.StreamsLunExamined++;
+        }
+    } else {
+        StorPortDebugPrint(INFO,
+            "NVMeStreamsCompletion: NSID 0x%x failed (SCT 0x%x SC 0x%x)\n",
+            pLunExt->namespaceId,
+            pCplEntry->DW3.SF.SCT,
+            pCplEntry->DW3.SF.SC);
+
+        pAE->DriverState.StreamsEnabled = FALSE;
+        pAE->DriverState.StreamsLunExamined++;
+    }
+
+    /* Reset the counter and stay here until all namespaces are done */
+    pAE->DriverState.StateChkCount = 0;
+    pAE->DriverState.NextDriverState = NVMeWaitOnStreams;
+} /* NVMeStreamsCompletion */
+
+/*******************************************************************************
+ * NVMeHmbCompletion
+ *
+ * @brief NVMeHmbCompletion gets called to examine the completion of the Set
+ *        Features (Host Memory Buffer) command issued by NVMeRunningWaitOnHmb.
+ *        The controller works without the buffer, only slower, so a failure
+ *        is logged and the state machine carries on.
+ *
+ * @param pAE - Pointer to hardware device extension.
+ * @param pCplEntry - Pointer to the completion entry
+ *
+ * @return VOID
+ ******************************************************************************/
+VOID NVMeHmbCompletion(
+    PNVME_DEVICE_EXTENSION pAE,
+    PNVMe_COMPLETION_QUEUE_ENTRY pCplEntry
+)
+{
+    if ((pCplEntry->DW3.SF.SC == SUCCESSFUL_COMPLETION) &&
+        (pCplEntry->DW3.SF.SCT == GENERIC_COMMAND_STATUS)) {
+        pAE->HmbEnabled = TRUE;
+        pAE->HmbReturned = TRUE;
+        StorPortDebugPrint(INFO,
+            "NVMeHmbCompletion: %d chunks of 0x%x bytes enabled\n",
+            pAE->HmbNumChunks, pAE->HmbChunkSize);
+    } else {
+        StorPortDebugPrint(INFO,
+            "NVMeHmbCompletion: failed (SCT 0x%x SC 0x%x)\n",
+            pCplEntry->DW3.SF.SCT,
+            pCplEntry->DW3.SF.SC);
+    }
+
+    /* Reset the counter and move on to the doorbell buffer */
+    pAE->DriverState.StateChkCount = 0;
+    pAE->DriverState.NextDriverState = NVMeWaitOnDoorbellBuffer;
+} /* NVMeHmbCompletion */
+
+/*******************************************************************************
+ * NVMeDoorbellBufferCompletion
+ *
+ * @brief NVMeDoorbellBufferCompletion gets called to examine the completion of
+ *        the Doorbell Buffer Config command. On failure the IO queues simply
+ *        keep ringing the doorbell registers.
+ *
+ * @param pAE - Pointer to hardware device extension.
+ * @param pCplEntry - Pointer to the completion entry
+ *
+ * @return VOID
+ ******************************************************************************/
+VOID NVMeDoorbellBufferCompletion(
+    PNVME_DEVICE_EXTENSION pAE,
+    PNVMe_COMPLETION_QUEUE_ENTRY pCplEntry
+)
+{
+    if ((pCplEntry->DW3.SF.SC == SUCCESSFUL_COMPLETION) &&
+        (pCplEntry->DW3.SF.SCT == GENERIC_COMMAND_STATUS)) {
+        pAE->DoorbellBufferEnabled = TRUE;
+        StorPortDebugPrint(INFO,
+            "NVMeDoorbellBufferCompletion: shadow doorbells enabled\n");
+    } else {
+        StorPortDebugPrint(INFO,
+            "NVMeDoorbellBufferCompletion: failed (SCT 0x%x SC 0x%x)\n",
+            pCplEntry->DW3.SF.SCT,
+            pCplEntry->DW3.SF.SC);
+    }
+
+    /* Reset the counter and move on to APST */
+    pAE->DriverState.StateChkCount = 0;
+    pAE->DriverState.NextDriverState = NVMeWaitOnApst;
+} /* NVMeDoorbellBufferCompletion */
+
+/*******************************************************************************
+ * NVMePlmCompletion
+ *
+ * @brief NVMePlmCompletion gets called to examine the completion of the
+ *        commands issued by NVMeConfigurePlm for the current NVM Set. A set
+ *        failing any step is left out of Predictable Latency Mode; once its
+ *        log page is read the set is tracked and the next one is started.
+ *
+ * @param pAE - Pointer to hardware device extension.
+ * @param pCplEntry - Pointer to the completion entry
+ *
+ * @return VOID
+ ******************************************************************************/
+VOID NVMePlmCompletion(
+    PNVME_DEVICE_EXTENSION pAE,
+    PNVMe_COMPLETION_QUEUE_ENTRY pCplEntry
+)
+{
+    ULONG SetIndex = pAE->DriverState.PlmSetExamined;
+
+    if ((pCplEntry->DW3.SF.SC == SUCCESSFUL_COMPLETION) &&
+        (pCplEntry->DW3.SF.SCT == GENERIC_COMMAND_STATUS)) {
+        if (pAE->DriverState.PlmStep == PLM_STEP_LOG) {
+            NVMePlmUpdateSet(pAE,
+                SetIndex,
+                (PADMIN_GET_LOG_PAGE_PREDICTABLE_LATENCY_NVM_SET)
+                pAE->DriverState.pDataBuffer);
+            pAE->PlmEnabled = TRUE;
+
+            StorPortDebugPrint(INFO,
+                "NVMePlmCompletion: NVM Set %d window %d\n",
+                SetIndex + 1,
+                pAE->PlmSets[SetIndex].Window);
+
+            pAE->DriverState.PlmStep = PLM_STEP_CONFIG;
+            pAE->DriverState.PlmSetExamined++;
+        } else {
+            pAE->DriverState.PlmStep++;
+        }
+    } else {
+        StorPortDebugPrint(INFO,
+            "NVMePlmCompletion: NVM Set %d step %d failed (SCT 0x%x SC 0x%x)\n",
+            SetIndex + 1,
+            pAE->DriverState.PlmStep,
+            pCplEntry->DW3.SF.SCT,
+            pCplEntry->DW3.SF.SC);
+
+        pAE->DriverState.PlmStep = PLM_STEP_CONFIG;
+        pAE->DriverState.PlmSetExamined++;
+    }
+
+    /* Reset the counter and stay here until all NVM Sets are done */
+    pAE->DriverState.StateChkCount = 0;
+    pAE->DriverState.NextDriverState = NVMeWaitOnPlm;
+} /* NVMePlmCompletion */
+
+/*******************************************************************************
+ * NVMeAnaCompletion
+ *
+ * @brief NVMeAnaCompletion gets called to examine the Asymmetric Namespace
+ *        Access log page read at start and record the path state of each
+ *        namespace. ANA reporting is only used once the page could be read;
+ *        otherwise every namespace stays optimized.
+ *
+ * @param pAE - Pointer to hardware device extension.
+ * @param pCplEntry - Pointer to the completion entry
+ *
+ * @return VOID
+ ******************************************************************************/
+VOID NVMeAnaCompletion(
+    PNVME_DEVICE_EXTENSION pAE,
+    PNVMe_COMPLETION_QUEUE_ENTRY pCplEntry
+)
+{
+    if ((pCplEntry->DW3.SF.SC == SUCCESSFUL_COMPLETION) &&
+        (pCplEntry->DW3.SF.SCT == GENERIC_COMMAND_STATUS)) {
+        NVMeAnaUpdateLuns(pAE,
+            (PADMIN_GET_LOG_PAGE_ANA_HEADER)pAE->DriverState.pDataBuffer,
+            PAGE_SIZE);
+        pAE->AnaEnabled = TRUE;
+    } else {
+        StorPortDebugPrint(INFO,
+            "NVMeAnaCompletion: failed (SCT 0x%x SC 0x%x)\n",
+            pCplEntry->DW3.SF.SCT,
+            pCplEntry->DW3.SF.SC);
+    }
+
+    /* Move on to asynchronous event configuration */
+    pAE->DriverState.StateChkCount = 0;
+    pAE->DriverState.NextDriverState = NVMeWaitOnAER;
+} /* NVMeAnaCompletion */
+
+/*******************************************************************************
+ * NVMeAsyncEventConfigCompletion
+ *
+ * @brief NVMeAsyncEventConfigCompletion gets called to examine the completion
+ *        of the Get and Set Features (Asynchronous Event Configuration)
+ *        commands issued by NVMeConfigAsyncEvents. When the current value
+ *        can't be read only the driver's notices are enabled; when they
+ *        can't be set no Asynchronous Event Request is kept outstanding.
+ *
+ * @param pAE - Pointer to hardware device extension.
+ * @param pNVMeCmd - Pointer to the original submission entry
+ * @param pCplEntry - Pointer to the completion entry
+ *
+ * @return VOID
+ ******************************************************************************/
+VOID NVMeAsyncEventConfigCompletion(
+    PNVME_DEVICE_EXTENSION pAE,
+    PNVMe_COMMAND pNVMeCmd,
+    PNVMe_COMPLETION_QUEUE_ENTRY pCplEntry
+)
+{
+    BOOLEAN Success = FALSE;
+
+    if ((pCplEntry->DW3.SF.SC == SUCCESSFUL_COMPLETION) &&
+        (pCplEntry->DW3.SF.SCT == GENERIC_COMMAND_STATUS))
+        Success = TRUE;
+    else
+        StorPortDebugPrint(INFO,
+            "NVMeAsyncEventConfigCompletion: OPC 0x%x failed (SCT 0x%x SC 0x%x)\n",
+            pNVMeCmd->CDW0.OPC,
+            pCplEntry->DW3.SF.SCT,
+            pCplEntry->DW3.SF.SC);
+
+    pAE->DriverState.StateChkCount = 0;
+    if (pNVMeCmd->CDW0.OPC == ADMIN_GET_FEATURES) {
+        /* Set Features is issued next, keeping what was enabled already */
+        pAE->DriverState.AerConfig = (Success == TRUE) ? pCplEntry->DW0 : 0;
+        pAE->DriverState.AerConfigStep = 2;
+        pAE->DriverState.NextDriverState = NVMeWaitOnAER;
+    } else {
+        if (Success == FALSE)
+            pAE->AerNotices = 0;
+
+        /* Move on to queue setup */
+        pAE->DriverState.NextDriverState = NVMeWaitOnSetupQueues;
+    }
+} /* NVMeAsyncEventConfigCompletion */
+
+/*******************************************************************************
+ * NVMeHmbDisableCallback
+ *
+ * @brief NVMeHmbDisableCallback is the completion routine of the Set Features
+ *        command issued by NVMeDisableHmb. Once the controller has let go of
+ *        the buffer it may be reclaimed; on failure the controller reset that
+ *        follows takes it back anyway.
+ *
+ * @param pNVMeDevExt - Pointer to hardware device extension.
+ * @param pSrbExtension - Pointer to the SRB extension of the command
+ *
+ * @return BOOLEAN
+ *     FALSE - there is no SRB to complete
+ ******************************************************************************/
+BOOLEAN NVMeHmbDisableCallback(
+    PVOID pNVMeDevExt,
+    PVOID pSrbExtension
+)
+{
+    PNVME_DEVICE_EXTENSION pAE = (PNVME_DEVICE_EXTENSION)pNVMeDevExt;
+    PNVME_SRB_EXTENSION pSrbExt = (PNVME_SRB_EXTENSION)pSrbExtension;
+    PNVMe_COMPLETION_QUEUE_ENTRY pCplEntry = pSrbExt->pCplEntry;
+
+    if ((pCplEntry->DW3.SF.SC != SUCCESSFUL_COMPLETION) ||
+        (pCplEntry->DW3.SF.SCT != GENERIC_COMMAND_STATUS)) {
+        StorPortDebugPrint(INFO,
+            "NVMeHmbDisableCallback: failed (SCT 0x%x SC 0x%x)\n",
+            pCplEntry->DW3.SF.SCT,
+            pCplEntry->DW3.SF.SC);
+    }
+
+    pAE->HmbEnabled = FALSE;
+
+    return (FALSE);
+} /* NVMeHmbDisableCallback */
+
+/*******************************************************************************
+ * NVMeAerCallback
+ *
+ * @brief NVMeAerCallback is the completion routine of the Asynchronous Event
+ *        Request issued by NVMeIssueAer. The event is acted on by NVMeAerWork
+ *        and the request issued again right away: the controller masks the
+ *        event type until its log page is read, so it can't fire twice. A
+ *        failed request, e.g. one aborted by a reset, isn't reissued here;
+ *        the next start does it.
+ *
+ * @param pNVMeDevExt - Pointer to hardware device extension.
+ * @param pSrbExtension - Pointer to the SRB extension of the command
+ *
+ * @return BOOLEAN
+ *     FALSE - there is no SRB to complete
+ ******************************************************************************/
+BOOLEAN NVMeAerCallback(
+    PVOID pNVMeDevExt,
+    PVOID pSrbExtension
+)
+{
+    PNVME_DEVICE_EXTENSION pAE = (PNVME_DEVICE_EXTENSION)pNVMeDevExt;
+    PNVME_SRB_EXTENSION pSrbExt = (PNVME_SRB_EXTENSION)pSrbExtension;
+    PNVMe_COMPLETION_QUEUE_ENTRY pCplEntry = pSrbExt->pCplEntry;
+    PADMIN_ASYNCHRONOUS_EVENT_REQUEST_COMPLETION_DW0 pEvent =
+        (PADMIN_ASYNCHRONOUS_EVENT_REQUEST_COMPLETION_DW0)&pCplEntry->DW0;
+    BOOLEAN AcquireLock = FALSE;
+
+    if ((pCplEntry->DW3.SF.SC != SUCCESSFUL_COMPLETION) ||
+        (pCplEntry->DW3.SF.SCT != GENERIC_COMMAND_STATUS)) {
+        StorPortDebugPrint(INFO,
+            "NVMeAerCallback: failed (SCT 0x%x SC 0x%x)\n",
+            pCplEntry->DW3.SF.SCT,
+            pCplEntry->DW3.SF.SC);
+        return (FALSE);
+    }
+
+    StorPortDebugPrint(INFO,
+        "NVMeAerCallback: type %d info 0x%x log page 0x%x\n",
+        pEvent->AsynchronousEventType,
+        pEvent->AsynchronousEventInformation,
+        pEvent->AssociatedLogPage);
+
+    if ((pEvent->AsynchronousEventType == ASYNC_EVENT_TYPE_NOTICE) &&
+        (pEvent->AsynchronousEventInformation ==
+            ASYNC_EVENT_NOTICE_NS_ATTRIBUTE_CHANGED)) {
+        InterlockedOr(&pAE->AerWork, AER_WORK_NS_LIST);
+    } else if ((pEvent->AsynchronousEventType == ASYNC_EVENT_TYPE_NOTICE) &&
+               (pEvent->AsynchronousEventInformation ==
+                   ASYNC_EVENT_NOTICE_PLEA_CHANGED)) {
+        InterlockedOr(&pAE->AerWork, AER_WORK_PLM_EVENTS);
+    } else if ((pEvent->AsynchronousEventType == ASYNC_EVENT_TYPE_NOTICE) &&
+               (pEvent->AsynchronousEventInformation ==
+                   ASYNC_EVENT_NOTICE_ANA_CHANGED)) {
+        InterlockedOr(&pAE->AerWork, AER_WORK_ANA_LOG);
+    } else {
+        /* Not one the driver asked for; read its log page to clear it */
+        pAE->AerLogPage = (UCHAR)pEvent->AssociatedLogPage;
+        InterlockedOr(&pAE->AerWork, AER_WORK_CLEAR_LOG);
+    }
+
+    /* The DPC only holds StartIoLock when cores share a queue */
+    AcquireLock = ((pAE->ntldrDump == FALSE) &&
+                   (pAE->MultipleCoresToSingleQueueFlag == FALSE)) ?
+                  TRUE : FALSE;
+
+    if (pAE->DriverState.NextDriverState == NVMeStartComplete)
+        NVMeIssueAer(pAE, AcquireLock);
+
+    NVMeAerWork(pAE, AcquireLock);
+
+    return (FALSE);
+} /* NVMeAerCallback */
+
+/*******************************************************************************
+ * NVMeAerWorkCallback
+ *
+ * @brief NVMeAerWorkCallback is the completion routine of the commands issued
+ *        by NVMeAerWork. The Predictable Latency Event Aggregate log page
+ *        lists the NVM Sets whose log page is to be read next; a set back in
+ *        the Deterministic Window has its log page read again as well. The
+ *        Asymmetric Namespace Access log page updates the path state of the
+ *        namespaces, and the Changed Namespace List starts a rescan of the
+ *        namespaces in it (NVMeRescanCompletion takes the Identify commands
+ *        that follow, NVMeNsSetupCompletion the setup of the namespaces it
+ *        added). Then the next piece of work, if any, is started.
+ *
+ * @param pNVMeDevExt - Pointer to hardware device extension.
+ * @param pSrbExtension - Pointer to the SRB extension of the command
+ *
+ * @return BOOLEAN
+ *     FALSE - there is no SRB to complete
+ ******************************************************************************/
+BOOLEAN NVMeAerWorkCallback(
+    PVOID pNVMeDevExt,
+    PVOID pSrbExtension
+)
+{
+    PNVME_DEVICE_EXTENSION pAE = (PNVME_DEVICE_EXTENSION)pNVMeDevExt;
+    PNVME_SRB_EXTENSION pSrbExt = (PNVME_SRB_EXTENSION)pSrbExtension;
+    PNVMe_COMMAND pNVMeCmd = (PNVMe_COMMAND)(&pSrbExt->nvmeSqeUnit);
+    PNVMe_COMPLETION_QUEUE_ENTRY pCplEntry = pSrbExt->pCplEntry;
+    PADMIN_GET_LOG_PAGE_COMMAND_DW10 pGetLogCDW10 =
+        (PADMIN_GET_LOG_PAGE_COMMAND_DW10)&pNVMeCmd->CDW10;
+    PADMIN_GET_LOG_PAGE_COMMAND_DW11 pGetLogCDW11 =
+        (PADMIN_GET_LOG_PAGE_COMMAND_DW11)&pNVMeCmd->CDW11;
+    PADMIN_IDENTIFY_COMMAND_DW10 pIdentifyCDW10 =
+        (PADMIN_IDENTIFY_COMMAND_DW10)&pNVMeCmd->CDW10;
+    PADMIN_GET_LOG_PAGE_PREDICTABLE_LATENCY_EVENTS pEvents =
+        (PADMIN_GET_LOG_PAGE_PREDICTABLE_LATENCY_EVENTS)pAE->pAerLogBuf;
+    PULONG pNsList = AER_NS_LIST(pAE);
+    ULONG Entries;
+    ULONG i;
+    USHORT SetId;
+    BOOLEAN AcquireLock = FALSE;
+
+    if ((pNVMeCmd->CDW0.OPC == ADMIN_DIRECTIVE_SEND) ||
+        (pNVMeCmd->CDW0.OPC == ADMIN_DIRECTIVE_RECEIVE) ||
+        ((pNVMeCmd->CDW0.OPC == ADMIN_IDENTIFY) &&
+         (pIdentifyCDW10->CNS == IDENTIFY_IO_CMD_SET_NAMESPACE))) {
+        NVMeNsSetupCompletion(pAE, pNVMeCmd, pCplEntry);
+    } else if (pNVMeCmd->CDW0.OPC == ADMIN_IDENTIFY) {
+        NVMeRescanCompletion(pAE, pNVMeCmd, pCplEntry);
+    } else if ((pCplEntry->DW3.SF.SC == SUCCESSFUL_COMPLETION) &&
+               (pCplEntry->DW3.SF.SCT == GENERIC_COMMAND_STATUS)) {
+        if (pNVMeCmd->CDW0.OPC == ADMIN_SET_FEATURES) {
+            /* Back in the Deterministic Window, refresh the set */
+            InterlockedOr(&pAE->PlmReadSets,
+                          (LONG)(1UL << (pNVMeCmd->CDW11 - 1)));
+        } else if (pGetLogCDW10->LID == PREDICTABLE_LATENCY_EVENTS) {
+            Entries = (ULONG)min(pEvents->NumEntries,
+                (PAGE_SIZE - FIELD_OFFSET(
+                    ADMIN_GET_LOG_PAGE_PREDICTABLE_LATENCY_EVENTS, NvmSetId)) /
+                sizeof(USHORT));
+            for (i = 0; i < Entries; i++) {
+                SetId = pEvents->NvmSetId[i];
+                if ((SetId != 0) && (SetId <= pAE->PlmNumSets))
+                    InterlockedOr(&pAE->PlmReadSets,
+                                  (LONG)(1UL << (SetId - 1)));
+            }
+        } else if (pGetLogCDW10->LID == PREDICTABLE_LATENCY_NVM_SET) {
+            NVMePlmUpdateSet(pAE,
+                pGetLogCDW11->LSI - 1,
+                (PADMIN_GET_LOG_PAGE_PREDICTABLE_LATENCY_NVM_SET)
+                pAE->pAerLogBuf);
+        } else if (pGetLogCDW10->LID == ASYMMETRIC_NAMESPACE_ACCESS) {
+            NVMeAnaUpdateLuns(pAE,
+                              (PADMIN_GET_LOG_PAGE_ANA_HEADER)pAE->pAerLogBuf,
+                              PAGE_SIZE);
+        } else if (pGetLogCDW10->LID == CHANGED_NAMESPACE_LIST) {
+            /* Too many changes to list, rescan all active namespaces */
+            pAE->NsRescanNext = 0;
+            if (pNsList[0] == CHANGED_NS_LIST_OVERFLOW)
+                InterlockedOr(&pAE->AerWork, AER_WORK_NS_ACTIVE_LIST);
+            else if (pNsList[0] != 0)
+                InterlockedOr(&pAE->AerWork, AER_WORK_NS_IDENTIFY);
+        }
+    } else {
+        StorPortDebugPrint(INFO,
+            "NVMeAerWorkCallback: OPC 0x%x failed (SCT 0x%x SC 0x%x)\n",
+            pNVMeCmd->CDW0.OPC,
+            pCplEntry->DW3.SF.SCT,
+            pCplEntry->DW3.SF.SC);
+    }
+
+    /* The DPC only holds StartIoLock when cores share a queue */
+    AcquireLock = ((pAE->ntldrDump == FALSE) &&
+                   (pAE->MultipleCoresToSingleQueueFlag == FALSE)) ?
+                  TRUE : FALSE;
+
+    pAE->AerWorkBusy = 0;
+    NVMeAerWork(pAE, AcquireLock);
+
+    return (FALSE);
+} /* NVMeAerWorkCallback */
+
+/*******************************************************************************
+ * NVMeDeleteQueueCallback
+ *
+ * @brief NVMeDeleteQueueCallback is the callback function used to notify
+ *        the caller that a queue deletion has completed
+ *
+ * @param pAE - Pointer to hardware device extension.
+ * @param pSrbExtension - Pointer to the completion entry
+ *
+ * @return BOOLEAN
+ *     TRUE - to indicate we completed fine
+ ******************************************************************************/
+BOOLEAN NVMeDeleteQueueCallback(
+    PVOID pNVMeDevExt,
+    PVOID pSrbExtension
+)
+{
+    PNVME_DEVICE_EXTENSION pAE = (PNVME_DEVICE_EXTENSION)pNVMeDevExt;
+    PNVME_SRB_EXTENSION pSrbExt = (PNVME_SRB_EXTENSION)pSrbExtension;
+    PNVMe_COMMAND pNVMeCmd = (PNVMe_COMMAND)(&pSrbExt->nvmeSqeUnit);
+    PNVMe_COMPLETION_QUEUE_ENTRY pCplEntry = pSrbExt->pCplEntry;
+    PQUEUE_INFO pQI = &pAE->QueueInfo;
+
+    if (pNVMeCmd->CDW0.OPC == ADMIN_DELETE_IO_COMPLETION_QUEUE) {
+        if (pCplEntry->DW3.SF.SC == 0) {
+            PCPL_QUEUE_INFO pCQI = pQI->pCplQueueInfo + pQI->NumCplIoQCreated;
+            /*
+             * Because learning mode doesn't re-allocate mem, we need to
+             * zero out some counters as well as all entries so nothing
+             * is left stale when recreated
+             */
+            pCQI->CurPhaseTag = 0;
+            pCQI->CplQHeadPtr = 0;
+            NVMeClearRing(pCQI->pCplQStart,
+                pCQI->pCplQPages,
+                (pCQI->CplQEntries * sizeof(NVMe_COMPLETION_QUEUE_ENTRY)));
+            pQI->NumCplIoQCreated--;
+        } else {
+            NVMeDriverFatalError(pAE,
+                                (1 << FATAL_CPLQ_DELETE_FAILURE));
+        }
+    } else if (pNVMeCmd->CDW0.OPC == ADMIN_DELETE_IO_SUBMISSION_QUEUE) {
+        if (pCplEntry->DW3.SF.SC == 0) {
+            PSUB_QUEUE_INFO pSQI = pQI->pSubQueueInfo + pQI->NumSubIoQCreated;
+            pSQI->SubQTailPtr = 0;
+            pSQI->SubQHeadPtr = 0;
+            /* we don't recycle SQs w/learning mode but for consistency... */
+            if (pSQI->InCmb == FALSE)
+                NVMeClearRing(pSQI->pSubQStart,
+                    pSQI->pSubQPages,
+                    (pSQI->SubQEntries * sizeof(NVMe_COMMAND)));
+            pQI->NumSubIoQCreated--;
+        } else {
+            NVMeDriverFatalError(pAE,
+                                (1 << FATAL_SUBQ_DELETE_FAILURE));
+        }
+    }
+    return TRUE;
+}
+
+/*******************************************************************************
+ * NVMeInitCallback
+ *
+ * @brief NVMeInitCallback is the callback function used to notify
+ *        Initialization module the completion of the requests, which are
+ *        initiated by driver's initialization module itself. In addition to the
+ *        NVME_DEVICE_EXTENSION, the completion entry are also passed. After
+ *        examining the entry, some resulted information needs to be noted and
+ *        error status needs to be reported if there is any.
+ *
+ * @param pAE - Pointer to hardware device extension.
+ * @param pSrbExtension - Pointer to the completion entry
+ *
+ * @return BOOLEAN
+ *     TRUE - If all resources are allocated and initialized properly
+ *     FALSE - If anything goes wrong
+ ******************************************************************************/
+BOOLEAN NVMeInitCallback(
+    PVOID pNVMeDevExt,
+    PVOID pSrbExtension
+)
+{
+    PNVME_DEVICE_EXTENSION pAE = (PNVME_DEVICE_EXTENSION)pNVMeDevExt;
+    PNVME_SRB_EXTENSION pSrbExt = (PNVME_SRB_EXTENSION)pSrbExtension;
+    PNVMe_COMMAND pNVMeCmd = (PNVMe_COMMAND)(&pSrbExt->nvmeSqeUnit);
+    PNVMe_COMPLETION_QUEUE_ENTRY pCplEntry = pSrbExt->pCplEntry;
+    PQUEUE_INFO pQI = &pAE->QueueInfo;
+	ULONG totalQueuePairs;
+	PRES_MAPPING_TBL pRMT;
+    PULONG pNamespaceId = NULL;
+    ULONG currentNSID = 0;
+    ULONG lunId = INVALID_LUN_EXTN;
+    int i = 0;
+    UCHAR flbas;
+
+    NVMe_CONTROLLER_CAPABILITIES CAP = {0};
+    StorPortDebugPrint(INFO,"NVMeInitCallback: Driver state: %d\n", pAE->DriverState.NextDriverState);
+    switch (pAE->DriverState.NextDriverState) {
+        case NVMeWaitOnIdentifyCtrl:
+            /*
+             * Mark down Controller structure is retrieved if succeeded
+             * Otherwise, log the error bit in case of errors and fail the state
+             * machine.
+             */
+            if ((pCplEntry->DW3.SF.SC == 0) &&
+                (pCplEntry->DW3.SF.SCT == 0)) {
+                ULONG maxXferSize;
+
+                /* Reset the counter */
+                pAE->DriverState.StateChkCount = 0;
+
+                /*
+                 * On a fast resume the namespaces found before the power down
+                 * are kept, unless the controller was swapped or updated
+                 */
+                if ((pAE->DriverState.FastResume == TRUE) &&
+                    (NVMeSameController(pAE,
+                        (PADMIN_IDENTIFY_CONTROLLER)pAE->DriverState.pDataBuffer) == FALSE)) {
+                    StorPortDebugPrint(INFO,
+                        "NVMeInitCallback: controller changed, rescanning namespaces\n");
+                    pAE->DriverState.FastResume = FALSE;
+                    NVMeClearNamespaces(pAE);
+                }
+
+                /* copy over the data from the init state machine temp buffer */
+                StorPortCopyMemory(&pAE->controllerIdentifyData,
+                                pAE->DriverState.pDataBuffer,
+                                sizeof(ADMIN_IDENTIFY_CONTROLLER));
+
+                /* Set next state */
+				if (pAE->DriverState.FastResume == TRUE) {
+					pAE->DriverState.NextDriverState = NVMeWaitOnSetFeatures;
+				}
+				else if (pAE->controllerIdentifyData.OACS.SupportsNamespaceMgmtAndAttachment) {
+					pAE->DriverState.NextDriverState = NVMeWaitOnListAttachedNs;
+				}
+				else {
+					pAE->DriverState.NextDriverState = NVMeWaitOnIdentifyNS;
+					/* Namespaces beyond the LUN slots aren't looked at */
+					pAE->DriverState.NumKnownNamespaces =
+						min(pAE->controllerIdentifyData.NN, pAE->NumLunSlots);
+				}
+
+/* Code Analysis fails on StoPortReadRegisterUlong64 */
+#if 0 // (NTDDI_VERSION > NTDDI_WIN7) && defined(_WIN64)
+                CAP.AsUlonglong = StorPortReadRegisterUlong64(pAE,
+                    (PULONG64)(&pAE->pCtrlRegister->CAP));
+#else
+                CAP.HighPart = StorPortReadRegisterUlong(pAE,
+                    (PULONG)(&pAE->pCtrlRegister->CAP.HighPart));
+                CAP.LowPart = StorPortReadRegisterUlong(pAE,
+                    (PULONG)(&pAE->pCtrlRegister->CAP.LowPart));
+#endif
+
+                /*
+                 * we don't discover the HW xfer limit until after we've reported it
+                 * to storport so if we find out its smaller than what we'rve reported,
+                 * then all we can do is fail init and log and error.  The user will
+                 * have to reconfigure the regsitry and try again
+                  */
+                if (pAE->controllerIdentifyData.MDTS > 0) {
+                    maxXferSize = (1 << pAE->controllerIdentifyData.MDTS) *
+                        (1 << (12 + CAP.MPSMIN)) ;
+                    if (pAE->InitInfo.MaxTxSize > maxXferSize) {
+                        StorPortDebugPrint(INFO, "ERROR: Ctrl reports smaller Max Xfer Sz than INF (0x%x < 0x%x)\n",
+                            maxXferSize, pAE->InitInfo.MaxTxSize);
+                        NVMeDriverFatalError(pAE,
+                                            (1 << START_MAX_XFER_MISMATCH_FAILURE));
+                    }
+                }
+                if (pAE->controllerIdentifyData.NN == 0) {
+                    /* No namespaces so jump to Disabled.  An adapter object will
+                     * be created without any child LUNs.
+                     * In this state, IOCTLs can be processed, but no IO.
+                     */
+                    NVMeDriverFatalError(pAE, 
+                                      ( 1 << START_STATE_IDENTIFY_CTRL_FAILURE)); 
+                    pAE->visibleLuns = 0;
+                }
+            } else {
+                NVMeDriverFatalError(pAE,
+                                    (1 << START_STATE_IDENTIFY_CTRL_FAILURE));
+            }
+        break;
+        case NVMeWaitOnListAttachedNs:
+            /*
+             * Save list of attached namespaces if succeed.
+			 * If command fails because of unknown opcode, most
+			 * likely drive does not support namespace management.
+             * Otherwise, log the error bit in case of errors and
+             * fail the state machine
+             */
+            if ((pCplEntry->DW3.SF.SC == SUCCESSFUL_COMPLETION) &&
+                (pCplEntry->DW3.SF.SCT == GENERIC_COMMAND_STATUS)) {
+
+                pNamespaceId = (PULONG) pAE->DriverState.pDataBuffer;
+                for (i = 0; i < MAX_NUMBER_OF_NAMESPACES; i++) {
+                    currentNSID = (ULONG)*pNamespaceId;
+
+                    /*
+                     * A value of 0 NSID indicates end of list of namespaces,
+                     * namespaces beyond the LUN slots are left out
+                     */
+                    if ((currentNSID == 0) ||
+                        (pAE->DriverState.NumKnownNamespaces >= pAE->NumLunSlots)) {
+                        break;
+                    }
+
+                    /* found a new NSID */
+                    lunId = pAE->DriverState.NumKnownNamespaces;
+                    pAE->pLunExtensionTable[lunId]->namespaceId = currentNSID;
+                    pAE->pLunExtensionTable[lunId]->nsStatus = ATTACHED;
+                    pAE->DriverState.NumKnownNamespaces++;
+                    pNamespaceId++;
+                }
+                /* Move to the next state: list all existing namespace(s) */
+                pAE->DriverState.NextDriverState = NVMeWaitOnListExistingNs;
+            } else {
+                NVMeDriverFatalError(pAE,
+                                    (1 << START_STATE_LIST_ATTACHED_NS_FAILURE));
+            }
+        break;
+        case NVMeWaitOnListExistingNs:
+            /*
+             * Save list of unattached namespaces if succeed.
+             * Otherwise, log the error bit in case of errors and
+             * fail the state machine
+             */
+            if ((pCplEntry->DW3.SF.SC == SUCCESSFUL_COMPLETION) &&
+                (pCplEntry->DW3.SF.SCT == GENERIC_COMMAND_STATUS)) {
+
+                pNamespaceId = (PULONG) pAE->DriverState.pDataBuffer;
+                for (i = 0; i < MAX_NUMBER_OF_NAMESPACES; i++) {
+                    currentNSID = (ULONG)*pNamespaceId;
+
+                    /*
+                     * A value of 0 NSID indicates end of list of namespaces,
+                     * namespaces beyond the LUN slots are left out
+                     */
+                    if ((currentNSID == 0) ||
+                        (pAE->DriverState.NumKnownNamespaces >= pAE->NumLunSlots)) {
+                        break;
+                    }
+
+                    if (INVALID == NVMeGetNamespaceStatusAndSlot(pAE, currentNSID, &lunId)) {
+                        /* found a new NSID */
+                        lunId = pAE->DriverState.NumKnownNamespaces;
+                        pAE->pLunExtensionTable[lunId]->namespaceId = currentNSID;
+                        pAE->pLunExtensionTable[lunId]->nsStatus = INACTIVE;
+                        pAE->DriverState.NumKnownNamespaces++;
+                    }
+                    pNamespaceId++;
+                }
+                /* Move to the next state: identify namespace(s) */
+                pAE->DriverState.NextDriverState = NVMeWaitOnIdentifyNS;
+            } else {
+                NVMeDriverFatalError(pAE,
+                                    (1 << START_STATE_LIST_EXISTING_NS_FAILURE));
+            }
+        break;
+        case NVMeWaitOnIdentifyNS:
+            /*
+             * Mark down Namespace structure is retrieved if succeeded
+             * Otherwise, log the error bit in case of errors and
+             * fail the state machine
+             */
+            if ((pCplEntry->DW3.SF.SC == 0) &&
+                (pCplEntry->DW3.SF.SCT == 0)) {
+                PNVME_LUN_EXTENSION pLunExt = NULL;
+				if (pAE->controllerIdentifyData.OACS.SupportsNamespaceMgmtAndAttachment)
+					pLunExt = pAE->pLunExtensionTable[pAE->DriverState.IdentifyNamespaceFetched];
+				else
+                    pLunExt = pAE->pLunExtensionTable[pAE->DriverState.VisibleNamespacesExamined];
+
+                pAE->DriverState.IdentifyNamespaceFetched++;
+
+                /* Reset the counter and set next state */
+                pAE->DriverState.StateChkCount = 0;
+
+                /* Move to the next state to set features for this namespace */
+                pAE->DriverState.NextDriverState = NVMeWaitOnSetFeatures;
+
+                /* copy over the data from the init state machine temp buffer */
+                StorPortCopyMemory(&pLunExt->identifyData,
+                                pAE->DriverState.pDataBuffer,
+                                sizeof(ADMIN_IDENTIFY_NAMESPACE));
+                /* Mark down the Namespace ID */
+                /* 
+                 * If capable of namespace mgmt, we already should have saved NSID
+                 * Otherwise, mark down the Namespace ID here 
+                 */
+                if (!pAE->controllerIdentifyData.OACS.SupportsNamespaceMgmtAndAttachment)
+                    pLunExt->namespaceId =
+                        pAE->DriverState.IdentifyNamespaceFetched;
+
+                /* Note next Namespace ID to fetch Namespace structure */
+                /* for use in the LBA range type commands we need this info */
+                pAE->DriverState.CurrentNsid = pLunExt->namespaceId;
+
+            } else {
+                /*
+                 * In case of supporting non-contiguous NSID and the inactive NSIDs, 
+                 * move onto next NSID until it hits the value of NN of 
+                 * Identify Controller structure.
+                 */
+                if ((pCplEntry->DW3.SF.SC == INVALID_NAMESPACE_OR_FORMAT) &&
+                    (pCplEntry->DW3.SF.SCT == 0) &&
+                    (pAE->DriverState.CurrentNsid < pAE->controllerIdentifyData.NN)) {
+                    pAE->DriverState.CurrentNsid++;
+
+                    /* Reset the counter */
+                    pAE->DriverState.StateChkCount = 0;
+
+                    /* Stay in this state to fetch next namespace structure */
+                    pAE->DriverState.NextDriverState = NVMeWaitOnIdentifyNS;
+                } else {
+                    NVMeDriverFatalError(pAE,
+                                    (1 << START_STATE_IDENTIFY_NS_FAILURE));
+                }
+            }
+        break;
+        case NVMeWaitOnSetFeatures:
+            NVMeSetFeaturesCompletion(pAE, pNVMeCmd, pCplEntry);
+        break;
+        case NVMeWaitOnZoned:
+            NVMeZonedCompletion(pAE, pCplEntry);
+        break;
+        case NVMeWaitOnStreams:
+            NVMeStreamsCompletion(pAE, pNVMeCmd, pCplEntry);
+        break;
+        case NVMeWaitOnHmb:
+            NVMeHmbCompletion(pAE, pCplEntry);
+        break;
+        case NVMeWaitOnDoorbellBuffer:
+            NVMeDoorbellBufferCompletion(pAE, pCplEntry);
+        break;
+        case NVMeWaitOnApst:
+            NVMeApstCompletion(pAE, pCplEntry);
+        break;
+        case NVMeWaitOnPlm:
+            NVMePlmCompletion(pAE, pCplEntry);
+        break;
+        case NVMeWaitOnAna:
+            NVMeAnaCompletion(pAE, pCplEntry);
+        break;
+        case NVMeWaitOnAER:
+            NVMeAsyncEventConfigCompletion(pAE, pNVMeCmd, pCplEntry);
+        break;
+        case NVMeWaitOnIoCQ:
+            /*
+             * Mark down the number of created completion queues if succeeded
+             * Otherwise, log the error bit in case of errors and
+             * fail the state machine
+             */
+
+            if ((pCplEntry->DW3.SF.SC == 0) &&
+                (pCplEntry->DW3.SF.SCT == 0)) {
+                pQI->NumCplIoQCreated++;
+
+                /* Reset the counter and set next state */
+                pAE->DriverState.StateChkCount = 0;
+                if (pQI->NumCplIoQAllocated == pQI->NumCplIoQCreated) {
+                    pAE->DriverState.QueueCreatesIssued = 0;
+                    pAE->DriverState.NextDriverState = NVMeWaitOnIoSQ;
+                } else {
+                    pAE->DriverState.NextDriverState = NVMeWaitOnIoCQ;
+                }
+            } else {
+                NVMeDriverFatalError(pAE,
+                                    (1 << START_STATE_CPLQ_CREATE_FAILURE));
+            }
+        break;
+        case NVMeWaitOnIoSQ:
+            /*
+             * Mark down the number of created submission queues if succeeded
+             * Otherwise, log the error bit in case of errors and
+             * fail the state machine
+             */
+            if ((pCplEntry->DW3.SF.SC == 0) &&
+                (pCplEntry->DW3.SF.SCT == 0)) {
+                PRES_MAPPING_TBL pRMT = &pAE->ResMapTbl;
+                pQI->NumSubIoQCreated++;
+
+                /* Reset the counter and set next state */
+                pAE->DriverState.StateChkCount = 0;
+                if (pQI->NumSubIoQAllocated == pQI->NumSubIoQCreated) {
+                    pAE->DriverState.QueueCreatesIssued = 0;
+                    /* if we've learned the cores we're done */
+                    if (pAE->LearningCores < pRMT->NumActiveCores) {
+                        pAE->DriverState.NextDriverState = NVMeWaitOnLearnMapping;
+                    } else {
+						/*In crash/Hibernate mode, NVMeWaitOnNamespaceReady state is skipped*/
+						if ((pAE->ntldrDump == TRUE) ||
+							(pAE->DriverState.AllNamespacesAreReady)) {
+							pAE->DriverState.NextDriverState = NVMeStartComplete;							
+						} else {
+							pAE->DriverState.NextDriverState = NVMeWaitOnNamespaceReady;
+						}                        
+                    }
+                } else {
+                    pAE->DriverState.NextDriverState = NVMeWaitOnIoSQ;
+                }
+            } else {
+                NVMeDriverFatalError(pAE,
+                                    (1 << START_STATE_SUBQ_CREATE_FAILURE));
+            }
+        break;
+        case NVMeWaitOnLearnMapping:
+
+				pRMT = &pAE->ResMapTbl;
+                
+
+                /*
+                 * see if we still have more core/vector mapping to learn
+                 * or if we're ready to redo the queues based on the new map
+                 */
+                pAE->DriverState.StateChkCount = 0;
+                totalQueuePairs = min(pAE->QueueInfo.NumCplIoQAllocFromAdapter,
+                                      pAE->QueueInfo.NumSubIoQAllocFromAdapter);
+                if (pAE->LearningCores < totalQueuePairs) {
+                    pAE->DriverState.NextDriverState = NVMeWaitOnLearnMapping;
+                } else {
+                    PRES_MAPPING_TBL pRMT = &pAE->ResMapTbl;
+                    PCORE_TBL pCT = NULL;
+                    ULONG CoreIndex;
+
+                    pAE->LearningCores = pAE->ResMapTbl.NumActiveCores;
+
+                    /*
+                     * At this point, learning mode should have mapped all 
+                     * queues and MSI vectors.  The counter will be equal to 
+                     * number of MSI and also equal to the number of total
+                     * queue pairs.  If not, it means there was a problem during
+                     * learning mode, so we should go to shared mode.
+                     */
+                    if ((pAE->QueueInfo.NumIoQMapped < pRMT->NumMsiMsgGranted) ||
+                        (pAE->QueueInfo.NumIoQMapped < (totalQueuePairs+1))) {
+                            ASSERT(FALSE);
+                            StorPortDebugPrint(INFO, 
+                                "Number of IO Queues mapped not equal to MSI, going to Shared mode\n");
+
+                            pRMT->pMsiMsgTbl->Shared = TRUE;
+                            pAE->DriverState.NextDriverState = NVMeStartComplete;
+
+                    } else if (NVMeMsiMapVerify(pAE) == FALSE) {
+                            StorPortDebugPrint(INFO, 
+                                "Learned mapping is inconsistent, going to Shared mode\n");
+
+                            pRMT->pMsiMsgTbl->Shared = TRUE;
+                            pAE->DriverState.NextDriverState = NVMeStartComplete;
+
+                    } else {
+
+#if DBG
+                        /* print out the learned table */
+                        StorPortDebugPrint(INFO, "Learning Complete.  Core Table:\n");
+                        for (CoreIndex = 0; CoreIndex < pRMT->NumActiveCores; CoreIndex++) {
+                            pCT = pRMT->pCoreTbl + CoreIndex;
+                            StorPortDebugPrint(INFO,
+                                               "\tCore(0x%x) MSID(0x%x) QueuePair(0x%x)\n",
+                                               CoreIndex,
+                                               pCT->MsiMsgID,
+                                               pCT->SubQueue);
+
+                        }
+
+                        pAE->LearningComplete = TRUE;
+#endif
+                        /*
+                         * Learning is done. Any additional cores not assigned to
+                         * queues will be assigned in the start complete state.
+                         */
+
+                        pAE->DriverState.NextDriverState = NVMeWaitOnReSetupQueues;
+                    }
+                }
+
+        break;
+        case NVMeWaitOnReSetupQueues:
+            if (TRUE == NVMeDeleteQueueCallback(pAE, pSrbExt)) {
+                /* if we've deleted the last CQ, we rae ready to recreate them */
+                if (0 == pQI->NumCplIoQCreated) {
+                    pAE->DriverState.QueueCreatesIssued = 0;
+                    pAE->DriverState.NextDriverState = NVMeWaitOnIoCQ;
+                } else {
+                    pAE->DriverState.NextDriverState = NVMeWaitOnReSetupQueues;
+                }
+            }
+        break;
+		case NVMeWaitOnNamespaceReady:
+			if ((pCplEntry->DW3.SF.SC == NAMESPACE_NOT_READY) &&
+				(pCplEntry->DW3.SF.SCT == 0)) {
+				pAE->DriverState.NextDriverState = NVMeWaitOnNamespaceReady;
+			}
+			else {
+				/* The command has completed succesfully, namespace should be ready */
+				pAE->pLunExtensionTable[pAE->DriverState.NextNamespaceToCheckForReady]->nsReady = TRUE;
+				pAE->DriverState.NextNamespaceToCheckForReady++;
+				/* We need to ensure all namespaces are ready in case of multiple namespaces */
+				if (pAE->DriverState.NextNamespaceToCheckForReady < pAE->DriverState.NumKnownNamespaces) {
+					pAE->DriverState.NextDriverState = NVMeWaitOnNamespaceReady;
+				}
+				else {
+					pAE->DriverState.AllNamespacesAreReady = TRUE;
+					pAE->DriverState.NextDriverState = NVMeStartComplete;
+				}				
+			}
+			/* free the read buffer for namespaceready */
+			if ((pAE->ntldrDump == FALSE) && (NULL != pSrbExt->pDataBuffer)) {
+			        StorPortFreePool((PVOID)pAE, pSrbExt->pDataBuffer);
+					pSrbExt->pDataBuffer = NULL;
+				}
+			break;
+        case NVMeStartComplete:
+            ASSERT(pAE->ntldrDump);
+        break;
+        default:
+            NVMeDriverFatalError(pAE,
+                                (1 << START_STATE_UNKNOWN_STATE_FAILURE));
+        break;
+    } /* end switch */
+
+    NVMeCallArbiter(pAE);
+
+    return (TRUE);
+} /* NVMeInitCallback */
+
+/*******************************************************************************
+ * NVMePreparePRPs
+ *
+ * @brief NVMePreparePRPs is a helper routine to prepare PRP entries
+ *        for initialization routines and ioctl requests.
+ *
+ * @param pAE - Pointer to hardware device extension.
+ * @param pSrbExt - Pointer to Srb Extension
+ * @param pBuffer - Pointer to the transferring buffer.
+ * @param TxLength - Data transfer size in bytes.
+ *
+ * @return BOOLEAN
+ *     TRUE - If the PRP conversion completed without any errors
+ *     FALSE - If anything goes wrong
+ ******************************************************************************/
+BOOLEAN NVMePreparePRPs(
+    PNVME_DEVICE_EXTENSION pAE,
+    PNVME_SRB_EXTENSION pSrbExt,
+    PVOID pBuffer,
+    ULONG TxLength
+)
+{
+    PNVMe_COMMAND pSubEntry = &pSrbExt->nvmeSqeUnit;
+    STOR_PHYSICAL_ADDRESS PhyAddr;
+    ULONG_PTR PtrTemp = 0;
+    ULONG RoomInFirstPage = 0;
+    ULONG RemainLength = TxLength;
+    PUINT64 pPrpList = NULL;
+
+    if (pBuffer == NULL || TxLength == 0)
+        return (FALSE);
+
+    /* Go ahead and prepare 1st PRP entries, need at least one PRP entry */
+    PhyAddr = NVMeGetPhysAddr(pAE, pBuffer);
+    if (PhyAddr.QuadPart == 0)
+        return (FALSE);
+
+    pSubEntry->PRP1 = PhyAddr.QuadPart;
+    pSrbExt->numberOfPrpEntries = 1;
+    /*
+     * Find out how much room still available in current page.
+     * If it's enough, only PRP1 is needed.
+     */
+    RoomInFirstPage = PAGE_SIZE - (PhyAddr.QuadPart & (PAGE_SIZE - 1));
+    if ( RoomInFirstPage >= TxLength )
+        return (TRUE);
+    else
+        RemainLength -= RoomInFirstPage;
+
+    PtrTemp = (ULONG_PTR)((PUCHAR)pBuffer);
+    PtrTemp = PAGE_ALIGN_BUF_ADDR(PtrTemp);
+    /*
+     * With the remaining transfer size, either use PRP2 as another PRP entry or
+     * a pointer to the pre-allocated PRP list
+     */
+    if (RemainLength > PAGE_SIZE) {
+        pPrpList = &pSrbExt->prpList[0];
+        pSubEntry->PRP2 = 0;
+    } else {
+        /* Use PRP2 as 2nd PRP entry and return */
+        PhyAddr = NVMeGetPhysAddr(pAE, (PVOID)PtrTemp);
+        if (PhyAddr.QuadPart == 0)
+            return (FALSE);
+        pSubEntry->PRP2 = PhyAddr.QuadPart;
+        pSrbExt->numberOfPrpEntries++;
+        return (TRUE);
+    }
+    /* 
+     * Convert data buffer pages into PRP entries while
+     * decreasing remaining transfer size and noting the # of PRP entries used
+     */
+    while (RemainLength) {
+        PhyAddr = NVMeGetPhysAddr(pAE, (PVOID)PtrTemp);
+        if (PhyAddr.QuadPart == 0)
+            return (FALSE);
+        *pPrpList = (UINT64) PhyAddr.QuadPart;
+        pSrbExt->numberOfPrpEntries++;
+        /* When remaining size is no larger than a page, it's the last entry */
+        if (RemainLength <= PAGE_SIZE)
+            break;
+        pPrpList++;
+        RemainLength -= PAGE_SIZE;
+        PtrTemp += PAGE_SIZE;
+    }
+
+    return (TRUE);
+}
+
+/*******************************************************************************
+ * NVMeSetIntCoalescing
+ *
+ * @brief NVMeSetIntCoalescing gets called to configure interrupt coalescing
+ *        with the values fetched from Registry via Set Features command with
+ *        Feature ID#8.
+ *
+ * @param pAE - Pointer to hardware device extension.
+ *
+ * @return BOOLEAN
+ *     TRUE - If the issued command completed without any errors
+ *     FALSE - If anything goes wrong
+ ******************************************************************************/
+BOOLEAN NVMeSetIntCoalescing(
+    PNVME_DEVICE_EXTENSION pAE
+)
+{
+    PNVME_SRB_EXTENSION pNVMeSrbExt =
+        (PNVME_SRB_EXTENSION)pAE->DriverState.pSrbExt;
+    PNVMe_COMMAND pSetFeatures = (PNVMe_COMMAND)(&pNVMeSrbExt->nvmeSqeUnit);
+
+    PADMIN_SET_FEATURES_COMMAND_DW10 pSetFeaturesCDW10 = NULL;
+    PADMIN_SET_FEATURES_COMMAND_INTERRUPT_COALESCING_DW11
+        pSetFeaturesCDW11 = NULL;
+
+    /* Zero out the extension first */
+    memset((PVOID)pNVMeSrbExt, 0, sizeof(NVME_SRB_EXTENSION));
+
+    /* Populate SRB_EXTENSION fields */
+    pNVMeSrbExt->pNvmeDevExt = pAE;
+    pNVMeSrbExt->pNvmeCompletionRoutine = NVMeInitCallback;
+
+    /* Populate submission entry fields */
+    pSetFeatures->CDW0.OPC = ADMIN_SET_FEATURES;
+    pSetFeaturesCDW10 = (PADMIN_SET_FEATURES_COMMAND_DW10) &pSetFeatures->CDW10;
+    pSetFeaturesCDW11 = (PADMIN_SET_FEATURES_COMMAND_INTERRUPT_COALESCING_DW11)
+        &pSetFeatures->CDW11;
+
+    pSetFeaturesCDW10->FID = INTERRUPT_COALESCING;
+
+    /* Set up the Aggregation Time and Threshold */
+    pSetFeaturesCDW11->TIME = pAE->InitInfo.IntCoalescingTime;
+    pSetFeaturesCDW11->THR = pAE->InitInfo.IntCoalescingEntry;
+
+    /* Now issue the command via Admin Doorbell register */
+    return ProcessIo(pAE, pNVMeSrbExt, NVME_QUEUE_TYPE_ADMIN, FALSE);
+} /* NVMeSetIntCoalescing */
+
+/*******************************************************************************
+ * NVMeAllocQueueFromAdapter
+ *
+ * @brief NVMeAllocQueueFromAdapter gets called to allocate
+ *        submission/completion queues from the adapter via Set Feature command
+ *        with Feature ID#7. This routine requests the same number of
+ *        submission/completion queues as the number of current active cores in
+ *        the system.
+ *
+ * @param pAE - Pointer to hardware device extension.
+ *
+ * @return BOOLEAN
+ *     TRUE - If the issued command completed without any errors
+ *     FALSE - If anything goes wrong
+ ******************************************************************************/
+BOOLEAN NVMeAllocQueueFromAdapter(
+    PNVME_DEVICE_EXTENSION pAE
+)
+{
+    PNVME_SRB_EXTENSION pNVMeSrbExt =
+        (PNVME_SRB_EXTENSION)pAE->DriverState.pSrbExt;
+    PNVMe_COMMAND pSetFeatures = (PNVMe_COMMAND)(&pNVMeSrbExt->nvmeSqeUnit);
+    PADMIN_SET_FEATURES_COMMAND_DW10 pSetFeaturesCDW10 = NULL;
+    PADMIN_SET_FEATURES_COMMAND_NUMBER_OF_QUEUES_DW11 pSetFeaturesCDW11 = NULL;
+
+    /* Zero out the extension first */
+    memset((PVOID)pNVMeSrbExt, 0, sizeof(NVME_SRB_EXTENSION));
+
+    /* Populate SRB_EXTENSION fields */
+    pNVMeSrbExt->pNvmeDevExt = pAE;
+    pNVMeSrbExt->pNvmeCompletionRoutine = NVMeInitCallback;
+
+    /* Populate submission entry fields */
+    pSetFeatures->CDW0.OPC = ADMIN_SET_FEATURES;
+    pSetFeaturesCDW10 = (PADMIN_SET_FEATURES_COMMAND_DW10) &pSetFeatures->CDW10;
+    pSetFeaturesCDW11 = (PADMIN_SET_FEATURES_COMMAND_NUMBER_OF_QUEUES_DW11)
+        &pSetFeatures->CDW11;
+    pSetFeaturesCDW10->FID = NUMBER_OF_QUEUES;
+
+    /* Set up NCSQR and NSQR, which are 0-based. */
+    if (pAE->ntldrDump == TRUE) {
+        /* In crashdump/hibernation case, only 1 pair of IO queue needed */
+        pSetFeaturesCDW11->NCQR = 0;
+        pSetFeaturesCDW11->NSQR = 0;
+    } else {
+        /*
+         * Number of cores, number of MSI granted, and number of queues
+         * supported by the controller are the variables to determine how
+         * many queues to create.
+         */
+        pSetFeaturesCDW11->NCQR = min(pAE->ResMapTbl.NumActiveCores,
+                                      pAE->ResMapTbl.NumMsiMsgGranted) - 1;
+        pSetFeaturesCDW11->NSQR = min(pAE->ResMapTbl.NumActiveCores,
+                                      pAE->ResMapTbl.NumMsiMsgGranted) - 1;    }
+
+    /* Now issue the command via Admin Doorbell register */
+    return ProcessIo(pAE, pNVMeSrbExt, NVME_QUEUE_TYPE_ADMIN, FALSE);
+} /* NVMeAllocQueueFromAdapter */
+
+/*******************************************************************************
+ * NVMeAccessLbaRangeEntry
+ *
+ * @brief NVMeAccessLbaRangeEntry gets called to query/update the first LBA
+ *        Range entry of a given namespace. The procedure is described below:
+ *
+ *        Depending on the value of ConfigLbaRangeNeeded, if TRUE, it issues
+ *        Set Features command. Otherwise, it issues Get Features commands.
+ *
+ *        When issuing Set Features, the namespace has:
+ *          Type = Filesystem,
+ *          ReadOnly = FALSE,
+ *          Visible = TRUE.
+ *
+ *        When command completes, NVMeSetFeaturesCompletion is called to exam
+ *        the LBA Range Type entries and wrap up the access.
+ *
+ * @param pAE - Pointer to hardware device extension.
+ *
+ * @return BOOLEAN
+ *     TRUE - If the issued command completed without any errors
+ *     FALSE - If anything goes wrong
+ ******************************************************************************/
+BOOLEAN NVMeAccessLbaRangeEntry(
+    PNVME_DEVICE_EXTENSION pAE
+)
+{
+    PNVME_SRB_EXTENSION pNVMeSrbExt =
+        (PNVME_SRB_EXTENSION)pAE->DriverState.pSrbExt;
+    PNVMe_COMMAND pSetFeatures = (PNVMe_COMMAND)(&pNVMeSrbExt->nvmeSqeUnit);
+    PADMIN_SET_FEATURES_COMMAND_DW10 pSetFeaturesCDW10 = NULL;
+    PADMIN_SET_FEATURES_COMMAND_LBA_RANGE_TYPE_ENTRY pLbaRangeEntry = NULL;
+    ULONG NSID = pAE->DriverState.CurrentNsid;
+    BOOLEAN Query = pAE->DriverState.ConfigLbaRangeNeeded;
+
+    /* 
+     * if not capable of namespace mgmt...
+     * Fail here if Namespace ID is 0 or out of range 
+     */
+    if ((!pAE->controllerIdentifyData.OACS.SupportsNamespaceMgmtAndAttachment) &&
+		(NSID == 0 || NSID > pAE->DriverState.NumKnownNamespaces))
+        return FALSE;
+
+    /* Zero out the extension first */
+    memset((PVOID)pNVMeSrbExt, 0, sizeof(NVME_SRB_EXTENSION));
+
+    /* Populate SRB_EXTENSION fields */
+    pNVMeSrbExt->pNvmeDevExt = pAE;
+    pNVMeSrbExt->pNvmeCompletionRoutine = NVMeInitCallback;
+
+    /* Populate submission entry fields */
+    pSetFeatures->NSID = NSID;
+
+    /*
+     * Prepare the buffer for transferring LBA Range entries
+     * Need to zero the buffer out first when retrieving the entries
+     */
+    if (pAE->DriverState.ConfigLbaRangeNeeded == TRUE) {
+        pSetFeatures->CDW0.OPC = ADMIN_SET_FEATURES;
+
+        /* Prepare new first LBA Range entry */
+        pLbaRangeEntry = (PADMIN_SET_FEATURES_COMMAND_LBA_RANGE_TYPE_ENTRY)
+            pAE->DriverState.pDataBuffer;
+        pLbaRangeEntry->Type = LBA_TYPE_FILESYSTEM;
+        pLbaRangeEntry->Attributes.Overwriteable = 1;
+        pLbaRangeEntry->Attributes.Hidden = 0;
+        pLbaRangeEntry->NLB = pAE->pLunExtensionTable[NSID-1]->identifyData.NSZE;
+    } else {
+        pSetFeatures->CDW0.OPC = ADMIN_GET_FEATURES;
+        memset(pAE->DriverState.pDataBuffer, 0, PAGE_SIZE);
+    }
+
+    /* Prepare PRP entries, need at least one PRP entry */
+    if (NVMePreparePRPs(pAE,
+                        pNVMeSrbExt,
+                        pAE->DriverState.pDataBuffer,
+                        sizeof(ADMIN_SET_FEATURES_LBA_COMMAND_RANGE_TYPE_ENTRY))
+                        == FALSE) {
+        return (FALSE);
+    }
+
+    pSetFeaturesCDW10 = (PADMIN_SET_FEATURES_COMMAND_DW10) &pSetFeatures->CDW10;
+    pSetFeaturesCDW10->FID = LBA_RANGE_TYPE;
+
+    /* Now issue the command via Admin Doorbell register */
+    return ProcessIo(pAE, pNVMeSrbExt, NVME_QUEUE_TYPE_ADMIN, FALSE);
+} /* NVMeAccessLbaRangeEntry */
+
+/*******************************************************************************
+ * NVMeIdentifyZoned
+ *
+ * @brief NVMeIdentifyZoned gets called to fetch the Zoned Namespace Command Set
+ *        specific Identify Namespace data (CNS 05h, CSI 02h) of a namespace,
+ *        by the init state machine and for namespaces added at runtime.
+ *
+ * @param pAE - Pointer to hardware device extension
+ * @param pNVMeSrbExt - SRB extension to issue the command with
+ * @param pCompletion - Completion routine of the command
+ * @param pLunExt - Pointer to the LUN extension of the namespace
+ * @param pBuffer - Page the data is returned in
+ * @param AcquireLock - if the caller needs the StartIO lock acquired or not
+ *
+ * @return BOOLEAN
+ *     Returns TRUE if the command was issued, otherwise, FALSE.
+ ******************************************************************************/
+BOOLEAN NVMeIdentifyZoned(
+    PNVME_DEVICE_EXTENSION pAE,
+    PNVME_SRB_EXTENSION pNVMeSrbExt,
+    PNVME_COMPLETION_ROUTINE pCompletion,
+    PNVME_LUN_EXTENSION pLunExt,
+    PVOID pBuffer,
+    BOOLEAN AcquireLock
+)
+{
+    PNVMe_COMMAND pIdentify = (PNVMe_COMMAND)(&pNVMeSrbExt->nvmeSqeUnit);
+    PADMIN_IDENTIFY_COMMAND_DW10 pIdentifyCDW10 = NULL;
+    PADMIN_IDENTIFY_COMMAND_DW11 pIdentifyCDW11 = NULL;
+
+    /* Zero out the extension first */
+    memset((PVOID)pNVMeSrbExt, 0, sizeof(NVME_SRB_EXTENSION));
+
+    /* Populate SRB_EXTENSION fields */
+    pNVMeSrbExt->pNvmeDevExt = pAE;
+    pNVMeSrbExt->pNvmeCompletionRoutine = pCompletion;
+
+    /* Populate submission entry fields */
+    pIdentify->CDW0.OPC = ADMIN_IDENTIFY;
+    pIdentify->NSID = pLunExt->namespaceId;
+
+    if (NVMePreparePRPs(pAE,
+                        pNVMeSrbExt,
+                        pBuffer,
+                        sizeof(ADMIN_IDENTIFY_ZNS_NAMESPACE)) == FALSE) {
+        return (FALSE);
+    }
+
+    pIdentifyCDW10 = (PADMIN_IDENTIFY_COMMAND_DW10)&pIdentify->CDW10;
+    pIdentifyCDW10->CNS = IDENTIFY_IO_CMD_SET_NAMESPACE;
+    pIdentifyCDW11 = (PADMIN_IDENTIFY_COMMAND_DW11)&pIdentify->CDW11;
+    pIdentifyCDW11->CSI = NVME_CSI_ZNS;
+
+    /* Now issue the command via Admin Doorbell register */
+    return ProcessIo(pAE, pNVMeSrbExt, NVME_QUEUE_TYPE_ADMIN, AcquireLock);
+} /* NVMeIdentifyZoned */
+
+/*******************************************************************************
+ * NVMeConfigureStreams
+ *
+ * @brief NVMeConfigureStreams gets called to set up the write streams of a
+ *        namespace, one step per call: first Directive Send to enable the
+ *        Streams directive for the namespace, then Directive Receive to
+ *        allocate InitInfo.Streams streams to it.
+ *
+ * @param pAE - Pointer to hardware device extension
+ * @param pNVMeSrbExt - SRB extension to issue the command with
+ * @param pCompletion - Completion routine of the command
+ * @param pLunExt - Pointer to the LUN extension of the namespace
+ * @param Allocate - FALSE for the enable step, TRUE for the allocation
+ * @param AcquireLock - if the caller needs the StartIO lock acquired or not
+ *
+ * @return BOOLEAN
+ *     Returns TRUE if the command was issued, otherwise, FALSE.
+ ******************************************************************************/
+BOOLEAN NVMeConfigureStreams(
+    PNVME_DEVICE_EXTENSION pAE,
+    PNVME_SRB_EXTENSION pNVMeSrbExt,
+    PNVME_COMPLETION_ROUTINE pCompletion,
+    PNVME_LUN_EXTENSION pLunExt,
+    BOOLEAN Allocate,
+    BOOLEAN AcquireLock
+)
+{
+    PNVMe_COMMAND pDirective = (PNVMe_COMMAND)(&pNVMeSrbExt->nvmeSqeUnit);
+    PADMIN_DIRECTIVE_DW11 pDirectiveCDW11 = NULL;
+    PADMIN_DIRECTIVE_ENABLE_DW12 pEnableCDW12 = NULL;
+
+    /* Zero out the extension first */
+    memset((PVOID)pNVMeSrbExt, 0, sizeof(NVME_SRB_EXTENSION));
+
+    /* Populate SRB_EXTENSION fields */
+    pNVMeSrbExt->pNvmeDevExt = pAE;
+    pNVMeSrbExt->pNvmeCompletionRoutine = pCompletion;
+
+    /* Populate submission entry fields, neither command transfers data */
+    pDirective->NSID = pLunExt->namespaceId;
+    pDirectiveCDW11 = (PADMIN_DIRECTIVE_DW11)&pDirective->CDW11;
+
+    if (Allocate == FALSE) {
+        pDirective->CDW0.OPC = ADMIN_DIRECTIVE_SEND;
+        pDirectiveCDW11->DTYPE = DIRECTIVE_TYPE_IDENTIFY;
+        pDirectiveCDW11->DOPER = DIRECTIVE_IDENTIFY_ENABLE;
+
+        pEnableCDW12 = (PADMIN_DIRECTIVE_ENABLE_DW12)&pDirective->CDW12;
+        pEnableCDW12->ENDIR = 1;
+        pEnableCDW12->TDTYPE = DIRECTIVE_TYPE_STREAMS;
+    } else {
+        pDirective->CDW0.OPC = ADMIN_DIRECTIVE_RECEIVE;
+        pDirectiveCDW11->DTYPE = DIRECTIVE_TYPE_STREAMS;
+        pDirectiveCDW11->DOPER = DIRECTIVE_STREAMS_ALLOCATE_RESOURCES;
+        pDirective->CDW12 = pAE->InitInfo.Streams;
+    }
+
+    /* Now issue the command via Admin Doorbell register */
+    return ProcessIo(pAE, pNVMeSrbExt, NVME_QUEUE_TYPE_ADMIN, AcquireLock);
+} /* NVMeConfigureStreams */
+
+/*******************************************************************************
+ * NVMeAllocHmb
+ *
+ * @brief NVMeAllocHmb gets called to allocate the Host Memory Buffer when the
+ *        controller asks for one. The buffer is sized to the controller's
+ *        preferred size (HMPRE) capped by the HmbMaxSize registry value and
+ *        built of physically contiguous chunks from the NUMA node of the
+ *        admin queue, described by a descriptor list. Memory allocated on an
+ *        earlier start is reused as is.
+ *
+ * @param pAE - Pointer to hardware device extension
+ *
+ * @return BOOLEAN
+ *     TRUE - The buffer is at least the controller's minimum size (HMMIN)
+ *     FALSE - If anything goes wrong
+ ******************************************************************************/
+BOOLEAN NVMeAllocHmb(
+    PNVME_DEVICE_EXTENSION pAE
+)
+{
+    PADMIN_IDENTIFY_CONTROLLER pCtrl = &pAE->controllerIdentifyData;
+    PSUB_QUEUE_INFO pSQI = pAE->QueueInfo.pSubQueueInfo;
+    STOR_PHYSICAL_ADDRESS PhyAddr = {0};
+    ULONGLONG PrefBytes = (ULONGLONG)pCtrl->HMPRE * (4 * 1024);
+    ULONGLONG MinBytes = (ULONGLONG)pCtrl->HMMIN * (4 * 1024);
+    ULONGLONG MinChunk = (ULONGLONG)pCtrl->HMMINDS * (4 * 1024);
+    ULONGLONG Bytes = 0;
+    ULONG MaxChunks = HMB_MAX_DESCRIPTORS;
+    ULONG Chunk = 0;
+
+    if (pAE->pHmbDescList != NULL)
+        return (TRUE);
+
+    Bytes = min(PrefBytes, (ULONGLONG)pAE->InitInfo.HmbMaxSize * 1024 * 1024);
+    if ((Bytes == 0) || (Bytes < MinBytes))
+        return (FALSE);
+
+    /* Honor the controller's smallest chunk and most chunks it can take */
+    pAE->HmbChunkSize = HMB_CHUNK_SIZE;
+    if (MinChunk > pAE->HmbChunkSize) {
+        if (MinChunk > Bytes)
+            return (FALSE);
+        pAE->HmbChunkSize = (ULONG)MinChunk;
+    }
+    if ((pCtrl->HMMAXD != 0) && (pCtrl->HMMAXD < MaxChunks))
+        MaxChunks = pCtrl->HMMAXD;
+
+    pAE->pHmbDescList = (PNVMe_HMB_DESCRIPTOR)
+        NVMeAllocateMem(pAE, PAGE_SIZE, pSQI->NumaNode);
+    if (pAE->pHmbDescList == NULL)
+        return (FALSE);
+    pAE->HmbDescListPhys = NVMeGetPhysAddr(pAE, pAE->pHmbDescList);
+
+    /* Take whatever the node can give, the minimum decides if it's enough */
+    pAE->HmbNumChunks = 0;
+    while (((ULONGLONG)pAE->HmbNumChunks * pAE->HmbChunkSize < Bytes) &&
+           (pAE->HmbNumChunks < MaxChunks)) {
+        Chunk = pAE->HmbNumChunks;
+        pAE->pHmbChunk[Chunk] = NVMeAllocateMem(pAE,
+                                                pAE->HmbChunkSize,
+                                                pSQI->NumaNode);
+        if (pAE->pHmbChunk[Chunk] == NULL)
+            break;
+
+        PhyAddr = NVMeGetPhysAddr(pAE, pAE->pHmbChunk[Chunk]);
+        pAE->pHmbDescList[Chunk].BADD = PhyAddr.QuadPart;
+        pAE->pHmbDescList[Chunk].BSIZE = pAE->HmbChunkSize / PAGE_SIZE;
+        pAE->HmbNumChunks++;
+    }
+
+    if ((pAE->HmbNumChunks == 0) ||
+        ((ULONGLONG)pAE->HmbNumChunks * pAE->HmbChunkSize < MinBytes)) {
+        StorPortDebugPrint(WARNING,
+            "NVMeAllocHmb: only %d chunks allocated\n", pAE->HmbNumChunks);
+        NVMeFreeHmb(pAE);
+        return (FALSE);
+    }
+
+    return (TRUE);
+} /* NVMeAllocHmb */
+
+/*******************************************************************************
+ * NVMeSetHmb
+ *
+ * @brief NVMeSetHmb gets called to issue Set Features (Host Memory Buffer) to
+ *        hand the allocated buffer to the controller, or to take it back.
+ *        Memory the controller had before is returned with MR set since its
+ *        contents are left untouched while the controller doesn't own it.
+ *
+ * @param pAE - Pointer to hardware device extension
+ * @param Enable - TRUE to enable the buffer, FALSE to disable it
+ *
+ * @return BOOLEAN
+ *     Returns TRUE if the command was issued, otherwise, FALSE.
+ ******************************************************************************/
+BOOLEAN NVMeSetHmb(
+    PNVME_DEVICE_EXTENSION pAE,
+    BOOLEAN Enable
+)
+{
+    PNVME_SRB_EXTENSION pNVMeSrbExt =
+        (PNVME_SRB_EXTENSION)pAE->DriverState.pSrbExt;
+    PNVMe_COMMAND pSetFeatures = (PNVMe_COMMAND)(&pNVMeSrbExt->nvmeSqeUnit);
+    PADMIN_SET_FEATURES_COMMAND_DW10 pSetFeaturesCDW10 = NULL;
+    PADMIN_SET_FEATURES_COMMAND_HOST_MEMORY_BUFFER_DW11
+        pSetFeaturesCDW11 = NULL;
+
+    /* Zero out the extension first */
+    memset((PVOID)pNVMeSrbExt, 0, sizeof(NVME_SRB_EXTENSION));
+
+    /* Populate SRB_EXTENSION fields */
+    pNVMeSrbExt->pNvmeDevExt = pAE;
+    pNVMeSrbExt->pNvmeCompletionRoutine =
+        (Enable == TRUE) ? NVMeInitCallback : NVMeHmbDisableCallback;
+
+    /* Populate submission entry fields */
+    pSetFeatures->CDW0.OPC = ADMIN_SET_FEATURES;
+    pSetFeaturesCDW10 = (PADMIN_SET_FEATURES_COMMAND_DW10) &pSetFeatures->CDW10;
+    pSetFeaturesCDW11 = (PADMIN_SET_FEATURES_COMMAND_HOST_MEMORY_BUFFER_DW11)
+        &pSetFeatures->CDW11;
+
+    pSetFeaturesCDW10->FID = HOST_MEMORY_BUFFER;
+
+    if (Enable == TRUE) {
+        pSetFeaturesCDW11->EHM = 1;
+        pSetFeaturesCDW11->MR = (pAE->HmbReturned == TRUE) ? 1 : 0;
+        pSetFeatures->CDW12 =
+            pAE->HmbNumChunks * (pAE->HmbChunkSize / PAGE_SIZE);
+        pSetFeatures->CDW13 = pAE->HmbDescListPhys.LowPart;
+        pSetFeatures->CDW14 = pAE->HmbDescListPhys.HighPart;
+        pSetFeatures->CDW15 = pAE->HmbNumChunks;
+    }
+
+    /* Now issue the command via Admin Doorbell register */
+    return ProcessIo(pAE, pNVMeSrbExt, NVME_QUEUE_TYPE_ADMIN, FALSE);
+} /* NVMeSetHmb */
+
+/*******************************************************************************
+ * NVMeDisableHmb
+ *
+ * @brief NVMeDisableHmb gets called before the controller is shut down or
+ *        reset for a power transition to take the Host Memory Buffer back
+ *        while the controller can still flush what it keeps there. The
+ *        command is polled for, like the polled restart does, since the
+ *        callers don't return until the controller is stopped.
+ *
+ * @param pAE - Pointer to hardware device extension
+ *
+ * @return VOID
+ ******************************************************************************/
+VOID NVMeDisableHmb(
+    PNVME_DEVICE_EXTENSION pAE
+)
+{
+    ULONG PollMax = pAE->uSecCrtlTimeout / MAX_STATE_STALL_us;
+    ULONG PollCount;
+    BOOLEAN polledResetInProg = pAE->polledResetInProg;
+
+    if ((pAE->HmbEnabled == FALSE) ||
+        (pAE->DriverState.NextDriverState != NVMeStartComplete))
+        return;
+
+    /* Keep the ISR from queuing the completion DPC while polling */
+    pAE->polledResetInProg = TRUE;
+
+    if (NVMeSetHmb(pAE, FALSE) == TRUE) {
+        for (PollCount = 0; PollCount < PollMax; PollCount++) {
+            IoCompletionRoutine(NULL, pAE, (PVOID)0, 0);
+            if (pAE->HmbEnabled == FALSE)
+                break;
+
+            NVMeStallExecution(pAE, MAX_STATE_STALL_us);
+        }
+    }
+
+    pAE->polledResetInProg = polledResetInProg;
+
+    StorPortDebugPrint(INFO,
+                       "NVMeDisableHmb: HMB %s\n",
+                       (pAE->HmbEnabled == FALSE) ? "disabled" : "timed out");
+} /* NVMeDisableHmb */
+
+/*******************************************************************************
+ * NVMeFreeHmb
+ *
+ * @brief NVMeFreeHmb gets called to free the Host Memory Buffer chunks and
+ *        descriptor list. The controller must not own the buffer anymore.
+ *
+ * @param pAE - Pointer to hardware device extension
+ *
+ * @return VOID
+ ******************************************************************************/
+VOID NVMeFreeHmb(
+    PNVME_DEVICE_EXTENSION pAE
+)
+{
+    ULONG Chunk;
+
+    for (Chunk = 0; Chunk < pAE->HmbNumChunks; Chunk++) {
+        StorPortFreeContiguousMemorySpecifyCache((PVOID)pAE,
+                                                 pAE->pHmbChunk[Chunk],
+                                                 pAE->HmbChunkSize,
+                                                 MmCached);
+        pAE->pHmbChunk[Chunk] = NULL;
+    }
+    pAE->HmbNumChunks = 0;
+
+    if (pAE->pHmbDescList != NULL) {
+        StorPortFreeContiguousMemorySpecifyCache((PVOID)pAE,
+                                                 pAE->pHmbDescList,
+                                                 PAGE_SIZE,
+                                                 MmCached);
+        pAE->pHmbDescList = NULL;
+    }
+    pAE->HmbReturned = FALSE;
+} /* NVMeFreeHmb */
+
+/*******************************************************************************
+ * NVMeConfigDoorbellBuffer
+ *
+ * @brief NVMeConfigDoorbellBuffer gets called to register the shadow doorbell
+ *        and EventIdx pages with the controller via Doorbell Buffer Config.
+ *        The pages are allocated on the first start and cleared on each one
+ *        since the IO queues are created again from scratch.
+ *
+ * @param pAE - Pointer to hardware device extension
+ *
+ * @return BOOLEAN
+ *     Returns TRUE if the command was issued, otherwise, FALSE.
+ ******************************************************************************/
+BOOLEAN NVMeConfigDoorbellBuffer(
+    PNVME_DEVICE_EXTENSION pAE
+)
+{
+    PNVME_SRB_EXTENSION pNVMeSrbExt =
+        (PNVME_SRB_EXTENSION)pAE->DriverState.pSrbExt;
+    PNVMe_COMMAND pDbbuf = (PNVMe_COMMAND)(&pNVMeSrbExt->nvmeSqeUnit);
+    PSUB_QUEUE_INFO pSQI = pAE->QueueInfo.pSubQueueInfo;
+
+    if (pAE->pShadowDoorbells == NULL) {
+        pAE->pShadowDoorbells = (PULONG)NVMeAllocateMem(pAE,
+                                                        PAGE_SIZE,
+                                                        pSQI->NumaNode);
+        if (pAE->pShadowDoorbells == NULL)
+            return (FALSE);
+        pAE->ShadowDoorbellsPhys =
+            NVMeGetPhysAddr(pAE, pAE->pShadowDoorbells);
+    }
+
+    if (pAE->pEventIdx == NULL) {
+        pAE->pEventIdx = (PULONG)NVMeAllocateMem(pAE,
+                                                 PAGE_SIZE,
+                                                 pSQI->NumaNode);
+        if (pAE->pEventIdx == NULL)
+            return (FALSE);
+        pAE->EventIdxPhys = NVMeGetPhysAddr(pAE, pAE->pEventIdx);
+    }
+
+    memset(pAE->pShadowDoorbells, 0, PAGE_SIZE);
+    memset(pAE->pEventIdx, 0, PAGE_SIZE);
+
+    /* Zero out the extension first */
+    memset((PVOID)pNVMeSrbExt, 0, sizeof(NVME_SRB_EXTENSION));
+
+    /* Populate SRB_EXTENSION fields */
+    pNVMeSrbExt->pNvmeDevExt = pAE;
+    pNVMeSrbExt->pNvmeCompletionRoutine = NVMeInitCallback;
+
+    /* Populate submission entry fields */
+    pDbbuf->CDW0.OPC = ADMIN_DOORBELL_BUFFER_CONFIG;
+    pDbbuf->PRP1 = pAE->ShadowDoorbellsPhys.QuadPart;
+    pDbbuf->PRP2 = pAE->EventIdxPhys.QuadPart;
+
+    /* Now issue the command via Admin Doorbell register */
+    return ProcessIo(pAE, pNVMeSrbExt, NVME_QUEUE_TYPE_ADMIN, FALSE);
+} /* NVMeConfigDoorbellBuffer */
+
+/*******************************************************************************
+ * NVMeInitShadowDoorbell
+ *
+ * @brief NVMeInitShadowDoorbell gets called before an IO queue is created to
+ *        locate and clear its entries in the shadow doorbell and EventIdx
+ *        pages. Both are left NULL, meaning the doorbell register is rung
+ *        directly, when shadow doorbells are not enabled or the entry falls
+ *        outside the pages.
+ *
+ * @param pAE - Pointer to hardware device extension
+ * @param DbIndex - Doorbell index, 2 * QID for SQ tail, 2 * QID + 1 for CQ head
+ * @param ppShadow - Returns the shadow doorbell entry
+ * @param ppEventIdx - Returns the EventIdx entry
+ *
+ * @return VOID
+ ******************************************************************************/
+VOID NVMeInitShadowDoorbell(
+    PNVME_DEVICE_EXTENSION pAE,
+    ULONG DbIndex,
+    PULONG *ppShadow,
+    PULONG *ppEventIdx
+)
+{
+    /* Entries are spaced like the doorbell registers themselves */
+    ULONG Offset = DbIndex * (pAE->strideSz / sizeof(ULONG));
+
+    *ppShadow = NULL;
+    *ppEventIdx = NULL;
+
+    if ((pAE->DoorbellBufferEnabled == FALSE) ||
+        (((Offset + 1) * sizeof(ULONG)) > PAGE_SIZE))
+        return;
+
+    pAE->pShadowDoorbells[Offset] = 0;
+    pAE->pEventIdx[Offset] = 0;
+    *ppShadow = &pAE->pShadowDoorbells[Offset];
+    *ppEventIdx = &pAE->pEventIdx[Offset];
+} /* NVMeInitShadowDoorbell */
+
+/*******************************************************************************
+ * NVMeGetLogPage
+ *
+ * @brief NVMeGetLogPage gets called to issue Get Log Page for the first Size
+ *        bytes of a log page. RAE is left cleared so reading the page also
+ *        clears the asynchronous event that reported it.
+ *
+ * @param pAE - Pointer to hardware device extension
+ * @param pNVMeSrbExt - SRB extension to issue the command with
+ * @param pCompletion - Completion routine of the command
+ * @param LID - Log Page Identifier
+ * @param LSP - Log Specific Field
+ * @param LSI - Log Specific Identifier, the NVM Set for per set pages
+ * @param pBuffer - Buffer the page is returned in
+ * @param Size - Bytes to read, a multiple of 4
+ * @param AcquireLock - if the caller needs the StartIO lock acquired or not
+ *
+ * @return BOOLEAN
+ *     Returns TRUE if the command was issued, otherwise, FALSE.
+ ******************************************************************************/
+BOOLEAN NVMeGetLogPage(
+    PNVME_DEVICE_EXTENSION pAE,
+    PNVME_SRB_EXTENSION pNVMeSrbExt,
+    PNVME_COMPLETION_ROUTINE pCompletion,
+    UCHAR LID,
+    UCHAR LSP,
+    USHORT LSI,
+    PVOID pBuffer,
+    ULONG Size,
+    BOOLEAN AcquireLock
+)
+{
+    PNVMe_COMMAND pGetLog = (PNVMe_COMMAND)(&pNVMeSrbExt->nvmeSqeUnit);
+    PADMIN_GET_LOG_PAGE_COMMAND_DW10 pGetLogCDW10 = NULL;
+    PADMIN_GET_LOG_PAGE_COMMAND_DW11 pGetLogCDW11 = NULL;
+
+    /* Zero out the extension first */
+    memset((PVOID)pNVMeSrbExt, 0, sizeof(NVME_SRB_EXTENSION));
+
+    /* Populate SRB_EXTENSION fields */
+    pNVMeSrbExt->pNvmeDevExt = pAE;
+    pNVMeSrbExt->pNvmeCompletionRoutine = pCompletion;
+
+    if (NVMePreparePRPs(pAE, pNVMeSrbExt, pBuffer, Size) == FALSE)
+        return (FALSE);
+
+    /* Populate submission entry fields */
+    pGetLog->CDW0.OPC = ADMIN_GET_LOG_PAGE;
+    pGetLog->NSID = ALL_NAMESPACES_APPLIED;
+    pGetLogCDW10 = (PADMIN_GET_LOG_PAGE_COMMAND_DW10)&pGetLog->CDW10;
+    pGetLogCDW10->LID = LID;
+    pGetLogCDW10->LSP = LSP;
+    pGetLogCDW10->NUMD = (Size / sizeof(ULONG)) - 1;
+    pGetLogCDW11 = (PADMIN_GET_LOG_PAGE_COMMAND_DW11)&pGetLog->CDW11;
+    pGetLogCDW11->LSI = LSI;
+
+    /* Now issue the command via Admin Doorbell register */
+    return ProcessIo(pAE, pNVMeSrbExt, NVME_QUEUE_TYPE_ADMIN, AcquireLock);
+} /* NVMeGetLogPage */
+
+/*******************************************************************************
+ * NVMeIssueIdentify
+ *
+ * @brief NVMeIssueIdentify gets called to issue an Identify command once the
+ *        controller is running, with a completion routine of the caller's
+ *        choice (NVMeGetIdentifyStructures is tied to the init state
+ *        machine).
+ *
+ * @param pAE - Pointer to hardware device extension
+ * @param pNVMeSrbExt - SRB extension to issue the command with
+ * @param pCompletion - Completion routine of the command
+ * @param Nsid - Namespace Identifier
+ * @param CNS - Controller or Namespace Structure
+ * @param pBuffer - Page the data is returned in
+ * @param AcquireLock - if the caller needs the StartIO lock acquired or not
+ *
+ * @return BOOLEAN
+ *     Returns TRUE if the command was issued, otherwise, FALSE.
+ ******************************************************************************/
+BOOLEAN NVMeIssueIdentify(
+    PNVME_DEVICE_EXTENSION pAE,
+    PNVME_SRB_EXTENSION pNVMeSrbExt,
+    PNVME_COMPLETION_ROUTINE pCompletion,
+    ULONG Nsid,
+    UCHAR CNS,
+    PVOID pBuffer,
+    BOOLEAN AcquireLock
+)
+{
+    PNVMe_COMMAND pIdentify = (PNVMe_COMMAND)(&pNVMeSrbExt->nvmeSqeUnit);
+    PADMIN_IDENTIFY_COMMAND_DW10 pIdentifyCDW10 = NULL;
+
+    /* Zero out the extension first */
+    memset((PVOID)pNVMeSrbExt, 0, sizeof(NVME_SRB_EXTENSION));
+
+    /* Populate SRB_EXTENSION fields */
+    pNVMeSrbExt->pNvmeDevExt = pAE;
+    pNVMeSrbExt->pNvmeCompletionRoutine = pCompletion;
+
+    /* Every Identify data structure is 4KB */
+    if (NVMePreparePRPs(pAE, pNVMeSrbExt, pBuffer, IDENTIFY_LIST_SIZE) == FALSE)
+        return (FALSE);
+
+    /* Populate submission entry fields */
+    pIdentify->CDW0.OPC = ADMIN_IDENTIFY;
+    pIdentify->NSID = Nsid;
+    pIdentifyCDW10 = (PADMIN_IDENTIFY_COMMAND_DW10)&pIdentify->CDW10;
+    pIdentifyCDW10->CNS = CNS;
+
+    /* Now issue the command via Admin Doorbell register */
+    return ProcessIo(pAE, pNVMeSrbExt, NVME_QUEUE_TYPE_ADMIN, AcquireLock);
+} /* NVMeIssueIdentify */
+
+/*******************************************************************************
+ * NVMeSetPlmFeature
+ *
+ * @brief NVMeSetPlmFeature gets called to issue Set Features for one of the
+ *        Predictable Latency Mode features of an NVM Set: Config enables the
+ *        mode with notices for both ways of leaving the Deterministic Window,
+ *        Window selects the Deterministic Window.
+ *
+ * @param pAE - Pointer to hardware device extension
+ * @param pNVMeSrbExt - SRB extension to issue the command with
+ * @param pCompletion - Completion routine of the command
+ * @param FID - PREDICTABLE_LATENCY_MODE_CONFIG or _WINDOW
+ * @param SetId - NVM Set Identifier
+ * @param pBuffer - Page the Config data is built in
+ * @param AcquireLock - if the caller needs the StartIO lock acquired or not
+ *
+ * @return BOOLEAN
+ *     Returns TRUE if the command was issued, otherwise, FALSE.
+ ******************************************************************************/
+BOOLEAN NVMeSetPlmFeature(
+    PNVME_DEVICE_EXTENSION pAE,
+    PNVME_SRB_EXTENSION pNVMeSrbExt,
+    PNVME_COMPLETION_ROUTINE pCompletion,
+    UCHAR FID,
+    USHORT SetId,
+    PVOID pBuffer,
+    BOOLEAN AcquireLock
+)
+{
+    PNVMe_COMMAND pSetFeatures = (PNVMe_COMMAND)(&pNVMeSrbExt->nvmeSqeUnit);
+    PADMIN_SET_FEATURES_COMMAND_DW10 pSetFeaturesCDW10 = NULL;
+    PNVMe_PLM_CONFIG pConfig = (PNVMe_PLM_CONFIG)pBuffer;
+
+    /* Zero out the extension first */
+    memset((PVOID)pNVMeSrbExt, 0, sizeof(NVME_SRB_EXTENSION));
+
+    /* Populate SRB_EXTENSION fields */
+    pNVMeSrbExt->pNvmeDevExt = pAE;
+    pNVMeSrbExt->pNvmeCompletionRoutine = pCompletion;
+
+    if (FID == PREDICTABLE_LATENCY_MODE_CONFIG) {
+        memset(pBuffer, 0, sizeof(NVMe_PLM_CONFIG));
+        pConfig->EnableEvent = PLM_EVENT_DTWIN_EXCEEDED |
+                               PLM_EVENT_AUTONOMOUS_TRANSITION;
+
+        if (NVMePreparePRPs(pAE,
+                            pNVMeSrbExt,
+                            pBuffer,
+                            sizeof(NVMe_PLM_CONFIG)) == FALSE) {
+            return (FALSE);
+        }
+
+        pSetFeatures->CDW12 = PLM_CONFIG_LPE;
+    } else {
+        pSetFeatures->CDW12 = PLM_WSEL_DETERMINISTIC;
+    }
+
+    /* Populate submission entry fields */
+    pSetFeatures->CDW0.OPC = ADMIN_SET_FEATURES;
+    pSetFeaturesCDW10 = (PADMIN_SET_FEATURES_COMMAND_DW10)&pSetFeatures->CDW10;
+    pSetFeaturesCDW10->FID = FID;
+    pSetFeatures->CDW11 = SetId;
+
+    /* Now issue the command via Admin Doorbell register */
+    return ProcessIo(pAE, pNVMeSrbExt, NVME_QUEUE_TYPE_ADMIN, AcquireLock);
+} /* NVMeSetPlmFeature */
+
+/*******************************************************************************
+ * NVMeConfigurePlm
+ *
+ * @brief NVMeConfigurePlm gets called to put the current NVM Set in
+ *        Predictable Latency Mode, one step per call: Set Features (Config)
+ *        to enable the mode and its events, Set Features (Window) to start
+ *        in the Deterministic Window and Get Log Page to read its state.
+ *
+ * @param pAE - Pointer to hardware device extension
+ *
+ * @return BOOLEAN
+ *     Returns TRUE if the command was issued, otherwise, FALSE.
+ ******************************************************************************/
+BOOLEAN NVMeConfigurePlm(
+    PNVME_DEVICE_EXTENSION pAE
+)
+{
+    PNVME_SRB_EXTENSION pNVMeSrbExt =
+        (PNVME_SRB_EXTENSION)pAE->DriverState.pSrbExt;
+    USHORT SetId = (USHORT)(pAE->DriverState.PlmSetExamined + 1);
+
+    switch (pAE->DriverState.PlmStep) {
+        case PLM_STEP_CONFIG:
+            return NVMeSetPlmFeature(pAE,
+                                     pNVMeSrbExt,
+                                     NVMeInitCallback,
+                                     PREDICTABLE_LATENCY_MODE_CONFIG,
+                                     SetId,
+                                     pAE->DriverState.pDataBuffer,
+                                     FALSE);
+        case PLM_STEP_WINDOW:
+            return NVMeSetPlmFeature(pAE,
+                                     pNVMeSrbExt,
+                                     NVMeInitCallback,
+                                     PREDICTABLE_LATENCY_MODE_WINDOW,
+                                     SetId,
+                                     pAE->DriverState.pDataBuffer,
+                                     FALSE);
+        default:
+            return NVMeGetLogPage(pAE,
+                pNVMeSrbExt,
+                NVMeInitCallback,
+                PREDICTABLE_LATENCY_NVM_SET,
+                0,
+                SetId,
+                pAE->DriverState.pDataBuffer,
+                sizeof(ADMIN_GET_LOG_PAGE_PREDICTABLE_LATENCY_NVM_SET),
+                FALSE);
+    }
+} /* NVMeConfigurePlm */
+
+/*******************************************************************************
+ * NVMePlmUpdateSet
+ *
+ * @brief NVMePlmUpdateSet gets called with the Predictable Latency Per NVM
+ *        Set log page of a set to record its window and estimates. A window
+ *        change is counted unless the set wasn't tracked yet.
+ *
+ * @param pAE - Pointer to hardware device extension
+ * @param SetIndex - Index of the set in PlmSets, its identifier minus 1
+ * @param pLog - The log page read
+ *
+ * @return VOID
+ ******************************************************************************/
+VOID NVMePlmUpdateSet(
+    PNVME_DEVICE_EXTENSION pAE,
+    ULONG SetIndex,
+    PADMIN_GET_LOG_PAGE_PREDICTABLE_LATENCY_NVM_SET pLog
+)
+{
+    PPLM_SET_INFO pSet = NULL;
+    UCHAR Window = pLog->Status & PLM_WINDOW_MASK;
+
+    if (SetIndex >= PLM_MAX_NVM_SETS)
+        return;
+
+    pSet = &pAE->PlmSets[SetIndex];
+    if (Window != pSet->Window) {
+        if (pSet->Window != PLM_WINDOW_NOT_ENABLED)
+            pSet->Transitions++;
+        pSet->Window = Window;
+        pSet->WindowMs = 0;
+    }
+
+    pSet->NdwinMinMs = (ULONG)min(pLog->NdwinTimeMinimumLow, MAXULONG);
+    pSet->DtwinReadsEstimate = pLog->DtwinReadsEstimate;
+    pSet->DtwinWritesEstimate = pLog->DtwinWritesEstimate;
+    pSet->DtwinTimeEstimate = pLog->DtwinTimeEstimate;
+} /* NVMePlmUpdateSet */
+
+/*******************************************************************************
+ * NVMePlmTick
+ *
+ * @brief NVMePlmTick gets called once a second by the surprise removal timer.
+ *        The controller leaves the Deterministic Window on its own but only
+ *        returns on request, so sets that have spent the minimum time in the
+ *        Non-Deterministic Window are asked back. Without Predictable Latency
+ *        event notices each set's log page is simply read every tick. The
+ *        timer then calls NVMeAerWork to issue the commands.
+ *
+ * @param pAE - Pointer to hardware device extension
+ * @param Ms - Time since the last call
+ *
+ * @return VOID
+ ******************************************************************************/
+VOID NVMePlmTick(
+    PNVME_DEVICE_EXTENSION pAE,
+    ULONG Ms
+)
+{
+    PPLM_SET_INFO pSet = NULL;
+    ULONG i;
+
+    if (pAE->PlmEnabled == FALSE)
+        return;
+
+    for (i = 0; i < pAE->PlmNumSets; i++) {
+        pSet = &pAE->PlmSets[i];
+        if (pSet->Window == PLM_WINDOW_NOT_ENABLED)
+            continue;
+
+        if (pSet->WindowMs < (MAXULONG - Ms))
+            pSet->WindowMs += Ms;
+
+        if ((pSet->Window == PLM_WINDOW_NON_DETERMINISTIC) &&
+            (pSet->WindowMs >= pSet->NdwinMinMs))
+            InterlockedOr(&pAE->PlmDtwinSets, (LONG)(1UL << i));
+        else if ((pAE->AerNotices & OAES_PLEA_CHANGE_NOTICES) == 0)
+            InterlockedOr(&pAE->PlmReadSets, (LONG)(1UL << i));
+    }
+} /* NVMePlmTick */
+
+/*******************************************************************************
+ * NVMeAnaUpdateLuns
+ *
+ * @brief NVMeAnaUpdateLuns gets called with the Asymmetric Namespace Access
+ *        log page, read with Return Groups Only, to record the state of each
+ *        ANA Group on the namespaces that belong to it. A namespace whose
+ *        state changed gets a unit attention (SntiCheckUnitAttention) so the
+ *        multipath layer asks for the new port group states.
+ *
+ * @param pAE - Pointer to hardware device extension
+ * @param pLog - The log page read
+ * @param Size - Bytes of the log page read
+ *
+ * @return VOID
+ ******************************************************************************/
+VOID NVMeAnaUpdateLuns(
+    PNVME_DEVICE_EXTENSION pAE,
+    PADMIN_GET_LOG_PAGE_ANA_HEADER pLog,
+    ULONG Size
+)
+{
+    PADMIN_GET_LOG_PAGE_ANA_DESCRIPTOR pDesc = NULL;
+    PNVME_LUN_EXTENSION pLunExt = NULL;
+    ULONG Offset = sizeof(ADMIN_GET_LOG_PAGE_ANA_HEADER);
+    ULONG DescSize;
+    ULONG i;
+    ULONG lunId;
+    UCHAR State;
+
+    for (i = 0; i < pLog->NumDescriptors; i++) {
+        DescSize = FIELD_OFFSET(ADMIN_GET_LOG_PAGE_ANA_DESCRIPTOR, Nsid);
+        if ((Size - Offset) < DescSize)
+            break;
+
+        pDesc = (PADMIN_GET_LOG_PAGE_ANA_DESCRIPTOR)((PUCHAR)pLog + Offset);
+        State = pDesc->State & ANA_STATE_MASK;
+
+        for (lunId = 0; lunId < pAE->NumLunSlots; lunId++) {
+            pLunExt = pAE->pLunExtensionTable[lunId];
+            if ((pLunExt->slotStatus != ONLINE) ||
+                (pLunExt->identifyData.ANAGRPID != pDesc->AnaGroupId) ||
+                (pLunExt->anaState == State))
+                continue;
+
+            StorPortDebugPrint(INFO,
+                "NVMeAnaUpdateLuns: NSID 0x%x group %d state %d -> %d\n",
+                pLunExt->namespaceId,
+                pDesc->AnaGroupId,
+                pLunExt->anaState,
+                State);
+
+            if (pLunExt->anaState != 0)
+                InterlockedOr(&pLunExt->unitAttention, LUN_UA_ANA_CHANGED);
+            pLunExt->anaState = State;
+        }
+
+        /* The NSID list, if any, follows the descriptor */
+        DescSize += pDesc->NumNsids * sizeof(ULONG);
+        if ((Size - Offset) < DescSize)
+            break;
+        Offset += DescSize;
+    }
+} /* NVMeAnaUpdateLuns */
+
+/*******************************************************************************
+ * NVMeRescanNamespace
+ *
+ * @brief NVMeRescanNamespace gets called with the Identify Namespace data of
+ *        a namespace reported changed, NULL once the namespace no longer
+ *        exists, to bring its LUN in line while IO to the others goes on:
+ *
+ *        - a namespace that went away, or has no capacity any more (it was
+ *          detached), takes its LUN offline the way the Namespace Attachment
+ *          and Management IOCTLs do
+ *        - a LUN still online gets the new data, and a capacity change unit
+ *          attention if the size changed
+ *        - a new namespace, or one attached again, gets a free slot; it is
+ *          brought online straight away, or by NVMeNsSetupCompletion once
+ *          NVMeAerWork has set up its zones and streams
+ *
+ *        Slots that IOCTLs took offline (format, detach, delete) are left to
+ *        them. BusChangeDetected is reported at the end of the rescan. The
+ *        caller holds StartIoLock, StartIo reads the same LUN extensions.
+ *
+ * @param pAE - Pointer to hardware device extension
+ * @param Nsid - Namespace Identifier
+ * @param pNsData - Identify Namespace data, NULL for an invalid namespace
+ *
+ * @return VOID
+ ******************************************************************************/
+VOID NVMeRescanNamespace(
+    PNVME_DEVICE_EXTENSION pAE,
+    ULONG Nsid,
+    PADMIN_IDENTIFY_NAMESPACE pNsData
+)
+{
+    PNVME_LUN_EXTENSION pLunExt = NULL;
+    ULONG lunId = INVALID_LUN_EXTN;
+
+    NVMeGetNamespaceStatusAndSlot(pAE, Nsid, &lunId);
+    if (lunId != INVALID_LUN_EXTN) {
+        pLunExt = pAE->pLunExtensionTable[lunId];
+        if (pLunExt->slotStatus == OFFLINE)
+            return;
+    }
+
+    if ((pNsData == NULL) || (pNsData->NCAP == 0)) {
+        if (pLunExt == NULL)
+            return;
+
+        StorPortDebugPrint(INFO,
+            "NVMeRescanNamespace: NSID 0x%x lun %d removed\n", Nsid, lunId);
+
+        if (pLunExt->slotStatus == ONLINE) {
+            pAE->visibleLuns--;
+            pAE->NsRescanBusChange = TRUE;
+        }
+
+        /* Keep track of a detached namespace, it may be attached again */
+        if ((pNsData != NULL) &&
+            (pAE->controllerIdentifyData.OACS.SupportsNamespaceMgmtAndAttachment)) {
+            pLunExt->nsStatus = INACTIVE;
+            pLunExt->slotStatus = FREE;
+            pLunExt->ReadOnly = TRUE;
+            pLunExt->nsSetupPending = 0;
+        } else {
+            memset(pLunExt, 0, sizeof(NVME_LUN_EXTENSION));
+            pAE->DriverState.NumKnownNamespaces--;
+        }
+        return;
+    }
+
+    if (pLunExt == NULL) {
+        lunId = NVMeGetFreeLunSlot(pAE);
+        if (lunId == INVALID_LUN_EXTN) {
+            StorPortDebugPrint(INFO,
+                "NVMeRescanNamespace: no slot for NSID 0x%x\n", Nsid);
+            return;
+        }
+        pAE->DriverState.NumKnownNamespaces++;
+        pLunExt = pAE->pLunExtensionTable[lunId];
+        pLunExt->namespaceId = Nsid;
+        pLunExt->nsStatus = INACTIVE;
+        pLunExt->slotStatus = FREE;
+        pLunExt->offlineReason = NOT_OFFLINE;
+    }
+
+    if ((pLunExt->slotStatus == ONLINE) &&
+        (pLunExt->identifyData.NSZE != pNsData->NSZE))
+        InterlockedOr(&pLunExt->unitAttention, LUN_UA_CAPACITY_CHANGED);
+
+    memcpy_s(&pLunExt->identifyData,
+             sizeof(pLunExt->identifyData),
+             pNsData,
+             sizeof(ADMIN_IDENTIFY_NAMESPACE));
+    pLunExt->nsSetupPending = 0;
+
+    if (NVMeLunFormatSupported(pAE, pLunExt) == FALSE) {
+        /* Formatted with a metadata layout the driver can't handle */
+        if (pLunExt->slotStatus == ONLINE) {
+            pLunExt->slotStatus = FREE;
+            pAE->visibleLuns--;
+            pAE->NsRescanBusChange = TRUE;
+        }
+        return;
+    }
+
+    if (pLunExt->slotStatus == ONLINE) {
+        NVMeRefreshLunIoParams(pAE, pLunExt);
+        return;
+    }
+
+    StorPortDebugPrint(INFO,
+        "NVMeRescanNamespace: NSID 0x%x lun %d added\n", Nsid, lunId);
+
+    pLunExt->anaState = 0;
+    pLunExt->unitAttention = 0;
+    pLunExt->zoned = FALSE;
+    pLunExt->numStreams = 0;
+    pLunExt->streamShift = 0;
+
+    /*
+     * Zones and streams are set up as NVMeRunningWaitOnZoned/Streams do at
+     * init before the LUN is exposed, a zoned namespace must never be seen
+     * as a regular block device.
+     */
+    if ((pAE->ntldrDump == FALSE) &&
+        (pAE->IoCmdSetsEnabled == TRUE))
+        pLunExt->nsSetupPending |= NS_SETUP_ZONED;
+
+    if ((pAE->ntldrDump == FALSE) &&
+        (pAE->InitInfo.Streams != 0) &&
+        (pAE->controllerIdentifyData.OACS.SupportsDirectives == 1))
+        pLunExt->nsSetupPending |= (NS_SETUP_STREAMS_ENABLE |
+                                    NS_SETUP_STREAMS_ALLOCATE);
+
+    if (pLunExt->nsSetupPending != 0) {
+        InterlockedOr(&pAE->AerWork, AER_WORK_NS_SETUP);
+        return;
+    }
+
+    NVMeNsOnline(pAE, pLunExt);
+    pAE->NsRescanBusChange = TRUE;
+} /* NVMeRescanNamespace */
+
+/*******************************************************************************
+ * NVMeNsOnline
+ *
+ * @brief NVMeNsOnline gets called to bring the LUN of a namespace a rescan
+ *        added online, once it needs no more setup. The caller holds
+ *        StartIoLock and reports the bus change.
+ *
+ * @param pAE - Pointer to hardware device extension
+ * @param pLunExt - Pointer to the LUN extension of the namespace
+ *
+ * @return VOID
+ ******************************************************************************/
+VOID NVMeNsOnline(
+    PNVME_DEVICE_EXTENSION pAE,
+    PNVME_LUN_EXTENSION pLunExt
+)
+{
+    pLunExt->nsStatus = ATTACHED;
+    pLunExt->slotStatus = ONLINE;
+    NVMeRefreshLunIoParams(pAE, pLunExt);
+    pLunExt->ReadOnly = FALSE;
+    pAE->visibleLuns++;
+
+    /* Learn the path state of its ANA Group */
+    if (pAE->AnaEnabled == TRUE)
+        InterlockedOr(&pAE->AerWork, AER_WORK_ANA_LOG);
+} /* NVMeNsOnline */
+
+/*******************************************************************************
+ * NVMeRescanCompletion
+ *
+ * @brief NVMeRescanCompletion gets called by NVMeAerWorkCallback with the
+ *        Identify commands of a namespace rescan. The Active Namespace ID
+ *        list, read when the Changed Namespace List overflowed, takes the
+ *        LUNs of namespaces missing from it offline and becomes the list of
+ *        namespaces to identify. Identify Namespace data goes to
+ *        NVMeRescanNamespace, then the rescan moves on to the next NSID and,
+ *        after the last one, reports a bus change if a LUN came or went. The
+ *        LUN table is updated under StartIoLock, and the bus change only
+ *        reported once the lock is released.
+ *
+ * @param pAE - Pointer to hardware device extension
+ * @param pNVMeCmd - The Identify command
+ * @param pCplEntry - Its completion entry
+ *
+ * @return VOID
+ ******************************************************************************/
+VOID NVMeRescanCompletion(
+    PNVME_DEVICE_EXTENSION pAE,
+    PNVMe_COMMAND pNVMeCmd,
+    PNVMe_COMPLETION_QUEUE_ENTRY pCplEntry
+)
+{
+    PADMIN_IDENTIFY_COMMAND_DW10 pIdentifyCDW10 =
+        (PADMIN_IDENTIFY_COMMAND_DW10)&pNVMeCmd->CDW10;
+    PNVME_LUN_EXTENSION pLunExt = NULL;
+    PULONG pNsList = AER_NS_LIST(pAE);
+    STOR_LOCK_HANDLE hStartIoLock = {0};
+    BOOLEAN AcquireLock = FALSE;
+    BOOLEAN BusChange = FALSE;
+    BOOLEAN Success;
+    ULONG lunId;
+    ULONG i;
+
+    Success = ((pCplEntry->DW3.SF.SC == SUCCESSFUL_COMPLETION) &&
+               (pCplEntry->DW3.SF.SCT == GENERIC_COMMAND_STATUS)) ?
+              TRUE : FALSE;
+
+    if ((pIdentifyCDW10->CNS == LIST_ATTACHED_NAMESPACES) &&
+        (Success == FALSE)) {
+        StorPortDebugPrint(INFO,
+            "NVMeRescanCompletion: active list failed (SCT 0x%x SC 0x%x)\n",
+            pCplEntry->DW3.SF.SCT,
+            pCplEntry->DW3.SF.SC);
+        return;
+    }
+
+    /* The DPC only holds StartIoLock when cores share a queue */
+    AcquireLock = ((pAE->ntldrDump == FALSE) &&
+                   (pAE->MultipleCoresToSingleQueueFlag == FALSE)) ?
+                  TRUE : FALSE;
+    if (AcquireLock == TRUE)
+        StorPortAcquireSpinLock(pAE, StartIoLock, NULL, &hStartIoLock);
+
+    if (pIdentifyCDW10->CNS == LIST_ATTACHED_NAMESPACES) {
+        for (lunId = 0; lunId < pAE->NumLunSlots; lunId++) {
+            pLunExt = pAE->pLunExtensionTable[lunId];
+            if (pLunExt->slotStatus != ONLINE)
+                continue;
+
+            for (i = 0; (i < CHANGED_NS_LIST_ENTRIES) && (pNsList[i] != 0); i++)
+                if (pNsList[i] == pLunExt->namespaceId)
+                    break;
+
+            if ((i == CHANGED_NS_LIST_ENTRIES) || (pNsList[i] == 0))
+                NVMeRescanNamespace(pAE, pLunExt->namespaceId, NULL);
+        }
+
+        pAE->NsRescanNext = 0;
+        if (pNsList[0] != 0)
+            InterlockedOr(&pAE->AerWork, AER_WORK_NS_IDENTIFY);
+        else
+            BusChange = pAE->NsRescanBusChange;
+    } else {
+        if (Success == TRUE) {
+            NVMeRescanNamespace(pAE,
+                                pNVMeCmd->NSID,
+                                (PADMIN_IDENTIFY_NAMESPACE)pAE->pAerLogBuf);
+        } else if ((pCplEntry->DW3.SF.SCT == GENERIC_COMMAND_STATUS) &&
+                   (pCplEntry->DW3.SF.SC == INVALID_NAMESPACE_OR_FORMAT)) {
+            /* The namespace was deleted */
+            NVMeRescanNamespace(pAE, pNVMeCmd->NSID, NULL);
+        } else {
+            StorPortDebugPrint(INFO,
+                "NVMeRescanCompletion: NSID 0x%x failed (SCT 0x%x SC 0x%x)\n",
+                pNVMeCmd->NSID,
+                pCplEntry->DW3.SF.SCT,
+                pCplEntry->DW3.SF.SC);
+        }
+
+        pAE->NsRescanNext++;
+        if ((pAE->NsRescanNext >= CHANGED_NS_LIST_ENTRIES) ||
+            (pNsList[pAE->NsRescanNext] == 0)) {
+            InterlockedAnd(&pAE->AerWork, ~AER_WORK_NS_IDENTIFY);
+            BusChange = pAE->NsRescanBusChange;
+        }
+    }
+
+    if (BusChange == TRUE)
+        pAE->NsRescanBusChange = FALSE;
+
+    if (AcquireLock == TRUE)
+        StorPortReleaseSpinLock(pAE, &hStartIoLock);
+
+    if (BusChange == TRUE)
+        StorPortNotification(BusChangeDetected, pAE);
+} /* NVMeRescanCompletion */
+
+/*******************************************************************************
+ * NVMeNextNsSetup
+ *
+ * @brief NVMeNextNsSetup gets called by NVMeAerWork to find the next LUN of
+ *        a namespace added at runtime whose zones or streams are still to be
+ *        set up. The work is dropped when there is none left.
+ *
+ * @param pAE - Pointer to hardware device extension
+ *
+ * @return PNVME_LUN_EXTENSION
+ *     The LUN to set up next, NULL if there is none.
+ ******************************************************************************/
+PNVME_LUN_EXTENSION NVMeNextNsSetup(
+    PNVME_DEVICE_EXTENSION pAE
+)
+{
+    PNVME_LUN_EXTENSION pLunExt = NULL;
+    ULONG lunId;
+
+    for (lunId = 0; lunId < pAE->NumLunSlots; lunId++) {
+        pLunExt = pAE->pLunExtensionTable[lunId];
+        if ((pLunExt->slotStatus == FREE) &&
+            (pLunExt->nsSetupPending != 0))
+            return pLunExt;
+    }
+
+    InterlockedAnd(&pAE->AerWork, ~AER_WORK_NS_SETUP);
+    return NULL;
+} /* NVMeNextNsSetup */
+
+/*******************************************************************************
+ * NVMeNsSetupCompletion
+ *
+ * @brief NVMeNsSetupCompletion gets called by NVMeAerWorkCallback with the
+ *        commands setting up a namespace added at runtime, one step each:
+ *        Identify (Zoned Namespace), then the Directive Send and Receive of
+ *        its streams. As at init, failures just leave the namespace a
+ *        regular block device or without streams, and zoned namespaces get
+ *        no streams. The LUN comes online after the last step, under
+ *        StartIoLock, and the bus change is reported once it is released.
+ *        A namespace that went away or that an IOCTL took over meanwhile is
+ *        left alone.
+ *
+ * @param pAE - Pointer to hardware device extension
+ * @param pNVMeCmd - The setup command
+ * @param pCplEntry - Its completion entry
+ *
+ * @return VOID
+ ******************************************************************************/
+VOID NVMeNsSetupCompletion(
+    PNVME_DEVICE_EXTENSION pAE,
+    PNVMe_COMMAND pNVMeCmd,
+    PNVMe_COMPLETION_QUEUE_ENTRY pCplEntry
+)
+{
+    PNVME_LUN_EXTENSION pLunExt = NULL;
+    STOR_LOCK_HANDLE hStartIoLock = {0};
+    BOOLEAN AcquireLock = FALSE;
+    BOOLEAN BusChange = FALSE;
+    BOOLEAN Success;
+    ULONG lunId = INVALID_LUN_EXTN;
+
+    Success = ((pCplEntry->DW3.SF.SC == SUCCESSFUL_COMPLETION) &&
+               (pCplEntry->DW3.SF.SCT == GENERIC_COMMAND_STATUS)) ?
+              TRUE : FALSE;
+
+    /* The DPC only holds StartIoLock when cores share a queue */
+    AcquireLock = ((pAE->ntldrDump == FALSE) &&
+                   (pAE->MultipleCoresToSingleQueueFlag == FALSE)) ?
+                  TRUE : FALSE;
+    if (AcquireLock == TRUE)
+        StorPortAcquireSpinLock(pAE, StartIoLock, NULL, &hStartIoLock);
+
+    NVMeGetNamespaceStatusAndSlot(pAE, pNVMeCmd->NSID, &lunId);
+    if (lunId != INVALID_LUN_EXTN)
+        pLunExt = pAE->pLunExtensionTable[lunId];
+
+    if ((pLunExt != NULL) &&
+        (pLunExt->slotStatus == FREE) &&
+        (pLunExt->nsSetupPending != 0)) {
+        if (pNVMeCmd->CDW0.OPC == ADMIN_IDENTIFY) {
+            NVMeZonedUpdateLun(pLunExt,
+                               pCplEntry,
+                               (PADMIN_IDENTIFY_ZNS_NAMESPACE)pAE->pAerLogBuf);
+            pLunExt->nsSetupPending &= ~NS_SETUP_ZONED;
+            if (pLunExt->zoned == TRUE)
+                pLunExt->nsSetupPending = 0;
+        } else if ((pNVMeCmd->CDW0.OPC == ADMIN_DIRECTIVE_SEND) &&
+                   (Success == TRUE)) {
+            /* Enabled, allocate the streams next */
+            pLunExt->nsSetupPending &= ~NS_SETUP_STREAMS_ENABLE;
+        } else {
+            if (Success == TRUE)
+                NVMeStreamsUpdateLun(pAE, pLunExt, pCplEntry);
+            else
+                StorPortDebugPrint(INFO,
+                    "NVMeNsSetupCompletion: NSID 0x%x streams failed (SCT 0x%x SC 0x%x)\n",
+                    pLunExt->namespaceId,
+                    pCplEntry->DW3.SF.SCT,
+                    pCplEntry->DW3.SF.SC);
+            pLunExt->nsSetupPending = 0;
+        }
+
+        if (pLunExt->nsSetupPending == 0) {
+            NVMeNsOnline(pAE, pLunExt);
+            BusChange = TRUE;
+        }
+    } else if (pLunExt != NULL) {
+        pLunExt->nsSetupPending = 0;
+    }
+
+    if (AcquireLock == TRUE)
+        StorPortReleaseSpinLock(pAE, &hStartIoLock);
+
+    if (BusChange == TRUE)
+        StorPortNotification(BusChangeDetected, pAE);
+} /* NVMeNsSetupCompletion */
+
+/*******************************************************************************
+ * NVMeConfigAsyncEvents
+ *
+ * @brief NVMeConfigAsyncEvents gets called to add the notices in AerNotices
+ *        to the Asynchronous Event Configuration: Get Features first, so
+ *        events enabled by the controller or by applications stay enabled,
+ *        then Set Features with the driver's notices added.
+ *
+ * @param pAE - Pointer to hardware device extension
+ * @param Set - FALSE for the Get Features step, TRUE for Set Features
+ *
+ * @return BOOLEAN
+ *     Returns TRUE if the command was issued, otherwise, FALSE.
+ ******************************************************************************/
+BOOLEAN NVMeConfigAsyncEvents(
+    PNVME_DEVICE_EXTENSION pAE,
+    BOOLEAN Set
+)
+{
+    PNVME_SRB_EXTENSION pNVMeSrbExt =
+        (PNVME_SRB_EXTENSION)pAE->DriverState.pSrbExt;
+    PNVMe_COMMAND pFeatures = (PNVMe_COMMAND)(&pNVMeSrbExt->nvmeSqeUnit);
+    PADMIN_SET_FEATURES_COMMAND_DW10 pFeaturesCDW10 = NULL;
+
+    /* Zero out the extension first */
+    memset((PVOID)pNVMeSrbExt, 0, sizeof(NVME_SRB_EXTENSION));
+
+    /* Populate SRB_EXTENSION fields */
+    pNVMeSrbExt->pNvmeDevExt = pAE;
+    pNVMeSrbExt->pNvmeCompletionRoutine = NVMeInitCallback;
+
+    /* Get and Set Features share the layout of CDW10 */
+    pFeaturesCDW10 = (PADMIN_SET_FEATURES_COMMAND_DW10)&pFeatures->CDW10;
+    pFeaturesCDW10->FID = ASYNCHRONOUS_EVENT_CONFIGURATION;
+
+    if (Set == TRUE) {
+        pFeatures->CDW0.OPC = ADMIN_SET_FEATURES;
+        pFeatures->CDW11 = pAE->DriverState.AerConfig | pAE->AerNotices;
+    } else {
+        pFeatures->CDW0.OPC = ADMIN_GET_FEATURES;
+    }
+
+    /* Now issue the command via Admin Doorbell register */
+    return ProcessIo(pAE, pNVMeSrbExt, NVME_QUEUE_TYPE_ADMIN, FALSE);
+} /* NVMeConfigAsyncEvents */
+
+/*******************************************************************************
+ * NVMeIssueAer
+ *
+ * @brief NVMeIssueAer gets called once the controller is started, and after
+ *        each event, to keep the driver's Asynchronous Event Request
+ *        outstanding. It counts against the limit applications' requests
+ *        are checked with once per start.
+ *
+ * @param pAE - Pointer to hardware device extension
+ * @param AcquireLock - if the caller needs the StartIO lock acquired or not
+ *
+ * @return BOOLEAN
+ *     Returns TRUE if the command was issued, otherwise, FALSE.
+ ******************************************************************************/
+BOOLEAN NVMeIssueAer(
+    PNVME_DEVICE_EXTENSION pAE,
+    BOOLEAN AcquireLock
+)
+{
+    PNVME_SRB_EXTENSION pNVMeSrbExt = (PNVME_SRB_EXTENSION)pAE->pAerSrbExt;
+    PNVMe_COMMAND pAer = (PNVMe_COMMAND)(&pNVMeSrbExt->nvmeSqeUnit);
+
+    /* Zero out the extension first */
+    memset((PVOID)pNVMeSrbExt, 0, sizeof(NVME_SRB_EXTENSION));
+
+    /* Populate SRB_EXTENSION fields */
+    pNVMeSrbExt->pNvmeDevExt = pAE;
+    pNVMeSrbExt->pNvmeCompletionRoutine = NVMeAerCallback;
+
+    /* Populate submission entry fields */
+    pAer->CDW0.OPC = ADMIN_ASYNCHRONOUS_EVENT_REQUEST;
+
+    /* Now issue the command via Admin Doorbell register */
+    return ProcessIo(pAE, pNVMeSrbExt, NVME_QUEUE_TYPE_ADMIN, AcquireLock);
+} /* NVMeIssueAer */
+
+/*******************************************************************************
+ * NVMeAerWork
+ *
+ * @brief NVMeAerWork gets called after an asynchronous event, a completed
+ *        piece of work and on each timer tick to issue the next command the
+ *        events call for, one at a time on pAerWorkSrbExt:
+ *
+ *        1. the log page of an event the driver didn't enable, to clear it
+ *        2. Identify Namespace of the next namespace being rescanned
+ *        3. the Active Namespace ID list, when the changes overflowed
+ *        4. the next zoned or streams setup step of a namespace a rescan
+ *           added
+ *        5. the Changed Namespace List log page, once no rescan is running
+ *        6. the Asymmetric Namespace Access log page
+ *        7. the Predictable Latency Event Aggregate log page
+ *        8. Set Features (Window) for a set due back in its DTWIN
+ *        9. the Predictable Latency Per NVM Set log page of a set
+ *
+ *        Anything left when a command can't be issued is retried on the next
+ *        timer tick.
+ *
+ * @param pAE - Pointer to hardware device extension
+ * @param AcquireLock - if the caller needs the StartIO lock acquired or not
+ *
+ * @return VOID
+ ******************************************************************************/
+VOID NVMeAerWork(
+    PNVME_DEVICE_EXTENSION pAE,
+    BOOLEAN AcquireLock
+)
+{
+    PNVME_SRB_EXTENSION pNVMeSrbExt =
+        (PNVME_SRB_EXTENSION)pAE->pAerWorkSrbExt;
+    PNVME_LUN_EXTENSION pLunExt = NULL;
+    PULONG pNsList = NULL;
+    BOOLEAN Issued = FALSE;
+    LONG Sets;
+    ULONG SetIndex;
+
+    if ((pNVMeSrbExt == NULL) ||
+        (pAE->DriverState.NextDriverState != NVMeStartComplete))
+        return;
+
+    if (InterlockedCompareExchange(&pAE->AerWorkBusy, 1, 0) != 0)
+        return;
+
+    if ((pAE->AerWork & AER_WORK_CLEAR_LOG) != 0) {
+        InterlockedAnd(&pAE->AerWork, ~AER_WORK_CLEAR_LOG);
+        Issued = NVMeGetLogPage(pAE,
+                                pNVMeSrbExt,
+                                NVMeAerWorkCallback,
+                                pAE->AerLogPage,
+                                0,
+                                0,
+                                pAE->pAerLogBuf,
+                                sizeof(ULONG),
+                                AcquireLock);
+    } else if ((pAE->AerWork & AER_WORK_NS_IDENTIFY) != 0) {
+        /* The entry moves on when the command completes */
+        pNsList = AER_NS_LIST(pAE);
+        Issued = NVMeIssueIdentify(pAE,
+                                   pNVMeSrbExt,
+                                   NVMeAerWorkCallback,
+                                   pNsList[pAE->NsRescanNext],
+                                   IDENTIFY_NAMESPACE,
+                                   pAE->pAerLogBuf,
+                                   AcquireLock);
+    } else if ((pAE->AerWork & AER_WORK_NS_ACTIVE_LIST) != 0) {
+        InterlockedAnd(&pAE->AerWork, ~AER_WORK_NS_ACTIVE_LIST);
+        Issued = NVMeIssueIdentify(pAE,
+                                   pNVMeSrbExt,
+                                   NVMeAerWorkCallback,
+                                   0,
+                                   LIST_ATTACHED_NAMESPACES,
+                                   AER_NS_LIST(pAE),
+                                   AcquireLock);
+    } else if (((pAE->AerWork & AER_WORK_NS_SETUP) != 0) &&
+               ((pLunExt = NVMeNextNsSetup(pAE)) != NULL)) {
+        /* The step is done with when the command completes */
+        if ((pLunExt->nsSetupPending & NS_SETUP_ZONED) != 0)
+            Issued = NVMeIdentifyZoned(pAE,
+                                       pNVMeSrbExt,
+                                       NVMeAerWorkCallback,
+                                       pLunExt,
+                                       pAE->pAerLogBuf,
+                                       AcquireLock);
+        else
+            Issued = NVMeConfigureStreams(pAE,
+                                          pNVMeSrbExt,
+                                          NVMeAerWorkCallback,
+                                          pLunExt,
+                                          ((pLunExt->nsSetupPending &
+                                            NS_SETUP_STREAMS_ENABLE) == 0) ?
+                                          TRUE : FALSE,
+                                          AcquireLock);
+    } else if ((pAE->AerWork & AER_WORK_NS_LIST) != 0) {
+        InterlockedAnd(&pAE->AerWork, ~AER_WORK_NS_LIST);
+        Issued = NVMeGetLogPage(pAE,
+                                pNVMeSrbExt,
+                                NVMeAerWorkCallback,
+                                CHANGED_NAMESPACE_LIST,
+                                0,
+                                0,
+                                AER_NS_LIST(pAE),
+                                sizeof(ADMIN_GET_LOG_PAGE_CHANGED_NS_LIST),
+                                AcquireLock);
+    } else if ((pAE->AerWork & AER_WORK_ANA_LOG) != 0) {
+        InterlockedAnd(&pAE->AerWork, ~AER_WORK_ANA_LOG);
+        Issued = NVMeGetLogPage(pAE,
+                                pNVMeSrbExt,
+                                NVMeAerWorkCallback,
+                                ASYMMETRIC_NAMESPACE_ACCESS,
+                                ANA_LOG_LSP_RGO,
+                                0,
+                                pAE->pAerLogBuf,
+                                PAGE_SIZE,
+                                AcquireLock);
+    } else if ((pAE->AerWork & AER_WORK_PLM_EVENTS) != 0) {
+        InterlockedAnd(&pAE->AerWork, ~AER_WORK_PLM_EVENTS);
+        Issued = NVMeGetLogPage(pAE,
+                                pNVMeSrbExt,
+                                NVMeAerWorkCallback,
+                                PREDICTABLE_LATENCY_EVENTS,
+                                0,
+                                0,
+                                pAE->pAerLogBuf,
+                                PAGE_SIZE,
+                                AcquireLock);
+    } else if ((Sets = pAE->PlmDtwinSets) != 0) {
+        for (SetIndex = 0; (Sets & (1UL << SetIndex)) == 0; SetIndex++);
+        InterlockedAnd(&pAE->PlmDtwinSets, (LONG)~(1UL << SetIndex));
+        Issued = NVMeSetPlmFeature(pAE,
+                                   pNVMeSrbExt,
+                                   NVMeAerWorkCallback,
+                                   PREDICTABLE_LATENCY_MODE_WINDOW,
+                                   (USHORT)(SetIndex + 1),
+                                   pAE->pAerLogBuf,
+                                   AcquireLock);
+    } else if ((Sets = pAE->PlmReadSets) != 0) {
+        for (SetIndex = 0; (Sets & (1UL << SetIndex)) == 0; SetIndex++);
+        InterlockedAnd(&pAE->PlmReadSets, (LONG)~(1UL << SetIndex));
+        Issued = NVMeGetLogPage(pAE,
+            pNVMeSrbExt,
+            NVMeAerWorkCallback,
+            PREDICTABLE_LATENCY_NVM_SET,
+            0,
+            (USHORT)(SetIndex + 1),
+            pAE->pAerLogBuf,
+            sizeof(ADMIN_GET_LOG_PAGE_PREDICTABLE_LATENCY_NVM_SET),
+            AcquireLock);
+    }
+
+    if (Issued == FALSE)
+        pAE->AerWorkBusy = 0;
+} /* NVMeAerWork */
+
+/*******************************************************************************
+ * NVMeGetIdentifyStructures
+ *
+ * @brief NVMeGetIdentifyStructures gets called to retrieve Identify structures,
+ *        including the Controller and Namespace information depending on
+ *        NamespaceID.
+ *
+ * @param pAE - Pointer to hardware device extension.
+ * @param NamespaceID - Specify either Controller or Namespace structure to
+ *                      retrieve
+ *
+ * @return BOOLEAN
+ *     TRUE - If the issued command completed without any errors
+ *     FALSE - If anything goes wrong
+ ******************************************************************************/
+BOOLEAN NVMeGetIdentifyStructures(
+    PNVME_DEVICE_EXTENSION pAE,
+    ULONG NamespaceID,
+    USHORT CNS
+)
+{
+    PNVME_SRB_EXTENSION pNVMeSrbExt =
+        (PNVME_SRB_EXTENSION)pAE->DriverState.pSrbExt;
+    PNVMe_COMMAND pIdentify = NULL;
+    PADMIN_IDENTIFY_CONTROLLER pIdenCtrl = &pAE->controllerIdentifyData;
+    PADMIN_IDENTIFY_COMMAND_DW10 pIdentifyCDW10 = NULL;
+    ULONG lunId;
+
+    /* Zero-out the entire SRB_EXTENSION */
+    memset((PVOID)pNVMeSrbExt, 0, sizeof(NVME_SRB_EXTENSION));
+
+    /* Populate SRB_EXTENSION fields */
+    pNVMeSrbExt->pNvmeDevExt = pAE;
+    pNVMeSrbExt->pNvmeCompletionRoutine = NVMeInitCallback;
+
+    /* Populate submission entry fields */
+    pIdentify = &pNVMeSrbExt->nvmeSqeUnit;
+    pIdentify->CDW0.OPC = ADMIN_IDENTIFY;
+
+    pIdentifyCDW10 = (PADMIN_IDENTIFY_COMMAND_DW10) &pIdentify->CDW10;
+    /* Set the type of identify command */
+    pIdentifyCDW10->CNS = CNS;
+
+    switch (CNS) {
+    case IDENTIFY_CNTLR:
+        /* Prepare PRP entries, need at least one PRP entry */
+        if (NVMePreparePRPs(pAE,
+                            pNVMeSrbExt,
+                            (PVOID)pAE->DriverState.pDataBuffer,
+                            sizeof(ADMIN_IDENTIFY_CONTROLLER)) == FALSE) {
+            return (FALSE);
+        }
+        break;
+     case IDENTIFY_NAMESPACE:
+
+        if ( pIdenCtrl == NULL )
+            return (FALSE);
+
+        StorPortDebugPrint(INFO,"NVMeGetIdentifyStructures: IDEN_NAMESPACE\n");
+        /* Indicate it's for Namespace structure */
+        pIdentifyCDW10 = (PADMIN_IDENTIFY_COMMAND_DW10) &pIdentify->CDW10;
+        pIdentifyCDW10->CNS = 0;
+
+        /* NN of Controller structure is 1-based */
+        if ((NamespaceID <= pIdenCtrl->NN) ||
+            (pAE->controllerIdentifyData.OACS.SupportsNamespaceMgmtAndAttachment)) {
+
+            if (pAE->controllerIdentifyData.OACS.SupportsNamespaceMgmtAndAttachment)
+                //Use NVMeGetNamespaceStatusAndSlot to get lunId
+                NVMeGetNamespaceStatusAndSlot(pAE, NamespaceID, &lunId);
+            else
+                lunId = pAE->DriverState.VisibleNamespacesExamined;
+
+            /* Namespace ID is 1-based. */
+            pIdentify->NSID = NamespaceID;
+
+            StorPortDebugPrint(INFO,
+                "NVMeGetIdentifyStructures: Get NS INFO for NSID 0x%x tgt lun 0x%x\n",
+                    NamespaceID, lunId);
+
+            /* Prepare PRP entries, need at least one PRP entry */
+            if (NVMePreparePRPs(pAE,
+                                pNVMeSrbExt,
+                                (PVOID)pAE->DriverState.pDataBuffer,
+                                sizeof(ADMIN_IDENTIFY_NAMESPACE)) == FALSE) {
+                return (FALSE);
+            }
+        } else {
+            /* no initial namespaces defined */
+            StorPortDebugPrint(INFO,
+                "NVMeGetIdentifyStructures: NamespaceID <= pIdenCtrl->NN\n");
+            pAE->DriverState.StateChkCount = 0;
+            pAE->visibleLuns = 0;
+            pAE->DriverState.NextDriverState = NVMeWaitOnSetupQueues;
+            NVMeCallArbiter(pAE);
+            return (TRUE);
+        }
+        break;
+    case LIST_ATTACHED_NAMESPACES:
+    case LIST_EXISTING_NAMESPACES:
+        /* Prepare PRP entries, need at least one PRP entry */
+        if (NVMePreparePRPs(pAE,
+                            pNVMeSrbExt,
+                            (PVOID)pAE->DriverState.pDataBuffer,
+							sizeof(ULONG) * MAX_NUMBER_OF_NAMESPACES) == FALSE) {
+            return (FALSE);
+        }
+        break;
+    default:
+        break;
+    }
+
+    /* Now issue the command via Admin Doorbell register */
+    return ProcessIo(pAE, pNVMeSrbExt, NVME_QUEUE_TYPE_ADMIN, FALSE);
+} /* NVMeGetIdentifyStructures */
+
+/*******************************************************************************
+ * NVMeQueueCreateBatch
+ *
+ * @brief Returns how many Create IO Queue commands the init state machine may
+ *        issue back to back. Each needs its own SRB extension and an admin
+ *        queue entry, so it's 1 when the extensions couldn't be allocated.
+ *
+ * @param pAE - Pointer to hardware device extension.
+ *
+ * @return ULONG
+ *     Number of Create IO Queue commands to keep outstanding
+ ******************************************************************************/
+ULONG NVMeQueueCreateBatch(
+    PNVME_DEVICE_EXTENSION pAE
+)
+{
+    if (pAE->DriverState.pQueueSrbExt == NULL)
+        return 1;
+
+    return max(1, min(QUEUE_CREATE_BATCH,
+                      (ULONG)pAE->QueueInfo.NumAdQEntriesAllocated - 1));
+} /* NVMeQueueCreateBatch */
+
+/*******************************************************************************
+ * NVMeSameController
+ *
+ * @brief Compares a freshly read Identify Controller structure against the one
+ *        kept from the last start. Serial number, model, firmware revision
+ *        and namespace count have to match for the namespaces found then to
+ *        be reused on resume.
+ *
+ * @param pAE - Pointer to hardware device extension.
+ * @param pIdentify - Identify Controller data just read
+ *
+ * @return BOOLEAN
+ *     TRUE - If it's the same controller running the same firmware
+ *     FALSE - Otherwise
+ ******************************************************************************/
+BOOLEAN NVMeSameController(
+    PNVME_DEVICE_EXTENSION pAE,
+    PADMIN_IDENTIFY_CONTROLLER pIdentify
+)
+{
+    PADMIN_IDENTIFY_CONTROLLER pKnown = &pAE->controllerIdentifyData;
+
+    return ((memcmp(pKnown->SN, pIdentify->SN, sizeof(pKnown->SN)) == 0) &&
+            (memcmp(pKnown->MN, pIdentify->MN, sizeof(pKnown->MN)) == 0) &&
+            (memcmp(pKnown->FR, pIdentify->FR, sizeof(pKnown->FR)) == 0) &&
+            (pKnown->NN == pIdentify->NN)) ? TRUE : FALSE;
+} /* NVMeSameController */
+
+/*******************************************************************************
+ * NVMeCreateCplQueue
+ *
+ * @brief NVMeCreateCplQueue gets called to create one IO completion queue at a
+ *        time via issuing Create IO Completion Queue command. The smaller value
+ *        of NumCplIoQAllocated of QUEUE_INFO and NumActiveCores of
+ *        RES_MAPPING_TABLE decides the number of completion queues to create,
+ *        which is indicated in NumCplIoQAllocated of QUEUE_INFO.
+ *
+ * @param pAE - Pointer to hardware device extension.
+ * @param QueueID - Which completion queue to create.
+ *
+ * @return BOOLEAN
+ *     TRUE - If the issued commands completed without any errors
+ *     FALSE - If anything goes wrong
+ ******************************************************************************/
+BOOLEAN NVMeCreateCplQueue(
+    PNVME_DEVICE_EXTENSION pAE,
+    USHORT QueueID
+)
+{
+    PNVME_SRB_EXTENSION pNVMeSrbExt =
+        (PNVME_SRB_EXTENSION)pAE->DriverState.pSrbExt;
+    PQUEUE_INFO pQI = &pAE->QueueInfo;
+    PNVMe_COMMAND pCreateCpl = NULL;
+    PADMIN_CREATE_IO_COMPLETION_QUEUE_DW10 pCreateCplCDW10 = NULL;
+    PADMIN_CREATE_IO_COMPLETION_QUEUE_DW11 pCreateCplCDW11 = NULL;
+    PCPL_QUEUE_INFO pCQI = NULL;
+
+    if (QueueID != 0 && QueueID <= pQI->NumCplIoQAllocated) {
+        /* Batched creates each need their own SRB extension */
+        if (pAE->DriverState.pQueueSrbExt != NULL)
+            pNVMeSrbExt = (PNVME_SRB_EXTENSION)pAE->DriverState.pQueueSrbExt +
+                          ((QueueID - 1) % QUEUE_CREATE_BATCH);
+
+        /* Zero-out the entire SRB_EXTENSION */
+        memset((PVOID)pNVMeSrbExt, 0, sizeof(NVME_SRB_EXTENSION));
+
+        /* Populate SRB_EXTENSION fields */
+        pNVMeSrbExt->pNvmeDevExt = pAE;
+        pNVMeSrbExt->pNvmeCompletionRoutine = NVMeInitCallback;
+
+        /* Populate submission entry fields */
+        pCreateCpl = (PNVMe_COMMAND)(&pNVMeSrbExt->nvmeSqeUnit);
+        pCreateCplCDW10 = (PADMIN_CREATE_IO_COMPLETION_QUEUE_DW10)
+                          (&pCreateCpl->CDW10);
+        pCreateCplCDW11 = (PADMIN_CREATE_IO_COMPLETION_QUEUE_DW11)
+                          (&pCreateCpl->CDW11);
+
+        /* Populate submission entry fields */
+        pCreateCpl->CDW0.OPC = ADMIN_CREATE_IO_COMPLETION_QUEUE;
+        pCQI = pQI->pCplQueueInfo + QueueID;
+        pCreateCpl->PRP1 = pCQI->CplQStart.QuadPart;
+        pCreateCplCDW10->QID = QueueID;
+        pCreateCplCDW10->QSIZE = pCQI->CplQEntries - 1;
+        pCreateCplCDW11->PC = (pCQI->pCplQPages != NULL) ? 0 : 1;
+        pCreateCplCDW11->IEN = 1;
+        pCreateCplCDW11->IV = pCQI->MsiMsgID;
+
+        NVMeInitShadowDoorbell(pAE,
+                               (2 * QueueID) + 1,
+                               &pCQI->pShadowCplHDBL,
+                               &pCQI->pEventIdxCplHDBL);
+
+        /* Now issue the command via Admin Doorbell register */
+        return ProcessIo(pAE, pNVMeSrbExt, NVME_QUEUE_TYPE_ADMIN, FALSE);
+    }
+
+    return (FALSE);
+} /* NVMeCreateCplQueue */
+
+/*******************************************************************************
+ * NVMeCreateSubQueue
+ *
+ * @brief NVMeCreateSubQueue gets called to create one IO submission queue at a
+ *        time via issuing Create IO Submission Queue command. The smaller value
+ *        of NumSubIoQAllocated of QUEUE_INFO and NumActiveCores of
+ *        RES_MAPPING_TABLE decides the number of submission queues to create,
+ *        which is indicated in NumSubIoQAllocated of QUEUE_INFO.
+ *
+ * @param pAE - Pointer to hardware device extension.
+ * @param QueueID - Which submission queue to create.
+ *
+ * @return BOOLEAN
+ *     TRUE - If the issued commands completed without any errors
+ *     FALSE - If anything goes wrong
+ ******************************************************************************/
+BOOLEAN NVMeCreateSubQueue(
+    PNVME_DEVICE_EXTENSION pAE,
+    USHORT QueueID
+)
+{
+    PNVME_SRB_EXTENSION pNVMeSrbExt =
+        (PNVME_SRB_EXTENSION)pAE->DriverState.pSrbExt;
+    PQUEUE_INFO pQI = &pAE->QueueInfo;
+    PNVMe_COMMAND pCreateSub = NULL;
+    PADMIN_CREATE_IO_SUBMISSION_QUEUE_DW10 pCreateSubCDW10 = NULL;
+    PADMIN_CREATE_IO_SUBMISSION_QUEUE_DW11 pCreateSubCDW11 = NULL;
+    PSUB_QUEUE_INFO pSQI = NULL;
+
+    if (QueueID != 0 && QueueID <= pQI->NumCplIoQAllocated) {
+        /* Batched creates each need their own SRB extension */
+        if (pAE->DriverState.pQueueSrbExt != NULL)
+            pNVMeSrbExt = (PNVME_SRB_EXTENSION)pAE->DriverState.pQueueSrbExt +
+                          ((QueueID - 1) % QUEUE_CREATE_BATCH);
+
+        /* Zero-out the entire SRB_EXTENSION */
+        memset((PVOID)pNVMeSrbExt, 0, sizeof(NVME_SRB_EXTENSION));
+
+        /* Populate SRB_EXTENSION fields */
+        pNVMeSrbExt->pNvmeDevExt = pAE;
+        pNVMeSrbExt->pNvmeCompletionRoutine = NVMeInitCallback;
+
+        /* Populate submission entry fields */
+        pCreateSub = (PNVMe_COMMAND)(&pNVMeSrbExt->nvmeSqeUnit);
+        pCreateSubCDW10 = (PADMIN_CREATE_IO_SUBMISSION_QUEUE_DW10)
+                          (&pCreateSub->CDW10);
+        pCreateSubCDW11 = (PADMIN_CREATE_IO_SUBMISSION_QUEUE_DW11)
+                          (&pCreateSub->CDW11);
+
+        /* Populate submission entry fields */
+        pCreateSub->CDW0.OPC = ADMIN_CREATE_IO_SUBMISSION_QUEUE;
+        pSQI = pQI->pSubQueueInfo + QueueID;
+        pCreateSub->PRP1 = pSQI->SubQStart.QuadPart;
+        pCreateSubCDW10->QID = QueueID;
+        pCreateSubCDW10->QSIZE = pSQI->SubQEntries - 1;
+        pCreateSubCDW11->CQID = pSQI->CplQueueID;
+        pCreateSubCDW11->PC = ((pSQI->NonContiguous == TRUE) &&
+                               (pSQI->InCmb == FALSE)) ? 0 : 1;
+
+        NVMeInitShadowDoorbell(pAE,
+                               2 * QueueID,
+                               &pSQI->pShadowSubTDBL,
+                               &pSQI->pEventIdxSubTDBL);
+
+        /* Now issue the command via Admin Doorbell register */
+        return ProcessIo(pAE, pNVMeSrbExt, NVME_QUEUE_TYPE_ADMIN, FALSE);
+    }
+
+    return (FALSE);
+} /* NVMeCreateSubQueue */
+
+/*******************************************************************************
+ * NVMeDeleteCplQueues
+ *
+ * @brief NVMeDeleteCplQueues gets called to delete a number of IO completion
+ *        queues via issuing Delete IO Completion Queue commands.
+ *        For us exclusively by the init state machine
+ *
+ * @param pAE - Pointer to hardware device extension.
+ *
+ * @return BOOLEAN
+ *     TRUE - If the issued commands completed without any errors
+ *     FALSE - If anything goes wrong
+ ******************************************************************************/
+BOOLEAN NVMeDeleteCplQueues(
+    PNVME_DEVICE_EXTENSION pAE
+)
+{
+    PNVME_SRB_EXTENSION pNVMeSrbExt =
+        (PNVME_SRB_EXTENSION)pAE->DriverState.pSrbExt;
+    PQUEUE_INFO pQI = &pAE->QueueInfo;
+    PNVMe_COMMAND pDeleteCpl = NULL;
+    PADMIN_DELETE_IO_COMPLETION_QUEUE_DW10 pDeleteCplCDW10 = NULL;
+    USHORT QueueID = (USHORT)pQI->NumCplIoQCreated;
+
+    if (QueueID > 0) {
+
+        /* init and setup srb ext */
+        NVMeInitSrbExtension(pNVMeSrbExt, pAE, NULL);
+        pNVMeSrbExt->pNvmeCompletionRoutine = NVMeInitCallback;
+
+        /* Populate submission entry fields */
+        pDeleteCpl = (PNVMe_COMMAND)(&pNVMeSrbExt->nvmeSqeUnit);
+        pDeleteCplCDW10 = (PADMIN_DELETE_IO_COMPLETION_QUEUE_DW10)
+                          (&pDeleteCpl->CDW10);
+        pDeleteCpl->CDW0.OPC = ADMIN_DELETE_IO_COMPLETION_QUEUE;
+        pDeleteCplCDW10->QID = QueueID;
+
+        /* Now issue the command via Admin Doorbell register */
+        if (ProcessIo(pAE, pNVMeSrbExt, NVME_QUEUE_TYPE_ADMIN, FALSE) == FALSE) {
+            return (FALSE);
+        }
+    }
+
+    return (TRUE);
+} /* NVMeDeleteCplQueues */
+
+/*******************************************************************************
+ * NVMeDeleteSubQueues
+ *
+ * @brief NVMeDeleteSubQueues gets called to delete a number of IO submission
+ *        queues via issuing Delete IO Submission Queue commands.
+ *        For us exclusively by the init state machine
+ *
+ * @param pAE - Pointer to hardware device extension.
+ *
+ * @return BOOLEAN
+ *     TRUE - If the issued commands completed without any errors
+ *     FALSE - If anything goes wrong
+ ******************************************************************************/
+BOOLEAN NVMeDeleteSubQueues(
+    PNVME_DEVICE_EXTENSION pAE
+)
+{
+    PNVME_SRB_EXTENSION pNVMeSrbExt =
+        (PNVME_SRB_EXTENSION)pAE->DriverState.pSrbExt;
+    PQUEUE_INFO pQI = &pAE->QueueInfo;
+    PNVMe_COMMAND pDeleteSub = NULL;
+    PADMIN_DELETE_IO_SUBMISSION_QUEUE_DW10 pDeleteSubCDW10 = NULL;
+    USHORT QueueID = (USHORT)pQI->NumSubIoQCreated;
+
+    if (QueueID > 0) {
+
+        /* init and setup srb ext */
+        NVMeInitSrbExtension(pNVMeSrbExt, pAE, NULL);
+        pNVMeSrbExt->pNvmeCompletionRoutine = NVMeInitCallback;
+
+        /* Populate submission entry fields */
+        pDeleteSub = (PNVMe_COMMAND)(&pNVMeSrbExt->nvmeSqeUnit);
+        pDeleteSubCDW10 = (PADMIN_DELETE_IO_SUBMISSION_QUEUE_DW10)
+                          (&pDeleteSub->CDW10);
+        pDeleteSub->CDW0.OPC = ADMIN_DELETE_IO_SUBMISSION_QUEUE;
+        pDeleteSubCDW10->QID = QueueID;
+
+        /* Now issue the command via Admin Doorbell register */
+        if (ProcessIo(pAE, pNVMeSrbExt, NVME_QUEUE_TYPE_ADMIN, FALSE) == FALSE) {
+            return (FALSE);
+        }
+    }
+    return (TRUE);
+} /* NVMeDeleteSubQueues */
+
+/*******************************************************************************
+ * NVMeNormalShutdown
+ *
+ * @brief NVMeNormalShutdown gets called to follow the normal shutdown sequence
+ *        defined in NVMe specification when receiving SRB_FUNCTION_SHUTDOWN
+ *        from the host:
+ *
+ *        1. Set state to NVMeShutdown to prevent taking any new requests
+ *        2. Delete all created submisison queues
+ *        3. If succeeded, delete all created completion queues (reset device)
+ *        4. Set SHN to normal shutdown (01b)
+ *        5. Keep reading back CSTS for 100 ms and check if SHST is 01b.
+ *        6. If so or timeout, return SRB_STATUS_SUCCESS to Storport
+ *
+ * @param pAE - Pointer to hardware device extension.
+ *
+ * @return BOOLEAN
+ *     TRUE - If the issued commands completed without any errors
+ *     FALSE - If anything goes wrong
+ ******************************************************************************/
+BOOLEAN NVMeNormalShutdown(
+    PNVME_DEVICE_EXTENSION pAE
+)
+{
+    NVMe_CONTROLLER_CONFIGURATION CC;
+    NVMe_CONTROLLER_STATUS CSTS;
+    ULONG PollMax = pAE->uSecCrtlTimeout / MAX_STATE_STALL_us;
+    ULONG PollCount;
+
+    /* Check for any pending cmds. */
+    if (NVMeDetectPendingCmds(pAE, FALSE, SRB_STATUS_BUS_RESET) == TRUE) {
+        return FALSE;
+    }
+
+    /* Take the Host Memory Buffer back while the controller is running */
+    NVMeDisableHmb(pAE);
+    NVMeReportPowerStates(pAE);
+
+    /* Delete all queues */
+    if (NVMeResetAdapter(pAE) != TRUE) {
+        return (FALSE);
+    }
+
+    /* Need to to ensure the Controller registers are memory-mapped properly */
+    if ( pAE->pCtrlRegister == FALSE ) {
+        return (FALSE);
+    }
+
+    StorPortDebugPrint(INFO, "NVMeInit.c: Issue Shutdown Notification\n");
+
+    /*
+     * Read Controller Configuration first before setting SHN bits of
+     * Controller Configuration to normal shutdown (01b)
+     */
+    CC.AsUlong = StorPortReadRegisterUlong(pAE,
+                                           (PULONG)(&pAE->pCtrlRegister->CC));
+    CC.SHN = 1;
+    /* Set SHN bits of Controller Configuration to normal shutdown (01b) */
+    StorPortWriteRegisterUlong (pAE,
+                                (PULONG)(&pAE->pCtrlRegister->CC),
+                                CC.AsUlong);
+
+    /* Checking if the adapter is ready for normal shutdown */
+    for (PollCount = 0; PollCount < PollMax; PollCount++) {
+        CSTS.AsUlong = StorPortReadRegisterUlong(pAE,
+                           (PULONG)(&pAE->pCtrlRegister->CSTS.AsUlong));
+
+        if (CSTS.SHST == 2) {
+            StorPortDebugPrint(INFO, "NVMeInit.c: Shutdown Successful\n");
+
+            /* Free the memory if we are doing shutdown */
+            NVMeFreeBuffers(pAE);
+            return (TRUE);
+        }
+
+        NVMeStallExecution(pAE, MAX_STATE_STALL_us);
+    }
+
+#if DBG
+    /*
+     * QEMU: Returning TRUE is a workaround as Qemu device is not returning the
+     * status as shutdown complete. So this is a workaround for QEMU.
+     */
+    NVMeFreeBuffers(pAE);
+    return (TRUE);
+#else /* DBG */
+    return (FALSE);
+#endif /* DBG */
+} /* NVMeNormalShutdown */
+
+/*******************************************************************************
+ * NVMeFreeBuffers
+ *
+ * @brief NVMeFreeBuffers gets called to free buffers that had been allocated.
+ *        The buffers are required to be physically contiguous.
+ *
+ * @param pAE - Pointer to hardware device extension.
+ *
+ * @return VOID
+ ******************************************************************************/
+VOID NVMeFreeBuffers (
+    PNVME_DEVICE_EXTENSION pAE
+)
+{
+    USHORT QueueID;
+    PQUEUE_INFO pQI = &pAE->QueueInfo;
+    PRES_MAPPING_TBL pRMT = &pAE->ResMapTbl;
+    PSUB_QUEUE_INFO pSQI = NULL;
+
+    /* First, free the Start State Data buffer memory allocated by driver */
+    if (pAE->DriverState.pDataBuffer != NULL) {
+        StorPortFreeContiguousMemorySpecifyCache((PVOID)pAE,
+                                                 pAE->DriverState.pDataBuffer,
+                                                 PAGE_SIZE, MmCached);
+        pAE->DriverState.pDataBuffer = NULL;
+    }
+    /* Free the VERIFY discard buffer */
+    if (pAE->pVerifyDiscardBuf != NULL) {
+        StorPortFreeContiguousMemorySpecifyCache((PVOID)pAE,
+                                                 pAE->pVerifyDiscardBuf,
+                                                 VERIFY_DISCARD_BUF_SIZE,
+                                                 MmCached);
+        pAE->pVerifyDiscardBuf = NULL;
+    }
+    /* Free the asynchronous event log page buffer */
+    if (pAE->pAerLogBuf != NULL) {
+        StorPortFreeContiguousMemorySpecifyCache((PVOID)pAE,
+                                                 pAE->pAerLogBuf,
+                                                 AER_LOG_BUF_SIZE, MmCached);
+        pAE->pAerLogBuf = NULL;
+    }
+    /* Free the UNMAP batch page pool */
+    if (pAE->pUnmapPool != NULL) {
+        StorPortFreeContiguousMemorySpecifyCache((PVOID)pAE,
+                                                 pAE->pUnmapPool,
+                                                 UNMAP_POOL_PAGES * PAGE_SIZE,
+                                                 MmCached);
+        pAE->pUnmapPool = NULL;
+    }
+    /*
+     * Free the Host Memory Buffer. It is taken back from the controller
+     * before any path that frees the buffers; should the controller still
+     * own it, leak it rather than free memory it may still write to.
+     */
+    if (pAE->HmbEnabled == FALSE) {
+        NVMeFreeHmb(pAE);
+    } else {
+        ASSERT(pAE->HmbEnabled == FALSE);
+        StorPortDebugPrint(ERROR,
+                           "NVMeFreeBuffers: HMB still enabled, not freed\n");
+    }
+    /* Free the shadow doorbell and EventIdx buffers */
+    if (pAE->pShadowDoorbells != NULL) {
+        StorPortFreeContiguousMemorySpecifyCache((PVOID)pAE,
+                                                 pAE->pShadowDoorbells,
+                                                 PAGE_SIZE,
+                                                 MmCached);
+        pAE->pShadowDoorbells = NULL;
+    }
+    if (pAE->pEventIdx != NULL) {
+        StorPortFreeContiguousMemorySpecifyCache((PVOID)pAE,
+                                                 pAE->pEventIdx,
+                                                 PAGE_SIZE,
+                                                 MmCached);
+        pAE->pEventIdx = NULL;
+    }
+    pAE->DoorbellBufferEnabled = FALSE;
+    /* Free the separate metadata buffer pool */
+    if (pAE->pMetadataPool != NULL) {
+        StorPortFreeContiguousMemorySpecifyCache((PVOID)pAE,
+                                                 pAE->pMetadataPool,
+                                                 METADATA_POOL_CHUNKS *
+                                                 pAE->MetadataChunkSize,
+                                                 MmCached);
+        pAE->pMetadataPool = NULL;
+    }
+    /* Free the NVME_LUN_EXTENSION memory allocated by driver */
+    if (pAE->pLunExtensionTable[0] != NULL) {
+        StorPortFreeContiguousMemorySpecifyCache((PVOID)pAE,
+                                                 pAE->pLunExtensionTable[0],
+                                                 pAE->LunExtSize,
+                                                 MmCached);
+        pAE->pLunExtensionTable[0] = NULL;
+    }
+
+    /* Free the allocated queue entry, command entry and PRP list buffers */
+    if (pQI->pSubQueueInfo != NULL) {
+        for (QueueID = 0; QueueID <= pRMT->NumActiveCores; QueueID++) {
+            pSQI = pQI->pSubQueueInfo + QueueID;
+            NVMeFreeQueueBuffers(pAE, pSQI);
+        }
+    }
+
+    /* Lastly, free the allocated non-contiguous buffers */
+    NVMeFreeNonContiguousBuffers(pAE);
+} /* NVMeFreeBuffers */
+
+/*******************************************************************************
+ * NVMeFreeQueueBuffers
+ *
+ * @brief NVMeFreeQueueBuffers frees the buffers NVMeAllocQueues allocated for
+ *        one queue pair: the Sub/Cpl rings, the command entries and the PRP
+ *        lists, page by page or as contiguous buffers depending on how the
+ *        queue was allocated. Buffers carved from the dump buffer are only forgotten.
+ *
+ * @param pAE - Pointer to hardware device extension.
+ * @param pSQI - Pointer to the submission queue info of the queue pair
+ *
+ * @return VOID
+ ******************************************************************************/
+VOID NVMeFreeQueueBuffers(
+    PNVME_DEVICE_EXTENSION pAE,
+    PSUB_QUEUE_INFO pSQI
+)
+{
+    if ((pAE->ntldrDump == FALSE) && (pSQI->NonContiguous == TRUE)) {
+        NVMeFreeQueuePages(pAE, pSQI->pRingPages, pSQI->NumRingPages);
+
+        if (pSQI->pCmdEntryAlloc != NULL)
+            StorPortFreePool((PVOID)pAE, pSQI->pCmdEntryAlloc);
+
+        NVMeFreeQueuePages(pAE, pSQI->pPRPListPages, pSQI->NumPRPListPages);
+
+        if (pSQI->pQueuePRPAlloc != NULL)
+            StorPortFreeContiguousMemorySpecifyCache((PVOID)pAE,
+                                                     pSQI->pQueuePRPAlloc,
+                                                     pSQI->QueuePRPAllocSize,
+                                                     MmCached);
+    } else if (pAE->ntldrDump == FALSE) {
+        if (pSQI->pQueueAlloc != NULL)
+            StorPortFreeContiguousMemorySpecifyCache((PVOID)pAE,
+                                                     pSQI->pQueueAlloc,
+                                                     pSQI->QueueAllocSize,
+                                                     MmCached);
+
+        if (pSQI->pCmdEntryAlloc != NULL)
+            StorPortFreeContiguousMemorySpecifyCache((PVOID)pAE,
+                                                     pSQI->pCmdEntryAlloc,
+                                                     pSQI->CmdEntryAllocSize,
+                                                     MmCached);
+
+        if (pSQI->pPRPListAlloc != NULL)
+            StorPortFreeContiguousMemorySpecifyCache((PVOID)pAE,
+                                                     pSQI->pPRPListAlloc,
+                                                     pSQI->PRPListAllocSize,
+                                                     MmCached);
+    }
+
+    if (pAE->ntldrDump == FALSE) {
+#ifdef DUMB_DRIVER
+        if (pSQI->pDblBuffAlloc != NULL)
+            StorPortFreeContiguousMemorySpecifyCache((PVOID)pAE,
+                                                     pSQI->pDblBuffAlloc,
+                                                     pSQI->dblBuffSz,
+                                                     MmCached);
+        if (pSQI->pDblBuffListAlloc != NULL)
+            StorPortFreeContiguousMemorySpecifyCache((PVOID)pAE,
+                                                     pSQI->pDblBuffListAlloc,
+                                                     pSQI->dblBuffListSz,
+                                                     MmCached);
+#endif /* DUMB_DRIVER */
+    }
+
+    pSQI->pQueueAlloc = NULL;
+    pSQI->pCmdEntryAlloc = NULL;
+    pSQI->pCmdEntry = NULL;
+    pSQI->pPRPListAlloc = NULL;
+    pSQI->pQueuePRPAlloc = NULL;
+    pSQI->pRingPages = NULL;
+    pSQI->NumRingPages = 0;
+    pSQI->pPRPListPages = NULL;
+    pSQI->NumPRPListPages = 0;
+    pSQI->pSubQPages = NULL;
+    pSQI->NonContiguous = FALSE;
+#ifdef DUMB_DRIVER
+    pSQI->pDblBuffAlloc = NULL;
+    pSQI->pDblBuffListAlloc = NULL;
+#endif /* DUMB_DRIVER */
+} /* NVMeFreeQueueBuffers */
+
+/*******************************************************************************
+ * NVMeReportQueueAllocs
+ *
+ * @brief NVMeReportQueueAllocs logs the depth and memory of every IO queue
+ *        pair, where its buffers ended up relative to the NUMA node they were
+ *        requested from, and the totals of remote allocations accounted by
+ *        NVMeAllocateMemNode. Also sums up IoQBytesAllocated.
+ *
+ * @param pAE - Pointer to hardware device extension.
+ *
+ * @return ULONG
+ *     Number of queue pairs with at least one buffer on a remote node
+ ******************************************************************************/
+ULONG NVMeReportQueueAllocs(
+    PNVME_DEVICE_EXTENSION pAE
+)
+{
+    PQUEUE_INFO pQI = &pAE->QueueInfo;
+    PSUB_QUEUE_INFO pSQI = NULL;
+    ULONG RemoteQueues = 0;
+    ULONG Bytes;
+    USHORT QueueID;
+
+    pQI->IoQBytesAllocated = 0;
+
+    for (QueueID = 1; QueueID <= pQI->NumSubIoQAllocated; QueueID++) {
+        pSQI = pQI->pSubQueueInfo + QueueID;
+        Bytes = pSQI->QueueAllocSize + pSQI->CmdEntryAllocSize +
+                pSQI->PRPListAllocSize;
+        if (pSQI->NonContiguous == TRUE)
+            Bytes += pSQI->QueuePRPAllocSize;
+        pQI->IoQBytesAllocated += Bytes;
+
+        StorPortDebugPrint(INFO,
+            "NVMeReportQueueAllocs: Queue 0x%x node %d, %d entries, %d bytes%s\n",
+            QueueID, pSQI->NumaNode, pSQI->QEntriesAllocated, Bytes,
+            (pSQI->NonContiguous == TRUE) ? ", non-contiguous" : "");
+
+        if (pSQI->RemoteAllocs == 0)
+            continue;
+
+        RemoteQueues++;
+        StorPortDebugPrint(WARNING,
+            "NVMeReportQueueAllocs: Queue 0x%x wanted node %d, remote:%s%s%s\n",
+            QueueID,
+            pSQI->NumaNode,
+            (pSQI->RemoteAllocs & NUMA_ALLOC_QUEUE) ? " rings" : "",
+            (pSQI->RemoteAllocs & NUMA_ALLOC_CMD_ENTRY) ? " cmd-entries" : "",
+            (pSQI->RemoteAllocs & NUMA_ALLOC_PRP_LIST) ? " prp-lists" : "");
+    }
+
+    StorPortDebugPrint(INFO,
+        "NVMeReportQueueAllocs: %d IO queue bytes, %d local, %d remote allocs (%d bytes), %d queue(s) affected\n",
+        pQI->IoQBytesAllocated,
+        pAE->NumaLocalAllocs,
+        pAE->NumaRemoteAllocs,
+        pAE->NumaRemoteBytes,
+        RemoteQueues);
+
+    return RemoteQueues;
+} /* NVMeReportQueueAllocs */
+
+/*******************************************************************************
+ * NVMeIoQueueDepth
+ *
+ * @brief NVMeIoQueueDepth decides how many entries an IO queue pair gets.
+ *        The queue gets IoQEntries unless an adapter wide IoQEntriesTotal
+ *        budget is set, in which case the budget is split by the share of
+ *        active cores mapped to the queue. The result stays within
+ *        [MIN_SHARE_IO_QUEUE_ENTRIES, IoQEntries], and IoQEntries itself was
+ *        already bounded by CAP.MQES in NVMeFindAdapter.
+ *
+ * @param pAE - Pointer to hardware device extension.
+ * @param NumCores - Number of cores submitting to the queue
+ *
+ * @return ULONG
+ *     Number of entries to allocate for the queue pair
+ ******************************************************************************/
+ULONG NVMeIoQueueDepth(
+    PNVME_DEVICE_EXTENSION pAE,
+    ULONG NumCores
+)
+{
+    PRES_MAPPING_TBL pRMT = &pAE->ResMapTbl;
+    ULONG QEntries = pAE->InitInfo.IoQEntries;
+    ULONG Share;
+
+    if ((pAE->InitInfo.IoQEntriesTotal == 0) || (pRMT->NumActiveCores == 0))
+        return (QEntries);
+
+    Share = (ULONG)(((ULONGLONG)pAE->InitInfo.IoQEntriesTotal * NumCores) /
+                    pRMT->NumActiveCores);
+    Share = max(Share, MIN_SHARE_IO_QUEUE_ENTRIES);
+
+    return (min(Share, QEntries));
+} /* NVMeIoQueueDepth */
+
+
+/*******************************************************************************
+ * NVMeFreeNonContiguousBuffers
+ *
+ * @brief NVMeFreeNonContiguousBuffer gets called to free buffers that had been
+ *        allocated without requiring physically contiguous.
+ *
+ * @param pAE - Pointer to hardware device extension.
+ *
+ * @return VOID
+ ******************************************************************************/
+VOID NVMeFreeNonContiguousBuffers (
+    PNVME_DEVICE_EXTENSION pAE
+)
+{
+    PQUEUE_INFO pQI = &pAE->QueueInfo;
+    PRES_MAPPING_TBL pRMT = &pAE->ResMapTbl;
+
+    /* Free the Start State Machine SRB EXTENSION allocated by driver */
+    if (pAE->DriverState.pSrbExt != NULL) {
+        StorPortFreePool((PVOID)pAE, pAE->DriverState.pSrbExt);
+        pAE->DriverState.pSrbExt = NULL;
+    }
+
+    if (pAE->DriverState.pQueueSrbExt != NULL) {
+        StorPortFreePool((PVOID)pAE, pAE->DriverState.pQueueSrbExt);
+        pAE->DriverState.pQueueSrbExt = NULL;
+    }
+
+    if (pAE->pAerSrbExt != NULL) {
+        StorPortFreePool((PVOID)pAE, pAE->pAerSrbExt);
+        pAE->pAerSrbExt = NULL;
+        pAE->pAerWorkSrbExt = NULL;
+    }
+
+    /* Free the resource mapping tables if allocated */
+    if (pRMT->pMsiMsgTbl != NULL) {
+        StorPortFreePool((PVOID)pAE, pRMT->pMsiMsgTbl);
+        pRMT->pMsiMsgTbl = NULL;
+    }
+
+    if (pRMT->pCoreTbl != NULL) {
+        StorPortFreePool((PVOID)pAE, pRMT->pCoreTbl);
+        pRMT->pCoreTbl = NULL;
+    }
+
+    if (pRMT->pNumaNodeTbl != NULL) {
+        StorPortFreePool((PVOID)pAE, pRMT->pNumaNodeTbl);
+        pRMT->pNumaNodeTbl = NULL;
+    }
+
+    if (pRMT->pProcGroupTbl != NULL) {
+        StorPortFreePool((PVOID)pAE, pRMT->pProcGroupTbl);
+        pRMT->pProcGroupTbl = NULL;
+    }
+
+    /* Free the allocated SUB/CPL_QUEUE_INFO structures memory */
+    if ( pQI->pSubQueueInfo != NULL ) {
+        StorPortFreePool((PVOID)pAE, pQI->pSubQueueInfo);
+        pQI->pSubQueueInfo = NULL;
+    }
+
+    if ( pQI->pCplQueueInfo != NULL ) {
+        StorPortFreePool((PVOID)pAE, pQI->pCplQueueInfo);
+        pQI->pCplQueueInfo = NULL;
+    }
+
+    /* Free the DPC array memory */
+    if (pAE->pDpcArray != NULL) {
+        StorPortFreePool((PVOID)pAE, pAE->pDpcArray);
+        pAE->pDpcArray = NULL;
+    }
+
+	/* Free the memory allocated for Group affinity */
+	if (pAE->pArrGrpAff != NULL) {
+		StorPortFreePool((PVOID)pAE, pAE->pArrGrpAff);
+		pAE->pArrGrpAff = NULL;
+	}
+
+} /* NVMeFreeNonContiguousBuffer */
+
+/*******************************************************************************
+ * NVMeAllocIoQueues
+ *
+ * @brief NVMeAllocIoQueues gets called to allocate IO queue(s) from system
+ *        memory after determining the number of queues to allocate. The
+ *        core to queue pair assignment comes from NVMeLocalityMapCores, and
+ *        each queue pair is allocated on the NUMA node of the first core that
+ *        uses it. In the case of failing to allocate memory, it needs to fall
+ *        back to use one queue per adapter and free up the allocated buffers
+ *        that is not used. The scenarios can be described in the follow
+ *        pseudo codes:
+ *
+ *        if (not crashdump) {
+ *            Assign cores to queue pairs by NUMA node and cache domain;
+ *            for (Queue = 1; Queue <= queue pairs; Queue++) {
+ *                Allocate queue pair on the node of its first core;
+ *                if (Succeeded) {
+ *                    Mark down number of queues allocated;
+ *                } else {
+ *                    if (failed on first queue allocation) {
+ *                        return FALSE;
+ *                    } else { //at least one queue allocated
+ *                        // Fall back to one queue per adapter
+ *                        Free up the allocated, not used queues;
+ *                        Mark down number of queues allocated;
+ *                        Note down which queue to use for each core;
+ *                        return TRUE;
+ *                    }
+ *                }
+ *            }
+ *            return TRUE;
+ *        } else {
+ *            // Allocate one queue pair only
+ *            Allocate one queue pair;
+ *            if (Succeeded) {
+ *                Mark down one pair of queues allocated;
+ *                Note down which queue to use for each core;
+ *                return TRUE;
+ *            } else {
+ *                return FALSE;
+ *            }
+ *        }
+ *
+ * @param pAE - Pointer to hardware device extension.
+ *
+ * @return BOOLEAN
+ *     TRUE - If all resources are allocated and initialized properly
+ *     FALSE - If anything goes wrong
+ ******************************************************************************/
+BOOLEAN NVMeAllocIoQueues(
+    PNVME_DEVICE_EXTENSION pAE
+)
+{
+    ULONG Status = STOR_STATUS_SUCCESS;
+    PQUEUE_INFO pQI = &pAE->QueueInfo;
+    PRES_MAPPING_TBL pRMT = &pAE->ResMapTbl;
+    PSUB_QUEUE_INFO pSQI = NULL;
+    PCORE_TBL pCT = NULL;
+    ULONG Core, QEntries;
+    USHORT QueueID = 0;
+    USHORT QueuePairs;
+    ULONG Queue = 0;
+    ULONG NumCores, FirstCore;
+
+    pQI->NumSubIoQAllocated = pQI->NumCplIoQAllocated = 0;
+    pQI->NumIoQEntriesAllocated = 0;
+    pAE->CmbUsed = 0;
+
+    if (pAE->ntldrDump == TRUE) {
+        QEntries = MIN_IO_QUEUE_ENTRIES; 
+        Status = NVMeAllocQueues(pAE,
+                                 QueueID + 1,
+                                 QEntries,
+                                 0);
+    
+        if (Status == STOR_STATUS_SUCCESS) {
+            pQI->NumSubIoQAllocated = ++pQI->NumCplIoQAllocated;
+            return (TRUE);
+        } else {
+            return (FALSE);
+        }
+    } else {
+        /*
+         * If there are more cores than Qs alloc'd from the adapter, cores that
+         * share a last level cache (and so a NUMA node) are packed onto the
+         * same queue pair instead of cycling through the queues.
+         */
+        QueuePairs = (USHORT)min(pQI->NumSubIoQAllocFromAdapter,
+                                 pQI->NumCplIoQAllocFromAdapter);
+        QueuePairs = (USHORT)min(QueuePairs, pRMT->NumActiveCores);
+        if (QueuePairs == 0)
+            return (FALSE);
+
+        NVMeLocalityMapCores(pRMT, QueuePairs);
+
+        if (QueuePairs < pRMT->NumActiveCores)
+            pAE->MultipleCoresToSingleQueueFlag = TRUE;
+
+        for (QueueID = 1; QueueID <= QueuePairs; QueueID++) {
+            /*
+             * Allocate the queue pair close to the first core using it, deep
+             * enough for the number of cores using it.
+             */
+            FirstCore = 0;
+            NumCores = 0;
+            for (Core = pRMT->NumActiveCores; Core > 0; Core--) {
+                pCT = pRMT->pCoreTbl + Core - 1;
+                if (pCT->SubQueue == QueueID) {
+                    FirstCore = Core - 1;
+                    NumCores++;
+                }
+            }
+            pCT = pRMT->pCoreTbl + FirstCore;
+
+            QEntries = NVMeIoQueueDepth(pAE, max(NumCores, 1));
+            Status = NVMeAllocQueues(pAE,
+                                     QueueID,
+                                     QEntries,
+                                     pCT->NumaNode);
+
+            if (Status == STOR_STATUS_SUCCESS) {
+                pQI->NumSubIoQAllocated = ++pQI->NumCplIoQAllocated;
+                StorPortDebugPrint(INFO,
+                    "NVMeAllocIoQueues: QueueID 0x%x on Node 0x%x, %d cores\n",
+                    QueueID, pCT->NumaNode, NumCores);
+                continue;
+            }
+
+            /* If faling on the very first queue allocation, failure case. */
+            if (QueueID == 1)
+                return (FALSE);
+
+            /*
+             * Fall back to share the very first queue allocated.
+             * Free the other allocated queues before returning
+             * and return TRUE.
+             */
+            Queue = 0;
+            for (Core = 1; Core < pRMT->NumActiveCores; Core++) {
+                /* Need to keep first allocated IO queue for sharing */
+                Queue = Core + 1; 
+                pSQI = pQI->pSubQueueInfo + Queue;
+
+                NVMeFreeQueueBuffers(pAE, pSQI);
+            }
+
+            for (Core = 0; Core < pRMT->NumActiveCores; Core++) {
+                pCT = pRMT->pCoreTbl + Core;
+                pCT->SubQueue = pCT->CplQueue = 1;
+            }
+
+            pQI->NumSubIoQAllocated = pQI->NumCplIoQAllocated = 1;
+
+            pAE->MultipleCoresToSingleQueueFlag = TRUE;
+            NVMeReportQueueAllocs(pAE);
+            return (TRUE);
+        } /* current queue pair */
+
+        NVMeReportQueueAllocs(pAE);
+        return (TRUE);
+    }
+} /* NVMeAllocIoQueues */
+/*******************************************************************************
+ * NVMeAcqQueueEntry
+ *
+ * @brief NVMeAcqQueueEntry gets called to retrieve a Command Info entry from
+ *        the head of the specified FreeQ
+ *
+ * @param pAE - Pointer to hardware device extension.
+ * @param pFreeQ - Pointer to the FreeQ
+ * @param queue - Which queue to retrieve entry from
+ *
+ * @return PCMD_ENTRY
+ *     Success: A poiter to the CMD_ENTRY structure
+ *     Failure: A NULL pointer
+ ******************************************************************************/
+PCMD_ENTRY NVMeAcqQueueEntry(
+    PNVME_DEVICE_EXTENSION pAE,
+    PLIST_ENTRY pFreeQ
+)
+{
+    PLIST_ENTRY pListEntry = NULL;
+    PCMD_ENTRY pCmdEntry = NULL;
+
+    if (IsListEmpty(pFreeQ) == FALSE) {
+        pListEntry = (PLIST_ENTRY) RemoveHeadList(pFreeQ);
+        pCmdEntry = CONTAINING_RECORD(pListEntry, CMD_ENTRY, ListEntry);
+
+        StorPortDebugPrint(TRACE,
+                           "NVMeAcqQueueEntry : Entry at 0x%p\n",
+                           pCmdEntry);
+    } else {
+        StorPortDebugPrint(WARNING,
+                           "NVMeAcqQueueEntry: <Warning> No entry acquired.\n");
+    }
+
+    return pCmdEntry;
+} /* NVMeAcqQueueEntry */
+
+/*******************************************************************************
+ * NVMeGetCmdEntry
+ *
+ * @brief NVMeGetCmdEntry gets called to acquire an command entry for a request
+ *        which needs to be processed in adapter. The returned CMD_INFO contains
+ *        CmdID and the associated PRPList that might be used when necessary.
+ *
+ * @param pAE - Pointer to hardware device extension.
+ * @param QueueID - Which submission queue to acquire Cmd ID from
+ * @param Context - Depending on callers, this can be the original SRB of the
+ *                  request or anything else.
+ * @param pCmdInfo - Pointer to a caller prepared buffer where the acquired
+ *                   command info is saved.
+ *
+ * @return ULONG
+ *     STOR_STATUS_SUCCESS - If a CmdID is successfully acquired
+ *     Otherwise - If anything goes wrong
+ ******************************************************************************/
+ULONG NVMeGetCmdEntry(
+    PNVME_DEVICE_EXTENSION pAE,
+    USHORT QueueID,
+    PVOID Context,
+    PVOID pCmdInfo
+)
+{
+    PQUEUE_INFO pQI = &pAE->QueueInfo;
+    PSUB_QUEUE_INFO pSQI = NULL;
+    PCMD_ENTRY pCmdEntry = NULL;
+    PLIST_ENTRY pListEntry = NULL;
+
+    if (QueueID > pQI->NumSubIoQCreated || pCmdInfo == NULL)
+        return (STOR_STATUS_INVALID_PARAMETER);
+
+    pSQI = pQI->pSubQueueInfo + QueueID;
+
+    if (!IsListEmpty(&pSQI->FreeQList)) {
+        /* Retrieve a free CMD_INFO entry for the request */
+        pListEntry = RemoveHeadList(&pSQI->FreeQList);
+        pCmdEntry = (PCMD_ENTRY)CONTAINING_RECORD(pListEntry, CMD_ENTRY, ListEntry);
+    } else {
+        StorPortDebugPrint(ERROR,
+                           "NVMeGetCmdEntry: <Error> Queue#%d is full!\n",
+                           QueueID);
+        return (STOR_STATUS_INSUFFICIENT_RESOURCES);
+    }
+
+
+    /* Mark down it's used and save the original context */
+    pCmdEntry->Context = Context;
+    ASSERT(pCmdEntry->Pending == FALSE);
+
+    pCmdEntry->Pending = TRUE;
+
+    /* Return the CMD_INFO structure */
+    *(ULONG_PTR *)pCmdInfo = (ULONG_PTR)(&pCmdEntry->CmdInfo);
+
+    return (STOR_STATUS_SUCCESS);
+} /* NVMeGetCmdEntry */
+
+/*******************************************************************************
+ * NVMeGetCplEntry
+ *
+ * @brief NVMeGetCplEntry gets called to retrieve one completion queue entry at
+ *        a time from the specified completion queue. This routine is
+ *        responsible for looking up teh embedded PhaseTag and determine if the
+ *        entry is a newly completed one. If not, return
+ *        STOR_STATUS_UNSUCCESSFUL. Otherwise, do the following:
+ *
+ *        1. Copy the completion entry to pCplEntry
+ *        2. Increase the Completion Queue Head Pointer by one.
+ *        3. Reset the Head Pointer to 0 and change CurPhaseTag if it's equal to
+ *           the associated CplQEntries
+ *        4. Program the associated Doorbell register with the Head Pointer
+ *        5. Return STOR_STATUS_SUCCESS
+ *
+ * @param pAE - Pointer to hardware device extension.
+ * @param QueueID - Which completion queue to retrieve entry from
+ * @param pCplEntry - The caller prepared buffer to save the retrieved entry
+ *
+ * @return ULONG
+ *    STOR_STATUS_SUCCESS - If there is one newly completed entry returned
+ *    STOR_STATUS_UNSUCCESSFUL - If there is no newly completed entry
+ *    Otherwise - If anything goes wrong
+ ******************************************************************************/
+ULONG NVMeGetCplEntry(
+    PNVME_DEVICE_EXTENSION pAE,
+    PCPL_QUEUE_INFO pCQI,
+    PVOID pCplEntry
+)
+{
+    PQUEUE_INFO pQI = &pAE->QueueInfo;
+    PNVMe_COMPLETION_QUEUE_ENTRY pCQE = NULL;
+
+    /* Make sure the parameters are valid */
+    if (pCQI->CplQueueID > pQI->NumCplIoQCreated || pCplEntry == NULL)
+        return (STOR_STATUS_INVALID_PARAMETER);
+
+    pCQE = NVME_CPLQ_ENTRY(pCQI, pCQI->CplQHeadPtr);
+
+    /* Check Phase Tag to determine if it's a newly completed entry */
+    if (pCQI->CurPhaseTag != pCQE->DW3.SF.P) {
+        *(ULONG_PTR *)pCplEntry = (ULONG_PTR)pCQE;
+        pCQI->CplQHeadPtr++;
+        pCQI->Completions++;
+
+        if (pCQI->CplQHeadPtr == pCQI->CplQEntries) {
+            pCQI->CplQHeadPtr = 0;
+            pCQI->CurPhaseTag = !pCQI->CurPhaseTag;
+        }
+
+        return STOR_STATUS_SUCCESS;
+    }
+
+    return STOR_STATUS_UNSUCCESSFUL;
+} /* NVMeGetCplEntry */
+
+/*******************************************************************************
+ * NVMeReadRegistry
+ *
+ * @brief This function gets called to fetch values of sub-keys from Registry
+ *        and it calls StorPortRegistryRead to complete.
+ *
+ * @param pAE - Pointer to Device Extension
+ * @param pLabel - Pointer to the string name
+ * @param Type - The Regsitry data type
+ * @param pBuffer - The buffer holding the value
+ * @param pLen - The buffer holding the length of readback data
+ *
+ * @return BOOLEAN
+ *     Returns TRUE when no error encountered, otherwise, FALSE.
+ ******************************************************************************/
+BOOLEAN NVMeReadRegistry(
+    PNVME_DEVICE_EXTENSION pAE,
+    UCHAR* pLabel,
+    ULONG Type,
+    UCHAR* pBuffer,
+    ULONG* pLen
+)
+{
+    BOOLEAN Ret = FALSE;
+
+    Ret = StorPortRegistryRead(pAE,
+                               pLabel,
+                               1,
+                               Type,
+                               pBuffer,
+                               pLen);
+
+    if (Ret == FALSE || (*pLen) == 0) {
+        StorPortDebugPrint(ERROR,
+                           "NVMeReadRegistry: <Error> ret = 0x%x\n",
+                           Ret);
+        return (FALSE);
+    }
+
+    if (*((PULONG)pBuffer) == REGISTRY_KEY_NOT_FOUND) {
+        StorPortDebugPrint(ERROR,
+                           "NVMeReadRegistry: <Error> Registry is not found\n");
+        return (FALSE);
+    }
+
+    return (TRUE);
+} /* NVMeReadRegistry */
+
+/*******************************************************************************
+ * NVMeWriteRegistry
+ *
+ * @brief This function gets called to write values of sub-keys in Registry and
+ *        it calls StorPortRegistryWrite to complete.
+ *
+ * @param pAE - Pointer to Device Extension
+ * @param pLabel - Pointer to the string name
+ * @param Type - The Regsitry data type
+ * @param pBuffer - The buffer holding the value
+ * @param Len - The length of data to write
+ *
+ * @return BOOLEAN
+ *     Returns TRUE when no error encountered, otherwise, FALSE.
+ ******************************************************************************/
+BOOLEAN NVMeWriteRegistry(
+    PNVME_DEVICE_EXTENSION pAE,
+    UCHAR* pLabel,
+    ULONG Type,
+    UCHAR* pBuffer,
+    ULONG Len
+)
+{
+    BOOLEAN Ret = FALSE;
+
+    Ret = StorPortRegistryWrite(pAE,
+                                pLabel,
+                                1,
+                                Type,
+                                pBuffer,
+                                Len);
+
+    if ( Ret == FALSE ) {
+        StorPortDebugPrint(ERROR,
+                           "NVMeWriteRegistry: <Error> ret = 0x%x\n",
+                           Ret);
+        return (FALSE);
+    }
+
+    return (TRUE);
+} /* NVMeWriteRegistry */
+
+/*******************************************************************************
+ * NVMeFetchRegistry
+ *
+ * @brief NVMeFetchRegistry gets called to fetch all the default values from
+ *        Registry when the driver first loaded. The sub-keys are:
+ *
+ *        Namespace: The supported number of Namespace
+ *        TranSize: Max transfer size in bytes with one request
+ *        AdQueueEntries: The number of Admin queue entries, 128 by default
+ *        IoQueueEntries: The number of IO queue entries, 1024 by default
+ *        IntCoalescingTime: The frequency of interrupt coalescing time in 100
+ *                           ms increments
+ *        IntCoalescingEntry: The frequency of interrupt coalescing entries
+ *        Streams: Write streams to allocate per namespace, 0 to not use them
+ *        HmbMaxSize: Largest Host Memory Buffer in MB, 0 to not use one
+ *        ShadowDoorbells: 1 to use Doorbell Buffer Config when supported
+ *        ApstMaxLatency: APST exit latency budget in us, 0 to disable APST
+ *        FastResume: 1 to keep the namespaces across S3/S4 resume
+ *        PredictableLatency: 1 to use Predictable Latency Mode when supported
+ *
+ * @param pAE - Device Extension
+ *
+ * @return BOOLEAN
+ *     Returns TRUE when no error encountered, otherwise, FALSE.
+ ******************************************************************************/
+BOOLEAN NVMeFetchRegistry(
+    PNVME_DEVICE_EXTENSION pAE
+)
+{
+    UCHAR NAMESPACES[] = "Namespaces";
+    UCHAR MAXTXSIZE[] = "MaxTXSize";
+    UCHAR ADQUEUEENTRY[] = "AdQEntries";
+    UCHAR IOQUEUEENTRY[] = "IoQEntries";
+    UCHAR IOQUEUEENTRYTOTAL[] = "IoQEntriesTotal";
+    UCHAR INTCOALESCINGTIME[] = "IntCoalescingTime";
+    UCHAR INTCOALESCINGENTRY[] = "IntCoalescingEntries";
+    UCHAR STREAMS[] = "Streams";
+    UCHAR SQINCMB[] = "SqInCmb";
+    UCHAR HMBMAXSIZE[] = "HmbMaxSize";
+    UCHAR SHADOWDOORBELLS[] = "ShadowDoorbells";
+    UCHAR APSTMAXLATENCY[] = "ApstMaxLatency";
+    UCHAR FASTRESUME[] = "FastResume";
+    UCHAR PREDICTABLELATENCY[] = "PredictableLatency";
+
+    ULONG Type = MINIPORT_REG_DWORD;
+    UCHAR* pBuf = NULL;
+    ULONG Len = sizeof(ULONG);
+
+    /* Allocate the buffer from Storport API and zero it out if succeeded */
+    pBuf = StorPortAllocateRegistryBuffer(pAE, &Len);
+    if (pBuf == NULL)
+        return (FALSE);
+
+    memset(pBuf, 0, sizeof(ULONG));
+
+    /*
+     * Fetch the following initial values from
+     * HKLM\System\CurrentControlSet\Services\NVMeOSD\Parameters\Device\
+     * NVMeOSD stands for NVM Express Open Source Driver
+     */
+    if (NVMeReadRegistry(pAE,
+                         NAMESPACES,
+                         Type,
+                         pBuf,
+                         (ULONG*)&Len ) == TRUE ) {
+        if (RANGE_CHK(*(PULONG)pBuf,
+                      MIN_NAMESPACES,
+                      MAX_NAMESPACES) == TRUE) {
+            StorPortCopyMemory((PVOID)(&pAE->InitInfo.Namespaces),
+                   (PVOID)pBuf,
+                   sizeof(ULONG));
+        }
+    }
+
+    memset(pBuf, 0, sizeof(ULONG));
+
+    if (NVMeReadRegistry(pAE,
+                         MAXTXSIZE,
+                         Type,
+                         pBuf,
+                         (ULONG*)&Len ) == TRUE ) {
+        if (RANGE_CHK(*(PULONG)pBuf, MIN_TX_SIZE, MAX_TX_SIZE) == TRUE) {
+            StorPortCopyMemory((PVOID)(&pAE->InitInfo.MaxTxSize),
+                   (PVOID)pBuf,
+                   sizeof(ULONG));
+        }
+    }
+
+    memset(pBuf, 0, sizeof(ULONG));
+
+    if (NVMeReadRegistry(pAE,
+                         ADQUEUEENTRY,
+                         Type,
+                         pBuf,
+                         (ULONG*)&Len ) == TRUE ) {
+        if (RANGE_CHK(*(PULONG)pBuf,
+                      MIN_AD_QUEUE_ENTRIES,
+                      MAX_AD_QUEUE_ENTRIES) == TRUE) {
+            StorPortCopyMemory((PVOID)(&pAE->InitInfo.AdQEntries),
+                   (PVOID)pBuf,
+                   sizeof(ULONG));
+        }
+    }
+
+    memset(pBuf, 0, sizeof(ULONG));
+
+    if (NVMeReadRegistry(pAE,
+                         IOQUEUEENTRY,
+                         Type,
+                         pBuf,
+                         (ULONG*)&Len ) == TRUE ) {
+        if (RANGE_CHK(*(PULONG)pBuf,
+                      MIN_IO_QUEUE_ENTRIES,
+                      MAX_IO_QUEUE_ENTRIES) == TRUE) {
+            StorPortCopyMemory((PVOID)(&pAE->InitInfo.IoQEntries),
+                   (PVOID)pBuf,
+                   sizeof(ULONG));
+        }
+    }
+
+    memset(pBuf, 0, sizeof(ULONG));
+
+    if (NVMeReadRegistry(pAE,
+                         IOQUEUEENTRYTOTAL,
+                         Type,
+                         pBuf,
+                         (ULONG*)&Len ) == TRUE ) {
+        if (RANGE_CHK(*(PULONG)pBuf,
+                      MIN_IO_QUEUE_ENTRIES_TOTAL,
+                      MAX_IO_QUEUE_ENTRIES_TOTAL) == TRUE) {
+            StorPortCopyMemory((PVOID)(&pAE->InitInfo.IoQEntriesTotal),
+                   (PVOID)pBuf,
+                   sizeof(ULONG));
+        }
+    }
+
+    memset(pBuf, 0, sizeof(ULONG));
+
+    if (NVMeReadRegistry(pAE,
+                         INTCOALESCINGTIME,
+                         Type,
+                         pBuf,
+                         (ULONG*)&Len ) == TRUE ) {
+        if (RANGE_CHK(*(PLONG)pBuf,
+                      MIN_INT_COALESCING_TIME,
+                      MAX_INT_COALESCING_TIME) == TRUE) {
+            StorPortCopyMemory((PVOID)(&pAE->InitInfo.IntCoalescingTime),
+                   (PVOID)pBuf,
+                   sizeof(ULONG));
+        }
+    }
+
+    memset(pBuf, 0, sizeof(ULONG));
+
+    if (NVMeReadRegistry(pAE,
+                         INTCOALESCINGENTRY,
+                         Type,
+                         pBuf,
+                         (ULONG*)&Len ) == TRUE ) {
+        if (RANGE_CHK(*(PLONG)pBuf,
+                      MIN_INT_COALESCING_ENTRY,
+                      MAX_INT_COALESCING_ENTRY) == TRUE) {
+            StorPortCopyMemory((PVOID)(&pAE->InitInfo.IntCoalescingEntry),
+                   (PVOID)pBuf,
+                   sizeof(ULONG));
+        }
+    }
+
+    memset(pBuf, 0, sizeof(ULONG));
+
+    if (NVMeReadRegistry(pAE,
+                         STREAMS,
+                         Type,
+                         pBuf,
+                         (ULONG*)&Len ) == TRUE ) {
+        if (RANGE_CHK(*(PULONG)pBuf, MIN_STREAMS, MAX_STREAMS) == TRUE) {
+            StorPortCopyMemory((PVOID)(&pAE->InitInfo.Streams),
+                   (PVOID)pBuf,
+                   sizeof(ULONG));
+        }
+    }
+
+    memset(pBuf, 0, sizeof(ULONG));
+
+    if (NVMeReadRegistry(pAE,
+                         SQINCMB,
+                         Type,
+                         pBuf,
+                         (ULONG*)&Len ) == TRUE ) {
+        if (RANGE_CHK(*(PULONG)pBuf, MIN_SQ_IN_CMB, MAX_SQ_IN_CMB) == TRUE) {
+            StorPortCopyMemory((PVOID)(&pAE->InitInfo.SqInCmb),
+                   (PVOID)pBuf,
+                   sizeof(ULONG));
+        }
+    }
+
+    memset(pBuf, 0, sizeof(ULONG));
+
+    if (NVMeReadRegistry(pAE,
+                         HMBMAXSIZE,
+                         Type,
+                         pBuf,
+                         (ULONG*)&Len ) == TRUE ) {
+        if (RANGE_CHK(*(PULONG)pBuf, MIN_HMB_MAX_SIZE, MAX_HMB_MAX_SIZE) == TRUE) {
+            StorPortCopyMemory((PVOID)(&pAE->InitInfo.HmbMaxSize),
+                   (PVOID)pBuf,
+                   sizeof(ULONG));
+        }
+    }
+
+    memset(pBuf, 0, sizeof(ULONG));
+
+    if (NVMeReadRegistry(pAE,
+                         SHADOWDOORBELLS,
+                         Type,
+                         pBuf,
+                         (ULONG*)&Len ) == TRUE ) {
+        if (RANGE_CHK(*(PULONG)pBuf, MIN_SHADOW_DOORBELLS, MAX_SHADOW_DOORBELLS) == TRUE) {
+            StorPortCopyMemory((PVOID)(&pAE->InitInfo.ShadowDoorbells),
+                   (PVOID)pBuf,
+                   sizeof(ULONG));
+        }
+    }
+
+    memset(pBuf, 0, sizeof(ULONG));
+
+    if (NVMeReadRegistry(pAE,
+                         APSTMAXLATENCY,
+                         Type,
+                         pBuf,
+                         (ULONG*)&Len ) == TRUE ) {
+        if (RANGE_CHK(*(PULONG)pBuf, MIN_APST_MAX_LATENCY, MAX_APST_MAX_LATENCY) == TRUE) {
+            StorPortCopyMemory((PVOID)(&pAE->InitInfo.ApstMaxLatency),
+                   (PVOID)pBuf,
+                   sizeof(ULONG));
+        }
+    }
+
+    memset(pBuf, 0, sizeof(ULONG));
+
+    if (NVMeReadRegistry(pAE,
+                         FASTRESUME,
+                         Type,
+                         pBuf,
+                         (ULONG*)&Len ) == TRUE ) {
+        if (RANGE_CHK(*(PULONG)pBuf, MIN_FAST_RESUME, MAX_FAST_RESUME) == TRUE) {
+            StorPortCopyMemory((PVOID)(&pAE->InitInfo.FastResume),
+                   (PVOID)pBuf,
+                   sizeof(ULONG));
+        }
+    }
+
+    memset(pBuf, 0, sizeof(ULONG));
+
+    if (NVMeReadRegistry(pAE,
+                         PREDICTABLELATENCY,
+                         Type,
+                         pBuf,
+                         (ULONG*)&Len ) == TRUE ) {
+        if (RANGE_CHK(*(PULONG)pBuf,
+                      MIN_PREDICTABLE_LATENCY,
+                      MAX_PREDICTABLE_LATENCY) == TRUE) {
+            StorPortCopyMemory((PVOID)(&pAE->InitInfo.PredictableLatency),
+                   (PVOID)pBuf,
+                   sizeof(ULONG));
+        }
+    }
+
+    /* Release the buffer before returning */
+    StorPortFreeRegistryBuffer( pAE, pBuf );
+
+    return (TRUE);
+} /* NVMeFetchRegistry */
+
+/*******************************************************************************
+ * NVMeMapCmb
+ *
+ * @brief NVMeMapCmb gets called from FindAdapter to map the Controller Memory
+ *        Buffer when the controller has one that can hold submission queues.
+ *        Access ranges are assigned in BAR order, one per implemented BAR, so
+ *        PCI config space is only walked to find which access range belongs
+ *        to the BAR named by CMBLOC; the address itself comes from that
+ *        access range. Up to CMB_MAX_MAP_SIZE bytes of it are mapped. Nothing
+ *        is mapped, and the IO queues stay in host memory, if any step fails.
+ *
+ * @param pAE - Pointer to hardware device extension.
+ * @param pPCI - Pointer to the port configuration passed to FindAdapter
+ *
+ * @return BOOLEAN
+ *     TRUE - The CMB is mapped and enabled
+ ******************************************************************************/
+BOOLEAN NVMeMapCmb(
+    PNVME_DEVICE_EXTENSION pAE,
+    PPORT_CONFIGURATION_INFORMATION pPCI
+)
+{
+    PCI_COMMON_CONFIG PciConfig = {0};
+    PACCESS_RANGE pRange = NULL;
+    NVMe_CONTROLLER_CAPABILITIES CAP = {0};
+    NVMe_CMB_MEMORY_SPACE_CONTROL CMBMSC = {0};
+    NVMe_CMB_LOCATION CMBLOC = {0};
+    NVMe_CMB_SIZE CMBSZ = {0};
+    STOR_PHYSICAL_ADDRESS CmbPhys = {0};
+    ULONGLONG Unit = 0;
+    ULONGLONG Offset = 0;
+    ULONGLONG Size = 0;
+    ULONG BarValue = 0;
+    ULONG Bar = 0;
+    ULONG Index = 0;
+    ULONG Range = 0;
+
+    /* Newer controllers hide CMBLOC/CMBSZ until asked for them */
+    CAP.HighPart = StorPortReadRegisterUlong(pAE,
+        (PULONG)(&pAE->pCtrlRegister->CAP.HighPart));
+    if (CAP.CMBS == 1) {
+        CMBMSC.CRE = 1;
+        StorPortWriteRegisterUlong(pAE,
+            (PULONG)(&pAE->pCtrlRegister->CMBMSC.LowPart),
+            CMBMSC.LowPart);
+    }
+
+    CMBLOC.AsUlong = StorPortReadRegisterUlong(pAE,
+        (PULONG)(&pAE->pCtrlRegister->CMBLOC));
+    CMBSZ.AsUlong = StorPortReadRegisterUlong(pAE,
+        (PULONG)(&pAE->pCtrlRegister->CMBSZ));
+
+    if ((CMBSZ.SZ == 0) || (CMBSZ.SQS == 0))
+        return (FALSE);
+
+    Unit = (ULONGLONG)(4 * 1024) << (4 * CMBSZ.SZU);
+    Offset = Unit * CMBLOC.OFST;
+    Size = min(Unit * CMBSZ.SZ, CMB_MAX_MAP_SIZE);
+
+    /* BIR 1 is the upper half of the 64 bit BAR 0 */
+    Bar = CMBLOC.BIR;
+    if ((Bar == 1) || (Bar >= PCI_TYPE0_ADDRESSES))
+        return (FALSE);
+
+    if (StorPortGetBusData(pAE,
+                           PCIConfiguration,
+                           pPCI->SystemIoBusNumber,
+                           pPCI->SlotNumber,
+                           (PVOID)&PciConfig,
+                           PCI_COMMON_HDR_LENGTH) != PCI_COMMON_HDR_LENGTH)
+        return (FALSE);
+
+    /* Count the access ranges of the implemented BARs before ours */
+    while (Index < Bar) {
+        BarValue = PciConfig.u.type0.BaseAddresses[Index++];
+        if (BarValue == 0)
+            continue;
+
+        Range++;
+
+        /* The upper half of a 64 bit BAR has no access range of its own */
+        if (((BarValue & PCI_ADDRESS_IO_SPACE) == 0) &&
+            ((BarValue & PCI_ADDRESS_MEMORY_TYPE_MASK) == PCI_TYPE_64BIT))
+            Index++;
+    }
+
+    /* CMBLOC named the upper half of a 64 bit BAR, or an empty BAR */
+    if ((Index != Bar) ||
+        (PciConfig.u.type0.BaseAddresses[Bar] == 0) ||
+        (Range >= pPCI->NumberOfAccessRanges))
+        return (FALSE);
+
+    pRange = &(*(pPCI->AccessRanges))[Range];
+    if ((pRange->RangeInMemory == FALSE) ||
+        (Offset >= pRange->RangeLength))
+        return (FALSE);
+
+    Size = min(Size, pRange->RangeLength - Offset);
+    CmbPhys.QuadPart = pRange->RangeStart.QuadPart + Offset;
+
+    pAE->pCmb = (PUCHAR)StorPortGetDeviceBase(pAE,
+                                              pPCI->AdapterInterfaceType,
+                                              pPCI->SystemIoBusNumber,
+                                              CmbPhys,
+                                              (ULONG)Size,
+                                              FALSE);
+    if (pAE->pCmb == NULL)
+        return (FALSE);
+
+    pAE->CmbPhys = CmbPhys;
+    pAE->CmbSize = (ULONG)Size;
+    NVMeEnableCmb(pAE);
+
+    StorPortDebugPrint(INFO,
+                       "NVMeMapCmb: BAR %d offset 0x%llx, 0x%x bytes mapped\n",
+                       Bar, Offset, pAE->CmbSize);
+
+    return (TRUE);
+} /* NVMeMapCmb */
+
+/*******************************************************************************
+ * NVMeEnableCmb
+ *
+ * @brief NVMeEnableCmb gets called to (re)enable accesses to the mapped
+ *        Controller Memory Buffer, at map time and before each start of the
+ *        init state machine. Only controllers reporting CAP.CMBS need it.
+ *
+ * @param pAE - Pointer to hardware device extension.
+ *
+ * @return VOID
+ ******************************************************************************/
+VOID NVMeEnableCmb(
+    PNVME_DEVICE_EXTENSION pAE
+)
+{
+    NVMe_CONTROLLER_CAPABILITIES CAP = {0};
+    NVMe_CMB_MEMORY_SPACE_CONTROL CMBMSC = {0};
+
+    if (pAE->pCmb == NULL)
+        return;
+
+    CAP.HighPart = StorPortReadRegisterUlong(pAE,
+        (PULONG)(&pAE->pCtrlRegister->CAP.HighPart));
+    if (CAP.CMBS == 0)
+        return;
+
+    /* The CMB is page aligned, the low bits hold the enables */
+    CMBMSC.AsUlonglong = (ULONGLONG)pAE->CmbPhys.QuadPart;
+    CMBMSC.CRE = 1;
+    CMBMSC.CMSE = 1;
+    StorPortWriteRegisterUlong(pAE,
+        (PULONG)(&pAE->pCtrlRegister->CMBMSC.HighPart),
+        CMBMSC.HighPart);
+    StorPortWriteRegisterUlong(pAE,
+        (PULONG)(&pAE->pCtrlRegister->CMBMSC.LowPart),
+        CMBMSC.LowPart);
+} /* NVMeEnableCmb */
+
+/*******************************************************************************
+ * NVMeUnmapCmb
+ *
+ * @brief NVMeUnmapCmb gets called when the adapter is stopped or removed to
+ *        release the Controller Memory Buffer mapping NVMeMapCmb set up. The
+ *        IO queues must no longer be in use.
+ *
+ * @param pAE - Pointer to hardware device extension.
+ *
+ * @return VOID
+ ******************************************************************************/
+VOID NVMeUnmapCmb(
+    PNVME_DEVICE_EXTENSION pAE
+)
+{
+    if (pAE->pCmb == NULL)
+        return;
+
+    StorPortFreeDeviceBase(pAE, (PVOID)pAE->pCmb);
+
+    pAE->pCmb = NULL;
+    pAE->CmbPhys.QuadPart = 0;
+    pAE->CmbSize = 0;
+} /* NVMeUnmapCmb */
+
+/*******************************************************************************
+ * NVMeMaskInterrupts
+ *
+ * @brief Masks/disables the interrupts
+ *
+ * @param pAE - Device Extension
+ *
+ * @return VOID
+ ******************************************************************************/
+VOID NVMeMaskInterrupts(
+    PNVME_DEVICE_EXTENSION pAE
+)
+{
+    PRES_MAPPING_TBL pRMT = &pAE->ResMapTbl;
+
+    /* Determine the Interrupt type */
+    switch (pRMT->InterruptType) {
+        case INT_TYPE_INTX: {
+            StorPortDebugPrint(INFO,
+                "NVMeDisableInterrupts: Disabled INTx interrupts\n");
+            break;
+        }
+        case INT_TYPE_MSIX: {
+            break;
+        }
+        case INT_TYPE_MSI: {
+            break;
+        }
+        case INT_TYPE_NONE:
+        default: {
+            StorPortDebugPrint(ERROR,
+                "NVMeDisableInterrupts: Unrecognized intr type\n");
+            break;
+        }
+    }
+} /* NVMeMaskInterrupts */
+
+/*******************************************************************************
+ * NVMeUnmaskInterrupts
+ *
+ * @brief Unmasks/Enables the interrupts
+ *
+ * @param pAE - Device Extension
+ *
+ * @return VOID
+ ******************************************************************************/
+VOID NVMeUnmaskInterrupts(
+    PNVME_DEVICE_EXTENSION pAE
+)
+{
+    PRES_MAPPING_TBL pRMT = &pAE->ResMapTbl;
+
+    /* Determine the Interrupt type */
+    switch (pRMT->InterruptType) {
+        case INT_TYPE_INTX: {
+            StorPortDebugPrint(INFO,
+                "NVMeDisableInterrupts: Disabled INTx interrupts\n");
+            break;
+        }
+        case INT_TYPE_MSIX: {
+            break;
+        }
+        case INT_TYPE_MSI: {
+            break;
+        }
+        case INT_TYPE_NONE:
+        default: {
+            StorPortDebugPrint(ERROR,
+                "NVMeDisableInterrupts: Unrecognized intr type\n");
+            break;
+        }
+    }
+} /* NVMeUnmaskInterrupts */
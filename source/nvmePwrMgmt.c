@@ -1,391 +1,662 @@
-/**
- *******************************************************************************
- ** Copyright (c) 2011-2012                                                   **
- **                                                                           **
- **   Integrated Device Technology, Inc.                                      **
- **   Intel Corporation                                                       **
- **   LSI Corporation                                                         **
- **                                                                           **
- ** All rights reserved.                                                      **
- **                                                                           **
- *******************************************************************************
- **                                                                           **
- ** Redistribution and use in source and binary forms, with or without        **
- ** modification, are permitted provided that the following conditions are    **
- ** met:                                                                      **
- **                                                                           **
- **   1. Redistributions of source code must retain the above copyright       **
- **      notice, this list of conditions and the following disclaimer.        **
- **                                                                           **
- **   2. Redistributions in binary form must reproduce the above copyright    **
- **      notice, this list of conditions and the following disclaimer in the  **
- **      documentation and/or other materials provided with the distribution. **
- **                                                                           **
- ** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS   **
- ** IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, **
- ** THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR    **
- ** PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR         **
- ** CONTRIBUTORS BE LIABLE FOR ANY DIRECT,INDIRECT, INCIDENTAL, SPECIAL,      **
- ** EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,       **
- ** PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR        **
- ** PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF    **
- ** LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING      **
- ** NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS        **
- ** SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.              **
- **                                                                           **
- ** The views and conclusions contained in the software and documentation     **
- ** are those of the authors and should not be interpreted as representing    **
- ** official policies, either expressed or implied, of Intel Corporation,     **
- ** Integrated Device Technology Inc., or Sandforce Corporation.              **
- **                                                                           **
- *******************************************************************************
-**/
-
-/*
- * File: nvmePwrMgmt.c
- */
-
-#include "precomp.h"
-#ifndef DBG
-#include "nvmePwrMgmt.tmh"
-#endif
-
-/*******************************************************************************
- * NVMeAdapterControlPowerUp
- *
- * @brief Routine for powering up the controller
- * 
- * @param pAE - pointer to device extension
- * 
- * @return BOOLEAN
- *     TRUE - command was processed successfully
- *     FALSE - If anything goes wrong
- ******************************************************************************/
-BOOLEAN NVMeAdapterControlPowerUp(
-    IN PNVME_DEVICE_EXTENSION pAE
-)
-{
-    BOOLEAN status = TRUE;
-
-    /* Reset the controller */
-    if (NVMeReInitializeController(pAE) == FALSE) {
-        NVMeFreeBuffers(pAE);
-        return (FALSE);
-    }
-
-    pAE->ShutdownInProgress = FALSE;
-    StorPortDebugPrint(INFO, "NvmeAdapterControlPowerUp: returning TRUE\n");
-    return status;
-}
-
-/*******************************************************************************
- * NVMeAdapterControlPowerDown
- *
- * @brief This function is called when srb function is SRB_FUNCTION_POWER or
- *        from NVMeAdapterControl when Control type is ScsiStopAdapter.
- * 
- * @param pAE - pointer to device extension
- * 
- * @return BOOLEAN
- *     TRUE - command was processed successfully
- *     FALSE - If anything goes wrong
- ******************************************************************************/
-BOOLEAN NVMeAdapterControlPowerDown(
-    IN PNVME_DEVICE_EXTENSION pAE
-)
-{
-    BOOLEAN status = FALSE;
-
-    ASSERT(pAE != NULL);
-
-    /*
-     * The controller is powered down when we get SRB_FUNCTION_POWER in
-     * StartIo... nothing else to do, just return.
-     */
-    if (pAE->ShutdownInProgress == TRUE) {
-        /* Shutdown */
-        status = TRUE;
-    } else {
-		pAE->ShutdownInProgress = TRUE;
-
-        /* Hibernate or Sleep - sanity check that there is no cmd pending */
-        if (NVMeDetectPendingCmds(pAE, FALSE, SRB_STATUS_BUS_RESET) == TRUE)
-            return status;
-
-        /* Stop the controller, but do not free the resources */
-        if (NVMeResetAdapter(pAE) != TRUE) {
-            return (FALSE);
-        }
-    }
-
-    StorPortDebugPrint(INFO,
-                       "NvmeAdapterControlPowerDown: returning %d\n",
-                       status);
-    return status;
-}
-
-/*******************************************************************************
- * NVMePowerControl
- *
- * @brief This function handles the power requests srb from the storport. This
- *        routine handles request from system to go to S3/S4 state or resume
- *        from S3/S4 state.
- * 
- * @param pAE - pointer to device extension
- * @param pPowerSrb - Power SRB pointer
- * 
- * @return BOOLEAN
- *     TRUE - command was processed successfully
- *     FALSE - If anything goes wrong
- ******************************************************************************/
-BOOLEAN NVMePowerControl(
-    IN PNVME_DEVICE_EXTENSION pAE,
-    IN PSCSI_REQUEST_BLOCK Srb
-)
-{
-    BOOLEAN status = FALSE;
-    BOOLEAN powerActionValid = FALSE;
-    NVME_PWR_ACTION nvmePwrAction = NVME_PWR_NONE;
-    PSCSI_POWER_REQUEST_BLOCK pPowerSrb = (PSCSI_POWER_REQUEST_BLOCK)Srb;
-#if (NTDDI_VERSION > NTDDI_WIN7)
-    PSRBEX_DATA_POWER pSrbExPower = NULL;
-#endif
-
-    ULONG PowerAction = 0;
-    UCHAR SrbPowerFlags = 0;
-    ULONG DevicePowerState = 0;
-
-#if (NTDDI_VERSION > NTDDI_WIN7)
-    pSrbExPower = (PSRBEX_DATA_POWER)SrbGetSrbExDataByType((PSTORAGE_REQUEST_BLOCK)Srb,
-                                                            SrbExDataTypePower);
-    if (pSrbExPower != NULL) {
-        PowerAction = pSrbExPower->PowerAction;
-        SrbPowerFlags = pSrbExPower->SrbPowerFlags;
-        DevicePowerState = pSrbExPower->DevicePowerState;
-    }
-    else {
-        PowerAction = pPowerSrb->PowerAction;
-        SrbPowerFlags = pPowerSrb->SrbPowerFlags;
-        DevicePowerState = pPowerSrb->DevicePowerState;
-    }
-#else
-    PowerAction = pPowerSrb->PowerAction;
-    SrbPowerFlags = pPowerSrb->SrbPowerFlags;
-    DevicePowerState = pPowerSrb->DevicePowerState;
-#endif
-
-    if ((SrbPowerFlags & SRB_POWER_FLAGS_ADAPTER_REQUEST) == FALSE) {
-        /* 
-         * Storport should not send the device level request (i.e PathId,
-         * TargetId, LUNID) but in case if it does then ignore it and return
-         * success.
-         */
-        Srb->SrbStatus = SRB_STATUS_SUCCESS;
-        return FALSE;
-    }
-
-    switch (DevicePowerState) {
-        case StorPowerDeviceD0:
-        case StorPowerDeviceD3:
-            StorPortDebugPrint(INFO,
-                               "Device Power State request %d\n",
-                               DevicePowerState);
-            powerActionValid = TRUE;
-        break;
-        case StorPowerDeviceD1:
-        case StorPowerDeviceD2:
-            StorPortDebugPrint(INFO,
-                               "Device Power State request %d\n",
-                               DevicePowerState);
-            powerActionValid = FALSE;
-            status = TRUE;
-        break;
-        case StorPowerDeviceUnspecified:
-            StorPortDebugPrint(WARNING,
-                               "Unsupported Device Power State received %d\n",
-                               DevicePowerState);
-            powerActionValid = FALSE;
-        break;
-        default:
-            ASSERT(FALSE);
-        break;
-    }
-
-    /* 
-     * Based on power state validity, which we determined above, we will
-     * transition into appropriate state.
-     */
-    if (powerActionValid == TRUE) {
-        switch (PowerAction) {
-            case StorPowerActionNone:
-            break;
-            case StorPowerActionHibernate:
-            case StorPowerActionSleep:
-                switch (DevicePowerState) {
-                    case StorPowerDeviceD0:
-                        nvmePwrAction = NVME_PWR_ADAPTER_RESUME_FROM_S3_S4;
-                    break;
-                    case StorPowerDeviceD3:
-                        nvmePwrAction = NVME_PWR_ADAPTER_ENTER_S3_S4;
-
-                        /* 
-                         * Save the PowerAction to prevent 
-                         * SCSIOP_START_STOP_UNIT to issue any cmds if we are 
-                         * waking from the Hibernate and before our controller 
-                         * is ready.
-                         */
-                        pAE->PowerAction = PowerAction;
-                    break;
-                    default:
-                        /* nvmePwrAction already initialized to NVME_PWR_NONE */
-                    break;
-                } /* end DevicePowerState switch */
-            break;
-            case StorPowerActionShutdown:
-            case StorPowerActionShutdownReset:
-            case StorPowerActionShutdownOff:
-            case StorPowerActionWarmEject:
-                nvmePwrAction =  NVME_PWR_ADAPTER_OFF;
-            break;
-            case StorPowerActionReserved:
-            default:
-                StorPortDebugPrint(ERROR,
-                                   "Unsupported Power Action requested %d\n",
-                                   PowerAction);
-            break;
-        } /* end PowerAction switch */
-    } /* end if (powerActionValid == TRUE) */
-
-    /* Now at this point we know what power action we need to take */
-    switch (nvmePwrAction) {
-        case NVME_PWR_ADAPTER_OFF:
-            status = NVMeNormalShutdown(pAE);
-        break;
-        case NVME_PWR_ADAPTER_ENTER_S3_S4:
-            status = NVMeAdapterControlPowerDown(pAE);
-        break;
-        case NVME_PWR_ADAPTER_RESUME_FROM_S3_S4:
-            status = NVMeAdapterControlPowerUp(pAE);
-        break;
-        case NVME_PWR_NONE:
-        default:
-            /* Do nothing, just complete */
-            Srb->SrbStatus= SRB_STATUS_SUCCESS;
-            return FALSE;
-        break;
-    } /* end switch */
-
-    return status;
-}
-
-#if (NTDDI_VERSION > NTDDI_WIN7)
-/*******************************************************************************
-* NVMeAdapterPowerControl
-*
-* @brief This function handles the power requests srb from the storport. This
-*        routine handles request from system to go to S3/S4 state or resume
-*        from S3/S4 state.
-*
-* @param pAE - pointer to device extension
-* @param DevicePowerState - Device Power State
-* @param PowerAction - Power Action
-*
-* @return BOOLEAN
-*     TRUE - command was processed successfully
-*     FALSE - If anything goes wrong
-******************************************************************************/
-BOOLEAN NVMeAdapterPowerControl(
-    IN PNVME_DEVICE_EXTENSION pAE,
-    IN ULONG DevicePowerState,
-	IN ULONG PowerAction
-	)
-{
-    BOOLEAN status = FALSE;
-    BOOLEAN powerActionValid = FALSE;
-    NVME_PWR_ACTION nvmePwrAction = NVME_PWR_NONE;
-
-    switch (DevicePowerState) {
-    case StorPowerDeviceD0:
-    case StorPowerDeviceD3:
-        StorPortDebugPrint(INFO, "NVMePowerControl: <Info> Device Power State request %d\n", DevicePowerState);
-        powerActionValid = TRUE;
-        break;
-    case StorPowerDeviceD1:
-    case StorPowerDeviceD2:
-        StorPortDebugPrint(INFO, "NVMePowerControl: <Info> Device Power State request %d\n", DevicePowerState);
-        powerActionValid = FALSE;
-        status = TRUE;
-        break;
-	case StorPowerDeviceUnspecified:
-        StorPortDebugPrint(ERROR, "NVMePowerControl: <Error> Unsupported Device Power State received %d\n", DevicePowerState);
-        powerActionValid = FALSE;
-        break;
-	default:
-        ASSERT(FALSE);
-        break;
-	}
-
-	/*
-	* Based on power state validity, which we determined above, we will
-	* transition into appropriate state.
-	*/
-    if (powerActionValid == TRUE) {
-        switch (PowerAction) {
-        case StorPowerActionNone:
-            break;
-        case StorPowerActionHibernate:
-        case StorPowerActionSleep:
-            switch (DevicePowerState) {
-            case StorPowerDeviceD0:
-                nvmePwrAction = NVME_PWR_ADAPTER_RESUME_FROM_S3_S4;
-                break;
-            case StorPowerDeviceD3:
-                nvmePwrAction = NVME_PWR_ADAPTER_ENTER_S3_S4;
-
-                /*
-                * Save the PowerAction to prevent
-                * SCSIOP_START_STOP_UNIT to issue any cmds if we are
-                * waking from the Hibernate and before our controller
-                * is ready.
-                */
-                pAE->PowerAction = PowerAction;
-                break;
-            default:
-                /* nvmePwrAction already initialized to NVME_PWR_NONE */
-                break;
-            } /* end DevicePowerState switch */
-            break;
-        case StorPowerActionShutdown:
-        case StorPowerActionShutdownReset:
-        case StorPowerActionShutdownOff:
-        case StorPowerActionWarmEject:
-            nvmePwrAction = NVME_PWR_ADAPTER_OFF;
-            break;
-        case StorPowerActionReserved:
-        default:
-            StorPortDebugPrint(ERROR, "NVMePowerControl: <Error> Unsupported Device Power Action requested %d\n", PowerAction);
-            break;
-        } /* end PowerAction switch */
-    } /* end if (powerActionValid == TRUE) */
-
-    /* Now at this point we know what power action we need to take */
-    switch (nvmePwrAction) {
-    case NVME_PWR_ADAPTER_OFF:
-        status = NVMeNormalShutdown(pAE);
-        break;
-    case NVME_PWR_ADAPTER_ENTER_S3_S4:
-        StorPortPause(pAE, STOR_ALL_REQUESTS);
-        status = NVMeAdapterControlPowerDown(pAE);
-        break;
-    case NVME_PWR_ADAPTER_RESUME_FROM_S3_S4:
-        status = NVMeAdapterControlPowerUp(pAE);
-        break;
-    case NVME_PWR_NONE:
-    default:
-        return FALSE;
-        break;
-    } /* end switch */
-
-    return status;
-}
-#endif
+/**
+ *******************************************************************************
+ ** Copyright (c) 2011-2012                                                   **
+ **                                                                           **
+ **   Integrated Device Technology, Inc.                                      **
+ **   Intel Corporation                                                       **
+ **   LSI Corporation                                                         **
+ **                                                                           **
+ ** All rights reserved.                                                      **
+ **                                                                           **
+ *******************************************************************************
+ **                                                                           **
+ ** Redistribution and use in source and binary forms, with or without        **
+ ** modification, are permitted provided that the following conditions are    **
+ ** met:                                                                      **
+ **                                                                           **
+ **   1. Redistributions of source code must retain the above copyright       **
+ **      notice, this list of conditions and the following disclaimer.        **
+ **                                                                           **
+ **   2. Redistributions in binary form must reproduce the above copyright    **
+ **      notice, this list of conditions and the following disclaimer in the  **
+ **      documentation and/or other materials provided with the distribution. **
+ **                                                                           **
+ ** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS   **
+ ** IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, **
+ ** THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR    **
+ ** PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR         **
+ ** CONTRIBUTORS BE LIABLE FOR ANY DIRECT,INDIRECT, INCIDENTAL, SPECIAL,      **
+ ** EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,       **
+ ** PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR        **
+ ** PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF    **
+ ** LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING      **
+ ** NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS        **
+ ** SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.              **
+ **                                                                           **
+ ** The views and conclusions contained in the software and documentation     **
+ ** are those of the authors and should not be interpreted as representing    **
+ ** official policies, either expressed or implied, of Intel Corporation,     **
+ ** Integrated Device Technology Inc., or Sandforce Corporation.              **
+ **                                                                           **
+ *******************************************************************************
+**/
+
+/*
+ * File: nvmePwrMgmt.c
+ */
+
+#include "precomp.h"
+#ifndef DBG
+#include "nvmePwrMgmt.tmh"
+#endif
+
+/*******************************************************************************
+ * NVMeAdapterControlPowerUp
+ *
+ * @brief Routine for powering up the controller
+ * 
+ * @param pAE - pointer to device extension
+ * 
+ * @return BOOLEAN
+ *     TRUE - command was processed successfully
+ *     FALSE - If anything goes wrong
+ ******************************************************************************/
+BOOLEAN NVMeAdapterControlPowerUp(
+    IN PNVME_DEVICE_EXTENSION pAE
+)
+{
+    BOOLEAN status = TRUE;
+    LARGE_INTEGER startTime = {0};
+    LARGE_INTEGER endTime = {0};
+    BOOLEAN fastResume;
+
+    StorPortQuerySystemTime(&startTime);
+
+    /*
+     * Nothing about the namespaces changes across S3/S4 unless the controller
+     * does, so keep what was found before the power down. The start state
+     * machine checks the controller identity and rescans if it changed.
+     */
+    fastResume = ((pAE->InitInfo.FastResume != 0) &&
+                  (pAE->DriverState.NumKnownNamespaces != 0)) ? TRUE : FALSE;
+    pAE->DriverState.FastResume = fastResume;
+
+    /* Reset the controller */
+    if (NVMeReInitializeController(pAE) == FALSE) {
+        pAE->DriverState.FastResume = FALSE;
+        NVMeFreeBuffers(pAE);
+        return (FALSE);
+    }
+
+    /* A changed controller had its namespaces rescanned, have Windows look */
+    if ((fastResume == TRUE) && (pAE->DriverState.FastResume == FALSE))
+        StorPortNotification(BusChangeDetected, pAE);
+
+    pAE->DriverState.FastResume = FALSE;
+    pAE->ShutdownInProgress = FALSE;
+
+    StorPortQuerySystemTime(&endTime);
+    pAE->LastResumeMs = (ULONG)((endTime.QuadPart - startTime.QuadPart) / 10000);
+    StorPortDebugPrint(INFO,
+                       "NvmeAdapterControlPowerUp: resumed in %d ms\n",
+                       pAE->LastResumeMs);
+    StorPortDebugPrint(INFO, "NvmeAdapterControlPowerUp: returning TRUE\n");
+    return status;
+}
+
+/*******************************************************************************
+ * NVMeAdapterControlPowerDown
+ *
+ * @brief This function is called when srb function is SRB_FUNCTION_POWER or
+ *        from NVMeAdapterControl when Control type is ScsiStopAdapter.
+ * 
+ * @param pAE - pointer to device extension
+ * 
+ * @return BOOLEAN
+ *     TRUE - command was processed successfully
+ *     FALSE - If anything goes wrong
+ ******************************************************************************/
+BOOLEAN NVMeAdapterControlPowerDown(
+    IN PNVME_DEVICE_EXTENSION pAE
+)
+{
+    BOOLEAN status = FALSE;
+
+    ASSERT(pAE != NULL);
+
+    /*
+     * The controller is powered down when we get SRB_FUNCTION_POWER in
+     * StartIo... nothing else to do, just return.
+     */
+    if (pAE->ShutdownInProgress == TRUE) {
+        /* Shutdown */
+        status = TRUE;
+    } else {
+		pAE->ShutdownInProgress = TRUE;
+
+        /* Hibernate or Sleep - sanity check that there is no cmd pending */
+        if (NVMeDetectPendingCmds(pAE, FALSE, SRB_STATUS_BUS_RESET) == TRUE)
+            return status;
+
+        /* Take the Host Memory Buffer back, it is enabled again on resume */
+        NVMeDisableHmb(pAE);
+        NVMeReportPowerStates(pAE);
+
+        /* Stop the controller, but do not free the resources */
+        if (NVMeResetAdapter(pAE) != TRUE) {
+            return (FALSE);
+        }
+    }
+
+    StorPortDebugPrint(INFO,
+                       "NvmeAdapterControlPowerDown: returning %d\n",
+                       status);
+    return status;
+}
+
+/*******************************************************************************
+ * NVMePowerControl
+ *
+ * @brief This function handles the power requests srb from the storport. This
+ *        routine handles request from system to go to S3/S4 state or resume
+ *        from S3/S4 state.
+ * 
+ * @param pAE - pointer to device extension
+ * @param pPowerSrb - Power SRB pointer
+ * 
+ * @return BOOLEAN
+ *     TRUE - command was processed successfully
+ *     FALSE - If anything goes wrong
+ ******************************************************************************/
+BOOLEAN NVMePowerControl(
+    IN PNVME_DEVICE_EXTENSION pAE,
+    IN PSCSI_REQUEST_BLOCK Srb
+)
+{
+    BOOLEAN status = FALSE;
+    BOOLEAN powerActionValid = FALSE;
+    NVME_PWR_ACTION nvmePwrAction = NVME_PWR_NONE;
+    PSCSI_POWER_REQUEST_BLOCK pPowerSrb = (PSCSI_POWER_REQUEST_BLOCK)Srb;
+#if (NTDDI_VERSION > NTDDI_WIN7)
+    PSRBEX_DATA_POWER pSrbExPower = NULL;
+#endif
+
+    ULONG PowerAction = 0;
+    UCHAR SrbPowerFlags = 0;
+    ULONG DevicePowerState = 0;
+
+#if (NTDDI_VERSION > NTDDI_WIN7)
+    pSrbExPower = (PSRBEX_DATA_POWER)SrbGetSrbExDataByType((PSTORAGE_REQUEST_BLOCK)Srb,
+                                                            SrbExDataTypePower);
+    if (pSrbExPower != NULL) {
+        PowerAction = pSrbExPower->PowerAction;
+        SrbPowerFlags = pSrbExPower->SrbPowerFlags;
+        DevicePowerState = pSrbExPower->DevicePowerState;
+    }
+    else {
+        PowerAction = pPowerSrb->PowerAction;
+        SrbPowerFlags = pPowerSrb->SrbPowerFlags;
+        DevicePowerState = pPowerSrb->DevicePowerState;
+    }
+#else
+    PowerAction = pPowerSrb->PowerAction;
+    SrbPowerFlags = pPowerSrb->SrbPowerFlags;
+    DevicePowerState = pPowerSrb->DevicePowerState;
+#endif
+
+    if ((SrbPowerFlags & SRB_POWER_FLAGS_ADAPTER_REQUEST) == FALSE) {
+        /* 
+         * Storport should not send the device level request (i.e PathId,
+         * TargetId, LUNID) but in case if it does then ignore it and return
+         * success.
+         */
+        Srb->SrbStatus = SRB_STATUS_SUCCESS;
+        return FALSE;
+    }
+
+    switch (DevicePowerState) {
+        case StorPowerDeviceD0:
+        case StorPowerDeviceD3:
+            StorPortDebugPrint(INFO,
+                               "Device Power State request %d\n",
+                               DevicePowerState);
+            powerActionValid = TRUE;
+        break;
+        case StorPowerDeviceD1:
+        case StorPowerDeviceD2:
+            StorPortDebugPrint(INFO,
+                               "Device Power State request %d\n",
+                               DevicePowerState);
+            powerActionValid = FALSE;
+            status = TRUE;
+        break;
+        case StorPowerDeviceUnspecified:
+            StorPortDebugPrint(WARNING,
+                               "Unsupported Device Power State received %d\n",
+                               DevicePowerState);
+            powerActionValid = FALSE;
+        break;
+        default:
+            ASSERT(FALSE);
+        break;
+    }
+
+    /* 
+     * Based on power state validity, which we determined above, we will
+     * transition into appropriate state.
+     */
+    if (powerActionValid == TRUE) {
+        switch (PowerAction) {
+            case StorPowerActionNone:
+            break;
+            case StorPowerActionHibernate:
+            case StorPowerActionSleep:
+                switch (DevicePowerState) {
+                    case StorPowerDeviceD0:
+                        nvmePwrAction = NVME_PWR_ADAPTER_RESUME_FROM_S3_S4;
+                    break;
+                    case StorPowerDeviceD3:
+                        nvmePwrAction = NVME_PWR_ADAPTER_ENTER_S3_S4;
+
+                        /* 
+                         * Save the PowerAction to prevent 
+                         * SCSIOP_START_STOP_UNIT to issue any cmds if we are 
+                         * waking from the Hibernate and before our controller 
+                         * is ready.
+                         */
+                        pAE->PowerAction = PowerAction;
+                    break;
+                    default:
+                        /* nvmePwrAction already initialized to NVME_PWR_NONE */
+                    break;
+                } /* end DevicePowerState switch */
+            break;
+            case StorPowerActionShutdown:
+            case StorPowerActionShutdownReset:
+            case StorPowerActionShutdownOff:
+            case StorPowerActionWarmEject:
+                nvmePwrAction =  NVME_PWR_ADAPTER_OFF;
+            break;
+            case StorPowerActionReserved:
+            default:
+                StorPortDebugPrint(ERROR,
+                                   "Unsupported Power Action requested %d\n",
+                                   PowerAction);
+            break;
+        } /* end PowerAction switch */
+    } /* end if (powerActionValid == TRUE) */
+
+    /* Now at this point we know what power action we need to take */
+    switch (nvmePwrAction) {
+        case NVME_PWR_ADAPTER_OFF:
+            status = NVMeNormalShutdown(pAE);
+        break;
+        case NVME_PWR_ADAPTER_ENTER_S3_S4:
+            status = NVMeAdapterControlPowerDown(pAE);
+        break;
+        case NVME_PWR_ADAPTER_RESUME_FROM_S3_S4:
+            status = NVMeAdapterControlPowerUp(pAE);
+        break;
+        case NVME_PWR_NONE:
+        default:
+            /* Do nothing, just complete */
+            Srb->SrbStatus= SRB_STATUS_SUCCESS;
+            return FALSE;
+        break;
+    } /* end switch */
+
+    return status;
+}
+
+#if (NTDDI_VERSION > NTDDI_WIN7)
+/*******************************************************************************
+* NVMeAdapterPowerControl
+*
+* @brief This function handles the power requests srb from the storport. This
+*        routine handles request from system to go to S3/S4 state or resume
+*        from S3/S4 state.
+*
+* @param pAE - pointer to device extension
+* @param DevicePowerState - Device Power State
+* @param PowerAction - Power Action
+*
+* @return BOOLEAN
+*     TRUE - command was processed successfully
+*     FALSE - If anything goes wrong
+******************************************************************************/
+BOOLEAN NVMeAdapterPowerControl(
+    IN PNVME_DEVICE_EXTENSION pAE,
+    IN ULONG DevicePowerState,
+	IN ULONG PowerAction
+	)
+{
+    BOOLEAN status = FALSE;
+    BOOLEAN powerActionValid = FALSE;
+    NVME_PWR_ACTION nvmePwrAction = NVME_PWR_NONE;
+
+    switch (DevicePowerState) {
+    case StorPowerDeviceD0:
+    case StorPowerDeviceD3:
+        StorPortDebugPrint(INFO, "NVMePowerControl: <Info> Device Power State request %d\n", DevicePowerState);
+        powerActionValid = TRUE;
+        break;
+    case StorPowerDeviceD1:
+    case StorPowerDeviceD2:
+        StorPortDebugPrint(INFO, "NVMePowerControl: <Info> Device Power State request %d\n", DevicePowerState);
+        powerActionValid = FALSE;
+        status = TRUE;
+        break;
+	case StorPowerDeviceUnspecified:
+        StorPortDebugPrint(ERROR, "NVMePowerControl: <Error> Unsupported Device Power State received %d\n", DevicePowerState);
+        powerActionValid = FALSE;
+        break;
+	default:
+        ASSERT(FALSE);
+        break;
+	}
+
+	/*
+	* Based on power state validity, which we determined above, we will
+	* transition into appropriate state.
+	*/
+    if (powerActionValid == TRUE) {
+        switch (PowerAction) {
+        case StorPowerActionNone:
+            break;
+        case StorPowerActionHibernate:
+        case StorPowerActionSleep:
+            switch (DevicePowerState) {
+            case StorPowerDeviceD0:
+                nvmePwrAction = NVME_PWR_ADAPTER_RESUME_FROM_S3_S4;
+                break;
+            case StorPowerDeviceD3:
+                nvmePwrAction = NVME_PWR_ADAPTER_ENTER_S3_S4;
+
+                /*
+                * Save the PowerAction to prevent
+                * SCSIOP_START_STOP_UNIT to issue any cmds if we are
+                * waking from the Hibernate and before our controller
+                * is ready.
+                */
+                pAE->PowerAction = PowerAction;
+                break;
+            default:
+                /* nvmePwrAction already initialized to NVME_PWR_NONE */
+                break;
+            } /* end DevicePowerState switch */
+            break;
+        case StorPowerActionShutdown:
+        case StorPowerActionShutdownReset:
+        case StorPowerActionShutdownOff:
+        case StorPowerActionWarmEject:
+            nvmePwrAction = NVME_PWR_ADAPTER_OFF;
+            break;
+        case StorPowerActionReserved:
+        default:
+            StorPortDebugPrint(ERROR, "NVMePowerControl: <Error> Unsupported Device Power Action requested %d\n", PowerAction);
+            break;
+        } /* end PowerAction switch */
+    } /* end if (powerActionValid == TRUE) */
+
+    /* Now at this point we know what power action we need to take */
+    switch (nvmePwrAction) {
+    case NVME_PWR_ADAPTER_OFF:
+        status = NVMeNormalShutdown(pAE);
+        break;
+    case NVME_PWR_ADAPTER_ENTER_S3_S4:
+        StorPortPause(pAE, STOR_ALL_REQUESTS);
+        status = NVMeAdapterControlPowerDown(pAE);
+        break;
+    case NVME_PWR_ADAPTER_RESUME_FROM_S3_S4:
+        status = NVMeAdapterControlPowerUp(pAE);
+        break;
+    case NVME_PWR_NONE:
+    default:
+        return FALSE;
+        break;
+    } /* end switch */
+
+    return status;
+}
+#endif
+
+/*******************************************************************************
+ * NVMeBuildApstTable
+ *
+ * @brief Builds the Autonomous Power State Transition table from the Identify
+ *        Controller power state descriptors. Walking from the deepest state
+ *        up, every state is set to move to the deepest non-operational state
+ *        below it whose exit latency fits the budget. The idle time before
+ *        moving is 50 times the entry plus exit latency of the target state,
+ *        so the transitions cost at most about 2% of idle time.
+ *
+ * @param pAE - pointer to device extension
+ * @param MaxLatency - exit latency budget in microseconds
+ * @param pTable - APST_MAX_ENTRIES entries to fill in
+ *
+ * @return ULONG
+ *     Number of power states given a transition, 0 if none fits the budget
+ ******************************************************************************/
+ULONG NVMeBuildApstTable(
+    IN PNVME_DEVICE_EXTENSION pAE,
+    IN ULONG MaxLatency,
+    OUT PNVMe_APST_ENTRY pTable
+)
+{
+    PADMIN_IDENTIFY_CONTROLLER pCtrl = &pAE->controllerIdentifyData;
+    PADMIN_IDENTIFY_POWER_STATE_DESCRIPTOR pPsd = NULL;
+    NVMe_APST_ENTRY Target = {0};
+    ULONGLONG IdleMs = 0;
+    ULONG Transitions = 0;
+    LONG State = 0;
+
+    memset(pTable, 0, sizeof(NVMe_APST_ENTRY) * APST_MAX_ENTRIES);
+
+    for (State = min(pCtrl->NPSS, APST_MAX_ENTRIES - 1); State >= 0; State--) {
+        if (Target.ITPT != 0) {
+            pTable[State] = Target;
+            Transitions++;
+        }
+
+        /* Only non-operational states within the budget are targets */
+        pPsd = &pCtrl->PSDx[State];
+        if ((State == 0) ||
+            (pPsd->NOPS == 0) ||
+            (pPsd->EXLAT > MaxLatency))
+            continue;
+
+        IdleMs = ((ULONGLONG)pPsd->ENLAT + pPsd->EXLAT + 19) / 20;
+        IdleMs = min(max(IdleMs, 1), 0xFFFFFF);
+        Target.ITPS = State;
+        Target.ITPT = IdleMs;
+    }
+
+    return Transitions;
+} /* NVMeBuildApstTable */
+
+/*******************************************************************************
+ * NVMeSetApst
+ *
+ * @brief Issues Set Features (Autonomous Power State Transition) with the
+ *        table built under the ApstMaxLatency budget. APST is disabled when
+ *        no state fits the budget, so firmware defaults don't pick states
+ *        that are too slow to leave.
+ *
+ * @param pAE - pointer to device extension
+ *
+ * @return BOOLEAN
+ *     Returns TRUE if the command was issued, otherwise, FALSE.
+ ******************************************************************************/
+BOOLEAN NVMeSetApst(
+    IN PNVME_DEVICE_EXTENSION pAE
+)
+{
+    PNVME_SRB_EXTENSION pNVMeSrbExt =
+        (PNVME_SRB_EXTENSION)pAE->DriverState.pSrbExt;
+    PNVMe_COMMAND pSetFeatures = (PNVMe_COMMAND)(&pNVMeSrbExt->nvmeSqeUnit);
+    PADMIN_SET_FEATURES_COMMAND_DW10 pSetFeaturesCDW10 = NULL;
+    PADMIN_SET_FEATURES_COMMAND_APST_DW11 pSetFeaturesCDW11 = NULL;
+    ULONG Transitions = 0;
+
+    Transitions = NVMeBuildApstTable(pAE,
+                                     pAE->InitInfo.ApstMaxLatency,
+                                     pAE->ApstTable);
+
+    /* Zero out the extension first */
+    memset((PVOID)pNVMeSrbExt, 0, sizeof(NVME_SRB_EXTENSION));
+
+    /* Populate SRB_EXTENSION fields */
+    pNVMeSrbExt->pNvmeDevExt = pAE;
+    pNVMeSrbExt->pNvmeCompletionRoutine = NVMeInitCallback;
+
+    memset(pAE->DriverState.pDataBuffer, 0, PAGE_SIZE);
+    StorPortCopyMemory(pAE->DriverState.pDataBuffer,
+                       pAE->ApstTable,
+                       sizeof(pAE->ApstTable));
+
+    if (NVMePreparePRPs(pAE,
+                        pNVMeSrbExt,
+                        pAE->DriverState.pDataBuffer,
+                        sizeof(pAE->ApstTable)) == FALSE) {
+        return (FALSE);
+    }
+
+    /* Populate submission entry fields */
+    pSetFeatures->CDW0.OPC = ADMIN_SET_FEATURES;
+    pSetFeaturesCDW10 = (PADMIN_SET_FEATURES_COMMAND_DW10) &pSetFeatures->CDW10;
+    pSetFeaturesCDW11 = (PADMIN_SET_FEATURES_COMMAND_APST_DW11)
+        &pSetFeatures->CDW11;
+
+    pSetFeaturesCDW10->FID = AUTONOMOUS_POWER_STATE_TRANSITION;
+    pSetFeaturesCDW11->APSTE = (Transitions != 0) ? 1 : 0;
+
+    StorPortDebugPrint(INFO,
+                       "NVMeSetApst: %d states with transitions, budget %d us\n",
+                       Transitions,
+                       pAE->InitInfo.ApstMaxLatency);
+
+    /* Now issue the command via Admin Doorbell register */
+    return ProcessIo(pAE, pNVMeSrbExt, NVME_QUEUE_TYPE_ADMIN, FALSE);
+} /* NVMeSetApst */
+
+/*******************************************************************************
+ * NVMeApstCompletion
+ *
+ * @brief Examines the completion of the Set Features (APST) command issued by
+ *        NVMeSetApst. A failure leaves the controller with its own settings
+ *        and is not fatal.
+ *
+ * @param pAE - pointer to device extension
+ * @param pCplEntry - Pointer to the completion entry
+ *
+ * @return VOID
+ ******************************************************************************/
+VOID NVMeApstCompletion(
+    IN PNVME_DEVICE_EXTENSION pAE,
+    IN PNVMe_COMPLETION_QUEUE_ENTRY pCplEntry
+)
+{
+    PADMIN_SET_FEATURES_COMMAND_APST_DW11 pSetFeaturesCDW11 =
+        (PADMIN_SET_FEATURES_COMMAND_APST_DW11)
+        &((PNVME_SRB_EXTENSION)pAE->DriverState.pSrbExt)->nvmeSqeUnit.CDW11;
+
+    if ((pCplEntry->DW3.SF.SC == SUCCESSFUL_COMPLETION) &&
+        (pCplEntry->DW3.SF.SCT == GENERIC_COMMAND_STATUS)) {
+        pAE->ApstEnabled = (pSetFeaturesCDW11->APSTE == 1) ? TRUE : FALSE;
+    } else {
+        StorPortDebugPrint(INFO,
+            "NVMeApstCompletion: failed (SCT 0x%x SC 0x%x)\n",
+            pCplEntry->DW3.SF.SCT,
+            pCplEntry->DW3.SF.SC);
+    }
+
+    /* Reset the counter and move on to Predictable Latency Mode */
+    pAE->DriverState.StateChkCount = 0;
+    pAE->DriverState.NextDriverState = NVMeWaitOnPlm;
+} /* NVMeApstCompletion */
+
+/*******************************************************************************
+ * NVMeAccountPowerStates
+ *
+ * @brief Adds the last ElapsedMs milliseconds to the time spent per power
+ *        state. An interval in which IO was submitted counts as power state
+ *        0. Otherwise the idle time so far is walked through the APST table,
+ *        and each state gets the part of the interval it would have covered.
+ *
+ * @param pAE - pointer to device extension
+ * @param ElapsedMs - length of the interval
+ *
+ * @return VOID
+ ******************************************************************************/
+VOID NVMeAccountPowerStates(
+    IN PNVME_DEVICE_EXTENSION pAE,
+    IN ULONG ElapsedMs
+)
+{
+    PQUEUE_INFO pQI = &pAE->QueueInfo;
+    PNVMe_APST_ENTRY pEntry = NULL;
+    ULONGLONG Requests = 0;
+    ULONGLONG Start = pAE->ApstIdleMs;
+    ULONGLONG End = Start + ElapsedMs;
+    ULONGLONG From = 0;
+    ULONGLONG Next = 0;
+    ULONG State = 0;
+    ULONG Steps = 0;
+    USHORT QueueID;
+
+    if (pQI->pSubQueueInfo == NULL)
+        return;
+
+    /* Counters are read without locks, a stale value only shifts a second */
+    for (QueueID = 1; QueueID <= pQI->NumSubIoQCreated; QueueID++)
+        Requests += (ULONGLONG)pQI->pSubQueueInfo[QueueID].Requests;
+
+    if ((pAE->ApstEnabled == FALSE) || (Requests != pAE->ApstLastRequests)) {
+        pAE->ApstLastRequests = Requests;
+        pAE->ApstIdleMs = 0;
+        pAE->PowerStateMs[0] += ElapsedMs;
+        return;
+    }
+
+    for (Steps = 0; Steps < APST_MAX_ENTRIES; Steps++) {
+        pEntry = &pAE->ApstTable[State];
+        Next = (pEntry->ITPT != 0) ? From + pEntry->ITPT : End;
+        if (Next > Start)
+            pAE->PowerStateMs[State] += min(Next, End) - max(From, Start);
+        if (Next >= End)
+            break;
+
+        From = Next;
+        State = (ULONG)pEntry->ITPS;
+    }
+
+    /* Past a day of idling the deepest state has long been reached */
+    pAE->ApstIdleMs = (ULONG)min(End, 24 * 60 * 60 * 1000);
+} /* NVMeAccountPowerStates */
+
+/*******************************************************************************
+ * NVMeReportPowerStates
+ *
+ * @brief Prints the time spent per power state, called when the controller is
+ *        powered down.
+ *
+ * @param pAE - pointer to device extension
+ *
+ * @return VOID
+ ******************************************************************************/
+VOID NVMeReportPowerStates(
+    IN PNVME_DEVICE_EXTENSION pAE
+)
+{
+    ULONG State;
+
+    for (State = 0; State < APST_MAX_ENTRIES; State++) {
+        if (pAE->PowerStateMs[State] == 0)
+            continue;
+
+        StorPortDebugPrint(INFO,
+                           "NVMeReportPowerStates: PS%d %I64u ms\n",
+                           State,
+                           pAE->PowerStateMs[State]);
+    }
+} /* NVMeReportPowerStates */